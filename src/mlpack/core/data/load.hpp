@@ -13,6 +13,8 @@
 #include <mlpack/core/arma_extend/arma_extend.hpp> // Includes Armadillo.
 #include <string>
 
+#include "mapped_matrix.hpp"
+
 namespace mlpack {
 namespace data /** Functions to load and save matrices. */ {
 
@@ -25,6 +27,7 @@ namespace data /** Functions to load and save matrices. */ {
  *
  *  - CSV (csv_ascii), denoted by .csv, or optionally .txt
  *  - ASCII (raw_ascii), denoted by .txt
+ *  - TSV (tab-separated values), denoted by .tsv
  *  - Armadillo ASCII (arma_ascii), also denoted by .txt
  *  - PGM (pgm_binary), denoted by .pgm
  *  - PPM (ppm_binary), denoted by .ppm
@@ -36,6 +39,11 @@ namespace data /** Functions to load and save matrices. */ {
  * This is preferable to Armadillo's default behavior of loading an unknown
  * filetype as raw_binary, which can have very confusing effects.
  *
+ * CSV, TSV and raw ASCII files are read into float and double matrices with a
+ * multi-threaded parser (see ParseText()), which also does the transpose; if it
+ * cannot parse the file, Armadillo's loader is used instead.  The time taken is
+ * recorded in the "parsing_text" timer.
+ *
  * If the parameter 'fatal' is set to true, a std::runtime_error exception will
  * be thrown if the matrix does not load successfully.  The parameter
  * 'transpose' controls whether or not the matrix is transposed after loading.
@@ -55,6 +63,43 @@ bool Load(const std::string& filename,
           bool fatal = false,
           bool transpose = true);
 
+/**
+ * Map a raw binary or Armadillo binary file (.bin) into memory and use the
+ * mapped memory as the memory of the given matrix, through Armadillo's
+ * auxiliary memory constructor.  Nothing is read or copied at load time; pages
+ * of the file are read when they are first used.  This is meant for datasets
+ * which are too large to read and transpose.
+ *
+ * Because nothing is copied, the matrix is not transposed: the file must
+ * already hold one point per column, in column-major order.  An Armadillo
+ * binary file like that can be written with data::Save(..., transpose =
+ * false).  Raw binary files hold no size information, so the number of rows
+ * (the dimensionality of the points) must be given.  If the data in an
+ * Armadillo binary file is not aligned for eT (this depends on the length of
+ * its header), it is copied, and a warning is given.
+ *
+ * If copyOnWrite is false, the matrix is read-only, and modifying it (for
+ * instance, by building a tree on it, which rearranges the points) will crash
+ * the program.  If copyOnWrite is true, the matrix can be modified: every page
+ * which is modified is privately copied, and the file is never changed.
+ *
+ * If the parameter 'fatal' is set to true, a std::runtime_error exception will
+ * be thrown if the matrix does not load successfully.
+ *
+ * @param filename Name of file to load.
+ * @param matrix Mapped matrix to load the file into.
+ * @param fatal If an error should be reported as fatal (default false).
+ * @param copyOnWrite If true, the matrix may be modified (privately).
+ * @param rawRows Number of rows of the matrix, for raw binary files.
+ * @return Boolean value indicating success or failure of load.
+ */
+template<typename eT>
+bool Load(const std::string& filename,
+          MappedMatrix<eT>& matrix,
+          const bool fatal = false,
+          const bool copyOnWrite = false,
+          const size_t rawRows = 1);
+
 }; // namespace data
 }; // namespace mlpack
 
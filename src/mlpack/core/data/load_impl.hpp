@@ -11,8 +11,13 @@
 #include "load.hpp"
 
 #include <algorithm>
+#include <fstream>
+#include <limits>
+#include <sstream>
 #include <mlpack/core/util/timers.hpp>
 
+#include "parse_text.hpp"
+
 namespace mlpack {
 namespace data {
 
@@ -92,6 +97,12 @@ bool Load(const std::string& filename,
     loadType = arma::csv_ascii;
     stringType = "CSV data";
   }
+  else if (extension == "tsv")
+  {
+    // Armadillo reads tab-separated data as raw ASCII.
+    loadType = arma::raw_ascii;
+    stringType = "TSV data";
+  }
   else if (extension == "txt")
   {
     // This could be raw ASCII or Armadillo ASCII (ASCII with size header).
@@ -224,7 +235,49 @@ bool Load(const std::string& filename,
     Log::Info << "Loading '" << filename << "' as " << stringType << ".  "
         << std::flush;
 
-  const bool success = matrix.load(stream, loadType);
+  // Delimited text is read with the multi-threaded parser, which produces the
+  // matrix in its final orientation; if it can't handle the file, Armadillo
+  // gets a try.
+  bool success = false;
+  bool parsed = false;
+  if (arma::is_real<eT>::value &&
+      (loadType == arma::csv_ascii || loadType == arma::raw_ascii))
+  {
+    const char delimiter = (extension == "tsv") ? '\t' :
+        ((loadType == arma::csv_ascii) ? ',' : ' ');
+
+    stream.seekg(0, std::ios::end);
+    const double megabytes = double(stream.tellg()) / (1024.0 * 1024.0);
+    stream.clear();
+    stream.seekg(0, std::ios::beg);
+
+    const timeval before = Timer::Get("parsing_text");
+    Timer::Start("parsing_text");
+    std::string error;
+    parsed = ParseText(filename, matrix, delimiter, transpose, error);
+    Timer::Stop("parsing_text");
+    const timeval after = Timer::Get("parsing_text");
+
+    if (parsed)
+    {
+      const double seconds = double(after.tv_sec - before.tv_sec) +
+          double(after.tv_usec - before.tv_usec) / 1e6;
+      Log::Info << "Parsed " << megabytes << " MB";
+      if (seconds > 0.0)
+        Log::Info << " (" << (megabytes / seconds) << " MB/s)";
+      Log::Info << ".  " << std::flush;
+      success = true;
+    }
+    else
+    {
+      Log::Info << std::endl;
+      Log::Warn << "Fast parser could not read '" << filename << "' ("
+          << error << "); falling back to Armadillo." << std::endl;
+    }
+  }
+
+  if (!parsed)
+    success = matrix.load(stream, loadType);
 
   if (!success)
   {
@@ -237,12 +290,15 @@ bool Load(const std::string& filename,
 
     return false;
   }
+  else if (parsed)
+    Log::Info << "Size is " << matrix.n_rows << " x " << matrix.n_cols
+        << ".\n";
   else
     Log::Info << "Size is " << (transpose ? matrix.n_cols : matrix.n_rows)
         << " x " << (transpose ? matrix.n_rows : matrix.n_cols) << ".\n";
 
-  // Now transpose the matrix, if necessary.
-  if (transpose)
+  // Now transpose the matrix, if necessary (the parser has already done it).
+  if (transpose && !parsed)
   {
     inplace_transpose(matrix);
   }
@@ -253,6 +309,132 @@ bool Load(const std::string& filename,
   return success;
 }
 
+template<typename eT>
+bool Load(const std::string& filename,
+          MappedMatrix<eT>& matrix,
+          const bool fatal,
+          const bool copyOnWrite,
+          const size_t rawRows)
+{
+  Timer::Start("loading_data");
+
+  // Only binary files can be mapped.
+  size_t ext = filename.rfind('.');
+  std::string extension = (ext == std::string::npos) ? "" :
+      filename.substr(ext + 1);
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+      ::tolower);
+  if (extension != "bin")
+  {
+    Timer::Stop("loading_data");
+    if (fatal)
+      Log::Fatal << "Cannot map '" << filename << "' into memory; only raw "
+          << "binary and Armadillo binary (.bin) files can be mapped."
+          << std::endl;
+    else
+      Log::Warn << "Cannot map '" << filename << "' into memory; only raw "
+          << "binary and Armadillo binary (.bin) files can be mapped.  Load "
+          << "failed." << std::endl;
+
+    return false;
+  }
+
+  // Look at the header (and the size) of the file without reading the rest.
+  std::ifstream stream(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!stream.is_open())
+  {
+    Timer::Stop("loading_data");
+    if (fatal)
+      Log::Fatal << "Cannot open file '" << filename << "'. " << std::endl;
+    else
+      Log::Warn << "Cannot open file '" << filename << "'; load failed."
+          << std::endl;
+
+    return false;
+  }
+
+  stream.seekg(0, std::ios::end);
+  const size_t fileSize = (size_t) stream.tellg();
+  stream.seekg(0, std::ios::beg);
+  char headerBuffer[256];
+  stream.read(headerBuffer, std::min(fileSize, (size_t) 256));
+  const std::string contents(headerBuffer, (size_t) stream.gcount());
+  stream.close();
+
+  const std::string ARMA_MAT_BIN = "ARMA_MAT_BIN";
+  size_t offset = 0;
+  size_t rows = 0;
+  size_t cols = 0;
+  bool valid = true;
+  std::string stringType;
+  if (contents.compare(0, ARMA_MAT_BIN.length(), ARMA_MAT_BIN) == 0)
+  {
+    stringType = "Armadillo binary formatted data";
+
+    // The header is the type line, then a line with the size, then the data.
+    // The type must match the type of the matrix exactly.
+    std::istringstream header(contents);
+    std::string type;
+    header >> type >> rows >> cols;
+    header.get(); // The newline after the size.
+    valid = !header.fail() &&
+        (type == arma::diskio::gen_bin_header(matrix.Matrix()));
+    offset = (size_t) header.tellg();
+
+    // A corrupt header can give a size whose product overflows and then
+    // happens to match the size of the file, so check that first.
+    const size_t maxSize = std::numeric_limits<size_t>::max();
+    valid = valid && (offset <= fileSize) &&
+        !(rows != 0 && cols > maxSize / rows / sizeof(eT)) &&
+        (fileSize - offset == rows * cols * sizeof(eT));
+  }
+  else
+  {
+    stringType = "raw binary formatted data";
+    rows = rawRows;
+    cols = (rawRows == 0) ? 0 : (fileSize / sizeof(eT) / rawRows);
+    valid = (rawRows > 0) && (fileSize == rows * cols * sizeof(eT));
+  }
+
+  if (!valid)
+  {
+    Timer::Stop("loading_data");
+    if (fatal)
+      Log::Fatal << "Cannot map '" << filename << "' as " << stringType
+          << "; the element type or the size does not match." << std::endl;
+    else
+      Log::Warn << "Cannot map '" << filename << "' as " << stringType
+          << "; the element type or the size does not match.  Load failed."
+          << std::endl;
+
+    return false;
+  }
+
+  Log::Info << "Mapping '" << filename << "' as " << stringType << ".  "
+      << std::flush;
+
+  if (!matrix.Map(filename, offset, rows, cols, copyOnWrite))
+  {
+    Log::Info << std::endl;
+    Timer::Stop("loading_data");
+    if (fatal)
+      Log::Fatal << "Mapping '" << filename << "' failed." << std::endl;
+    else
+      Log::Warn << "Mapping '" << filename << "' failed." << std::endl;
+
+    return false;
+  }
+
+  Log::Info << "Size is " << rows << " x " << cols << ".\n";
+  if (!matrix.IsMapped() && rows * cols > 0)
+    Log::Warn << "The data in '" << filename << "' is not aligned, so it was "
+        << "copied instead of mapped." << std::endl;
+
+  Timer::Stop("loading_data");
+
+  return true;
+}
+
 }; // namespace data
 }; // namespace mlpack
 
@@ -0,0 +1,118 @@
+/**
+ * @file mapped_file.cpp
+ *
+ * Implementation of MappedFile.
+ */
+#include "mapped_file.hpp"
+
+#include <fstream>
+
+#ifndef _WIN32
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+using namespace mlpack;
+using namespace mlpack::data;
+
+MappedFile::MappedFile() :
+    data(NULL),
+    size(0),
+    isOpen(false),
+    mapped(false),
+    copyOnWrite(false)
+{
+  // Nothing to do.
+}
+
+MappedFile::~MappedFile()
+{
+  Close();
+}
+
+bool MappedFile::Open(const std::string& filename, const bool copyOnWrite)
+{
+  Close();
+
+#ifndef _WIN32
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0)
+  {
+    close(fd);
+    return false;
+  }
+
+  // An empty file cannot be mapped, but it is still a valid (empty) file.
+  size = (size_t) fileStat.st_size;
+  if (size > 0)
+  {
+    // The mapping is private either way, so writes (if they are allowed) never
+    // reach the file.
+    const int protection = copyOnWrite ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    void* address = mmap(NULL, size, protection, MAP_PRIVATE, fd, 0);
+    if (address == MAP_FAILED)
+    {
+      close(fd);
+      size = 0;
+      return false;
+    }
+
+    data = (char*) address;
+    mapped = true;
+  }
+
+  // The mapping stays valid after the file descriptor is closed.
+  close(fd);
+#else
+  std::ifstream stream(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!stream.is_open())
+    return false;
+
+  stream.seekg(0, std::ios::end);
+  size = (size_t) stream.tellg();
+  stream.seekg(0, std::ios::beg);
+
+  if (size > 0)
+  {
+    data = new char[size];
+    stream.read(data, size);
+    if (!stream.good())
+    {
+      delete[] data;
+      data = NULL;
+      size = 0;
+      return false;
+    }
+  }
+
+  mapped = false;
+#endif
+
+  this->copyOnWrite = copyOnWrite;
+  isOpen = true;
+  return true;
+}
+
+void MappedFile::Close()
+{
+  if (data != NULL)
+  {
+#ifndef _WIN32
+    munmap(data, size);
+#else
+    delete[] data;
+#endif
+  }
+
+  data = NULL;
+  size = 0;
+  isOpen = false;
+  mapped = false;
+  copyOnWrite = false;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file mapped_file.hpp
+ *
+ * A file which is mapped into memory, used by the memory-mapped overload of
+ * data::Load().
+ */
+#ifndef __MLPACK_CORE_DATA_MAPPED_FILE_HPP
+#define __MLPACK_CORE_DATA_MAPPED_FILE_HPP
+
+#include <string>
+#include <cstddef>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * The contents of a file, mapped into memory with mmap() so that nothing is
+ * read until it is used.  The mapping is always private: if the file is opened
+ * for copy-on-write, the memory may be modified, but each modified page is
+ * copied first and the file itself is never changed.  Otherwise, the memory is
+ * read-only and writing to it will crash the program.
+ *
+ * On systems without mmap() (Windows), the whole file is read into memory
+ * instead, and the memory can always be modified.
+ */
+class MappedFile
+{
+ public:
+  //! Create an empty object which does not hold a file.
+  MappedFile();
+
+  //! Unmap the file, if one is mapped.
+  ~MappedFile();
+
+  /**
+   * Map the given file into memory, unmapping any file that is already mapped.
+   *
+   * @param filename Name of the file to map.
+   * @param copyOnWrite If true, the memory can be modified (without modifying
+   *     the file).
+   * @return false if the file could not be opened or mapped.
+   */
+  bool Open(const std::string& filename, const bool copyOnWrite = false);
+
+  //! Unmap the file; this invalidates any pointer to its memory.
+  void Close();
+
+  //! Return whether or not a file is held.
+  bool IsOpen() const { return isOpen; }
+  //! Return whether or not the file is actually mapped (and not read).
+  bool IsMapped() const { return mapped; }
+  //! Return whether or not the memory can be modified.
+  bool CopyOnWrite() const { return copyOnWrite; }
+
+  //! Get the contents of the file (NULL if the file is empty).
+  const char* Data() const { return data; }
+  //! Modify the contents of the file; only allowed if CopyOnWrite() is true.
+  char* Data() { return data; }
+
+  //! Get the size of the file in bytes.
+  size_t Size() const { return size; }
+
+ private:
+  //! The contents of the file.
+  char* data;
+  //! The size of the file in bytes.
+  size_t size;
+  //! Whether or not a file is held.
+  bool isOpen;
+  //! Whether or not the memory is mapped (as opposed to allocated).
+  bool mapped;
+  //! Whether or not the memory may be modified.
+  bool copyOnWrite;
+
+  //! A mapping cannot be copied.
+  MappedFile(const MappedFile& other);
+  //! A mapping cannot be copied.
+  MappedFile& operator=(const MappedFile& other);
+};
+
+}; // namespace data
+}; // namespace mlpack
+
+#endif
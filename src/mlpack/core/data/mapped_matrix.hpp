@@ -0,0 +1,99 @@
+/**
+ * @file mapped_matrix.hpp
+ *
+ * An Armadillo matrix whose memory is a memory-mapped file.
+ */
+#ifndef __MLPACK_CORE_DATA_MAPPED_MATRIX_HPP
+#define __MLPACK_CORE_DATA_MAPPED_MATRIX_HPP
+
+#include <mlpack/core/arma_extend/arma_extend.hpp> // Includes Armadillo.
+#include "mapped_file.hpp"
+
+namespace mlpack {
+namespace data {
+
+/**
+ * A matrix which uses the memory of a memory-mapped file directly, through
+ * Armadillo's auxiliary memory constructor, so that loading it does not copy
+ * (or even read) the data.  This is filled by the memory-mapped overload of
+ * data::Load(); see load.hpp.  The matrix is only valid while this object
+ * exists.
+ *
+ * If the file was mapped for copy-on-write, the matrix can be modified freely
+ * (for instance, rearranged by a tree builder): each page that is modified is
+ * copied privately, and the file on disk is never changed.  Otherwise the
+ * matrix is read-only, and modifying it will crash the program.
+ *
+ * @code
+ * data::MappedMatrix<double> mapped;
+ * data::Load("dataset.bin", mapped, true, true); // Copy-on-write.
+ * tree::BinarySpaceTree<bound::HRectBound<2> > tree(mapped.Matrix());
+ * @endcode
+ *
+ * @tparam eT Type of the elements of the matrix.
+ */
+template<typename eT>
+class MappedMatrix
+{
+ public:
+  //! Create an empty matrix, which does not hold a file.
+  MappedMatrix() : matrix(new arma::Mat<eT>()) { }
+
+  //! Delete the matrix and unmap the file.
+  ~MappedMatrix() { delete matrix; }
+
+  /**
+   * Use the given mapped file as the memory of a matrix of the given size,
+   * starting at the given byte offset in the file.  If the data in the file is
+   * not aligned for eT, it is copied instead (and the file is unmapped).  Any
+   * previously held file is released.  This is called by data::Load(); the
+   * caller must make sure the file is large enough.
+   *
+   * @param filename Name of the file to map.
+   * @param offset Byte offset of the first element in the file.
+   * @param rows Number of rows of the matrix.
+   * @param cols Number of columns of the matrix.
+   * @param copyOnWrite If true, the matrix can be modified.
+   * @return false if the file could not be mapped.
+   */
+  bool Map(const std::string& filename,
+           const size_t offset,
+           const size_t rows,
+           const size_t cols,
+           const bool copyOnWrite);
+
+  //! Release the matrix and the file.
+  void Clear();
+
+  //! Get the matrix.
+  const arma::Mat<eT>& Matrix() const { return *matrix; }
+  //! Modify the matrix (only allowed if the file was mapped for copy-on-write).
+  arma::Mat<eT>& Matrix() { return *matrix; }
+
+  //! Return whether or not the matrix uses the memory of a mapped file (false
+  //! if the data had to be copied).
+  bool IsMapped() const { return file.IsMapped(); }
+
+  //! Get the mapped file.
+  const MappedFile& File() const { return file; }
+
+ private:
+  //! The mapped file.
+  MappedFile file;
+  //! The matrix, which usually uses the memory of the mapped file.  It is held
+  //! by pointer because an Armadillo matrix cannot be pointed at new memory.
+  arma::Mat<eT>* matrix;
+
+  //! A mapped matrix cannot be copied.
+  MappedMatrix(const MappedMatrix& other);
+  //! A mapped matrix cannot be copied.
+  MappedMatrix& operator=(const MappedMatrix& other);
+};
+
+}; // namespace data
+}; // namespace mlpack
+
+// Include implementation.
+#include "mapped_matrix_impl.hpp"
+
+#endif
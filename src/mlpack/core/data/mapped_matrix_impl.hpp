@@ -0,0 +1,67 @@
+/**
+ * @file mapped_matrix_impl.hpp
+ *
+ * Implementation of MappedMatrix.
+ */
+#ifndef __MLPACK_CORE_DATA_MAPPED_MATRIX_IMPL_HPP
+#define __MLPACK_CORE_DATA_MAPPED_MATRIX_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "mapped_matrix.hpp"
+
+#include <cstring>
+
+namespace mlpack {
+namespace data {
+
+template<typename eT>
+bool MappedMatrix<eT>::Map(const std::string& filename,
+                           const size_t offset,
+                           const size_t rows,
+                           const size_t cols,
+                           const bool copyOnWrite)
+{
+  Clear();
+
+  if (!file.Open(filename, copyOnWrite))
+    return false;
+
+  if (rows * cols == 0)
+  {
+    file.Close();
+    matrix->set_size(rows, cols);
+    return true;
+  }
+
+  // The matrix memory must be aligned for the element type; the header of an
+  // Armadillo binary file can leave it unaligned, and then we have no choice
+  // but to copy.
+  char* start = file.Data() + offset;
+  if (((size_t) start) % sizeof(eT) != 0)
+  {
+    matrix->set_size(rows, cols);
+    std::memcpy(matrix->memptr(), start, rows * cols * sizeof(eT));
+    file.Close();
+    return true;
+  }
+
+  // Use the mapped memory directly, and don't let Armadillo change the size of
+  // the matrix (since it can't reallocate the memory).
+  delete matrix;
+  matrix = new arma::Mat<eT>((eT*) start, rows, cols, false, true);
+  return true;
+}
+
+template<typename eT>
+void MappedMatrix<eT>::Clear()
+{
+  // The matrix must not outlive the memory it uses.
+  delete matrix;
+  matrix = new arma::Mat<eT>();
+  file.Close();
+}
+
+}; // namespace data
+}; // namespace mlpack
+
+#endif
@@ -0,0 +1,60 @@
+/**
+ * @file parse_text.hpp
+ *
+ * A multi-threaded parser for delimited text (CSV, TSV and whitespace-separated
+ * ASCII) files, used by data::Load() instead of Armadillo's single-threaded
+ * iostreams-based loaders.
+ */
+#ifndef __MLPACK_CORE_DATA_PARSE_TEXT_HPP
+#define __MLPACK_CORE_DATA_PARSE_TEXT_HPP
+
+#include <mlpack/core/util/log.hpp>
+#include <mlpack/core/arma_extend/arma_extend.hpp> // Includes Armadillo.
+#include <string>
+
+namespace mlpack {
+namespace data /** Functions to load and save matrices. */ {
+
+/**
+ * Parse a numeric text file with one line per row, whose fields are separated
+ * by the given delimiter (or by any run of spaces and tabs, if the delimiter is
+ * ' ').  The file is mapped into memory and split into chunks on line
+ * boundaries; the chunks are first scanned in parallel to count the lines and
+ * fields, then parsed in parallel straight into their place in the matrix, so
+ * no transpose and no intermediate copy is needed.
+ *
+ * The behavior matches Armadillo's csv_ascii and raw_ascii loaders: for
+ * delimited files, short lines and empty fields are filled with zeros, and for
+ * whitespace-separated files every line must have the same number of fields.
+ * Blank lines are skipped.  Numbers are parsed with a fast path that is exact
+ * for up to 15 significant digits and exponents up to 22; anything else
+ * (including nan and inf) goes through strtod().
+ *
+ * If the file cannot be parsed (for instance, a field is not a number, or the
+ * whitespace-separated lines have different lengths), false is returned and the
+ * reason is stored in the given string; the caller can then fall back to
+ * Armadillo.  The matrix is not modified in that case.
+ *
+ * @tparam eT Element type of the matrix; only float and double are supported.
+ * @param filename Name of file to parse.
+ * @param matrix Matrix to load the contents of the file into.
+ * @param delimiter Field delimiter (',' or '\\t'), or ' ' for whitespace.
+ * @param transpose If true, each line of the file is stored as a column of the
+ *     matrix (this is what data::Load() does by default).
+ * @param error Set to the reason the parse failed, if it did.
+ * @return Boolean value indicating success or failure of the parse.
+ */
+template<typename eT>
+bool ParseText(const std::string& filename,
+               arma::Mat<eT>& matrix,
+               const char delimiter,
+               const bool transpose,
+               std::string& error);
+
+}; // namespace data
+}; // namespace mlpack
+
+// Include implementation.
+#include "parse_text_impl.hpp"
+
+#endif
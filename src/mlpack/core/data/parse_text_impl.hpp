@@ -0,0 +1,401 @@
+/**
+ * @file parse_text_impl.hpp
+ *
+ * Implementation of the multi-threaded text parser.
+ */
+#ifndef __MLPACK_CORE_DATA_PARSE_TEXT_IMPL_HPP
+#define __MLPACK_CORE_DATA_PARSE_TEXT_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "parse_text.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <vector>
+#include <stdint.h>
+
+#include "mapped_file.hpp"
+
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
+namespace mlpack {
+namespace data {
+
+/**
+ * Return whether the given character is padding around a field: a space, a
+ * carriage return, or a tab (unless tabs are the delimiter).
+ */
+inline bool IsTextPadding(const char c, const char delimiter)
+{
+  return (c == ' ' || c == '\r' || (c == '\t' && delimiter != '\t'));
+}
+
+/**
+ * Parse the number in [begin, end) into the given value.  An empty field is
+ * zero.  Returns false if the field is not entirely a number.
+ */
+inline bool ParseTextValue(const char* begin, const char* end, double& value)
+{
+  // Powers of ten that are exactly representable as doubles.
+  static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8,
+      1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20,
+      1e21, 1e22 };
+
+  if (begin == end)
+  {
+    value = 0.0;
+    return true;
+  }
+
+  const char* p = begin;
+  const bool negative = (*p == '-');
+  if (*p == '-' || *p == '+')
+    ++p;
+
+  // Collect up to 19 significant digits (which always fit in 64 bits) and the
+  // decimal exponent.
+  uint64_t mantissa = 0;
+  size_t digits = 0;
+  size_t totalDigits = 0;
+  int exponent = 0;
+  bool fast = true;
+  for (; p != end && *p >= '0' && *p <= '9'; ++p, ++totalDigits)
+  {
+    if (mantissa == 0 && *p == '0')
+      continue;
+
+    if (digits < 19)
+    {
+      mantissa = 10 * mantissa + (*p - '0');
+      ++digits;
+    }
+    else
+    {
+      fast = false;
+    }
+  }
+
+  if (p != end && *p == '.')
+  {
+    for (++p; p != end && *p >= '0' && *p <= '9'; ++p, ++totalDigits)
+    {
+      if (mantissa == 0 && *p == '0')
+      {
+        --exponent;
+        continue;
+      }
+
+      if (digits < 19)
+      {
+        mantissa = 10 * mantissa + (*p - '0');
+        ++digits;
+        --exponent;
+      }
+      else
+      {
+        fast = false;
+      }
+    }
+  }
+
+  // Things like "nan", "inf" and "." are left to strtod().
+  if (totalDigits == 0)
+    fast = false;
+
+  if (fast && p != end && (*p == 'e' || *p == 'E'))
+  {
+    ++p;
+    const bool negativeExponent = (p != end && *p == '-');
+    if (p != end && (*p == '-' || *p == '+'))
+      ++p;
+
+    if (p == end || *p < '0' || *p > '9')
+      fast = false;
+
+    int e = 0;
+    for (; p != end && *p >= '0' && *p <= '9'; ++p)
+      if (e < 10000)
+        e = 10 * e + (*p - '0');
+
+    exponent += (negativeExponent ? -e : e);
+  }
+
+  if (fast && p == end)
+  {
+    if (mantissa == 0)
+    {
+      value = negative ? -0.0 : 0.0;
+      return true;
+    }
+
+    // With at most 15 digits the mantissa is exact, and so is the power of
+    // ten, so a single multiplication or division is correctly rounded.
+    if (digits <= 15 && exponent >= -22 && exponent <= 22)
+    {
+      const double v = (exponent < 0) ? (double(mantissa) / powers[-exponent])
+          : (double(mantissa) * powers[exponent]);
+      value = negative ? -v : v;
+      return true;
+    }
+  }
+
+  // The slow path.  The field is not terminated, so it has to be copied.
+  char buffer[128];
+  const size_t length = end - begin;
+  if (length >= sizeof(buffer))
+    return false;
+
+  memcpy(buffer, begin, length);
+  buffer[length] = '\0';
+  char* parsedEnd;
+  value = strtod(buffer, &parsedEnd);
+  return (parsedEnd == buffer + length);
+}
+
+/**
+ * Split the line [begin, end) (without the newline) into fields.  If values is
+ * not NULL, the first maxFields fields are parsed and stored at values[0],
+ * values[stride], values[2 * stride] and so on.  Returns the number of fields
+ * in the line (0 for a blank line), or size_t(-1) if a field could not be
+ * parsed.
+ */
+template<typename eT>
+size_t ScanTextLine(const char* begin,
+                    const char* end,
+                    const char delimiter,
+                    eT* values,
+                    const size_t stride,
+                    const size_t maxFields)
+{
+  while (begin != end && IsTextPadding(*begin, delimiter))
+    ++begin;
+  while (end != begin && IsTextPadding(*(end - 1), delimiter))
+    --end;
+
+  if (begin == end)
+    return 0;
+
+  size_t fields = 0;
+  const char* p = begin;
+  if (delimiter == ' ')
+  {
+    while (p != end)
+    {
+      const char* fieldEnd = p;
+      while (fieldEnd != end && *fieldEnd != ' ' && *fieldEnd != '\t')
+        ++fieldEnd;
+
+      if (values && fields < maxFields)
+      {
+        double value;
+        if (!ParseTextValue(p, fieldEnd, value))
+          return size_t(-1);
+        values[fields * stride] = eT(value);
+      }
+      ++fields;
+
+      p = fieldEnd;
+      while (p != end && (*p == ' ' || *p == '\t'))
+        ++p;
+    }
+  }
+  else
+  {
+    // Like std::getline(), a delimiter at the very end of the line does not
+    // start another field.
+    while (p != end)
+    {
+      const char* fieldEnd = (const char*) memchr(p, delimiter, end - p);
+      const char* next = (fieldEnd == NULL) ? end : (fieldEnd + 1);
+      if (fieldEnd == NULL)
+        fieldEnd = end;
+
+      if (values && fields < maxFields)
+      {
+        const char* fieldBegin = p;
+        while (fieldBegin != fieldEnd && IsTextPadding(*fieldBegin, delimiter))
+          ++fieldBegin;
+        while (fieldEnd != fieldBegin &&
+               IsTextPadding(*(fieldEnd - 1), delimiter))
+          --fieldEnd;
+
+        double value;
+        if (!ParseTextValue(fieldBegin, fieldEnd, value))
+          return size_t(-1);
+        values[fields * stride] = eT(value);
+      }
+      ++fields;
+
+      p = next;
+    }
+  }
+
+  return fields;
+}
+
+template<typename eT>
+bool ParseText(const std::string& filename,
+               arma::Mat<eT>& matrix,
+               const char delimiter,
+               const bool transpose,
+               std::string& error)
+{
+  MappedFile file;
+  if (!file.Open(filename))
+  {
+    error = "the file could not be mapped";
+    return false;
+  }
+
+  const char* data = file.Data();
+  const size_t size = file.Size();
+
+#ifdef _OPENMP
+  const size_t threads = (size_t) omp_get_max_threads();
+#else
+  const size_t threads = 1;
+#endif
+
+  // Use several chunks per thread to balance the load, but don't make the
+  // chunks so small that the per-chunk work dominates.
+  const size_t minChunkSize = 1 << 20;
+  const size_t numChunks = std::max(size_t(1),
+      std::min(4 * threads, size / minChunkSize));
+
+  // Each chunk starts at the beginning of a line.
+  std::vector<size_t> chunkBegin(numChunks + 1);
+  chunkBegin[0] = 0;
+  chunkBegin[numChunks] = size;
+  for (size_t c = 1; c < numChunks; ++c)
+  {
+    size_t pos = std::max(chunkBegin[c - 1], c * (size / numChunks));
+    const char* newline = (const char*) ((pos < size) ?
+        memchr(data + pos, '\n', size - pos) : NULL);
+    chunkBegin[c] = (newline == NULL) ? size : size_t(newline - data + 1);
+  }
+
+  // First pass: count the non-blank lines in each chunk, and the smallest and
+  // largest number of fields on them.
+  std::vector<size_t> chunkLines(numChunks, 0);
+  std::vector<size_t> chunkMinFields(numChunks, size_t(-1));
+  std::vector<size_t> chunkMaxFields(numChunks, 0);
+
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t c = 0; c < numChunks; ++c)
+  {
+    const char* p = data + chunkBegin[c];
+    const char* chunkEnd = data + chunkBegin[c + 1];
+    while (p < chunkEnd)
+    {
+      const char* lineEnd = (const char*) memchr(p, '\n', chunkEnd - p);
+      if (lineEnd == NULL)
+        lineEnd = chunkEnd;
+
+      const size_t fields = ScanTextLine<eT>(p, lineEnd, delimiter, NULL, 0,
+          0);
+      if (fields > 0)
+      {
+        ++chunkLines[c];
+        chunkMinFields[c] = std::min(chunkMinFields[c], fields);
+        chunkMaxFields[c] = std::max(chunkMaxFields[c], fields);
+      }
+
+      p = lineEnd + 1;
+    }
+  }
+
+  size_t lines = 0;
+  size_t minFields = size_t(-1);
+  size_t maxFields = 0;
+  std::vector<size_t> chunkFirstLine(numChunks);
+  for (size_t c = 0; c < numChunks; ++c)
+  {
+    chunkFirstLine[c] = lines;
+    lines += chunkLines[c];
+    minFields = std::min(minFields, chunkMinFields[c]);
+    maxFields = std::max(maxFields, chunkMaxFields[c]);
+  }
+
+  if (delimiter == ' ' && lines > 0 && minFields != maxFields)
+  {
+    error = "the lines do not all have the same number of columns";
+    return false;
+  }
+
+  // Allocate the result in its final orientation; it is only filled with zeros
+  // if some lines are short.
+  arma::Mat<eT> result;
+  if (lines > 0 && minFields != maxFields)
+  {
+    if (transpose)
+      result.zeros(maxFields, lines);
+    else
+      result.zeros(lines, maxFields);
+  }
+  else if (lines > 0)
+  {
+    if (transpose)
+      result.set_size(maxFields, lines);
+    else
+      result.set_size(lines, maxFields);
+  }
+
+  // Second pass: parse each line straight into its place in the matrix.
+  eT* memory = result.memptr();
+  const size_t stride = transpose ? 1 : lines;
+  size_t badLine = 0;
+  bool failed = false;
+
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t c = 0; c < numChunks; ++c)
+  {
+    const char* p = data + chunkBegin[c];
+    const char* chunkEnd = data + chunkBegin[c + 1];
+    size_t line = chunkFirstLine[c];
+    while (p < chunkEnd)
+    {
+      const char* lineEnd = (const char*) memchr(p, '\n', chunkEnd - p);
+      if (lineEnd == NULL)
+        lineEnd = chunkEnd;
+
+      eT* values = transpose ? (memory + line * maxFields) : (memory + line);
+      const size_t fields = ScanTextLine(p, lineEnd, delimiter, values, stride,
+          maxFields);
+      if (fields == size_t(-1))
+      {
+        #pragma omp critical(ParseTextFailure)
+        {
+          if (!failed || line < badLine)
+            badLine = line;
+          failed = true;
+        }
+        break;
+      }
+      else if (fields > 0)
+      {
+        ++line;
+      }
+
+      p = lineEnd + 1;
+    }
+  }
+
+  if (failed)
+  {
+    std::ostringstream oss;
+    oss << "non-numeric value on non-blank line " << (badLine + 1);
+    error = oss.str();
+    return false;
+  }
+
+  matrix.swap(result);
+  return true;
+}
+
+}; // namespace data
+}; // namespace mlpack
+
+#endif
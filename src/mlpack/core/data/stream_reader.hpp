@@ -0,0 +1,165 @@
+/**
+ * @file stream_reader.hpp
+ *
+ * A reader which iterates over a dataset on disk in blocks of points, so that
+ * datasets which do not fit in memory can be used for training.
+ */
+#ifndef __MLPACK_CORE_DATA_STREAM_READER_HPP
+#define __MLPACK_CORE_DATA_STREAM_READER_HPP
+
+#include <mlpack/core/util/log.hpp>
+#include <mlpack/core/arma_extend/arma_extend.hpp> // Includes Armadillo.
+#include <fstream>
+#include <string>
+#include <thread>
+
+#ifdef ARMA_USE_HDF5
+  #include <hdf5.h>
+#endif
+
+namespace mlpack {
+namespace data {
+
+/**
+ * Read a dataset from disk in fixed-size blocks of points, with one point per
+ * column, instead of loading it all at once.  While the caller works on one
+ * block, the next block is read (and parsed) on a background thread, so the
+ * time spent waiting on the disk is hidden as long as the work per block takes
+ * longer than reading it.  Only two blocks are ever held in memory.
+ *
+ * The type of the file is determined by its extension, like data::Load():
+ *
+ *  - CSV (.csv), TSV (.tsv) and whitespace-separated (.txt) text, with one
+ *    point per line, like what data::Load() expects.
+ *  - Armadillo binary or raw binary (.bin), with one point per column, like
+ *    what memory-mapped loading expects (see load.hpp); raw binary files hold
+ *    no size information, so the number of rows must be given.
+ *  - HDF5 (.h5, .hdf5, .hdf, .he5) files written by Armadillo (the data is in
+ *    the dataset called "dataset"), with one point per column, if Armadillo was
+ *    compiled with HDF5 support.
+ *
+ * The file can be read as many times as needed by calling Reset(); this is
+ * what multi-pass algorithms like k-means do.  If an error occurs while reading
+ * a block, it is reported (as fatal if 'fatal' was given) and NextBlock()
+ * returns false.
+ *
+ * @code
+ * data::StreamReader<> reader("huge.csv", 50000);
+ * arma::mat block;
+ * while (reader.NextBlock(block))
+ * {
+ *   // Do something with the points in 'block'.
+ * }
+ * @endcode
+ *
+ * @tparam eT Type of the elements of the blocks.
+ */
+template<typename eT = double>
+class StreamReader
+{
+ public:
+  /**
+   * Open the given file for reading in blocks, and start reading the first
+   * block in the background.  If the file cannot be opened, an error is given
+   * (as fatal if 'fatal' is true) and IsOpen() will return false.
+   *
+   * @param filename Name of file to read.
+   * @param blockSize Number of points in each block (the last block may be
+   *     smaller).
+   * @param fatal If an error should be reported as fatal (default false).
+   * @param rawRows Number of rows (dimensions) of a raw binary file.
+   */
+  StreamReader(const std::string& filename,
+               const size_t blockSize = 10000,
+               const bool fatal = false,
+               const size_t rawRows = 1);
+
+  //! Wait for the background read (if any) and close the file.
+  ~StreamReader();
+
+  /**
+   * Get the next block of points, with one point per column.  The memory of
+   * the given matrix is reused for reading the block after it.  Returns false
+   * (and leaves the block untouched) when the end of the file has been reached
+   * or an error occurred.
+   *
+   * @param block Matrix to store the next block of points in.
+   */
+  bool NextBlock(arma::Mat<eT>& block);
+
+  //! Go back to the beginning of the file.
+  void Reset();
+
+  //! Return whether or not the file was opened successfully.
+  bool IsOpen() const { return isOpen; }
+  //! Get the name of the file.
+  const std::string& Filename() const { return filename; }
+  //! Get the number of points in each block.
+  size_t BlockSize() const { return blockSize; }
+  //! Get the dimensionality of the points (the number of rows of each block).
+  size_t Dimensionality() const { return dimensionality; }
+
+ private:
+  //! Open the file and find its dimensionality.  Returns false on failure.
+  bool Open(const size_t rawRows);
+  //! Read the next block into 'next'; this runs on the background thread, so
+  //! errors are only stored in 'error'.
+  void ReadBlock();
+  //! Read the next block of text lines into 'next'.
+  void ReadTextBlock();
+  //! Start reading the next block on the background thread.
+  void Prefetch();
+  //! Wait for the background thread to finish reading.
+  void Wait();
+
+  //! Copying would share the open file and the background thread.
+  StreamReader(const StreamReader& other);
+  //! Copying would share the open file and the background thread.
+  StreamReader& operator=(const StreamReader& other);
+
+  //! The name of the file.
+  std::string filename;
+  //! Number of points in each block.
+  size_t blockSize;
+  //! Whether errors are fatal.
+  bool fatal;
+  //! Whether or not the file is open.
+  bool isOpen;
+  //! The type of the file (csv_ascii, raw_ascii, arma_binary, raw_binary or
+  //! hdf5_binary).
+  arma::file_type loadType;
+  //! The field delimiter for text files (' ' for whitespace).
+  char delimiter;
+  //! The dimensionality of the points.
+  size_t dimensionality;
+  //! The number of points in the file (unknown, and 0, for text files).
+  size_t points;
+  //! The number of points (or, for text files, lines) read so far.
+  size_t position;
+
+  //! The file, for text and binary files.
+  std::ifstream stream;
+  //! The position of the first point in the stream.
+  std::streampos dataStart;
+#ifdef ARMA_USE_HDF5
+  //! The file, for HDF5 files.
+  hid_t hdf5File;
+  //! The dataset, for HDF5 files.
+  hid_t hdf5Dataset;
+#endif
+
+  //! The block being read in the background.
+  arma::Mat<eT> next;
+  //! The error that happened while reading 'next', if any.
+  std::string error;
+  //! The thread reading 'next'.
+  std::thread prefetcher;
+};
+
+}; // namespace data
+}; // namespace mlpack
+
+// Include implementation.
+#include "stream_reader_impl.hpp"
+
+#endif
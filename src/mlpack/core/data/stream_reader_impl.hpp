@@ -0,0 +1,445 @@
+/**
+ * @file stream_reader_impl.hpp
+ *
+ * Implementation of StreamReader.
+ */
+#ifndef __MLPACK_CORE_DATA_STREAM_READER_IMPL_HPP
+#define __MLPACK_CORE_DATA_STREAM_READER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "stream_reader.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <mlpack/core/util/timers.hpp>
+
+#include "parse_text.hpp"
+
+namespace mlpack {
+namespace data {
+
+#ifdef ARMA_USE_HDF5
+//! The HDF5 memory type of the elements of a block (only float and double are
+//! supported).
+template<typename eT>
+inline hid_t StreamHDF5Type() { return -1; }
+
+template<>
+inline hid_t StreamHDF5Type<double>() { return H5T_NATIVE_DOUBLE; }
+
+template<>
+inline hid_t StreamHDF5Type<float>() { return H5T_NATIVE_FLOAT; }
+#endif
+
+template<typename eT>
+StreamReader<eT>::StreamReader(const std::string& filename,
+                               const size_t blockSize,
+                               const bool fatal,
+                               const size_t rawRows) :
+    filename(filename),
+    blockSize(blockSize),
+    fatal(fatal),
+    isOpen(false),
+    loadType(arma::raw_ascii),
+    delimiter(' '),
+    dimensionality(0),
+    points(0),
+    position(0)
+#ifdef ARMA_USE_HDF5
+    ,
+    hdf5File(-1),
+    hdf5Dataset(-1)
+#endif
+{
+  if (blockSize == 0)
+    error = "the block size must be positive";
+  else if (Open(rawRows))
+    isOpen = true;
+
+  if (!isOpen)
+  {
+    if (fatal)
+      Log::Fatal << "Cannot read '" << filename << "' in blocks: " << error
+          << "." << std::endl;
+    else
+      Log::Warn << "Cannot read '" << filename << "' in blocks: " << error
+          << "." << std::endl;
+
+    return;
+  }
+
+  Log::Info << "Reading '" << filename << "' in blocks of " << blockSize
+      << " points of dimensionality " << dimensionality << "." << std::endl;
+
+  Prefetch();
+}
+
+template<typename eT>
+StreamReader<eT>::~StreamReader()
+{
+  Wait();
+
+#ifdef ARMA_USE_HDF5
+  if (hdf5Dataset >= 0)
+    H5Dclose(hdf5Dataset);
+  if (hdf5File >= 0)
+    H5Fclose(hdf5File);
+#endif
+}
+
+template<typename eT>
+bool StreamReader<eT>::NextBlock(arma::Mat<eT>& block)
+{
+  if (!isOpen)
+    return false;
+
+  // Any time spent here is time the computation spent waiting for the disk.
+  Timer::Start("loading_data");
+  Wait();
+  Timer::Stop("loading_data");
+
+  if (!error.empty())
+  {
+    const std::string message = error;
+    error.clear();
+    next.reset();
+
+    if (fatal)
+      Log::Fatal << "Reading a block from '" << filename << "' failed: "
+          << message << "." << std::endl;
+    else
+      Log::Warn << "Reading a block from '" << filename << "' failed: "
+          << message << "." << std::endl;
+
+    return false;
+  }
+
+  // The end of the file.
+  if (next.n_cols == 0)
+    return false;
+
+  // Hand the block over, and read the next one into the old block's memory.
+  block.swap(next);
+  Prefetch();
+
+  return true;
+}
+
+template<typename eT>
+void StreamReader<eT>::Reset()
+{
+  if (!isOpen)
+    return;
+
+  Wait();
+
+  error.clear();
+  position = 0;
+  if (loadType != arma::hdf5_binary)
+  {
+    stream.clear();
+    stream.seekg(dataStart);
+  }
+
+  Prefetch();
+}
+
+template<typename eT>
+bool StreamReader<eT>::Open(const size_t rawRows)
+{
+  // Get the extension and force it to lowercase.
+  const size_t ext = filename.rfind('.');
+  if (ext == std::string::npos)
+  {
+    error = "no extension is present";
+    return false;
+  }
+
+  std::string extension = filename.substr(ext + 1);
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+      ::tolower);
+
+  if (extension == "h5" || extension == "hdf5" || extension == "hdf" ||
+      extension == "he5")
+  {
+#ifdef ARMA_USE_HDF5
+    loadType = arma::hdf5_binary;
+    if (StreamHDF5Type<eT>() < 0)
+    {
+      error = "only float and double HDF5 data can be read";
+      return false;
+    }
+
+    hdf5File = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+    if (hdf5File < 0)
+    {
+      error = "the file could not be opened";
+      return false;
+    }
+
+    hdf5Dataset = H5Dopen(hdf5File, "dataset", H5P_DEFAULT);
+    if (hdf5Dataset < 0)
+    {
+      error = "there is no dataset called \"dataset\"";
+      return false;
+    }
+
+    // Armadillo stores an n_rows x n_cols matrix as an n_cols x n_rows HDF5
+    // dataset (HDF5 is row-major), so each HDF5 row is one point.
+    const hid_t space = H5Dget_space(hdf5Dataset);
+    const int rank = H5Sget_simple_extent_ndims(space);
+    hsize_t dims[2] = { 0, 1 };
+    if (rank == 1 || rank == 2)
+      H5Sget_simple_extent_dims(space, dims, NULL);
+    H5Sclose(space);
+
+    if (rank != 1 && rank != 2)
+    {
+      error = "the dataset is not a matrix";
+      return false;
+    }
+
+    points = (size_t) dims[0];
+    dimensionality = (size_t) dims[1];
+    return true;
+#else
+    error = "Armadillo was compiled without HDF5 support";
+    return false;
+#endif
+  }
+
+  if (extension != "csv" && extension != "tsv" && extension != "txt" &&
+      extension != "bin")
+  {
+    error = "unknown extension '" + extension + "'";
+    return false;
+  }
+
+  stream.open(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!stream.is_open())
+  {
+    error = "the file could not be opened";
+    return false;
+  }
+
+  if (extension == "bin")
+  {
+    stream.seekg(0, std::ios::end);
+    const size_t fileSize = (size_t) stream.tellg();
+    stream.seekg(0, std::ios::beg);
+
+    const std::string ARMA_MAT_BIN = "ARMA_MAT_BIN";
+    char rawHeader[12];
+    stream.read(rawHeader, std::streamsize(ARMA_MAT_BIN.length()));
+    const bool armaBinary = stream.good() &&
+        (std::string(rawHeader, ARMA_MAT_BIN.length()) == ARMA_MAT_BIN);
+    stream.clear();
+    stream.seekg(0, std::ios::beg);
+
+    if (armaBinary)
+    {
+      loadType = arma::arma_binary;
+
+      // The type must match the type of the blocks exactly.
+      std::string type;
+      stream >> type >> dimensionality >> points;
+      stream.get(); // The newline after the size.
+      if (stream.fail() ||
+          type != arma::diskio::gen_bin_header(arma::Mat<eT>()))
+      {
+        error = "the element type of the data does not match";
+        return false;
+      }
+
+      // A corrupt header can give a size whose product overflows and then
+      // happens to match the size of the file, so check that first.
+      dataStart = stream.tellg();
+      const size_t maxSize = std::numeric_limits<size_t>::max();
+      if ((size_t) dataStart > fileSize || (dimensionality != 0 &&
+          points > maxSize / dimensionality / sizeof(eT)) ||
+          fileSize - (size_t) dataStart != dimensionality * points * sizeof(eT))
+      {
+        error = "the size of the data does not match the header";
+        return false;
+      }
+    }
+    else
+    {
+      loadType = arma::raw_binary;
+      dimensionality = rawRows;
+      dataStart = 0;
+      if (rawRows == 0 || fileSize % (rawRows * sizeof(eT)) != 0)
+      {
+        error = "the size of the file is not a multiple of the size of a point";
+        return false;
+      }
+
+      points = fileSize / (rawRows * sizeof(eT));
+    }
+
+    return true;
+  }
+
+  // Text.  If a .txt file isn't whitespace-separated, it is probably CSV.
+  dataStart = 0;
+  std::string line;
+  while (std::getline(stream, line))
+  {
+    if (line.compare(0, 12, "ARMA_MAT_TXT") == 0)
+    {
+      error = "Armadillo ASCII files cannot be read in blocks";
+      return false;
+    }
+
+    if (extension == "csv")
+      delimiter = ',';
+    else if (extension == "tsv")
+      delimiter = '\t';
+    else
+      delimiter = (line.find(',') != std::string::npos) ? ',' : ' ';
+
+    dimensionality = ScanTextLine<eT>(line.data(), line.data() + line.size(),
+        delimiter, NULL, 0, 0);
+    if (dimensionality > 0)
+      break;
+  }
+
+  loadType = (delimiter == ' ') ? arma::raw_ascii : arma::csv_ascii;
+  stream.clear();
+  stream.seekg(dataStart);
+
+  if (dimensionality == 0)
+  {
+    error = "the file holds no points";
+    return false;
+  }
+
+  return true;
+}
+
+template<typename eT>
+void StreamReader<eT>::ReadBlock()
+{
+  try
+  {
+    if (loadType == arma::csv_ascii || loadType == arma::raw_ascii)
+    {
+      ReadTextBlock();
+      return;
+    }
+
+    const size_t count = std::min(blockSize, points - position);
+    next.set_size(dimensionality, count);
+    if (count == 0)
+      return;
+
+#ifdef ARMA_USE_HDF5
+    if (loadType == arma::hdf5_binary)
+    {
+      // Select the rows of the dataset holding the next points.
+      const hsize_t start[2] = { (hsize_t) position, 0 };
+      const hsize_t size[2] = { (hsize_t) count, (hsize_t) dimensionality };
+      const hid_t fileSpace = H5Dget_space(hdf5Dataset);
+      H5Sselect_hyperslab(fileSpace, H5S_SELECT_SET, start, NULL, size, NULL);
+      const hid_t memorySpace = H5Screate_simple(2, size, NULL);
+
+      const herr_t status = H5Dread(hdf5Dataset, StreamHDF5Type<eT>(),
+          memorySpace, fileSpace, H5P_DEFAULT, next.memptr());
+      H5Sclose(memorySpace);
+      H5Sclose(fileSpace);
+
+      if (status < 0)
+      {
+        error = "the HDF5 read failed";
+        next.reset();
+        return;
+      }
+
+      position += count;
+      return;
+    }
+#endif
+
+    stream.read((char*) next.memptr(), std::streamsize(next.n_elem *
+        sizeof(eT)));
+    if (!stream.good())
+    {
+      error = "the file is shorter than expected";
+      next.reset();
+      return;
+    }
+
+    position += count;
+  }
+  catch (std::exception& e)
+  {
+    error = e.what();
+    next.reset();
+  }
+}
+
+template<typename eT>
+void StreamReader<eT>::ReadTextBlock()
+{
+  next.set_size(dimensionality, blockSize);
+
+  size_t count = 0;
+  std::string line;
+  while (count < blockSize && std::getline(stream, line))
+  {
+    ++position;
+
+    // Parse straight into the block; short lines of delimited files are
+    // filled with zeros, like in data::Load().
+    eT* column = next.colptr(count);
+    const size_t fields = ScanTextLine(line.data(), line.data() + line.size(),
+        delimiter, column, 1, dimensionality);
+    if (fields == size_t(-1))
+    {
+      std::ostringstream oss;
+      oss << "non-numeric value on line " << position;
+      error = oss.str();
+      next.reset();
+      return;
+    }
+    else if (fields == 0)
+    {
+      continue; // Blank line.
+    }
+    else if (fields > dimensionality || (fields < dimensionality &&
+        loadType == arma::raw_ascii))
+    {
+      std::ostringstream oss;
+      oss << "line " << position << " has " << fields << " columns instead of "
+          << dimensionality;
+      error = oss.str();
+      next.reset();
+      return;
+    }
+
+    std::fill(column + fields, column + dimensionality, eT(0));
+    ++count;
+  }
+
+  if (count < blockSize)
+    next.resize(dimensionality, count);
+}
+
+template<typename eT>
+void StreamReader<eT>::Prefetch()
+{
+  prefetcher = std::thread(&StreamReader::ReadBlock, this);
+}
+
+template<typename eT>
+void StreamReader<eT>::Wait()
+{
+  if (prefetcher.joinable())
+    prefetcher.join();
+}
+
+}; // namespace data
+}; // namespace mlpack
+
+#endif
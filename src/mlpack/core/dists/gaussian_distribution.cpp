@@ -40,36 +40,44 @@ void GaussianDistribution::FactorCovariance()
     covLower = arma::chol(covariance, "lower");
   #endif
 
-  // Comment from rcurtin:
-  //
-  // I think the use of the word "interpret" in the Armadillo documentation
-  // about trimatl and trimatu is somewhat misleading. What the function will
-  // actually do, when used in that context, is loop over the upper triangular
-  // part of the matrix and set it all to 0, so this ends up actually just
-  // burning cycles---also because the operator=() evaluates the expression and
-  // strips the knowledge that it's a lower triangular matrix. So then the call
-  // to .i() doesn't actually do anything smarter.
-  //
-  // But perusing fn_inv.hpp more closely, there is a specialization that will
-  // work when called like this: inv(trimatl(covLower)), and will use LAPACK's
-  // ?trtri functions. However, it will still set the upper triangular part to
-  // 0 after the method. That last part is unnecessary, but baked into
-  // Armadillo, so there's not really much that can be done about that without
-  // discussion with the Armadillo maintainer.
-  const arma::mat invCovLower = arma::inv(arma::trimatl(covLower));
-
-  invCov = invCovLower.t() * invCovLower;
-  double sign = 0.;
-  arma::log_det(logDetCov, sign, covLower);
-  logDetCov *= 2;
+  // The determinant of a triangular matrix is the product of its diagonal, so
+  // logdet(cov) = 2 * logdet(L) = 2 * sum(log(diag(L))).  Nothing else needs
+  // to be cached: the inverse of the covariance is never formed, and
+  // LogProbability() uses triangular solves with L instead.
+  logDetCov = 2.0 * arma::accu(arma::log(covLower.diag()));
 }
 
 double GaussianDistribution::LogProbability(const arma::vec& observation) const
 {
   const size_t k = observation.n_elem;
-  const arma::vec diff = mean - observation;
-  const arma::vec v = (diff.t() * invCov * diff);
-  return -0.5 * k * log2pi - 0.5 * logDetCov - 0.5 * v(0);
+
+  // (x - mu)^T cov^-1 (x - mu) = || L^-1 (x - mu) ||^2.
+  const arma::vec z = arma::solve(arma::trimatl(covLower), observation - mean);
+  return -0.5 * k * log2pi - 0.5 * logDetCov - 0.5 * arma::dot(z, z);
+}
+
+void GaussianDistribution::LogProbability(const arma::mat& x,
+                                          arma::vec& logProbabilities) const
+{
+  logProbabilities.set_size(x.n_cols);
+  const double logNormalizer = -0.5 * x.n_rows * log2pi - 0.5 * logDetCov;
+
+  // Work on blocks of observations, so that the differences from the mean and
+  // their whitened versions stay small no matter how many observations there
+  // are.  Each block takes one triangular solve with all of its columns as
+  // right-hand sides.
+  const size_t blockSize = 1024;
+  for (size_t begin = 0; begin < x.n_cols; begin += blockSize)
+  {
+    const size_t end = std::min(begin + blockSize, (size_t) x.n_cols) - 1;
+
+    const arma::mat diffs = x.cols(begin, end) - (mean *
+        arma::ones<arma::rowvec>(end - begin + 1));
+    const arma::mat z = arma::solve(arma::trimatl(covLower), diffs);
+
+    logProbabilities.subvec(begin, end) = logNormalizer -
+        0.5 * trans(arma::sum(z % z, 0 /* columnwise */));
+  }
 }
 
 arma::vec GaussianDistribution::Random() const
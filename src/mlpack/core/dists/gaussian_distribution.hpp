@@ -25,8 +25,6 @@ class GaussianDistribution
   arma::mat covariance;
   //! Lower triangular factor of cov (e.g. cov = LL^T).
   arma::mat covLower;
-  //! Cached inverse of covariance.
-  arma::mat invCov;
   //! Cached logdet(cov).
   double logDetCov;
 
@@ -47,7 +45,6 @@ class GaussianDistribution
       mean(arma::zeros<arma::vec>(dimension)),
       covariance(arma::eye<arma::mat>(dimension, dimension)),
       covLower(arma::eye<arma::mat>(dimension, dimension)),
-      invCov(arma::eye<arma::mat>(dimension, dimension)),
       logDetCov(0)
   { /* Nothing to do. */ }
 
@@ -90,6 +87,18 @@ class GaussianDistribution
     probabilities = arma::exp(logProbabilities);
   }
 
+  /**
+   * Calculates the multivariate Gaussian log probability density function for
+   * each data point (column) in the given matrix.  The observations are
+   * whitened with the cached Cholesky factor of the covariance, a block at a
+   * time, so this is much faster than calling LogProbability() on each column,
+   * and unlike Probability() it does not underflow for points far from the
+   * mean.
+   *
+   * @param x List of observations.
+   * @param logProbabilities Output log probabilities for each input
+   *     observation.
+   */
   void LogProbability(const arma::mat& x, arma::vec& logProbabilities) const;
 
   /**
@@ -150,38 +159,12 @@ class GaussianDistribution
   static std::string const Type() { return "GaussianDistribution"; }
 
  private:
+  //! Cache the Cholesky factor and log-determinant of the covariance.  This
+  //! must be called whenever the covariance changes.
   void FactorCovariance();
 
 };
 
-/**
-* Calculates the multivariate Gaussian log probability density function for each
-* data point (column) in the given matrix
-*
-* @param x List of observations.
-* @param probabilities Output log probabilities for each input observation.
-*/
-inline void GaussianDistribution::LogProbability(const arma::mat& x,
-                                                 arma::vec& logProbabilities) const
-{
-  // Column i of 'diffs' is the difference between x.col(i) and the mean.
-  arma::mat diffs = x - (mean * arma::ones<arma::rowvec>(x.n_cols));
-
-  // Now, we only want to calculate the diagonal elements of (diffs' * cov^-1 *
-  // diffs).  We just don't need any of the other elements.  We can calculate
-  // the right hand part of the equation (instead of the left side) so that
-  // later we are referencing columns, not rows -- that is faster.
-  const arma::mat rhs = -0.5 * invCov * diffs;
-  arma::vec logExponents(diffs.n_cols); // We will now fill this.
-  for (size_t i = 0; i < diffs.n_cols; i++)
-    logExponents(i) = accu(diffs.unsafe_col(i) % rhs.unsafe_col(i));
-
-  const size_t k = x.n_rows;
-
-  logProbabilities = -0.5 * k * log2pi - 0.5 * logDetCov + logExponents;
-}
-
-
 }; // namespace distribution
 }; // namespace mlpack
 
@@ -0,0 +1,229 @@
+/**
+ * @file block_evaluate.hpp
+ *
+ * Functions to compute a whole block of pairwise distances between two
+ * contiguous ranges of points at once, as is needed for leaf-leaf base cases in
+ * dual-tree algorithms.  For the L2 distance on dense matrices, the block is
+ * computed with a single matrix multiplication.
+ */
+#ifndef __MLPACK_CORE_METRICS_BLOCK_EVALUATE_HPP
+#define __MLPACK_CORE_METRICS_BLOCK_EVALUATE_HPP
+
+#include <mlpack/core.hpp>
+#include "lmetric.hpp"
+
+#include <cmath>
+#include <vector>
+
+namespace mlpack {
+namespace metric {
+
+/**
+ * Compute the distances between each point in columns [aBegin, aBegin + aCount)
+ * of a and each point in columns [bBegin, bBegin + bCount) of b, storing them
+ * in the aCount x bCount matrix distances.  This general version simply calls
+ * metric.Evaluate() for every pair.
+ *
+ * @param metric Instantiated metric.
+ * @param a First dataset.
+ * @param aBegin Index of first point in a.
+ * @param aCount Number of points in a.
+ * @param b Second dataset.
+ * @param bBegin Index of first point in b.
+ * @param bCount Number of points in b.
+ * @param distances Matrix to store the distances in.
+ */
+template<typename MetricType, typename MatType>
+void BlockEvaluate(MetricType& metric,
+                   const MatType& a,
+                   const size_t aBegin,
+                   const size_t aCount,
+                   const MatType& b,
+                   const size_t bBegin,
+                   const size_t bCount,
+                   arma::Mat<typename MatType::elem_type>& distances)
+{
+  distances.set_size(aCount, bCount);
+  for (size_t j = 0; j < bCount; ++j)
+    for (size_t i = 0; i < aCount; ++i)
+      distances(i, j) = metric.Evaluate(a.col(aBegin + i), b.col(bBegin + j));
+}
+
+/**
+ * Return whether every element of the given column of m is finite.
+ */
+template<typename eT>
+bool IsFiniteColumn(const arma::Mat<eT>& m, const size_t col)
+{
+  const eT* column = m.colptr(col);
+  for (size_t d = 0; d < m.n_rows; ++d)
+    if (!std::isfinite(column[d]))
+      return false;
+
+  return true;
+}
+
+/**
+ * Compute the squared L2 distances between each column of a and each column of
+ * b using the expansion ||a - b||^2 = ||a||^2 + ||b||^2 - 2 a^T b, so that the
+ * bulk of the work is a single (BLAS) matrix multiplication.
+ *
+ * The expansion subtracts numbers on the order of the squared norms of the
+ * points, so both blocks are first centered on the mean of the finite points of
+ * a (in double precision, whatever the element type); this keeps the norms on
+ * the order of the spread of the blocks rather than of their distance from the
+ * origin.  Points that are not finite (such as the DBL_MAX centroids that
+ * k-means gives to empty clusters) are left out of the center and of the
+ * multiplication, so that they cannot spoil the distances of the other points.
+ * Their distances, and distances that are still small compared to the norms of
+ * the two points (including those between duplicate points), are computed
+ * directly, and the results are never negative.
+ *
+ * @param a First block of points.
+ * @param b Second block of points.
+ * @param squared Matrix to store the squared distances in.
+ */
+template<typename eT>
+void BlockSquaredDistances(const arma::Mat<eT>& a,
+                           const arma::Mat<eT>& b,
+                           arma::Mat<eT>& squared)
+{
+  squared.set_size(a.n_cols, b.n_cols);
+  if (a.n_cols == 0 || b.n_cols == 0)
+    return;
+
+  std::vector<bool> aFinite(a.n_cols);
+  size_t aFiniteCount = 0;
+  for (size_t i = 0; i < a.n_cols; ++i)
+  {
+    aFinite[i] = IsFiniteColumn(a, i);
+    if (aFinite[i])
+      ++aFiniteCount;
+  }
+
+  std::vector<bool> bFinite(b.n_cols);
+  size_t bFiniteCount = 0;
+  for (size_t j = 0; j < b.n_cols; ++j)
+  {
+    bFinite[j] = IsFiniteColumn(b, j);
+    if (bFinite[j])
+      ++bFiniteCount;
+  }
+
+  arma::mat aCentered = arma::conv_to<arma::mat>::from(a);
+  arma::mat bCentered = arma::conv_to<arma::mat>::from(b);
+
+  // Center on the finite points of a, or of b if a has none.
+  arma::vec center;
+  center.zeros(a.n_rows);
+  if (aFiniteCount > 0)
+  {
+    for (size_t i = 0; i < a.n_cols; ++i)
+      if (aFinite[i])
+        center += aCentered.col(i);
+    center /= aFiniteCount;
+  }
+  else if (bFiniteCount > 0)
+  {
+    for (size_t j = 0; j < b.n_cols; ++j)
+      if (bFinite[j])
+        center += bCentered.col(j);
+    center /= bFiniteCount;
+  }
+
+  aCentered.each_col() -= center;
+  bCentered.each_col() -= center;
+  for (size_t i = 0; i < a.n_cols; ++i)
+    if (!aFinite[i])
+      aCentered.col(i).zeros();
+  for (size_t j = 0; j < b.n_cols; ++j)
+    if (!bFinite[j])
+      bCentered.col(j).zeros();
+
+  const arma::rowvec aNorms = arma::sum(arma::square(aCentered), 0);
+  const arma::rowvec bNorms = arma::sum(arma::square(bCentered), 0);
+  const arma::mat products = arma::trans(aCentered) * bCentered;
+
+  for (size_t j = 0; j < b.n_cols; ++j)
+  {
+    for (size_t i = 0; i < a.n_cols; ++i)
+    {
+      const double norms = aNorms[i] + bNorms[j];
+      double distance = norms - 2 * products(i, j);
+
+      // The cancellation error is on the order of epsilon * norms; if that is
+      // not negligible compared to the distance, compute it directly.  The
+      // comparison is written so that it also catches NaN, which points with
+      // huge (but finite) coordinates can give.
+      if (!aFinite[i] || !bFinite[j] || !(distance > 1e-6 * norms))
+      {
+        distance = 0;
+        for (size_t d = 0; d < a.n_rows; ++d)
+        {
+          const double diff = double(a(d, i)) - double(b(d, j));
+          distance += diff * diff;
+        }
+      }
+
+      squared(i, j) = eT(distance);
+    }
+  }
+}
+
+/**
+ * Compute a block of L2 distances on dense data with
+ * BlockSquaredDistances(), taking the square root afterwards if the metric
+ * does.
+ */
+template<bool TakeRoot, typename eT>
+void BlockEvaluate(LMetric<2, TakeRoot>& /* metric */,
+                   const arma::Mat<eT>& a,
+                   const size_t aBegin,
+                   const size_t aCount,
+                   const arma::Mat<eT>& b,
+                   const size_t bBegin,
+                   const size_t bCount,
+                   arma::Mat<eT>& distances)
+{
+  // Alias the two blocks of columns without copying them.
+  const arma::Mat<eT> aBlock(const_cast<eT*>(a.colptr(aBegin)), a.n_rows,
+      aCount, false, true);
+  const arma::Mat<eT> bBlock(const_cast<eT*>(b.colptr(bBegin)), b.n_rows,
+      bCount, false, true);
+
+  BlockSquaredDistances(aBlock, bBlock, distances);
+  if (TakeRoot)
+    distances = arma::sqrt(distances);
+}
+
+/**
+ * BlockEvaluateTraits tells algorithms whether calling BlockEvaluate() for a
+ * leaf-leaf base case is worthwhile for a given metric and matrix type, or
+ * whether they should simply evaluate the distances one pair at a time.  By
+ * default it is not.
+ */
+template<typename MetricType, typename MatType>
+struct BlockEvaluateTraits
+{
+  //! Whether BlockEvaluate() is faster for data of the given dimensionality.
+  static bool IsFaster(const size_t /* dimensionality */) { return false; }
+};
+
+/**
+ * The L2 distance on dense data is computed by matrix multiplication, which
+ * pays off once there are enough dimensions; in very low dimensions the
+ * pairwise loop is just as fast and does not lose precision to cancellation.
+ */
+template<bool TakeRoot, typename eT>
+struct BlockEvaluateTraits<LMetric<2, TakeRoot>, arma::Mat<eT> >
+{
+  static bool IsFaster(const size_t dimensionality)
+  {
+    return (dimensionality >= 8);
+  }
+};
+
+}; // namespace metric
+}; // namespace mlpack
+
+#endif
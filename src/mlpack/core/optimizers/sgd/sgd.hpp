@@ -98,6 +98,32 @@ class SGD
    */
   double Optimize(arma::mat& iterate);
 
+  /**
+   * Optimize the function using stochastic gradient descent on a dataset which
+   * is read from disk in blocks (out-of-core), so that it never has to fit in
+   * memory.  Each pass over the file is one sequence of updates; the points in
+   * each block are visited in random order if shuffle is true, but the blocks
+   * are always visited in the order of the file.  The algorithm terminates in
+   * the same way as Optimize(arma::mat&), after a pass where the objective
+   * changes by less than the tolerance or after the maximum number of
+   * iterations.
+   *
+   * For this, DecomposableFunctionType must also implement
+   *
+   *   void SetBlock(const arma::mat& block, const size_t totalPoints);
+   *
+   * after which NumFunctions(), Evaluate() and Gradient() refer to the points
+   * in the given block; totalPoints is the number of points in the whole
+   * dataset, so that terms spread over all the points (like regularization)
+   * are divided by the right number.  To find it, the file is read once before
+   * the optimization starts.
+   *
+   * @param reader Reader for the dataset.
+   * @param iterate Starting point (will be modified).
+   * @return Objective value of the final point.
+   */
+  double Optimize(data::StreamReader<>& reader, arma::mat& iterate);
+
   //! Get the instantiated function to be optimized.
   const DecomposableFunctionType& Function() const { return function; }
   //! Modify the instantiated function.
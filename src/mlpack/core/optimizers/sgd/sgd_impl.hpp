@@ -109,6 +109,106 @@ double SGD<DecomposableFunctionType>::Optimize(arma::mat& iterate)
   return overallObjective;
 }
 
+//! Optimize the function (minimize), reading the dataset in blocks.
+template<typename DecomposableFunctionType>
+double SGD<DecomposableFunctionType>::Optimize(data::StreamReader<>& reader,
+                                               arma::mat& iterate)
+{
+  double lastObjective = DBL_MAX;
+  arma::mat block;
+  arma::mat gradient(iterate.n_rows, iterate.n_cols);
+  arma::vec visitationOrder;
+
+  // Terms of the objective that are spread over all the points (like
+  // regularization) need the size of the whole dataset, which text files do not
+  // give without reading them once.
+  size_t totalPoints = 0;
+  reader.Reset();
+  while (reader.NextBlock(block))
+    totalPoints += block.n_cols;
+
+  if (totalPoints == 0)
+  {
+    Log::Warn << "SGD: the dataset is empty; terminating optimization."
+        << std::endl;
+    return 0.0;
+  }
+
+  // The iteration counter counts single updates, like in Optimize(arma::mat&).
+  size_t i = 1;
+  bool finished = false;
+  while (!finished)
+  {
+    double overallObjective = 0;
+
+    reader.Reset();
+    while (!finished && reader.NextBlock(block))
+    {
+      function.SetBlock(block, totalPoints);
+      const size_t numFunctions = function.NumFunctions();
+      if (shuffle)
+        visitationOrder = arma::shuffle(arma::linspace(0, (numFunctions - 1),
+            numFunctions));
+
+      for (size_t j = 0; j < numFunctions; ++j, ++i)
+      {
+        if (i == maxIterations)
+        {
+          finished = true;
+          break;
+        }
+
+        const size_t currentFunction = shuffle ? (size_t) visitationOrder[j] :
+            j;
+
+        // Evaluate the gradient for this iteration, update the iterate, and add
+        // the new objective to the overall objective function.
+        function.Gradient(iterate, currentFunction, gradient);
+        iterate -= stepSize * gradient;
+        overallObjective += function.Evaluate(iterate, currentFunction);
+      }
+    }
+
+    if (finished)
+      break;
+
+    // Output current objective function.
+    Log::Info << "SGD: iteration " << i << ", objective " << overallObjective
+        << "." << std::endl;
+
+    if (overallObjective != overallObjective)
+    {
+      Log::Warn << "SGD: converged to " << overallObjective << "; terminating"
+          << " with failure.  Try a smaller step size?" << std::endl;
+      return overallObjective;
+    }
+
+    if (std::abs(lastObjective - overallObjective) < tolerance)
+    {
+      Log::Info << "SGD: minimized within tolerance " << tolerance << "; "
+          << "terminating optimization." << std::endl;
+      return overallObjective;
+    }
+
+    lastObjective = overallObjective;
+  }
+
+  Log::Info << "SGD: maximum iterations (" << maxIterations << ") reached; "
+      << "terminating optimization." << std::endl;
+
+  // Calculate final objective, with one more pass over the data.
+  double overallObjective = 0;
+  reader.Reset();
+  while (reader.NextBlock(block))
+  {
+    function.SetBlock(block, totalPoints);
+    for (size_t j = 0; j < function.NumFunctions(); ++j)
+      overallObjective += function.Evaluate(iterate, j);
+  }
+
+  return overallObjective;
+}
+
 // Convert the object to a string.
 template<typename DecomposableFunctionType>
 std::string SGD<DecomposableFunctionType>::ToString() const
@@ -112,7 +112,11 @@ class BallBound
    *
    * @param centroid Vector which the centroid will be written to.
    */
-  void Centroid(VecType& centroid) const { centroid = center; }
+  template<typename OtherVecType>
+  void Centroid(OtherVecType& centroid) const
+  {
+    centroid = arma::conv_to<OtherVecType>::from(center);
+  }
 
   /**
    * Calculates minimum bound-to-point squared distance.
@@ -185,6 +189,24 @@ class BallBound
    * Returns a string representation of this object.
    */
   std::string ToString() const;
+
+  /**
+   * Write the radius and center of the bound to the given binary stream, in
+   * the native byte order.
+   *
+   * @param stream Stream to write to.
+   */
+  void Save(std::ostream& stream) const;
+
+  /**
+   * Read the radius and center of the bound from the given binary stream, as
+   * written by Save().  If the stored dimensionality is not the expected one,
+   * std::runtime_error is thrown before anything is allocated.
+   *
+   * @param stream Stream to read from.
+   * @param dimensionality Expected dimensionality of the bound.
+   */
+  void Load(std::istream& stream, const size_t dimensionality);
 };
 
 //! A specialization of BoundTraits for this bound type.
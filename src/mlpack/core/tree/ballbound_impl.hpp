@@ -12,6 +12,7 @@
 // In case it hasn't been included already.
 #include "ballbound.hpp"
 
+#include <stdexcept>
 #include <string>
 
 namespace mlpack {
@@ -242,7 +243,7 @@ BallBound<VecType, TMetricType>::operator|=(const MatType& data)
     {
       // Move towards the new point and increase the radius just enough to
       // accomodate the new point.
-      arma::vec diff = data.col(i) - center;
+      VecType diff = data.col(i) - center;
       center += ((dist - radius) / (2 * dist)) * diff;
       radius = 0.5 * (dist + radius);
     }
@@ -266,6 +267,51 @@ std::string BallBound<VecType, TMetricType>::ToString() const
   return convert.str();
 }
 
+/**
+ * Write the bound to a binary stream: the radius, the dimensionality, and then
+ * the center.
+ */
+template<typename VecType, typename TMetricType>
+void BallBound<VecType, TMetricType>::Save(std::ostream& stream) const
+{
+  const uint64_t dimension = center.n_elem;
+  stream.write((const char*) &radius, sizeof(double));
+  stream.write((const char*) &dimension, sizeof(uint64_t));
+  for (size_t i = 0; i < center.n_elem; ++i)
+  {
+    const double value = center[i];
+    stream.write((const char*) &value, sizeof(double));
+  }
+}
+
+/**
+ * Read the bound from a binary stream written by Save().
+ */
+template<typename VecType, typename TMetricType>
+void BallBound<VecType, TMetricType>::Load(std::istream& stream,
+                                           const size_t dimensionality)
+{
+  uint64_t dimension;
+  stream.read((char*) &radius, sizeof(double));
+  stream.read((char*) &dimension, sizeof(uint64_t));
+  if (!stream.good())
+    return;
+
+  // Check the dimensionality before allocating anything, so that a corrupt
+  // stream doesn't make us allocate gigabytes.
+  if (dimension != dimensionality)
+    throw std::runtime_error("BallBound::Load(): unexpected dimensionality in "
+        "stream");
+
+  center.set_size(dimension);
+  for (size_t i = 0; i < center.n_elem; ++i)
+  {
+    double value;
+    stream.read((char*) &value, sizeof(double));
+    center[i] = value;
+  }
+}
+
 }; // namespace bound
 }; // namespace mlpack
 
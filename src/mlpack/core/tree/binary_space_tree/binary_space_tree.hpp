@@ -14,6 +14,14 @@
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
 
+// Forward declarations of the depth-first traversers, which are shared by all
+// binary tree types; see single_tree_traverser.hpp and dual_tree_traverser.hpp.
+template<typename TreeType, typename RuleType>
+class BinarySingleTreeTraverser;
+
+template<typename TreeType, typename RuleType>
+class BinaryDualTreeTraverser;
+
 /**
  * A binary space partitioning tree, such as a KD-tree or a ball tree.  Once the
  * bound and type of dataset is defined, the tree will construct itself.  Call
@@ -74,18 +82,31 @@ class BinarySpaceTree
   //! So other classes can use TreeType::Mat.
   typedef MatType Mat;
 
+  //! Nodes holding at least this many points are built in parallel, if OpenMP
+  //! is available: their bound is computed over chunks of the points in
+  //! separate tasks (for bounds with tight dimensions), and children of at
+  //! least this size are built in separate tasks.  The tree is the same as the
+  //! one built serially.
+  static const size_t ParallelBuildSize = 20000;
+
   //! A single-tree traverser for binary space trees; see
   //! single_tree_traverser.hpp for implementation.
   template<typename RuleType>
-  class SingleTreeTraverser;
+  using SingleTreeTraverser = BinarySingleTreeTraverser<BinarySpaceTree,
+      RuleType>;
 
   //! A dual-tree traverser for binary space trees; see dual_tree_traverser.hpp.
   template<typename RuleType>
-  class DualTreeTraverser;
+  using DualTreeTraverser = BinaryDualTreeTraverser<BinarySpaceTree, RuleType>;
 
   template<typename RuleType>
   class BreadthFirstDualTreeTraverser;
 
+  //! A dual-tree traverser which traverses query subtrees in parallel with
+  //! OpenMP tasks; see parallel_dual_tree_traverser.hpp.
+  template<typename RuleType>
+  class ParallelDualTreeTraverser;
+
   /**
    * Construct this as the root node of a binary space tree using the given
    * dataset.  This will modify the ordering of the points in the dataset!
@@ -209,6 +230,21 @@ class BinarySpaceTree
    */
   BinarySpaceTree(const BinarySpaceTree& other);
 
+  /**
+   * Construct this node (and all of its descendants) from a binary stream
+   * which was written by Save().  No splitting is done, so this is much faster
+   * than building the tree; but the given dataset must be the (already
+   * rearranged) dataset that the saved tree was built on.  If the stream is
+   * invalid, std::runtime_error is thrown.
+   *
+   * @param data Dataset that the saved tree was built on.
+   * @param stream Binary stream to read the tree from.
+   * @param parent Parent of this node (NULL if this is the root).
+   */
+  BinarySpaceTree(MatType& data,
+                  std::istream& stream,
+                  BinarySpaceTree* parent = NULL);
+
   /**
    * Deletes this node, deallocating the memory for the children and calling
    * their destructors in turn.  This will invalidate any pointers or references
@@ -424,6 +460,16 @@ class BinarySpaceTree
   //! Returns false: this tree type does not have self children.
   static bool HasSelfChildren() { return false; }
 
+  /**
+   * Write this node and all of its descendants to the given binary stream (in
+   * the native byte order), so that the tree can later be reconstructed with
+   * the stream constructor.  The dataset and the statistics are not written.
+   * The bound type must provide Save() and Load() methods.
+   *
+   * @param stream Binary stream to write the tree to.
+   */
+  void Save(std::ostream& stream) const;
+
  private:
   /**
    * Splits the current node, assigning its left and right children recursively.
@@ -12,10 +12,64 @@
 #include <mlpack/core/util/cli.hpp>
 #include <mlpack/core/util/log.hpp>
 #include <mlpack/core/util/string_util.hpp>
+#include "../bound_traits.hpp"
 
 namespace mlpack {
 namespace tree {
 
+//! Expand the bound to include the given points.  Bounds whose dimensions are
+//! not tight (such as BallBound) depend on the order in which the points are
+//! added, so they are always expanded serially.
+template<typename BoundType, typename MatType>
+void ExpandBound(BoundType& bound,
+                 const MatType& data,
+                 const size_t begin,
+                 const size_t count,
+                 const size_t /* chunkSize */,
+                 const typename boost::disable_if_c<
+                     bound::BoundTraits<BoundType>::HasTightBounds>::type* = 0)
+{
+  bound |= data.cols(begin, begin + count - 1);
+}
+
+//! Expand the bound to include the given points.  A bound with tight
+//! dimensions is exactly the range of the points in every dimension, so the
+//! points can be split into chunks whose bounds are computed in separate
+//! OpenMP tasks and then combined, without changing the result.
+template<typename BoundType, typename MatType>
+void ExpandBound(BoundType& bound,
+                 const MatType& data,
+                 const size_t begin,
+                 const size_t count,
+                 const size_t chunkSize,
+                 const typename boost::enable_if_c<
+                     bound::BoundTraits<BoundType>::HasTightBounds>::type* = 0)
+{
+  if (count <= chunkSize)
+  {
+    bound |= data.cols(begin, begin + count - 1);
+    return;
+  }
+
+  const size_t chunks = (count + chunkSize - 1) / chunkSize;
+  std::vector<BoundType> chunkBounds(chunks, BoundType(data.n_rows));
+  BoundType* chunkBoundsPtr = &chunkBounds[0];
+  const MatType* dataPtr = &data;
+  for (size_t c = 0; c < chunks; ++c)
+  {
+    #pragma omp task firstprivate(c, chunkBoundsPtr, dataPtr)
+    {
+      const size_t chunkBegin = begin + c * chunkSize;
+      const size_t chunkEnd = std::min(chunkBegin + chunkSize, begin + count);
+      chunkBoundsPtr[c] |= dataPtr->cols(chunkBegin, chunkEnd - 1);
+    }
+  }
+  #pragma omp taskwait
+
+  for (size_t c = 0; c < chunks; ++c)
+    bound |= chunkBounds[c];
+}
+
 // Each of these overloads is kept as a separate function to keep the overhead
 // from the two std::vectors out, if possible.
 template<typename BoundType,
@@ -34,9 +88,14 @@ BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::BinarySpaceTree(
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
     dataset(data)
 {
-  // Do the actual splitting of this node.
+  // Do the actual splitting of this node.  One thread starts the build, and
+  // the large nodes are split in parallel tasks (see SplitNode()).
   SplitType splitter;
-  SplitNode(data, maxLeafSize, splitter);
+  #pragma omp parallel if (count >= ParallelBuildSize)
+  {
+    #pragma omp single
+    SplitNode(data, maxLeafSize, splitter);
+  }
 
   // Create the statistic depending on if we are a leaf or not.
   stat = StatisticType(*this);
@@ -64,9 +123,14 @@ BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::BinarySpaceTree(
   for (size_t i = 0; i < data.n_cols; i++)
     oldFromNew[i] = i; // Fill with unharmed indices.
 
-  // Now do the actual splitting.
+  // Now do the actual splitting.  One thread starts the build, and the large
+  // nodes are split in parallel tasks (see SplitNode()).
   SplitType splitter;
-  SplitNode(data, oldFromNew, maxLeafSize, splitter);
+  #pragma omp parallel if (count >= ParallelBuildSize)
+  {
+    #pragma omp single
+    SplitNode(data, oldFromNew, maxLeafSize, splitter);
+  }
 
   // Create the statistic depending on if we are a leaf or not.
   stat = StatisticType(*this);
@@ -95,9 +159,14 @@ BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::BinarySpaceTree(
   for (size_t i = 0; i < data.n_cols; i++)
     oldFromNew[i] = i; // Fill with unharmed indices.
 
-  // Now do the actual splitting.
+  // Now do the actual splitting.  One thread starts the build, and the large
+  // nodes are split in parallel tasks (see SplitNode()).
   SplitType splitter;
-  SplitNode(data, oldFromNew, maxLeafSize, splitter);
+  #pragma omp parallel if (count >= ParallelBuildSize)
+  {
+    #pragma omp single
+    SplitNode(data, oldFromNew, maxLeafSize, splitter);
+  }
 
   // Create the statistic depending on if we are a leaf or not.
   stat = StatisticType(*this);
@@ -237,6 +306,64 @@ BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::BinarySpaceTree(
   }
 }
 
+/**
+ * Read a tree from a binary stream written by Save().  Each node is stored as
+ * its begin and count, its parent and furthest descendant distances, whether or
+ * not it has children, and its bound; then its children follow.
+ */
+template<typename BoundType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType>
+BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::BinarySpaceTree(
+    MatType& data,
+    std::istream& stream,
+    BinarySpaceTree* parent) :
+    left(NULL),
+    right(NULL),
+    parent(parent),
+    dataset(data)
+{
+  uint64_t nodeBegin, nodeCount;
+  uint8_t hasChildren;
+  stream.read((char*) &nodeBegin, sizeof(uint64_t));
+  stream.read((char*) &nodeCount, sizeof(uint64_t));
+  stream.read((char*) &parentDistance, sizeof(double));
+  stream.read((char*) &furthestDescendantDistance, sizeof(double));
+  stream.read((char*) &hasChildren, sizeof(uint8_t));
+  if (!stream.good() || (nodeBegin + nodeCount > data.n_cols) ||
+      (nodeCount == 0))
+    throw std::runtime_error("BinarySpaceTree: invalid or truncated tree in "
+        "stream");
+
+  begin = nodeBegin;
+  count = nodeCount;
+
+  // The dimensionality of the dataset has already been checked against the
+  // size of the stream, so the bound can't allocate more than that.
+  bound.Load(stream, data.n_rows);
+  if (!stream.good())
+    throw std::runtime_error("BinarySpaceTree: invalid or truncated bound in "
+        "stream");
+
+  if (hasChildren)
+  {
+    left = new BinarySpaceTree(data, stream, this);
+    try
+    {
+      right = new BinarySpaceTree(data, stream, this);
+    }
+    catch (std::runtime_error&)
+    {
+      delete left;
+      throw;
+    }
+  }
+
+  // Create the statistic depending on if we are a leaf or not.
+  stat = StatisticType(*this);
+}
+
 /**
  * Deletes this node, deallocating the memory for the children and calling their
  * destructors in turn.  This will invalidate any pointers or references to any
@@ -525,7 +652,7 @@ void BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::SplitNode(
     SplitType& splitter)
 {
   // We need to expand the bounds of this node properly.
-  bound |= data.cols(begin, begin + count - 1);
+  ExpandBound(bound, data, begin, count, ParallelBuildSize);
 
   // Calculate the furthest descendant distance.
   furthestDescendantDistance = 0.5 * bound.Diameter();
@@ -549,11 +676,23 @@ void BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::SplitNode(
     return;
 
   // Now that we know the split column, we will recursively split the children
-  // by calling their constructors (which perform this splitting process).
-  left = new BinarySpaceTree(data, begin, splitCol - begin, splitter, this,
+  // by calling their constructors (which perform this splitting process).  Each
+  // child only touches its own columns of the data, so large children are
+  // built in concurrent tasks.  The splitter has no state.
+  MatType* dataPtr = &data;
+  SplitType* splitterPtr = &splitter;
+  const size_t leftCount = splitCol - begin;
+  const size_t rightCount = begin + count - splitCol;
+
+  #pragma omp task firstprivate(dataPtr, splitterPtr) \
+      if (leftCount >= ParallelBuildSize)
+  left = new BinarySpaceTree(*dataPtr, begin, leftCount, *splitterPtr, this,
       maxLeafSize);
-  right = new BinarySpaceTree(data, splitCol, begin + count - splitCol,
-      splitter, this, maxLeafSize);
+  #pragma omp task firstprivate(dataPtr, splitterPtr) \
+      if (rightCount >= ParallelBuildSize)
+  right = new BinarySpaceTree(*dataPtr, splitCol, rightCount, *splitterPtr,
+      this, maxLeafSize);
+  #pragma omp taskwait
 
   // Calculate parent distances for those two nodes.
   arma::vec centroid, leftCentroid, rightCentroid;
@@ -580,9 +719,8 @@ void BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::SplitNode(
     const size_t maxLeafSize,
     SplitType& splitter)
 {
-  // This should be a single function for Bound.
   // We need to expand the bounds of this node properly.
-  bound |= data.cols(begin, begin + count - 1);
+  ExpandBound(bound, data, begin, count, ParallelBuildSize);
 
   // Calculate the furthest descendant distance.
   furthestDescendantDistance = 0.5 * bound.Diameter();
@@ -607,11 +745,25 @@ void BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::SplitNode(
     return;
 
   // Now that we know the split column, we will recursively split the children
-  // by calling their constructors (which perform this splitting process).
-  left = new BinarySpaceTree(data, begin, splitCol - begin, oldFromNew,
-      splitter, this, maxLeafSize);
-  right = new BinarySpaceTree(data, splitCol, begin + count - splitCol,
-      oldFromNew, splitter, this, maxLeafSize);
+  // by calling their constructors (which perform this splitting process).  Each
+  // child only touches its own columns of the data and its own part of
+  // oldFromNew, so large children are built in concurrent tasks.  The splitter
+  // has no state.
+  MatType* dataPtr = &data;
+  std::vector<size_t>* oldFromNewPtr = &oldFromNew;
+  SplitType* splitterPtr = &splitter;
+  const size_t leftCount = splitCol - begin;
+  const size_t rightCount = begin + count - splitCol;
+
+  #pragma omp task firstprivate(dataPtr, oldFromNewPtr, splitterPtr) \
+      if (leftCount >= ParallelBuildSize)
+  left = new BinarySpaceTree(*dataPtr, begin, leftCount, *oldFromNewPtr,
+      *splitterPtr, this, maxLeafSize);
+  #pragma omp task firstprivate(dataPtr, oldFromNewPtr, splitterPtr) \
+      if (rightCount >= ParallelBuildSize)
+  right = new BinarySpaceTree(*dataPtr, splitCol, rightCount, *oldFromNewPtr,
+      *splitterPtr, this, maxLeafSize);
+  #pragma omp taskwait
 
   // Calculate parent distances for those two nodes.
   arma::vec centroid, leftCentroid, rightCentroid;
@@ -628,6 +780,34 @@ void BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::SplitNode(
   right->ParentDistance() = rightParentDistance;
 }
 
+/**
+ * Write this node and its descendants to a binary stream, in the order that the
+ * stream constructor reads them.
+ */
+template<typename BoundType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType>
+void BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::Save(
+    std::ostream& stream) const
+{
+  const uint64_t nodeBegin = begin;
+  const uint64_t nodeCount = count;
+  const uint8_t hasChildren = (left != NULL) ? 1 : 0;
+  stream.write((const char*) &nodeBegin, sizeof(uint64_t));
+  stream.write((const char*) &nodeCount, sizeof(uint64_t));
+  stream.write((const char*) &parentDistance, sizeof(double));
+  stream.write((const char*) &furthestDescendantDistance, sizeof(double));
+  stream.write((const char*) &hasChildren, sizeof(uint8_t));
+  bound.Save(stream);
+
+  if (left)
+  {
+    left->Save(stream);
+    right->Save(stream);
+  }
+}
+
 /**
  * Returns a string representation of this object.
  */
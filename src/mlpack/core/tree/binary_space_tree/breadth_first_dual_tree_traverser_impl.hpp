@@ -12,6 +12,8 @@
 // In case it hasn't been included yet.
 #include "breadth_first_dual_tree_traverser.hpp"
 
+#include "../prepare_base_cases.hpp"
+
 namespace mlpack {
 namespace tree {
 
@@ -23,11 +25,7 @@ template<typename RuleType>
 BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
 BreadthFirstDualTreeTraverser<RuleType>::BreadthFirstDualTreeTraverser(
     RuleType& rule) :
-    rule(rule),
-    numPrunes(0),
-    numVisited(0),
-    numScores(0),
-    numBaseCases(0)
+    rule(rule)
 { /* Nothing to do. */ }
 
 template<typename TreeType, typename TraversalInfoType>
@@ -52,14 +50,12 @@ BreadthFirstDualTreeTraverser<RuleType>::Traverse(
     BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>&
         referenceRoot)
 {
-  // Increment the visit counter.
-  ++numVisited;
-
   // Store the current traversal info.
   traversalInfo = rule.TraversalInfo();
 
   // Must score the root combination.
   const double rootScore = rule.Score(queryRoot, referenceRoot);
+  statistics.Score();
   if (rootScore == DBL_MAX)
     return; // This probably means something is wrong.
 
@@ -105,17 +101,24 @@ BreadthFirstDualTreeTraverser<RuleType>::Traverse(
     const size_t queryDepth = currentFrame.queryDepth;
 
     double score = rule.Score(queryNode, referenceNode);
-    ++numScores;
+    statistics.Score();
 
     if (score == DBL_MAX)
     {
-      ++numPrunes;
+      statistics.Prune();
       continue;
     }
 
+    // The combination is visited at the depth of the query node.
+    statistics.Visit(queryDepth);
+
     // If both are leaves, we must evaluate the base case.
     if (queryNode.IsLeaf() && referenceNode.IsLeaf())
     {
+      // Let the rules prepare all the base cases between the two leaves at
+      // once, if they know how to.
+      PrepareBaseCases(rule, queryNode, referenceNode);
+
       // Loop through each of the points in each node.
       for (size_t query = queryNode.Begin(); query < queryNode.End(); ++query)
       {
@@ -131,7 +134,7 @@ BreadthFirstDualTreeTraverser<RuleType>::Traverse(
             ++ref)
           rule.BaseCase(query, ref);
 
-        numBaseCases += referenceNode.Count();
+        statistics.BaseCase(referenceNode.Count());
       }
     }
     else if ((!queryNode.IsLeaf()) && referenceNode.IsLeaf())
@@ -2,34 +2,44 @@
  * @file dual_tree_traverser.hpp
  * @author Ryan Curtin
  *
- * Defines the DualTreeTraverser for the BinarySpaceTree tree type.  This is a
- * nested class of BinarySpaceTree which traverses two trees in a depth-first
- * manner with a given set of rules which indicate the branches which can be
- * pruned and the order in which to recurse.
+ * Defines the depth-first dual-tree traverser for binary trees.  This
+ * traverses two trees in a depth-first manner with a given set of rules which
+ * indicate the branches which can be pruned and the order in which to recurse.
+ * It is the DualTreeTraverser of both BinarySpaceTree and FlatBinarySpaceTree.
  */
 #ifndef __MLPACK_CORE_TREE_BINARY_SPACE_TREE_DUAL_TREE_TRAVERSER_HPP
 #define __MLPACK_CORE_TREE_BINARY_SPACE_TREE_DUAL_TREE_TRAVERSER_HPP
 
 #include <mlpack/core.hpp>
 
-#include "binary_space_tree.hpp"
+#include "../traversal_statistics.hpp"
 
 namespace mlpack {
 namespace tree {
 
-template<typename BoundType,
-         typename StatisticType,
-         typename MatType,
-         typename SplitType>
-template<typename RuleType>
-class BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
-    DualTreeTraverser
+/**
+ * A depth-first dual-tree traverser for any binary tree type whose nodes
+ * provide IsLeaf(), Left(), Right(), Begin(), End(), Count() and
+ * NumDescendants(), such as BinarySpaceTree and FlatBinarySpaceTree.  Those
+ * trees make it available as TreeType::DualTreeTraverser<RuleType>.
+ *
+ * @tparam TreeType Type of the trees to traverse.
+ * @tparam RuleType Type of the rules to traverse the trees with.
+ */
+template<typename TreeType, typename RuleType>
+class BinaryDualTreeTraverser
 {
  public:
   /**
-   * Instantiate the dual-tree traverser with the given rule set.
+   * Instantiate the dual-tree traverser with the given rule set.  The visits
+   * to node combinations are counted at depths relative to the given depth;
+   * this is useful when the traversal is only part of a larger one (as in the
+   * ParallelDualTreeTraverser).
+   *
+   * @param rule Rules to traverse the trees with.
+   * @param depth Depth of the first node combination that is traversed.
    */
-  DualTreeTraverser(RuleType& rule);
+  BinaryDualTreeTraverser(RuleType& rule, const size_t depth = 0);
 
   /**
    * Traverse the two trees.  This does not reset the number of prunes.
@@ -38,48 +48,51 @@ class BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
    * @param referenceNode The reference node to be traversed.
    * @param score The score of the current node combination.
    */
-  void Traverse(BinarySpaceTree& queryNode,
-                BinarySpaceTree& referenceNode);
+  void Traverse(TreeType& queryNode, TreeType& referenceNode);
 
   //! Get the number of prunes.
-  size_t NumPrunes() const { return numPrunes; }
+  size_t NumPrunes() const { return statistics.NumPrunes(); }
   //! Modify the number of prunes.
-  size_t& NumPrunes() { return numPrunes; }
+  size_t& NumPrunes() { return statistics.NumPrunes(); }
 
   //! Get the number of visited combinations.
-  size_t NumVisited() const { return numVisited; }
+  size_t NumVisited() const { return statistics.NumVisited(); }
   //! Modify the number of visited combinations.
-  size_t& NumVisited() { return numVisited; }
+  size_t& NumVisited() { return statistics.NumVisited(); }
 
   //! Get the number of times a node combination was scored.
-  size_t NumScores() const { return numScores; }
+  size_t NumScores() const { return statistics.NumScores(); }
   //! Modify the number of times a node combination was scored.
-  size_t& NumScores() { return numScores; }
+  size_t& NumScores() { return statistics.NumScores(); }
 
   //! Get the number of times a base case was calculated.
-  size_t NumBaseCases() const { return numBaseCases; }
+  size_t NumBaseCases() const { return statistics.NumBaseCases(); }
   //! Modify the number of times a base case was calculated.
-  size_t& NumBaseCases() { return numBaseCases; }
+  size_t& NumBaseCases() { return statistics.NumBaseCases(); }
+
+  //! Get the statistics of the traversal.
+  const TraversalStatistics& Statistics() const { return statistics; }
+  //! Modify the statistics of the traversal.
+  TraversalStatistics& Statistics() { return statistics; }
 
  private:
   //! Reference to the rules with which the trees will be traversed.
   RuleType& rule;
 
-  //! The number of prunes.
-  size_t numPrunes;
-
-  //! The number of node combinations that have been visited during traversal.
-  size_t numVisited;
+  //! The counts of the work done during traversal.
+  TraversalStatistics statistics;
 
-  //! The number of times a node combination was scored.
-  size_t numScores;
-
-  //! The number of times a base case was calculated.
-  size_t numBaseCases;
+  //! The current depth of the recursion.
+  size_t depth;
 
   //! Traversal information, held in the class so that it isn't continually
   //! being reallocated.
   typename RuleType::TraversalInfoType traversalInfo;
+
+  //! The scores of the points of a query leaf against a reference leaf, for
+  //! rules that implement PrepareBaseCases(); held in the class for the same
+  //! reason.
+  std::vector<double> pointScores;
 };
 
 }; // namespace tree
@@ -2,9 +2,9 @@
  * @file dual_tree_traverser_impl.hpp
  * @author Ryan Curtin
  *
- * Implementation of the DualTreeTraverser for BinarySpaceTree.  This is a way
- * to perform a dual-tree traversal of two trees.  The trees must be the same
- * type.
+ * Implementation of the depth-first dual-tree traverser for binary trees.  This
+ * is a way to perform a dual-tree traversal of two trees.  The trees must be
+ * the same type.
  */
 #ifndef __MLPACK_CORE_TREE_BINARY_SPACE_TREE_DUAL_TREE_TRAVERSER_IMPL_HPP
 #define __MLPACK_CORE_TREE_BINARY_SPACE_TREE_DUAL_TREE_TRAVERSER_IMPL_HPP
@@ -12,36 +12,26 @@
 // In case it hasn't been included yet.
 #include "dual_tree_traverser.hpp"
 
+#include "../prepare_base_cases.hpp"
+
 namespace mlpack {
 namespace tree {
 
-template<typename BoundType,
-         typename StatisticType,
-         typename MatType,
-         typename SplitType>
-template<typename RuleType>
-BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
-DualTreeTraverser<RuleType>::DualTreeTraverser(RuleType& rule) :
+template<typename TreeType, typename RuleType>
+BinaryDualTreeTraverser<TreeType, RuleType>::BinaryDualTreeTraverser(
+    RuleType& rule,
+    const size_t depth) :
     rule(rule),
-    numPrunes(0),
-    numVisited(0),
-    numScores(0),
-    numBaseCases(0)
+    depth(depth)
 { /* Nothing to do. */ }
 
-template<typename BoundType,
-         typename StatisticType,
-         typename MatType,
-         typename SplitType>
-template<typename RuleType>
-void BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
-DualTreeTraverser<RuleType>::Traverse(
-    BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>& queryNode,
-    BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>&
-        referenceNode)
+template<typename TreeType, typename RuleType>
+void BinaryDualTreeTraverser<TreeType, RuleType>::Traverse(
+    TreeType& queryNode,
+    TreeType& referenceNode)
 {
   // Increment the visit counter.
-  ++numVisited;
+  statistics.Visit(depth++);
 
   // Store the current traversal info.
   traversalInfo = rule.TraversalInfo();
@@ -49,22 +39,65 @@ DualTreeTraverser<RuleType>::Traverse(
   // If both are leaves, we must evaluate the base case.
   if (queryNode.IsLeaf() && referenceNode.IsLeaf())
   {
-    // Loop through each of the points in each node.
-    for (size_t query = queryNode.Begin(); query < queryNode.End(); ++query)
+    if (HasPrepareBaseCases<RuleType, TreeType>::value)
     {
-      // See if we need to investigate this point (this function should be
-      // implemented for the single-tree recursion too).  Restore the traversal
-      // information first.
-      rule.TraversalInfo() = traversalInfo;
-      const double childScore = rule.Score(query, referenceNode);
+      // See which of the points we need to investigate first (this function
+      // should be implemented for the single-tree recursion too), so that no
+      // base cases are prepared for points that are pruned.  Restore the
+      // traversal information before each score.
+      size_t unpruned = 0;
+      pointScores.resize(queryNode.Count());
+      for (size_t i = 0; i < queryNode.Count(); ++i)
+      {
+        rule.TraversalInfo() = traversalInfo;
+        pointScores[i] = rule.Score(queryNode.Begin() + i, referenceNode);
+        statistics.PointScore(pointScores[i] == DBL_MAX);
+        if (pointScores[i] != DBL_MAX)
+          ++unpruned;
+      }
 
-      if (childScore == DBL_MAX)
-        continue; // We can't improve this particular point.
+      // Let the rules prepare all the base cases between the two leaves at
+      // once, unless most of the points were pruned.
+      if (2 * unpruned >= queryNode.Count())
+        PrepareBaseCases(rule, queryNode, referenceNode);
 
-      for (size_t ref = referenceNode.Begin(); ref < referenceNode.End(); ++ref)
-        rule.BaseCase(query, ref);
+      // Loop through each of the points in each node.
+      for (size_t i = 0; i < queryNode.Count(); ++i)
+      {
+        if (pointScores[i] == DBL_MAX)
+          continue; // We can't improve this particular point.
 
-      numBaseCases += referenceNode.Count();
+        const size_t query = queryNode.Begin() + i;
+        for (size_t ref = referenceNode.Begin(); ref < referenceNode.End();
+            ++ref)
+          rule.BaseCase(query, ref);
+
+        statistics.BaseCase(referenceNode.Count());
+      }
+    }
+    else
+    {
+      // Loop through each of the points in each node.  Each point is scored
+      // right before its base cases, so the score can use the bounds that the
+      // base cases of the earlier points have tightened.
+      for (size_t query = queryNode.Begin(); query < queryNode.End(); ++query)
+      {
+        // See if we need to investigate this point (this function should be
+        // implemented for the single-tree recursion too).  Restore the
+        // traversal information first.
+        rule.TraversalInfo() = traversalInfo;
+        const double childScore = rule.Score(query, referenceNode);
+        statistics.PointScore(childScore == DBL_MAX);
+
+        if (childScore == DBL_MAX)
+          continue; // We can't improve this particular point.
+
+        for (size_t ref = referenceNode.Begin(); ref < referenceNode.End();
+            ++ref)
+          rule.BaseCase(query, ref);
+
+        statistics.BaseCase(referenceNode.Count());
+      }
     }
   }
   else if (((!queryNode.IsLeaf()) && referenceNode.IsLeaf()) ||
@@ -74,22 +107,22 @@ DualTreeTraverser<RuleType>::Traverse(
     // We have to recurse down the query node.  In this case the recursion order
     // does not matter.
     const double leftScore = rule.Score(*queryNode.Left(), referenceNode);
-    ++numScores;
+    statistics.Score();
 
     if (leftScore != DBL_MAX)
       Traverse(*queryNode.Left(), referenceNode);
     else
-      ++numPrunes;
+      statistics.Prune();
 
     // Before recursing, we have to set the traversal information correctly.
     rule.TraversalInfo() = traversalInfo;
     const double rightScore = rule.Score(*queryNode.Right(), referenceNode);
-    ++numScores;
+    statistics.Score();
 
     if (rightScore != DBL_MAX)
       Traverse(*queryNode.Right(), referenceNode);
     else
-      ++numPrunes;
+      statistics.Prune();
   }
   else if (queryNode.IsLeaf() && (!referenceNode.IsLeaf()))
   {
@@ -100,7 +133,7 @@ DualTreeTraverser<RuleType>::Traverse(
     typename RuleType::TraversalInfoType leftInfo = rule.TraversalInfo();
     rule.TraversalInfo() = traversalInfo;
     double rightScore = rule.Score(queryNode, *referenceNode.Right());
-    numScores += 2;
+    statistics.Score(2);
 
     if (leftScore < rightScore)
     {
@@ -112,6 +145,7 @@ DualTreeTraverser<RuleType>::Traverse(
 
       // Is it still valid to recurse to the right?
       rightScore = rule.Rescore(queryNode, *referenceNode.Right(), rightScore);
+      statistics.Rescore(rightScore == DBL_MAX);
 
       if (rightScore != DBL_MAX)
       {
@@ -120,7 +154,7 @@ DualTreeTraverser<RuleType>::Traverse(
         Traverse(queryNode, *referenceNode.Right());
       }
       else
-        ++numPrunes;
+        statistics.Prune();
     }
     else if (rightScore < leftScore)
     {
@@ -129,6 +163,7 @@ DualTreeTraverser<RuleType>::Traverse(
 
       // Is it still valid to recurse to the left?
       leftScore = rule.Rescore(queryNode, *referenceNode.Left(), leftScore);
+      statistics.Rescore(leftScore == DBL_MAX);
 
       if (leftScore != DBL_MAX)
       {
@@ -137,13 +172,13 @@ DualTreeTraverser<RuleType>::Traverse(
         Traverse(queryNode, *referenceNode.Left());
       }
       else
-        ++numPrunes;
+        statistics.Prune();
     }
     else // leftScore is equal to rightScore.
     {
       if (leftScore == DBL_MAX)
       {
-        numPrunes += 2;
+        statistics.Prune(2);
       }
       else
       {
@@ -155,6 +190,7 @@ DualTreeTraverser<RuleType>::Traverse(
 
         rightScore = rule.Rescore(queryNode, *referenceNode.Right(),
             rightScore);
+        statistics.Rescore(rightScore == DBL_MAX);
 
         if (rightScore != DBL_MAX)
         {
@@ -163,7 +199,7 @@ DualTreeTraverser<RuleType>::Traverse(
           Traverse(queryNode, *referenceNode.Right());
         }
         else
-          ++numPrunes;
+          statistics.Prune();
       }
     }
   }
@@ -178,7 +214,7 @@ DualTreeTraverser<RuleType>::Traverse(
     rule.TraversalInfo() = traversalInfo;
     double rightScore = rule.Score(*queryNode.Left(), *referenceNode.Right());
     typename RuleType::TraversalInfoType rightInfo;
-    numScores += 2;
+    statistics.Score(2);
 
     if (leftScore < rightScore)
     {
@@ -191,6 +227,7 @@ DualTreeTraverser<RuleType>::Traverse(
       // Is it still valid to recurse to the right?
       rightScore = rule.Rescore(*queryNode.Left(), *referenceNode.Right(),
           rightScore);
+      statistics.Rescore(rightScore == DBL_MAX);
 
       if (rightScore != DBL_MAX)
       {
@@ -199,7 +236,7 @@ DualTreeTraverser<RuleType>::Traverse(
         Traverse(*queryNode.Left(), *referenceNode.Right());
       }
       else
-        ++numPrunes;
+        statistics.Prune();
     }
     else if (rightScore < leftScore)
     {
@@ -209,6 +246,7 @@ DualTreeTraverser<RuleType>::Traverse(
       // Is it still valid to recurse to the left?
       leftScore = rule.Rescore(*queryNode.Left(), *referenceNode.Left(),
           leftScore);
+      statistics.Rescore(leftScore == DBL_MAX);
 
       if (leftScore != DBL_MAX)
       {
@@ -217,13 +255,13 @@ DualTreeTraverser<RuleType>::Traverse(
         Traverse(*queryNode.Left(), *referenceNode.Left());
       }
       else
-        ++numPrunes;
+        statistics.Prune();
     }
     else
     {
       if (leftScore == DBL_MAX)
       {
-        numPrunes += 2;
+        statistics.Prune(2);
       }
       else
       {
@@ -236,6 +274,7 @@ DualTreeTraverser<RuleType>::Traverse(
         // Is it still valid to recurse to the right?
         rightScore = rule.Rescore(*queryNode.Left(), *referenceNode.Right(),
             rightScore);
+        statistics.Rescore(rightScore == DBL_MAX);
 
         if (rightScore != DBL_MAX)
         {
@@ -244,7 +283,7 @@ DualTreeTraverser<RuleType>::Traverse(
           Traverse(*queryNode.Left(), *referenceNode.Right());
         }
         else
-          ++numPrunes;
+          statistics.Prune();
       }
     }
 
@@ -256,7 +295,7 @@ DualTreeTraverser<RuleType>::Traverse(
     leftInfo = rule.TraversalInfo();
     rule.TraversalInfo() = traversalInfo;
     rightScore = rule.Score(*queryNode.Right(), *referenceNode.Right());
-    numScores += 2;
+    statistics.Score(2);
 
     if (leftScore < rightScore)
     {
@@ -269,6 +308,7 @@ DualTreeTraverser<RuleType>::Traverse(
       // Is it still valid to recurse to the right?
       rightScore = rule.Rescore(*queryNode.Right(), *referenceNode.Right(),
           rightScore);
+      statistics.Rescore(rightScore == DBL_MAX);
 
       if (rightScore != DBL_MAX)
       {
@@ -277,7 +317,7 @@ DualTreeTraverser<RuleType>::Traverse(
         Traverse(*queryNode.Right(), *referenceNode.Right());
       }
       else
-        ++numPrunes;
+        statistics.Prune();
     }
     else if (rightScore < leftScore)
     {
@@ -287,6 +327,7 @@ DualTreeTraverser<RuleType>::Traverse(
       // Is it still valid to recurse to the left?
       leftScore = rule.Rescore(*queryNode.Right(), *referenceNode.Left(),
           leftScore);
+      statistics.Rescore(leftScore == DBL_MAX);
 
       if (leftScore != DBL_MAX)
       {
@@ -295,13 +336,13 @@ DualTreeTraverser<RuleType>::Traverse(
         Traverse(*queryNode.Right(), *referenceNode.Left());
       }
       else
-        ++numPrunes;
+        statistics.Prune();
     }
     else
     {
       if (leftScore == DBL_MAX)
       {
-        numPrunes += 2;
+        statistics.Prune(2);
       }
       else
       {
@@ -314,6 +355,7 @@ DualTreeTraverser<RuleType>::Traverse(
         // Is it still valid to recurse to the right?
         rightScore = rule.Rescore(*queryNode.Right(), *referenceNode.Right(),
             rightScore);
+        statistics.Rescore(rightScore == DBL_MAX);
 
         if (rightScore != DBL_MAX)
         {
@@ -322,10 +364,12 @@ DualTreeTraverser<RuleType>::Traverse(
           Traverse(*queryNode.Right(), *referenceNode.Right());
         }
         else
-          ++numPrunes;
+          statistics.Prune();
       }
     }
   }
+
+  --depth;
 }
 
 }; // namespace tree
@@ -0,0 +1,139 @@
+/**
+ * @file parallel_dual_tree_traverser.hpp
+ *
+ * Defines the ParallelDualTreeTraverser for the BinarySpaceTree tree type.
+ * This is a nested class of BinarySpaceTree which splits the query tree into
+ * independent subtrees and traverses each of them against the reference tree
+ * in a separate OpenMP task, using the depth-first DualTreeTraverser.
+ */
+#ifndef __MLPACK_CORE_TREE_BINARY_SPACE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_HPP
+#define __MLPACK_CORE_TREE_BINARY_SPACE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_HPP
+
+#include <mlpack/core.hpp>
+
+#include "binary_space_tree.hpp"
+#include "dual_tree_traverser.hpp"
+#include "../traversal_statistics.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * A task-parallel dual-tree traverser.  The query tree is descended to a depth
+ * of TaskDepth(); every query node at that depth (or any leaf above it) is then
+ * traversed against the full reference node in its own OpenMP task.
+ *
+ * Each task works on its own copy of the given rules, so the rules' per-query
+ * state (last base case, traversal info, and so on) is never shared between
+ * threads.  This is only safe for rules which write exclusively to state
+ * indexed by query points and to the statistics of query nodes (this is true
+ * for NeighborSearchRules with BinarySpaceTree); the counts of scores and base
+ * cases from each task's rules are added back into the original rules when the
+ * task finishes.  This means that RuleType must provide modifiable Scores() and
+ * BaseCases() accessors.
+ *
+ * If TaskDepth() is 0, the traversal is equivalent to the serial
+ * DualTreeTraverser.
+ */
+template<typename BoundType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType>
+template<typename RuleType>
+class BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
+    ParallelDualTreeTraverser
+{
+ public:
+  /**
+   * Instantiate the parallel dual-tree traverser with the given rule set.  If
+   * taskDepth is 0, a depth is chosen based on the maximum number of OpenMP
+   * threads, so that there are several tasks for each thread.  If there is
+   * only one thread available, no tasks are created.
+   *
+   * @param rule Rules to traverse the trees with.
+   * @param taskDepth Depth in the query tree at which tasks are spawned.
+   */
+  ParallelDualTreeTraverser(RuleType& rule, const size_t taskDepth = 0);
+
+  /**
+   * Traverse the two trees.  This does not reset the number of prunes.
+   *
+   * @param queryNode The query node to be traversed.
+   * @param referenceNode The reference node to be traversed.
+   */
+  void Traverse(BinarySpaceTree& queryNode,
+                BinarySpaceTree& referenceNode);
+
+  //! Get the depth in the query tree at which tasks are spawned.
+  size_t TaskDepth() const { return taskDepth; }
+  //! Modify the depth in the query tree at which tasks are spawned.
+  size_t& TaskDepth() { return taskDepth; }
+
+  //! Get the number of prunes.
+  size_t NumPrunes() const { return statistics.NumPrunes(); }
+  //! Modify the number of prunes.
+  size_t& NumPrunes() { return statistics.NumPrunes(); }
+
+  //! Get the number of visited combinations.
+  size_t NumVisited() const { return statistics.NumVisited(); }
+  //! Modify the number of visited combinations.
+  size_t& NumVisited() { return statistics.NumVisited(); }
+
+  //! Get the number of times a node combination was scored.
+  size_t NumScores() const { return statistics.NumScores(); }
+  //! Modify the number of times a node combination was scored.
+  size_t& NumScores() { return statistics.NumScores(); }
+
+  //! Get the number of times a base case was calculated.
+  size_t NumBaseCases() const { return statistics.NumBaseCases(); }
+  //! Modify the number of times a base case was calculated.
+  size_t& NumBaseCases() { return statistics.NumBaseCases(); }
+
+  //! Get the statistics of the traversal, added up over all tasks.  The
+  //! query nodes above the task depth count as visited, but not as scored.
+  const TraversalStatistics& Statistics() const { return statistics; }
+  //! Modify the statistics of the traversal.
+  TraversalStatistics& Statistics() { return statistics; }
+
+ private:
+  /**
+   * Descend the query tree until the task depth is reached, then spawn a task
+   * which traverses the query subtree against the reference node.
+   *
+   * @param queryNode The query node to be traversed.
+   * @param referenceNode The reference node to be traversed.
+   * @param depth Depth of queryNode relative to the root of the traversal.
+   */
+  void SpawnTasks(BinarySpaceTree* queryNode,
+                  BinarySpaceTree* referenceNode,
+                  const size_t depth);
+
+  /**
+   * Traverse the given query subtree against the reference node with a private
+   * copy of the rules and a serial DualTreeTraverser, and merge the results.
+   *
+   * @param queryNode The query node to be traversed.
+   * @param referenceNode The reference node to be traversed.
+   * @param depth Depth of queryNode relative to the root of the traversal.
+   */
+  void TraverseSubtree(BinarySpaceTree& queryNode,
+                       BinarySpaceTree& referenceNode,
+                       const size_t depth);
+
+  //! Reference to the rules with which the trees will be traversed.
+  RuleType& rule;
+
+  //! The depth in the query tree at which tasks are spawned.
+  size_t taskDepth;
+
+  //! The counts of the work done during traversal.
+  TraversalStatistics statistics;
+};
+
+}; // namespace tree
+}; // namespace mlpack
+
+// Include implementation.
+#include "parallel_dual_tree_traverser_impl.hpp"
+
+#endif // __MLPACK_CORE_TREE_BINARY_SPACE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_HPP
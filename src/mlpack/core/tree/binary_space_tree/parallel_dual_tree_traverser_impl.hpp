@@ -0,0 +1,145 @@
+/**
+ * @file parallel_dual_tree_traverser_impl.hpp
+ *
+ * Implementation of the ParallelDualTreeTraverser for BinarySpaceTree.  The
+ * query tree is split into subtrees which are each traversed in an OpenMP task.
+ */
+#ifndef __MLPACK_CORE_TREE_BINARY_SPACE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_IMPL_HPP
+#define __MLPACK_CORE_TREE_BINARY_SPACE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "parallel_dual_tree_traverser.hpp"
+
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
+namespace mlpack {
+namespace tree {
+
+template<typename BoundType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType>
+template<typename RuleType>
+BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
+ParallelDualTreeTraverser<RuleType>::ParallelDualTreeTraverser(
+    RuleType& rule,
+    const size_t taskDepth) :
+    rule(rule),
+    taskDepth(taskDepth)
+{
+  if (taskDepth == 0)
+  {
+#ifdef _OPENMP
+    const size_t threads = (size_t) omp_get_max_threads();
+#else
+    const size_t threads = 1;
+#endif
+
+    // Aim for roughly four tasks per thread, so that unbalanced query subtrees
+    // do not leave threads idle.  With only one thread there is no point in
+    // splitting the query tree at all.
+    if (threads > 1)
+    {
+      this->taskDepth = 2;
+      while ((size_t(1) << this->taskDepth) < 4 * threads)
+        ++this->taskDepth;
+    }
+  }
+}
+
+template<typename BoundType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType>
+template<typename RuleType>
+void BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
+ParallelDualTreeTraverser<RuleType>::Traverse(
+    BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>& queryNode,
+    BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>&
+        referenceNode)
+{
+  // Without any splitting, this is just the serial traversal.
+  if (taskDepth == 0 || queryNode.IsLeaf())
+  {
+    TraverseSubtree(queryNode, referenceNode, 0);
+    return;
+  }
+
+  // One thread walks the top of the query tree and creates the tasks; the
+  // implicit barrier at the end of the parallel region waits for all of them.
+  #pragma omp parallel
+  {
+    #pragma omp single nowait
+    SpawnTasks(&queryNode, &referenceNode, 0);
+  }
+}
+
+template<typename BoundType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType>
+template<typename RuleType>
+void BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
+ParallelDualTreeTraverser<RuleType>::SpawnTasks(
+    BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>* queryNode,
+    BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>*
+        referenceNode,
+    const size_t depth)
+{
+  if (queryNode->IsLeaf() || depth >= taskDepth)
+  {
+    #pragma omp task firstprivate(queryNode, referenceNode, depth)
+    TraverseSubtree(*queryNode, *referenceNode, depth);
+    return;
+  }
+
+  // The serial traversal would visit this combination too.  Tasks spawned
+  // earlier may be merging their statistics already.
+  #pragma omp critical(ParallelDualTreeTraverserMerge)
+  statistics.Visit(depth);
+
+  // The query nodes above the task depth are never scored, so their statistics
+  // keep their initial (loosest) bounds; this keeps the reads of parent bounds
+  // in each task free of races.
+  SpawnTasks(queryNode->Left(), referenceNode, depth + 1);
+  SpawnTasks(queryNode->Right(), referenceNode, depth + 1);
+}
+
+template<typename BoundType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType>
+template<typename RuleType>
+void BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
+ParallelDualTreeTraverser<RuleType>::TraverseSubtree(
+    BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>& queryNode,
+    BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>&
+        referenceNode,
+    const size_t depth)
+{
+  // Each task gets its own rules, so that the cached base case and traversal
+  // information are not shared between threads.
+  RuleType taskRule(rule);
+  taskRule.Scores() = 0;
+  taskRule.BaseCases() = 0;
+
+  // The visits are counted at their depth in the whole traversal, so that the
+  // merged statistics match those of the serial traversal.
+  DualTreeTraverser<RuleType> traverser(taskRule, depth);
+  traverser.Traverse(queryNode, referenceNode);
+
+  #pragma omp critical(ParallelDualTreeTraverserMerge)
+  {
+    rule.Scores() += taskRule.Scores();
+    rule.BaseCases() += taskRule.BaseCases();
+
+    statistics += traverser.Statistics();
+  }
+}
+
+}; // namespace tree
+}; // namespace mlpack
+
+#endif // __MLPACK_CORE_TREE_BINARY_SPACE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_IMPL_HPP
@@ -2,33 +2,38 @@
  * @file single_tree_traverser.hpp
  * @author Ryan Curtin
  *
- * A nested class of BinarySpaceTree which traverses the entire tree with a
- * given set of rules which indicate the branches which can be pruned and the
- * order in which to recurse.  This traverser is a depth-first traverser.
+ * A traverser for binary trees which traverses the entire tree with a given set
+ * of rules which indicate the branches which can be pruned and the order in
+ * which to recurse.  This traverser is a depth-first traverser.  It is the
+ * SingleTreeTraverser of both BinarySpaceTree and FlatBinarySpaceTree.
  */
 #ifndef __MLPACK_CORE_TREE_BINARY_SPACE_TREE_SINGLE_TREE_TRAVERSER_HPP
 #define __MLPACK_CORE_TREE_BINARY_SPACE_TREE_SINGLE_TREE_TRAVERSER_HPP
 
 #include <mlpack/core.hpp>
 
-#include "binary_space_tree.hpp"
+#include "../traversal_statistics.hpp"
 
 namespace mlpack {
 namespace tree {
 
-template<typename BoundType,
-         typename StatisticType,
-         typename MatType,
-         typename SplitType>
-template<typename RuleType>
-class BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
-    SingleTreeTraverser
+/**
+ * A depth-first single-tree traverser for any binary tree type whose nodes
+ * provide IsLeaf(), Left(), Right(), Begin(), End() and Count(), such as
+ * BinarySpaceTree and FlatBinarySpaceTree.  Those trees make it available as
+ * TreeType::SingleTreeTraverser<RuleType>.
+ *
+ * @tparam TreeType Type of the tree to traverse.
+ * @tparam RuleType Type of the rules to traverse the tree with.
+ */
+template<typename TreeType, typename RuleType>
+class BinarySingleTreeTraverser
 {
  public:
   /**
    * Instantiate the single tree traverser with the given rule set.
    */
-  SingleTreeTraverser(RuleType& rule);
+  BinarySingleTreeTraverser(RuleType& rule);
 
   /**
    * Traverse the tree with the given point.
@@ -37,19 +42,27 @@ class BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
    *     used as the query point.
    * @param referenceNode The tree node to be traversed.
    */
-  void Traverse(const size_t queryIndex, BinarySpaceTree& referenceNode);
+  void Traverse(const size_t queryIndex, TreeType& referenceNode);
 
   //! Get the number of prunes.
-  size_t NumPrunes() const { return numPrunes; }
+  size_t NumPrunes() const { return statistics.NumPrunes(); }
   //! Modify the number of prunes.
-  size_t& NumPrunes() { return numPrunes; }
+  size_t& NumPrunes() { return statistics.NumPrunes(); }
+
+  //! Get the statistics of the traversal.
+  const TraversalStatistics& Statistics() const { return statistics; }
+  //! Modify the statistics of the traversal.
+  TraversalStatistics& Statistics() { return statistics; }
 
  private:
   //! Reference to the rules with which the tree will be traversed.
   RuleType& rule;
 
-  //! The number of nodes which have been pruned during traversal.
-  size_t numPrunes;
+  //! The counts of the work done during traversal.
+  TraversalStatistics statistics;
+
+  //! The current depth of the recursion.
+  size_t depth;
 };
 
 }; // namespace tree
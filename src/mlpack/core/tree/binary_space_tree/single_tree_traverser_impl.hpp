@@ -2,9 +2,7 @@
  * @file single_tree_traverser_impl.hpp
  * @author Ryan Curtin
  *
- * A nested class of BinarySpaceTree which traverses the entire tree with a
- * given set of rules which indicate the branches which can be pruned and the
- * order in which to recurse.  This traverser is a depth-first traverser.
+ * Implementation of the depth-first single-tree traverser for binary trees.
  */
 #ifndef __MLPACK_CORE_TREE_BINARY_SPACE_TREE_SINGLE_TREE_TRAVERSER_IMPL_HPP
 #define __MLPACK_CORE_TREE_BINARY_SPACE_TREE_SINGLE_TREE_TRAVERSER_IMPL_HPP
@@ -17,39 +15,33 @@
 namespace mlpack {
 namespace tree {
 
-template<typename BoundType,
-         typename StatisticType,
-         typename MatType,
-         typename SplitType>
-template<typename RuleType>
-BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
-SingleTreeTraverser<RuleType>::SingleTreeTraverser(RuleType& rule) :
+template<typename TreeType, typename RuleType>
+BinarySingleTreeTraverser<TreeType, RuleType>::BinarySingleTreeTraverser(
+    RuleType& rule) :
     rule(rule),
-    numPrunes(0)
+    depth(0)
 { /* Nothing to do. */ }
 
-template<typename BoundType,
-         typename StatisticType,
-         typename MatType,
-         typename SplitType>
-template<typename RuleType>
-void BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
-SingleTreeTraverser<RuleType>::Traverse(
+template<typename TreeType, typename RuleType>
+void BinarySingleTreeTraverser<TreeType, RuleType>::Traverse(
     const size_t queryIndex,
-    BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>&
-        referenceNode)
+    TreeType& referenceNode)
 {
+  statistics.Visit(depth++);
+
   // If we are a leaf, run the base case as necessary.
   if (referenceNode.IsLeaf())
   {
     for (size_t i = referenceNode.Begin(); i < referenceNode.End(); ++i)
       rule.BaseCase(queryIndex, i);
+    statistics.BaseCase(referenceNode.Count());
   }
   else
   {
     // If either score is DBL_MAX, we do not recurse into that node.
     double leftScore = rule.Score(queryIndex, *referenceNode.Left());
     double rightScore = rule.Score(queryIndex, *referenceNode.Right());
+    statistics.Score(2);
 
     if (leftScore < rightScore)
     {
@@ -58,11 +50,12 @@ SingleTreeTraverser<RuleType>::Traverse(
 
       // Is it still valid to recurse to the right?
       rightScore = rule.Rescore(queryIndex, *referenceNode.Right(), rightScore);
+      statistics.Rescore(rightScore == DBL_MAX);
 
       if (rightScore != DBL_MAX)
         Traverse(queryIndex, *referenceNode.Right()); // Recurse to the right.
       else
-        ++numPrunes;
+        statistics.Prune();
     }
     else if (rightScore < leftScore)
     {
@@ -71,17 +64,18 @@ SingleTreeTraverser<RuleType>::Traverse(
 
       // Is it still valid to recurse to the left?
       leftScore = rule.Rescore(queryIndex, *referenceNode.Left(), leftScore);
+      statistics.Rescore(leftScore == DBL_MAX);
 
       if (leftScore != DBL_MAX)
         Traverse(queryIndex, *referenceNode.Left()); // Recurse to the left.
       else
-        ++numPrunes;
+        statistics.Prune();
     }
     else // leftScore is equal to rightScore.
     {
       if (leftScore == DBL_MAX)
       {
-        numPrunes += 2; // Pruned both left and right.
+        statistics.Prune(2); // Pruned both left and right.
       }
       else
       {
@@ -91,14 +85,17 @@ SingleTreeTraverser<RuleType>::Traverse(
         // Is it still valid to recurse to the right?
         rightScore = rule.Rescore(queryIndex, *referenceNode.Right(),
             rightScore);
+        statistics.Rescore(rightScore == DBL_MAX);
 
         if (rightScore != DBL_MAX)
           Traverse(queryIndex, *referenceNode.Right());
         else
-          ++numPrunes;
+          statistics.Prune();
       }
     }
   }
+
+  --depth;
 }
 
 }; // namespace tree
@@ -10,6 +10,8 @@
 #include <mlpack/core.hpp>
 #include <queue>
 
+#include "../traversal_statistics.hpp"
+
 namespace mlpack {
 namespace tree {
 
@@ -38,22 +40,33 @@ class CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
   void Traverse(CoverTree& queryNode, CoverTree& referenceNode);
 
   //! Get the number of pruned nodes.
-  size_t NumPrunes() const { return numPrunes; }
+  size_t NumPrunes() const { return statistics.NumPrunes(); }
   //! Modify the number of pruned nodes.
-  size_t& NumPrunes() { return numPrunes; }
-
-  ///// These are all fake because this is a patch for kd-trees only and I still
-  ///// want it to compile!
-  size_t NumVisited() const { return 0; }
-  size_t NumScores() const { return 0; }
-  size_t NumBaseCases() const { return 0; }
+  size_t& NumPrunes() { return statistics.NumPrunes(); }
+
+  //! Get the number of visited query nodes.
+  size_t NumVisited() const { return statistics.NumVisited(); }
+  //! Get the number of times a node combination was scored.
+  size_t NumScores() const { return statistics.NumScores(); }
+  //! Get the number of times a base case was calculated.
+  size_t NumBaseCases() const { return statistics.NumBaseCases(); }
+
+  //! Get the statistics of the traversal.  A visit is counted for every query
+  //! node recursed into (with its reference map), at its depth in the query
+  //! recursion.
+  const TraversalStatistics& Statistics() const { return statistics; }
+  //! Modify the statistics of the traversal (good for a reset).
+  TraversalStatistics& Statistics() { return statistics; }
 
  private:
   //! The instantiated rule set for pruning branches.
   RuleType& rule;
 
-  //! The number of pruned nodes.
-  size_t numPrunes;
+  //! The counts of the work done during traversal.
+  TraversalStatistics statistics;
+
+  //! The depth of the current query node in the recursion.
+  size_t depth;
 
   //! Struct used for traversal.
   struct DualCoverTreeMapEntry
@@ -23,7 +23,7 @@ template<typename RuleType>
 CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
 DualTreeTraverser<RuleType>::DualTreeTraverser(RuleType& rule) :
     rule(rule),
-    numPrunes(0)
+    depth(0)
 { /* Nothing to do. */ }
 
 template<
@@ -48,6 +48,8 @@ DualTreeTraverser<RuleType>::Traverse(CoverTree& queryNode,
   rootRefEntry.score = rule.Score(queryNode, referenceNode);
   rootRefEntry.baseCase = rule.BaseCase(queryNode.Point(),
       referenceNode.Point());
+  statistics.Score();
+  statistics.BaseCase();
   rootRefEntry.traversalInfo = rule.TraversalInfo();
 
   refMap[referenceNode.Scale()].push_back(rootRefEntry);
@@ -70,6 +72,8 @@ DualTreeTraverser<RuleType>::Traverse(
   if (referenceMap.size() == 0)
     return; // Nothing to do!
 
+  statistics.Visit(depth);
+
   // First recurse down the reference nodes as necessary.
   ReferenceRecursion(queryNode, referenceMap);
 
@@ -87,6 +91,7 @@ DualTreeTraverser<RuleType>::Traverse(
     // results are separate and independent.  I don't think this is true in
     // every case, and we may have to modify this section to consider scores in
     // the future.
+    ++depth;
     for (size_t i = 1; i < queryNode.NumChildren(); ++i)
     {
       // We need a copy of the map for this child.
@@ -97,6 +102,7 @@ DualTreeTraverser<RuleType>::Traverse(
     std::map<int, std::vector<DualCoverTreeMapEntry> > selfChildMap;
     PruneMap(queryNode.Child(0), referenceMap, selfChildMap);
     Traverse(queryNode.Child(0), selfChildMap);
+    --depth;
   }
 
   if (queryNode.Scale() != INT_MIN)
@@ -121,7 +127,7 @@ DualTreeTraverser<RuleType>::Traverse(
     if ((refNode->Point() == refNode->Parent()->Point()) &&
         (queryNode.Point() == queryNode.Parent()->Point()))
     {
-      ++numPrunes;
+      statistics.Prune();
       continue;
     }
 
@@ -129,15 +135,17 @@ DualTreeTraverser<RuleType>::Traverse(
     // info.
     rule.TraversalInfo() = frame.traversalInfo;
     double score = rule.Score(queryNode, *refNode);
+    statistics.Score();
 
     if (score == DBL_MAX)
     {
-      ++numPrunes;
+      statistics.Prune();
       continue;
     }
 
     // If not, compute the base case.
     rule.BaseCase(queryNode.Point(), pointVector[i].referenceNode->Point());
+    statistics.BaseCase();
   }
 }
 
@@ -182,17 +190,19 @@ DualTreeTraverser<RuleType>::PruneMap(
       // Perform the actual scoring, after restoring the traversal info.
       rule.TraversalInfo() = frame.traversalInfo;
       double score = rule.Score(queryNode, *refNode);
+      statistics.Score();
 
       if (score == DBL_MAX)
       {
         // Pruned.  Move on.
-        ++numPrunes;
+        statistics.Prune();
         continue;
       }
 
       // If it isn't pruned, we must evaluate the base case.
       const double baseCase = rule.BaseCase(queryNode.Point(),
           refNode->Point());
+      statistics.BaseCase();
 
       // Add to child map.
       newScaleVector.push_back(frame);
@@ -235,17 +245,19 @@ DualTreeTraverser<RuleType>::PruneMap(
       // Perform the actual scoring, after restoring the traversal info.
       rule.TraversalInfo() = frame.traversalInfo;
       double score = rule.Score(queryNode, *refNode);
+      statistics.Score();
 
       if (score == DBL_MAX)
       {
         // Pruned.  Move on.
-        ++numPrunes;
+        statistics.Prune();
         continue;
       }
 
       // If it isn't pruned, we must evaluate the base case.
       const double baseCase = rule.BaseCase(queryNode.Point(),
           refNode->Point());
+      statistics.BaseCase();
 
       // Add to child map.
       newScaleVector.push_back(frame);
@@ -307,12 +319,13 @@ DualTreeTraverser<RuleType>::ReferenceRecursion(
 
       // Create the score for the children.
       double score = rule.Rescore(queryNode, *refNode, frame.score);
+      statistics.Rescore(score == DBL_MAX);
 
       // Now if this childScore is DBL_MAX we can prune all children.  In this
       // recursion setup pruning is all or nothing for children.
       if (score == DBL_MAX)
       {
-        ++numPrunes;
+        statistics.Prune();
         continue;
       }
 
@@ -323,15 +336,17 @@ DualTreeTraverser<RuleType>::ReferenceRecursion(
       {
         rule.TraversalInfo() = frame.traversalInfo;
         double childScore = rule.Score(queryNode, refNode->Child(j));
+        statistics.Score();
         if (childScore == DBL_MAX)
         {
-          ++numPrunes;
+          statistics.Prune();
           continue;
         }
 
         // It wasn't pruned; evaluate the base case.
         const double baseCase = rule.BaseCase(queryNode.Point(),
             refNode->Child(j).Point());
+        statistics.BaseCase();
 
         DualCoverTreeMapEntry newFrame;
         newFrame.referenceNode = &refNode->Child(j);
@@ -12,6 +12,7 @@
 #include <mlpack/core.hpp>
 
 #include "cover_tree.hpp"
+#include "../traversal_statistics.hpp"
 
 namespace mlpack {
 namespace tree {
@@ -42,16 +43,22 @@ class CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
   void Traverse(const size_t queryIndex, CoverTree& referenceNode);
 
   //! Get the number of prunes so far.
-  size_t NumPrunes() const { return numPrunes; }
+  size_t NumPrunes() const { return statistics.NumPrunes(); }
   //! Set the number of prunes (good for a reset to 0).
-  size_t& NumPrunes() { return numPrunes; }
+  size_t& NumPrunes() { return statistics.NumPrunes(); }
+
+  //! Get the statistics of the traversal.  The depth of a node is the number
+  //! of scales between it and the root of the traversal.
+  const TraversalStatistics& Statistics() const { return statistics; }
+  //! Modify the statistics of the traversal (good for a reset).
+  TraversalStatistics& Statistics() { return statistics; }
 
  private:
   //! Reference to the rules with which the tree will be traversed.
   RuleType& rule;
 
-  //! The number of nodes which have been pruned during traversal.
-  size_t numPrunes;
+  //! The counts of the work done during traversal.
+  TraversalStatistics statistics;
 };
 
 }; // namespace tree
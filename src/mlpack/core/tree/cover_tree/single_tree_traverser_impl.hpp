@@ -50,8 +50,7 @@ template<
 template<typename RuleType>
 CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
 SingleTreeTraverser<RuleType>::SingleTreeTraverser(RuleType& rule) :
-    rule(rule),
-    numPrunes(0)
+    rule(rule)
 { /* Nothing to do. */ }
 
 template<
@@ -81,10 +80,12 @@ SingleTreeTraverser<RuleType>::Traverse(
 
   // Create the score for the children.
   double rootChildScore = rule.Score(queryIndex, referenceNode);
+  statistics.Score();
+  statistics.Visit(0);
 
   if (rootChildScore == DBL_MAX)
   {
-    numPrunes += referenceNode.NumChildren();
+    statistics.Prune(referenceNode.NumChildren());
   }
   else
   {
@@ -93,12 +94,13 @@ SingleTreeTraverser<RuleType>::Traverse(
     // using TreeTraits::FirstPointIsCentroid; this is an optimization that
     // (theoretically) the compiler should get right.
     double rootBaseCase = rule.BaseCase(queryIndex, referenceNode.Point());
+    statistics.BaseCase();
 
     // Don't add the self-leaf.
     size_t i = 0;
     if (referenceNode.Child(0).NumChildren() == 0)
     {
-      ++numPrunes;
+      statistics.Prune();
       i = 1;
     }
 
@@ -121,6 +123,9 @@ SingleTreeTraverser<RuleType>::Traverse(
   typename std::map<int, std::vector<MapEntryType> >::reverse_iterator rit =
       mapQueue.rbegin();
 
+  // The number of scales between the root and the scale being traversed.
+  size_t depth = 1;
+
   // We will treat the leaves differently (below).
   while ((*rit).first != INT_MIN)
   {
@@ -143,20 +148,24 @@ SingleTreeTraverser<RuleType>::Traverse(
       double baseCase = frame.baseCase;
 
       // First we recalculate the score of this node to find if we can prune it.
-      if (rule.Rescore(queryIndex, *node, score) == DBL_MAX)
+      const double rescore = rule.Rescore(queryIndex, *node, score);
+      statistics.Rescore(rescore == DBL_MAX);
+      if (rescore == DBL_MAX)
       {
-        ++numPrunes;
+        statistics.Prune();
         continue;
       }
 
       // Create the score for the children.
       const double childScore = rule.Score(queryIndex, *node);
+      statistics.Score();
+      statistics.Visit(depth);
 
       // Now if this childScore is DBL_MAX we can prune all children.  In this
       // recursion setup pruning is all or nothing for children.
       if (childScore == DBL_MAX)
       {
-        numPrunes += node->NumChildren();
+        statistics.Prune(node->NumChildren());
         continue;
       }
 
@@ -165,13 +174,16 @@ SingleTreeTraverser<RuleType>::Traverse(
       // trees using TreeTraits::FirstPointIsCentroid; this is an optimization
       // that (theoretically) the compiler should get right.
       if (point != parent)
+      {
         baseCase = rule.BaseCase(queryIndex, point);
+        statistics.BaseCase();
+      }
 
       // Don't add the self-leaf.
       size_t j = 0;
       if (node->Child(0).NumChildren() == 0)
       {
-        ++numPrunes;
+        statistics.Prune();
         j = 1;
       }
 
@@ -189,6 +201,7 @@ SingleTreeTraverser<RuleType>::Traverse(
 
     // Now clear the memory for this scale; it isn't needed anymore.
     mapQueue.erase((*rit).first);
+    ++depth;
   }
 
   // Now deal with the leaves.
@@ -202,10 +215,11 @@ SingleTreeTraverser<RuleType>::Traverse(
 
     // First, recalculate the score of this node to find if we can prune it.
     double rescore = rule.Rescore(queryIndex, *node, score);
+    statistics.Rescore(rescore == DBL_MAX);
 
     if (rescore == DBL_MAX)
     {
-      ++numPrunes;
+      statistics.Prune();
       continue;
     }
 
@@ -213,10 +227,11 @@ SingleTreeTraverser<RuleType>::Traverse(
     // combination, even if pruning it will make no difference.  It's the
     // definition.
     const double actualScore = rule.Score(queryIndex, *node);
+    statistics.Score();
 
     if (actualScore == DBL_MAX)
     {
-      ++numPrunes;
+      statistics.Prune();
       continue;
     }
     else
@@ -226,6 +241,8 @@ SingleTreeTraverser<RuleType>::Traverse(
       // trees using TreeTraits::FirstPointIsCentroid; this is an optimization
       // that (theoretically) the compiler should get right.
       rule.BaseCase(queryIndex, point);
+      statistics.BaseCase();
+      statistics.Visit(depth);
     }
   }
 }
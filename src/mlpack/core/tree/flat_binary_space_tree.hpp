@@ -0,0 +1,16 @@
+/**
+ * @file flat_binary_space_tree.hpp
+ *
+ * Include all the necessary files to use the FlatBinarySpaceTree class.
+ */
+#ifndef __MLPACK_CORE_TREE_FLAT_BINARY_SPACE_TREE_HPP
+#define __MLPACK_CORE_TREE_FLAT_BINARY_SPACE_TREE_HPP
+
+#include <mlpack/core.hpp>
+#include "binary_space_tree.hpp"
+#include "flat_binary_space_tree/breadth_first_layout.hpp"
+#include "flat_binary_space_tree/van_emde_boas_layout.hpp"
+#include "flat_binary_space_tree/flat_binary_space_tree.hpp"
+#include "flat_binary_space_tree/traits.hpp"
+
+#endif
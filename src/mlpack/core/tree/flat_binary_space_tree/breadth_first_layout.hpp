@@ -0,0 +1,56 @@
+/**
+ * @file breadth_first_layout.hpp
+ *
+ * A node layout for FlatBinarySpaceTree which stores the nodes level by level.
+ */
+#ifndef __MLPACK_CORE_TREE_FLAT_BINARY_SPACE_TREE_BREADTH_FIRST_LAYOUT_HPP
+#define __MLPACK_CORE_TREE_FLAT_BINARY_SPACE_TREE_BREADTH_FIRST_LAYOUT_HPP
+
+#include <mlpack/core.hpp>
+#include <queue>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * Order the nodes of a binary tree breadth-first: the root comes first, then
+ * all of the nodes at depth one from left to right, then all of the nodes at
+ * depth two, and so on.  This keeps the two children of every node next to each
+ * other and keeps the top levels of the tree (which every traversal touches) in
+ * a small number of cache lines.
+ */
+class BreadthFirstLayout
+{
+ public:
+  /**
+   * Fill the given vector with the nodes of the tree rooted at root, in the
+   * order in which they should be stored.
+   *
+   * @param root Root of the tree to order.
+   * @param order Vector to store the ordering in; it will be cleared first.
+   */
+  template<typename TreeType>
+  static void Order(const TreeType& root, std::vector<const TreeType*>& order)
+  {
+    order.clear();
+
+    std::queue<const TreeType*> queue;
+    queue.push(&root);
+    while (!queue.empty())
+    {
+      const TreeType* node = queue.front();
+      queue.pop();
+      order.push_back(node);
+
+      if (node->Left())
+        queue.push(node->Left());
+      if (node->Right())
+        queue.push(node->Right());
+    }
+  }
+};
+
+}; // namespace tree
+}; // namespace mlpack
+
+#endif
@@ -0,0 +1,332 @@
+/**
+ * @file flat_binary_space_tree.hpp
+ *
+ * Definition of FlatBinarySpaceTree, a kd-tree whose nodes are stored
+ * contiguously in one array instead of being allocated one by one.
+ */
+#ifndef __MLPACK_CORE_TREE_FLAT_BINARY_SPACE_TREE_FLAT_BINARY_SPACE_TREE_HPP
+#define __MLPACK_CORE_TREE_FLAT_BINARY_SPACE_TREE_FLAT_BINARY_SPACE_TREE_HPP
+
+#include <mlpack/core.hpp>
+
+#include "../statistic.hpp"
+#include "../hrectbound.hpp"
+#include "../binary_space_tree/binary_space_tree.hpp"
+#include "breadth_first_layout.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * A kd-tree (a BinarySpaceTree with hyperrectangle bounds and the Euclidean
+ * distance) which is laid out in memory for fast traversal.  The tree is built
+ * exactly like BinarySpaceTree<HRectBound<2>, ...>, so it has the same nodes
+ * and the same point ordering, but then every node is copied into a single
+ * contiguous array, in the order given by the LayoutType policy.  The bounds of
+ * all nodes are stored in two dimension-by-nodes matrices (one for the lower
+ * and one for the upper corners), so the bound of a node is two contiguous
+ * columns instead of an array of math::Range objects on the heap.
+ *
+ * The node API and the traversers are the same as for BinarySpaceTree, so any
+ * rules that work with a kd-tree work with this tree unchanged.  The only
+ * thing that is not available is Bound(), since there is no bound object.
+ *
+ * The object given to the user is the root of the tree; it owns the node array
+ * and the bounds.  Like BinarySpaceTree, the tree cannot be modified after it
+ * has been built.
+ *
+ * @tparam StatisticType Extra data contained in the node.  See statistic.hpp
+ *     for the necessary skeleton interface.  It must be default-constructible
+ *     and assignable.
+ * @tparam MatType The dataset class.
+ * @tparam LayoutType The order to store the nodes in; BreadthFirstLayout or
+ *     VanEmdeBoasLayout.
+ * @tparam SplitType The class that partitions the dataset/points at a
+ *     particular node into two parts.
+ */
+template<typename StatisticType = EmptyStatistic,
+         typename MatType = arma::mat,
+         typename LayoutType = BreadthFirstLayout,
+         typename SplitType = MidpointSplit<bound::HRectBound<2>, MatType>>
+class FlatBinarySpaceTree
+{
+ public:
+  //! So other classes can use TreeType::Mat.
+  typedef MatType Mat;
+
+  //! The pointer-based tree that is built and then flattened.
+  typedef BinarySpaceTree<bound::HRectBound<2>, EmptyStatistic, MatType,
+      SplitType> BuildTreeType;
+
+ private:
+  //! The left child node (NULL if this is a leaf).
+  FlatBinarySpaceTree* left;
+  //! The right child node (NULL if this is a leaf).
+  FlatBinarySpaceTree* right;
+  //! The parent node (NULL if this is the root of the tree).
+  FlatBinarySpaceTree* parent;
+  //! The index of the first point in the dataset contained in this node (and
+  //! its children).
+  size_t begin;
+  //! The number of points of the dataset contained in this node (and its
+  //! children).
+  size_t count;
+  //! The position of this node in the layout (0 for the root).
+  size_t index;
+  //! The lower corner of the bound of this node (a column of the bounds).
+  const double* lo;
+  //! The upper corner of the bound of this node (a column of the bounds).
+  const double* hi;
+  //! Any extra data contained in the node.
+  StatisticType stat;
+  //! The distance from the centroid of this node to the centroid of the parent.
+  double parentDistance;
+  //! The worst possible distance to the furthest descendant, cached to speed
+  //! things up.
+  double furthestDescendantDistance;
+  //! The worst possible distance to the furthest point held in this node (0 if
+  //! this is not a leaf), cached to speed things up.
+  double furthestPointDistance;
+  //! The minimum distance from the center to any edge of the bound.
+  double minimumBoundDistance;
+  //! The dataset.
+  MatType* dataset;
+
+  //! The non-root nodes, in layout order (only held by the root).
+  FlatBinarySpaceTree* nodes;
+  //! The total number of nodes, including the root (only set in the root).
+  size_t numNodes;
+  //! The lower corners of the bounds of all nodes (only held by the root).
+  arma::mat* loBounds;
+  //! The upper corners of the bounds of all nodes (only held by the root).
+  arma::mat* hiBounds;
+
+ public:
+  //! A single-tree traverser for flat binary space trees; this is the same
+  //! traverser as that of BinarySpaceTree (see
+  //! binary_space_tree/single_tree_traverser.hpp).
+  template<typename RuleType>
+  using SingleTreeTraverser = BinarySingleTreeTraverser<FlatBinarySpaceTree,
+      RuleType>;
+
+  //! A dual-tree traverser for flat binary space trees; this is the same
+  //! traverser as that of BinarySpaceTree (see
+  //! binary_space_tree/dual_tree_traverser.hpp).
+  template<typename RuleType>
+  using DualTreeTraverser = BinaryDualTreeTraverser<FlatBinarySpaceTree,
+      RuleType>;
+
+  /**
+   * Construct this as the root node of a flat kd-tree using the given dataset.
+   * This will modify the ordering of the points in the dataset!
+   *
+   * @param data Dataset to create tree from.  This will be modified!
+   * @param maxLeafSize Size of each leaf in the tree.
+   */
+  FlatBinarySpaceTree(MatType& data, const size_t maxLeafSize = 20);
+
+  /**
+   * Construct this as the root node of a flat kd-tree using the given dataset.
+   * This will modify the ordering of points in the dataset!  A mapping of the
+   * old point indices to the new point indices is filled.
+   *
+   * @param data Dataset to create tree from.  This will be modified!
+   * @param oldFromNew Vector which will be filled with the old positions for
+   *     each new point.
+   * @param maxLeafSize Size of each leaf in the tree.
+   */
+  FlatBinarySpaceTree(MatType& data,
+                      std::vector<size_t>& oldFromNew,
+                      const size_t maxLeafSize = 20);
+
+  /**
+   * Construct this as the root node of a flat kd-tree using the given dataset.
+   * This will modify the ordering of points in the dataset!  A mapping of the
+   * old point indices to the new point indices is filled, as well as a mapping
+   * of the new point indices to the old point indices.
+   *
+   * @param data Dataset to create tree from.  This will be modified!
+   * @param oldFromNew Vector which will be filled with the old positions for
+   *     each new point.
+   * @param newFromOld Vector which will be filled with the new positions for
+   *     each old point.
+   * @param maxLeafSize Size of each leaf in the tree.
+   */
+  FlatBinarySpaceTree(MatType& data,
+                      std::vector<size_t>& oldFromNew,
+                      std::vector<size_t>& newFromOld,
+                      const size_t maxLeafSize = 20);
+
+  /**
+   * Flatten an already-built kd-tree.  The flat tree refers to the dataset of
+   * the given tree, which must outlive it; the given tree may be destroyed
+   * afterwards.
+   *
+   * @param buildTree Tree to flatten.
+   */
+  FlatBinarySpaceTree(const BuildTreeType& buildTree);
+
+  /**
+   * Delete the tree.  This only does something for the root, which owns all of
+   * the other nodes.
+   */
+  ~FlatBinarySpaceTree();
+
+  //! Return the statistic object for this node.
+  const StatisticType& Stat() const { return stat; }
+  //! Modify the statistic object for this node.
+  StatisticType& Stat() { return stat; }
+
+  //! Return whether or not this node is a leaf (true if it has no children).
+  bool IsLeaf() const { return !left; }
+
+  //! Gets the left child of this node.
+  FlatBinarySpaceTree* Left() const { return left; }
+  //! Gets the right child of this node.
+  FlatBinarySpaceTree* Right() const { return right; }
+  //! Gets the parent of this node.
+  FlatBinarySpaceTree* Parent() const { return parent; }
+
+  //! Get the dataset which the tree is built on.
+  const MatType& Dataset() const { return *dataset; }
+  //! Modify the dataset which the tree is built on.  Be careful!
+  MatType& Dataset() { return *dataset; }
+
+  //! Get the metric which the tree uses.
+  metric::EuclideanDistance Metric() const
+  {
+    return metric::EuclideanDistance();
+  }
+
+  //! Get the centroid of the node and store it in the given vector.
+  void Centroid(arma::vec& centroid) const;
+
+  //! Return the number of children in this node.
+  size_t NumChildren() const { return left ? 2 : 0; }
+
+  /**
+   * Return the furthest distance to a point held in this node.  If this is not
+   * a leaf node, then the distance is 0 because the node holds no points.
+   */
+  double FurthestPointDistance() const { return furthestPointDistance; }
+
+  /**
+   * Return the furthest possible descendant distance.  This returns the maximum
+   * distance from the centroid to the edge of the bound and not the empirical
+   * quantity which is the actual furthest descendant distance.
+   */
+  double FurthestDescendantDistance() const
+  { return furthestDescendantDistance; }
+
+  //! Return the minimum distance from the center of the node to any bound edge.
+  double MinimumBoundDistance() const { return minimumBoundDistance; }
+
+  //! Return the distance from the center of this node to the center of the
+  //! parent node.
+  double ParentDistance() const { return parentDistance; }
+
+  //! Return the specified child (0 will be left, 1 will be right).
+  FlatBinarySpaceTree& Child(const size_t child) const
+  { return (child == 0) ? *left : *right; }
+
+  //! Return the number of points in this node (0 if not a leaf).
+  size_t NumPoints() const { return left ? 0 : count; }
+
+  //! Return the number of descendants of this node.
+  size_t NumDescendants() const { return count; }
+
+  //! Return the index (with reference to the dataset) of a particular
+  //! descendant of this node.
+  size_t Descendant(const size_t index) const { return begin + index; }
+
+  //! Return the index (with reference to the dataset) of a particular point in
+  //! this node.  This will happily return invalid indices if the given index is
+  //! greater than the number of points in this node (obtained with
+  //! NumPoints()).
+  size_t Point(const size_t index) const { return begin + index; }
+
+  //! Return the minimum distance to another node.
+  double MinDistance(const FlatBinarySpaceTree* other) const;
+
+  //! Return the maximum distance to another node.
+  double MaxDistance(const FlatBinarySpaceTree* other) const;
+
+  //! Return the minimum and maximum distance to another node.
+  math::Range RangeDistance(const FlatBinarySpaceTree* other) const;
+
+  //! Return the minimum distance to another point.
+  template<typename VecType>
+  double MinDistance(const VecType& point,
+                     typename boost::enable_if<IsVector<VecType> >::type* = 0)
+      const;
+
+  //! Return the maximum distance to another point.
+  template<typename VecType>
+  double MaxDistance(const VecType& point,
+                     typename boost::enable_if<IsVector<VecType> >::type* = 0)
+      const;
+
+  //! Return the minimum and maximum distance to another point.
+  template<typename VecType>
+  math::Range
+  RangeDistance(const VecType& point,
+                typename boost::enable_if<IsVector<VecType> >::type* = 0) const;
+
+  //! Obtains the number of nodes in the tree, starting with this.
+  size_t TreeSize() const;
+
+  //! Obtains the number of levels below this node in the tree, starting with
+  //! this.
+  size_t TreeDepth() const;
+
+  //! Return the index of the beginning point of this subset.
+  size_t Begin() const { return begin; }
+  //! Gets the index one beyond the last index in the subset.
+  size_t End() const { return begin + count; }
+  //! Return the number of points in this subset.
+  size_t Count() const { return count; }
+
+  //! Return the position of this node in the layout (0 for the root).
+  size_t Index() const { return index; }
+
+  //! Returns false: this tree type does not have self children.
+  static bool HasSelfChildren() { return false; }
+
+  /**
+   * Returns a string representation of this object.
+   */
+  std::string ToString() const;
+
+ private:
+  /**
+   * Construct an empty node; used for the node array, which is filled by
+   * Flatten().
+   */
+  FlatBinarySpaceTree();
+
+  //! Copying would leave the children pointing into the other tree's array.
+  FlatBinarySpaceTree(const FlatBinarySpaceTree& other);
+  //! Copying would leave the children pointing into the other tree's array.
+  FlatBinarySpaceTree& operator=(const FlatBinarySpaceTree& other);
+
+  /**
+   * Copy the given tree into the node array and the bounds, using this node as
+   * the root, and then build the statistics of every node.
+   */
+  void Flatten(const BuildTreeType& buildTree);
+
+  //! Get the node at the given position in the layout.
+  FlatBinarySpaceTree* Node(const size_t i)
+  { return (i == 0) ? this : &nodes[i - 1]; }
+};
+
+}; // namespace tree
+}; // namespace mlpack
+
+// Include implementation.
+#include "flat_binary_space_tree_impl.hpp"
+
+// Include everything else, if necessary.
+#include "../flat_binary_space_tree.hpp"
+
+#endif
@@ -0,0 +1,451 @@
+/**
+ * @file flat_binary_space_tree_impl.hpp
+ *
+ * Implementation of FlatBinarySpaceTree.
+ */
+#ifndef __MLPACK_CORE_TREE_FLAT_BINARY_SPACE_TREE_FLAT_BINARY_SPACE_TREE_IMPL_HPP
+#define __MLPACK_CORE_TREE_FLAT_BINARY_SPACE_TREE_FLAT_BINARY_SPACE_TREE_IMPL_HPP
+
+// In case it wasn't included already for some reason.
+#include "flat_binary_space_tree.hpp"
+
+#include <mlpack/core/util/string_util.hpp>
+#include <map>
+
+namespace mlpack {
+namespace tree {
+
+template<typename StatisticType,
+         typename MatType,
+         typename LayoutType,
+         typename SplitType>
+FlatBinarySpaceTree<StatisticType, MatType, LayoutType, SplitType>::
+FlatBinarySpaceTree(MatType& data, const size_t maxLeafSize) :
+    left(NULL),
+    right(NULL),
+    parent(NULL),
+    begin(0),
+    count(0),
+    index(0),
+    lo(NULL),
+    hi(NULL),
+    parentDistance(0),
+    furthestDescendantDistance(0),
+    furthestPointDistance(0),
+    minimumBoundDistance(0),
+    dataset(&data),
+    nodes(NULL),
+    numNodes(0),
+    loBounds(NULL),
+    hiBounds(NULL)
+{
+  // Build the tree the usual way, then copy it into the node array.
+  BuildTreeType buildTree(data, maxLeafSize);
+  Flatten(buildTree);
+}
+
+template<typename StatisticType,
+         typename MatType,
+         typename LayoutType,
+         typename SplitType>
+FlatBinarySpaceTree<StatisticType, MatType, LayoutType, SplitType>::
+FlatBinarySpaceTree(MatType& data,
+                    std::vector<size_t>& oldFromNew,
+                    const size_t maxLeafSize) :
+    left(NULL),
+    right(NULL),
+    parent(NULL),
+    begin(0),
+    count(0),
+    index(0),
+    lo(NULL),
+    hi(NULL),
+    parentDistance(0),
+    furthestDescendantDistance(0),
+    furthestPointDistance(0),
+    minimumBoundDistance(0),
+    dataset(&data),
+    nodes(NULL),
+    numNodes(0),
+    loBounds(NULL),
+    hiBounds(NULL)
+{
+  BuildTreeType buildTree(data, oldFromNew, maxLeafSize);
+  Flatten(buildTree);
+}
+
+template<typename StatisticType,
+         typename MatType,
+         typename LayoutType,
+         typename SplitType>
+FlatBinarySpaceTree<StatisticType, MatType, LayoutType, SplitType>::
+FlatBinarySpaceTree(MatType& data,
+                    std::vector<size_t>& oldFromNew,
+                    std::vector<size_t>& newFromOld,
+                    const size_t maxLeafSize) :
+    left(NULL),
+    right(NULL),
+    parent(NULL),
+    begin(0),
+    count(0),
+    index(0),
+    lo(NULL),
+    hi(NULL),
+    parentDistance(0),
+    furthestDescendantDistance(0),
+    furthestPointDistance(0),
+    minimumBoundDistance(0),
+    dataset(&data),
+    nodes(NULL),
+    numNodes(0),
+    loBounds(NULL),
+    hiBounds(NULL)
+{
+  BuildTreeType buildTree(data, oldFromNew, newFromOld, maxLeafSize);
+  Flatten(buildTree);
+}
+
+template<typename StatisticType,
+         typename MatType,
+         typename LayoutType,
+         typename SplitType>
+FlatBinarySpaceTree<StatisticType, MatType, LayoutType, SplitType>::
+FlatBinarySpaceTree(const BuildTreeType& buildTree) :
+    left(NULL),
+    right(NULL),
+    parent(NULL),
+    begin(0),
+    count(0),
+    index(0),
+    lo(NULL),
+    hi(NULL),
+    parentDistance(0),
+    furthestDescendantDistance(0),
+    furthestPointDistance(0),
+    minimumBoundDistance(0),
+    dataset(NULL),
+    nodes(NULL),
+    numNodes(0),
+    loBounds(NULL),
+    hiBounds(NULL)
+{
+  Flatten(buildTree);
+}
+
+template<typename StatisticType,
+         typename MatType,
+         typename LayoutType,
+         typename SplitType>
+FlatBinarySpaceTree<StatisticType, MatType, LayoutType, SplitType>::
+FlatBinarySpaceTree() :
+    left(NULL),
+    right(NULL),
+    parent(NULL),
+    begin(0),
+    count(0),
+    index(0),
+    lo(NULL),
+    hi(NULL),
+    parentDistance(0),
+    furthestDescendantDistance(0),
+    furthestPointDistance(0),
+    minimumBoundDistance(0),
+    dataset(NULL),
+    nodes(NULL),
+    numNodes(0),
+    loBounds(NULL),
+    hiBounds(NULL)
+{
+  // Nothing to do; Flatten() fills this node in.
+}
+
+template<typename StatisticType,
+         typename MatType,
+         typename LayoutType,
+         typename SplitType>
+FlatBinarySpaceTree<StatisticType, MatType, LayoutType, SplitType>::
+~FlatBinarySpaceTree()
+{
+  // Only the root holds anything.
+  delete[] nodes;
+  delete loBounds;
+  delete hiBounds;
+}
+
+template<typename StatisticType,
+         typename MatType,
+         typename LayoutType,
+         typename SplitType>
+void FlatBinarySpaceTree<StatisticType, MatType, LayoutType, SplitType>::
+    Flatten(const BuildTreeType& buildTree)
+{
+  std::vector<const BuildTreeType*> order;
+  LayoutType::Order(buildTree, order);
+
+  numNodes = order.size();
+  dataset = &const_cast<MatType&>(buildTree.Dataset());
+  const size_t dim = dataset->n_rows;
+
+  loBounds = new arma::mat(dim, numNodes);
+  hiBounds = new arma::mat(dim, numNodes);
+  if (numNodes > 1)
+    nodes = new FlatBinarySpaceTree[numNodes - 1];
+
+  // We need to be able to find where each node of the built tree went, so that
+  // we can set the child and parent pointers.
+  std::map<const BuildTreeType*, size_t> positions;
+  for (size_t i = 0; i < numNodes; ++i)
+    positions[order[i]] = i;
+
+  for (size_t i = 0; i < numNodes; ++i)
+  {
+    const BuildTreeType& buildNode = *order[i];
+    FlatBinarySpaceTree* node = Node(i);
+
+    node->index = i;
+    node->begin = buildNode.Begin();
+    node->count = buildNode.Count();
+    node->dataset = dataset;
+
+    for (size_t d = 0; d < dim; ++d)
+    {
+      (*loBounds)(d, i) = buildNode.Bound()[d].Lo();
+      (*hiBounds)(d, i) = buildNode.Bound()[d].Hi();
+    }
+    node->lo = loBounds->colptr(i);
+    node->hi = hiBounds->colptr(i);
+
+    node->parentDistance = buildNode.ParentDistance();
+    node->furthestDescendantDistance = buildNode.FurthestDescendantDistance();
+    node->furthestPointDistance = buildNode.FurthestPointDistance();
+    node->minimumBoundDistance = buildNode.MinimumBoundDistance();
+
+    if (!buildNode.IsLeaf())
+    {
+      node->left = Node(positions[buildNode.Left()]);
+      node->right = Node(positions[buildNode.Right()]);
+    }
+
+    // The given tree may be a subtree, in which case its root has a parent
+    // which we do not copy.
+    if (i != 0)
+      node->parent = Node(positions[buildNode.Parent()]);
+  }
+
+  // Now build the statistics.  Parents always come before their children in
+  // the layout, so going backwards means every node's children are complete
+  // when its statistic is built, just like in BinarySpaceTree.
+  for (size_t i = numNodes; i > 0; --i)
+    Node(i - 1)->stat = StatisticType(*Node(i - 1));
+}
+
+template<typename StatisticType,
+         typename MatType,
+         typename LayoutType,
+         typename SplitType>
+void FlatBinarySpaceTree<StatisticType, MatType, LayoutType, SplitType>::
+    Centroid(arma::vec& centroid) const
+{
+  centroid.set_size(dataset->n_rows);
+  for (size_t d = 0; d < dataset->n_rows; ++d)
+    centroid[d] = (lo[d] + hi[d]) / 2.0;
+}
+
+/**
+ * The distance calculations below are those of HRectBound<2, true>, written
+ * directly against the lower and upper corners.
+ */
+template<typename StatisticType,
+         typename MatType,
+         typename LayoutType,
+         typename SplitType>
+inline double
+FlatBinarySpaceTree<StatisticType, MatType, LayoutType, SplitType>::
+    MinDistance(const FlatBinarySpaceTree* other) const
+{
+  double sum = 0;
+  for (size_t d = 0; d < dataset->n_rows; ++d)
+  {
+    // Only one of these can be positive.
+    const double lower = other->lo[d] - hi[d];
+    const double higher = lo[d] - other->hi[d];
+    const double v = std::max(std::max(lower, higher), 0.0);
+    sum += v * v;
+  }
+
+  return std::sqrt(sum);
+}
+
+template<typename StatisticType,
+         typename MatType,
+         typename LayoutType,
+         typename SplitType>
+inline double
+FlatBinarySpaceTree<StatisticType, MatType, LayoutType, SplitType>::
+    MaxDistance(const FlatBinarySpaceTree* other) const
+{
+  double sum = 0;
+  for (size_t d = 0; d < dataset->n_rows; ++d)
+  {
+    const double v = std::max(std::fabs(other->hi[d] - lo[d]),
+        std::fabs(hi[d] - other->lo[d]));
+    sum += v * v;
+  }
+
+  return std::sqrt(sum);
+}
+
+template<typename StatisticType,
+         typename MatType,
+         typename LayoutType,
+         typename SplitType>
+inline math::Range
+FlatBinarySpaceTree<StatisticType, MatType, LayoutType, SplitType>::
+    RangeDistance(const FlatBinarySpaceTree* other) const
+{
+  double loSum = 0;
+  double hiSum = 0;
+  for (size_t d = 0; d < dataset->n_rows; ++d)
+  {
+    const double v1 = other->lo[d] - hi[d];
+    const double v2 = lo[d] - other->hi[d];
+    // One of v1 or v2 is negative.
+    const double vLo = std::max(std::max(v1, v2), 0.0);
+    const double vHi = -std::min(v1, v2);
+
+    loSum += vLo * vLo;
+    hiSum += vHi * vHi;
+  }
+
+  return math::Range(std::sqrt(loSum), std::sqrt(hiSum));
+}
+
+template<typename StatisticType,
+         typename MatType,
+         typename LayoutType,
+         typename SplitType>
+template<typename VecType>
+inline double
+FlatBinarySpaceTree<StatisticType, MatType, LayoutType, SplitType>::
+    MinDistance(const VecType& point,
+                typename boost::enable_if<IsVector<VecType> >::type*) const
+{
+  double sum = 0;
+  for (size_t d = 0; d < dataset->n_rows; ++d)
+  {
+    const double lower = lo[d] - point[d];
+    const double higher = point[d] - hi[d];
+    const double v = std::max(std::max(lower, higher), 0.0);
+    sum += v * v;
+  }
+
+  return std::sqrt(sum);
+}
+
+template<typename StatisticType,
+         typename MatType,
+         typename LayoutType,
+         typename SplitType>
+template<typename VecType>
+inline double
+FlatBinarySpaceTree<StatisticType, MatType, LayoutType, SplitType>::
+    MaxDistance(const VecType& point,
+                typename boost::enable_if<IsVector<VecType> >::type*) const
+{
+  double sum = 0;
+  for (size_t d = 0; d < dataset->n_rows; ++d)
+  {
+    const double v = std::max(std::fabs(point[d] - lo[d]),
+        std::fabs(hi[d] - point[d]));
+    sum += v * v;
+  }
+
+  return std::sqrt(sum);
+}
+
+template<typename StatisticType,
+         typename MatType,
+         typename LayoutType,
+         typename SplitType>
+template<typename VecType>
+inline math::Range
+FlatBinarySpaceTree<StatisticType, MatType, LayoutType, SplitType>::
+    RangeDistance(const VecType& point,
+                  typename boost::enable_if<IsVector<VecType> >::type*) const
+{
+  double loSum = 0;
+  double hiSum = 0;
+  for (size_t d = 0; d < dataset->n_rows; ++d)
+  {
+    const double v1 = lo[d] - point[d]; // Negative if point[d] > lo.
+    const double v2 = point[d] - hi[d]; // Negative if point[d] < hi.
+    const double vLo = std::max(std::max(v1, v2), 0.0);
+    const double vHi = std::max(std::fabs(v1), std::fabs(v2));
+
+    loSum += vLo * vLo;
+    hiSum += vHi * vHi;
+  }
+
+  return math::Range(std::sqrt(loSum), std::sqrt(hiSum));
+}
+
+template<typename StatisticType,
+         typename MatType,
+         typename LayoutType,
+         typename SplitType>
+size_t FlatBinarySpaceTree<StatisticType, MatType, LayoutType, SplitType>::
+    TreeSize() const
+{
+  // The root knows the answer already.
+  if (index == 0 && numNodes > 0)
+    return numNodes;
+
+  return 1 + (left ? left->TreeSize() + right->TreeSize() : 0);
+}
+
+template<typename StatisticType,
+         typename MatType,
+         typename LayoutType,
+         typename SplitType>
+size_t FlatBinarySpaceTree<StatisticType, MatType, LayoutType, SplitType>::
+    TreeDepth() const
+{
+  return 1 + (left ? std::max(left->TreeDepth(), right->TreeDepth()) : 0);
+}
+
+/**
+ * Returns a string representation of this object.
+ */
+template<typename StatisticType,
+         typename MatType,
+         typename LayoutType,
+         typename SplitType>
+std::string FlatBinarySpaceTree<StatisticType, MatType, LayoutType, SplitType>::
+    ToString() const
+{
+  std::ostringstream convert;
+  convert << "FlatBinarySpaceTree [" << this << "]" << std::endl;
+  convert << "  Layout position: " << index << std::endl;
+  convert << "  First point: " << begin << std::endl;
+  convert << "  Number of descendants: " << count << std::endl;
+  convert << "  Statistic: " << std::endl;
+  convert << mlpack::util::Indent(stat.ToString(), 2);
+
+  // How many levels should we print?  This will print the top two tree levels.
+  if (left != NULL && parent == NULL)
+  {
+    convert << " Left child:" << std::endl;
+    convert << mlpack::util::Indent(left->ToString(), 2);
+  }
+  if (right != NULL && parent == NULL)
+  {
+    convert << " Right child:" << std::endl;
+    convert << mlpack::util::Indent(right->ToString(), 2);
+  }
+  return convert.str();
+}
+
+}; // namespace tree
+}; // namespace mlpack
+
+#endif
@@ -0,0 +1,59 @@
+/**
+ * @file traits.hpp
+ *
+ * Specialization of the TreeTraits class for the FlatBinarySpaceTree type of
+ * tree.
+ */
+#ifndef __MLPACK_CORE_TREE_FLAT_BINARY_SPACE_TREE_TRAITS_HPP
+#define __MLPACK_CORE_TREE_FLAT_BINARY_SPACE_TREE_TRAITS_HPP
+
+#include <mlpack/core/tree/tree_traits.hpp>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * This is a specialization of the TreeType class to the FlatBinarySpaceTree
+ * tree type.  The flat tree has exactly the structure of a kd-tree, so its
+ * traits are the same as those of BinarySpaceTree.  See
+ * mlpack/core/tree/tree_traits.hpp for more information.
+ */
+template<typename StatisticType,
+         typename MatType,
+         typename LayoutType,
+         typename SplitType>
+class TreeTraits<FlatBinarySpaceTree<StatisticType, MatType, LayoutType,
+    SplitType>>
+{
+ public:
+  /**
+   * The children of a node represent non-overlapping subsets of the space which
+   * the node represents.
+   */
+  static const bool HasOverlappingChildren = false;
+
+  /**
+   * There is no guarantee that the first point in a node is its centroid.
+   */
+  static const bool FirstPointIsCentroid = false;
+
+  /**
+   * Points are not contained at multiple levels of the tree.
+   */
+  static const bool HasSelfChildren = false;
+
+  /**
+   * Points are rearranged during building of the tree.
+   */
+  static const bool RearrangesDataset = true;
+
+  /**
+   * This is always a binary tree.
+   */
+  static const bool BinaryTree = true;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,92 @@
+/**
+ * @file van_emde_boas_layout.hpp
+ *
+ * A node layout for FlatBinarySpaceTree which stores the nodes in van Emde Boas
+ * order.
+ */
+#ifndef __MLPACK_CORE_TREE_FLAT_BINARY_SPACE_TREE_VAN_EMDE_BOAS_LAYOUT_HPP
+#define __MLPACK_CORE_TREE_FLAT_BINARY_SPACE_TREE_VAN_EMDE_BOAS_LAYOUT_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * Order the nodes of a binary tree in van Emde Boas order.  A tree of height h
+ * is cut at height h / 2; the top subtree is laid out first (recursively, in
+ * the same way), followed by each of the bottom subtrees from left to right
+ * (also recursively).  Any root-to-leaf path then crosses only O(log_B n)
+ * blocks of size B, for any B, so the layout is cache-oblivious.  This tends to
+ * be better than BreadthFirstLayout for deep trees, where the lower levels of a
+ * breadth-first layout are spread over many pages.
+ */
+class VanEmdeBoasLayout
+{
+ public:
+  /**
+   * Fill the given vector with the nodes of the tree rooted at root, in the
+   * order in which they should be stored.
+   *
+   * @param root Root of the tree to order.
+   * @param order Vector to store the ordering in; it will be cleared first.
+   */
+  template<typename TreeType>
+  static void Order(const TreeType& root, std::vector<const TreeType*>& order)
+  {
+    order.clear();
+    OrderSubtree(&root, root.TreeDepth(), order);
+  }
+
+ private:
+  /**
+   * Lay out the subtree rooted at node, truncated to the given number of
+   * levels.
+   */
+  template<typename TreeType>
+  static void OrderSubtree(const TreeType* node,
+                           const size_t height,
+                           std::vector<const TreeType*>& order)
+  {
+    if (height == 1 || !node->Left())
+    {
+      order.push_back(node);
+      return;
+    }
+
+    // Lay out the top half of the subtree, then each of the subtrees hanging
+    // off the bottom of it.
+    const size_t topHeight = height / 2;
+    OrderSubtree(node, topHeight, order);
+
+    std::vector<const TreeType*> bottoms;
+    NodesAtDepth(node, topHeight, bottoms);
+    for (size_t i = 0; i < bottoms.size(); ++i)
+      OrderSubtree(bottoms[i], height - topHeight, order);
+  }
+
+  /**
+   * Collect the descendants of node which are exactly the given number of
+   * levels below it, from left to right.
+   */
+  template<typename TreeType>
+  static void NodesAtDepth(const TreeType* node,
+                           const size_t depth,
+                           std::vector<const TreeType*>& nodes)
+  {
+    if (depth == 0)
+    {
+      nodes.push_back(node);
+    }
+    else if (node->Left())
+    {
+      NodesAtDepth(node->Left(), depth - 1, nodes);
+      NodesAtDepth(node->Right(), depth - 1, nodes);
+    }
+  }
+};
+
+}; // namespace tree
+}; // namespace mlpack
+
+#endif
@@ -168,6 +168,24 @@ class HRectBound
    */
   std::string ToString() const;
 
+  /**
+   * Write the bound to the given binary stream, in the native byte order.
+   *
+   * @param stream Stream to write to.
+   */
+  void Save(std::ostream& stream) const;
+
+  /**
+   * Read the bound from the given binary stream, as written by Save().  The
+   * dimensionality of the bound is changed if necessary.  If the stored
+   * dimensionality is not the expected one, std::runtime_error is thrown
+   * before anything is allocated.
+   *
+   * @param stream Stream to read from.
+   * @param dimensionality Expected dimensionality of the bound.
+   */
+  void Load(std::istream& stream, const size_t dimensionality);
+
   /**
    * Return the metric associated with this bound.  Because it is an LMetric, it
    * cannot store state, so we can make it on the fly.  It is also static
@@ -10,6 +10,7 @@
 #define __MLPACK_CORE_TREE_HRECTBOUND_IMPL_HPP
 
 #include <math.h>
+#include <stdexcept>
 
 // In case it has not been included yet.
 #include "hrectbound.hpp"
@@ -352,8 +353,10 @@ inline HRectBound<Power, TakeRoot>& HRectBound<Power, TakeRoot>::operator|=(
 {
   Log::Assert(data.n_rows == dim);
 
-  arma::vec mins(min(data, 1));
-  arma::vec maxs(max(data, 1));
+  // The data may be single-precision; the bounds are always kept in double
+  // precision, which represents float values exactly.
+  arma::Col<typename MatType::elem_type> mins(min(data, 1));
+  arma::Col<typename MatType::elem_type> maxs(max(data, 1));
 
   minWidth = DBL_MAX;
   for (size_t i = 0; i < dim; i++)
@@ -439,6 +442,63 @@ std::string HRectBound<Power, TakeRoot>::ToString() const
   return convert.str();
 }
 
+/**
+ * Write the bound to a binary stream: the dimensionality, the minimum width,
+ * and then the low and high values of each dimension.
+ */
+template<int Power, bool TakeRoot>
+void HRectBound<Power, TakeRoot>::Save(std::ostream& stream) const
+{
+  const uint64_t dimension = dim;
+  stream.write((const char*) &dimension, sizeof(uint64_t));
+  stream.write((const char*) &minWidth, sizeof(double));
+  for (size_t i = 0; i < dim; ++i)
+  {
+    const double lo = bounds[i].Lo();
+    const double hi = bounds[i].Hi();
+    stream.write((const char*) &lo, sizeof(double));
+    stream.write((const char*) &hi, sizeof(double));
+  }
+}
+
+/**
+ * Read the bound from a binary stream written by Save().
+ */
+template<int Power, bool TakeRoot>
+void HRectBound<Power, TakeRoot>::Load(std::istream& stream,
+                                       const size_t dimensionality)
+{
+  uint64_t dimension;
+  stream.read((char*) &dimension, sizeof(uint64_t));
+  if (!stream.good())
+    return;
+
+  // Check the dimensionality before allocating anything, so that a corrupt
+  // stream doesn't make us allocate gigabytes.
+  if (dimension != dimensionality)
+    throw std::runtime_error("HRectBound::Load(): unexpected dimensionality "
+        "in stream");
+
+  if (dim != dimension)
+  {
+    // Reallocation is necessary.
+    if (bounds)
+      delete[] bounds;
+
+    dim = dimension;
+    bounds = new math::Range[dim];
+  }
+
+  stream.read((char*) &minWidth, sizeof(double));
+  for (size_t i = 0; i < dim; ++i)
+  {
+    double lo, hi;
+    stream.read((char*) &lo, sizeof(double));
+    stream.read((char*) &hi, sizeof(double));
+    bounds[i] = math::Range(lo, hi);
+  }
+}
+
 }; // namespace bound
 }; // namespace mlpack
 
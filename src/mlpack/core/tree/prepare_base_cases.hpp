@@ -0,0 +1,65 @@
+/**
+ * @file prepare_base_cases.hpp
+ *
+ * A utility function for dual-tree traversers, which gives the RuleType a
+ * chance to prepare for all of the base cases between a query leaf and a
+ * reference leaf at once (for instance, by computing the whole block of
+ * distances with a single matrix multiplication).
+ */
+#ifndef __MLPACK_CORE_TREE_PREPARE_BASE_CASES_HPP
+#define __MLPACK_CORE_TREE_PREPARE_BASE_CASES_HPP
+
+#include <mlpack/core.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+
+namespace mlpack {
+namespace tree {
+
+HAS_MEM_FUNC(PrepareBaseCases, HasPrepareBaseCasesCheck);
+
+/**
+ * Whether RuleType implements PrepareBaseCases() for the given TreeType.  A
+ * traverser can use this to keep its usual order of scores and base cases for
+ * rules that do not prepare anything.
+ */
+template<typename RuleType, typename TreeType>
+struct HasPrepareBaseCases
+{
+  static const bool value = HasPrepareBaseCasesCheck<RuleType,
+      void(RuleType::*)(TreeType&, TreeType&)>::value;
+};
+
+/**
+ * Call rule.PrepareBaseCases(queryNode, referenceNode) before the base cases
+ * between the points of the two given leaves are evaluated.  RuleType does not
+ * need to implement PrepareBaseCases(); if it does not, nothing is done.
+ *
+ * A RuleType implementing it must still return correct results for any call to
+ * BaseCase(), including calls that are not preceded by PrepareBaseCases() (as
+ * happens with other traversers).
+ */
+template<typename RuleType, typename TreeType>
+void PrepareBaseCases(
+    RuleType& rule,
+    TreeType& queryNode,
+    TreeType& referenceNode,
+    const typename boost::enable_if<HasPrepareBaseCasesCheck<RuleType,
+        void(RuleType::*)(TreeType&, TreeType&)> >::type* = 0)
+{
+  rule.PrepareBaseCases(queryNode, referenceNode);
+}
+
+//! RuleType does not implement PrepareBaseCases(), so there is nothing to do.
+template<typename RuleType, typename TreeType>
+void PrepareBaseCases(
+    RuleType& /* rule */,
+    TreeType& /* queryNode */,
+    TreeType& /* referenceNode */,
+    const typename boost::disable_if<HasPrepareBaseCasesCheck<RuleType,
+        void(RuleType::*)(TreeType&, TreeType&)> >::type* = 0)
+{ /* Nothing to do. */ }
+
+}; // namespace tree
+}; // namespace mlpack
+
+#endif
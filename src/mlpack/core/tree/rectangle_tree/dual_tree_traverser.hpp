@@ -12,6 +12,7 @@
 #include <mlpack/core.hpp>
 
 #include "rectangle_tree.hpp"
+#include "../traversal_statistics.hpp"
 
 namespace mlpack {
 namespace tree {
@@ -41,24 +42,29 @@ class RectangleTree<SplitType, DescentType, StatisticType, MatType>::
 		RectangleTree<SplitType, DescentType, StatisticType, MatType>& referenceNode);
 
   //! Get the number of prunes.
-  size_t NumPrunes() const { return numPrunes; }
+  size_t NumPrunes() const { return statistics.NumPrunes(); }
   //! Modify the number of prunes.
-  size_t& NumPrunes() { return numPrunes; }
+  size_t& NumPrunes() { return statistics.NumPrunes(); }
 
   //! Get the number of visited combinations.
-  size_t NumVisited() const { return numVisited; }
+  size_t NumVisited() const { return statistics.NumVisited(); }
   //! Modify the number of visited combinations.
-  size_t& NumVisited() { return numVisited; }
+  size_t& NumVisited() { return statistics.NumVisited(); }
 
   //! Get the number of times a node combination was scored.
-  size_t NumScores() const { return numScores; }
+  size_t NumScores() const { return statistics.NumScores(); }
   //! Modify the number of times a node combination was scored.
-  size_t& NumScores() { return numScores; }
+  size_t& NumScores() { return statistics.NumScores(); }
 
   //! Get the number of times a base case was calculated.
-  size_t NumBaseCases() const { return numBaseCases; }
+  size_t NumBaseCases() const { return statistics.NumBaseCases(); }
   //! Modify the number of times a base case was calculated.
-  size_t& NumBaseCases() { return numBaseCases; }
+  size_t& NumBaseCases() { return statistics.NumBaseCases(); }
+
+  //! Get the statistics of the traversal.
+  const TraversalStatistics& Statistics() const { return statistics; }
+  //! Modify the statistics of the traversal.
+  TraversalStatistics& Statistics() { return statistics; }
 
  private:
 
@@ -79,17 +85,11 @@ class RectangleTree<SplitType, DescentType, StatisticType, MatType>::
   //! Reference to the rules with which the trees will be traversed.
   RuleType& rule;
 
-  //! The number of prunes.
-  size_t numPrunes;
-
-  //! The number of node combinations that have been visited during traversal.
-  size_t numVisited;
-
-  //! The number of times a node combination was scored.
-  size_t numScores;
+  //! The counts of the work done during traversal.
+  TraversalStatistics statistics;
 
-  //! The number of times a base case was calculated.
-  size_t numBaseCases;
+  //! The current depth of the recursion.
+  size_t depth;
 
   //! Traversal information, held in the class so that it isn't continually
   //! being reallocated.
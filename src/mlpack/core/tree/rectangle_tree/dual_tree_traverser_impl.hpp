@@ -25,10 +25,7 @@ template<typename RuleType>
 RectangleTree<SplitType, DescentType, StatisticType, MatType>::
 DualTreeTraverser<RuleType>::DualTreeTraverser(RuleType& rule) :
     rule(rule),
-    numPrunes(0),
-    numVisited(0),
-    numScores(0),
-    numBaseCases(0)
+    depth(0)
 { /* Nothing to do */ }
 
 template<typename SplitType,
@@ -42,7 +39,7 @@ DualTreeTraverser<RuleType>::Traverse(
     RectangleTree<SplitType, DescentType, StatisticType, MatType>& referenceNode)
 {
   // Increment the visit counter.
-  ++numVisited;
+  statistics.Visit(depth++);
 
   // Store the current traversal info.
   traversalInfo = rule.TraversalInfo();
@@ -63,6 +60,7 @@ DualTreeTraverser<RuleType>::Traverse(
       // Restore the traversal information.
       rule.TraversalInfo() = traversalInfo;
       const double childScore = rule.Score(queryNode.Points()[query], referenceNode);
+      statistics.PointScore(childScore == DBL_MAX);
 
       if(childScore == DBL_MAX)
         continue;  // This point doesn't require a search in this reference node.
@@ -70,7 +68,7 @@ DualTreeTraverser<RuleType>::Traverse(
       for(size_t ref = 0; ref < referenceNode.Count(); ++ref)
         rule.BaseCase(queryNode.Points()[query], referenceNode.Points()[ref]);
 
-      numBaseCases += referenceNode.Count();
+      statistics.BaseCase(referenceNode.Count());
     }
   }
   else if(!queryNode.IsLeaf() && referenceNode.IsLeaf())
@@ -80,11 +78,11 @@ DualTreeTraverser<RuleType>::Traverse(
     {
       // Before recursing, we have to set the traversal information correctly.
       rule.TraversalInfo() = traversalInfo;
-      ++numScores;
+      statistics.Score();
       if(rule.Score(queryNode.Child(i), referenceNode) < DBL_MAX)
         Traverse(queryNode.Child(i), referenceNode);
       else
-        numPrunes++;
+        statistics.Prune();
     }
   }
   else if(queryNode.IsLeaf() && !referenceNode.IsLeaf())
@@ -101,15 +99,17 @@ DualTreeTraverser<RuleType>::Traverse(
       nodesAndScores[i].travInfo = rule.TraversalInfo();
     }
     std::sort(nodesAndScores.begin(), nodesAndScores.end(), nodeComparator);
-    numScores += nodesAndScores.size();
+    statistics.Score(nodesAndScores.size());
 
     for (size_t i = 0; i < nodesAndScores.size(); i++)
     {
       rule.TraversalInfo() = nodesAndScores[i].travInfo;
-      if(rule.Rescore(queryNode, *(nodesAndScores[i].node), nodesAndScores[i].score) < DBL_MAX) {
+      const double rescore = rule.Rescore(queryNode, *(nodesAndScores[i].node), nodesAndScores[i].score);
+      statistics.Rescore(rescore == DBL_MAX);
+      if(rescore < DBL_MAX) {
         Traverse(queryNode, *(nodesAndScores[i].node));
       } else {
-        numPrunes += nodesAndScores.size() - i;
+        statistics.Prune(nodesAndScores.size() - i);
         break;
       }
     }
@@ -132,20 +132,24 @@ DualTreeTraverser<RuleType>::Traverse(
         nodesAndScores[i].travInfo = rule.TraversalInfo();
       }
       std::sort(nodesAndScores.begin(), nodesAndScores.end(), nodeComparator);
-      numScores += nodesAndScores.size();
+      statistics.Score(nodesAndScores.size());
 
       for (size_t i = 0; i < nodesAndScores.size(); i++)
       {
         rule.TraversalInfo() = nodesAndScores[i].travInfo;
-        if(rule.Rescore(queryNode.Child(j), *(nodesAndScores[i].node), nodesAndScores[i].score) < DBL_MAX) {
+        const double rescore = rule.Rescore(queryNode.Child(j), *(nodesAndScores[i].node), nodesAndScores[i].score);
+        statistics.Rescore(rescore == DBL_MAX);
+        if(rescore < DBL_MAX) {
           Traverse(queryNode.Child(j), *(nodesAndScores[i].node));
         } else {
-          numPrunes += nodesAndScores.size() - i;
+          statistics.Prune(nodesAndScores.size() - i);
           break;
         }
       }
     }
   }
+
+  --depth;
 }
 
 }; // namespace tree
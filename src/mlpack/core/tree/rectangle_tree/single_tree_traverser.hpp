@@ -12,6 +12,7 @@
 #include <mlpack/core.hpp>
 
 #include "rectangle_tree.hpp"
+#include "../traversal_statistics.hpp"
 
 namespace mlpack {
 namespace tree {
@@ -40,9 +41,14 @@ class RectangleTree<SplitType, DescentType, StatisticType, MatType>::
   void Traverse(const size_t queryIndex, const RectangleTree& referenceNode);
 
   //! Get the number of prunes.
-  size_t NumPrunes() const { return numPrunes; }
+  size_t NumPrunes() const { return statistics.NumPrunes(); }
   //! Modify the number of prunes.
-  size_t& NumPrunes() { return numPrunes; }
+  size_t& NumPrunes() { return statistics.NumPrunes(); }
+
+  //! Get the statistics of the traversal.
+  const TraversalStatistics& Statistics() const { return statistics; }
+  //! Modify the statistics of the traversal (good for a reset).
+  TraversalStatistics& Statistics() { return statistics; }
 
  private:
 
@@ -62,8 +68,11 @@ class RectangleTree<SplitType, DescentType, StatisticType, MatType>::
   //! Reference to the rules with which the tree will be traversed.
   RuleType& rule;
 
-  //! The number of nodes which have been prenud during traversal.
-  size_t numPrunes;
+  //! The counts of the work done during traversal.
+  TraversalStatistics statistics;
+
+  //! The depth of the current reference node in the recursion.
+  size_t depth;
 };
 
 }; // namespace tree
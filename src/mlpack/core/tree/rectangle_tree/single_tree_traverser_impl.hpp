@@ -25,7 +25,7 @@ template<typename RuleType>
 RectangleTree<SplitType, DescentType, StatisticType, MatType>::
 SingleTreeTraverser<RuleType>::SingleTreeTraverser(RuleType& rule) :
     rule(rule),
-    numPrunes(0)
+    depth(0)
 { /* Nothing to do */ }
 
 template<typename SplitType,
@@ -39,12 +39,14 @@ SingleTreeTraverser<RuleType>::Traverse(
     const RectangleTree<SplitType, DescentType, StatisticType, MatType>&
         referenceNode)
 {
+  statistics.Visit(depth);
 
   // If we reach a leaf node, we need to run the base case.
   if (referenceNode.IsLeaf())
   {
     for (size_t i = 0; i < referenceNode.Count(); i++)
       rule.BaseCase(queryIndex, referenceNode.Points()[i]);
+    statistics.BaseCase(referenceNode.Count());
 
     return;
   }
@@ -57,6 +59,7 @@ SingleTreeTraverser<RuleType>::Traverse(
     nodesAndScores[i].node = referenceNode.Children()[i];
     nodesAndScores[i].score = rule.Score(queryIndex, *nodesAndScores[i].node);
   }
+  statistics.Score(referenceNode.NumChildren());
 
   std::sort(nodesAndScores.begin(), nodesAndScores.end(), NodeComparator);
 
@@ -64,14 +67,18 @@ SingleTreeTraverser<RuleType>::Traverse(
   // one that isn't good enough.
   for (size_t i = 0; i < referenceNode.NumChildren(); i++)
   {
-    if (rule.Rescore(queryIndex, *nodesAndScores[i].node,
-        nodesAndScores[i].score) != DBL_MAX)
+    const double rescore = rule.Rescore(queryIndex, *nodesAndScores[i].node,
+        nodesAndScores[i].score);
+    statistics.Rescore(rescore == DBL_MAX);
+    if (rescore != DBL_MAX)
     {
+      ++depth;
       Traverse(queryIndex, *nodesAndScores[i].node);
+      --depth;
     }
     else
     {
-      numPrunes += referenceNode.NumChildren() - i;
+      statistics.Prune(referenceNode.NumChildren() - i);
       return;
     }
   }
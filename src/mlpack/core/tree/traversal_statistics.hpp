@@ -0,0 +1,230 @@
+/**
+ * @file traversal_statistics.hpp
+ *
+ * Counters of the work done by a tree traversal (prunes, scores, base cases,
+ * rescores, and node combinations visited at each depth), which every
+ * single-tree and dual-tree traverser keeps.
+ */
+#ifndef __MLPACK_CORE_TREE_TRAVERSAL_STATISTICS_HPP
+#define __MLPACK_CORE_TREE_TRAVERSAL_STATISTICS_HPP
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The TraversalStatistics class counts the work done by a traversal, so that
+ * the leaf size and the type of tree can be tuned for a dataset.  Every
+ * traverser holds one, available through its Statistics() method, and updates
+ * it as it goes:
+ *
+ *  - Visit() for every node (single-tree) or node combination (dual-tree) that
+ *    is recursed into, with the depth of the recursion;
+ *  - Score() for every call to RuleType::Score() with a node (or a node
+ *    combination);
+ *  - PointScore() for every call to RuleType::Score() with a single query point
+ *    in the base case of a dual-tree traversal, noting whether it led to a
+ *    prune;
+ *  - Prune() for every node or node combination that is not recursed into;
+ *  - Rescore() for every call to RuleType::Rescore(), noting whether it led to
+ *    a prune;
+ *  - BaseCase() for every call to RuleType::BaseCase().
+ *
+ * Counting is cheap, but it is in the innermost loops of every traversal, so
+ * it can be compiled out by defining MLPACK_NO_TRAVERSAL_STATISTICS (the CMake
+ * option TRAVERSAL_STATISTICS=OFF does this).  Then all of the counters stay
+ * zero.
+ */
+class TraversalStatistics
+{
+ public:
+#ifdef MLPACK_NO_TRAVERSAL_STATISTICS
+  //! Whether or not the counters are updated.
+  static const bool Enabled = false;
+#else
+  //! Whether or not the counters are updated.
+  static const bool Enabled = true;
+#endif
+
+  //! Create the statistics with all counters set to zero.
+  TraversalStatistics() :
+      numVisited(0),
+      numScores(0),
+      numPrunes(0),
+      numRescores(0),
+      numRescorePrunes(0),
+      numPointScores(0),
+      numPointPrunes(0),
+      numBaseCases(0)
+  { /* Nothing to do. */ }
+
+  //! Set all counters to zero.
+  void Reset() { *this = TraversalStatistics(); }
+
+  //! Count a node (combination) visited at the given depth of the recursion.
+  void Visit(const size_t depth)
+  {
+    if (!Enabled)
+      return;
+
+    ++numVisited;
+    if (depth >= visitsPerDepth.size())
+      visitsPerDepth.resize(depth + 1, 0);
+    ++visitsPerDepth[depth];
+  }
+
+  //! Count the given number of calls to Score() with a node (combination).
+  void Score(const size_t count = 1) { if (Enabled) numScores += count; }
+
+  //! Count the given number of prunes.
+  void Prune(const size_t count = 1) { if (Enabled) numPrunes += count; }
+
+  //! Count a call to Rescore(), and whether it caused a prune.
+  void Rescore(const bool pruned)
+  {
+    if (!Enabled)
+      return;
+
+    ++numRescores;
+    if (pruned)
+      ++numRescorePrunes;
+  }
+
+  //! Count a call to Score() with a single query point in the base case of a
+  //! dual-tree traversal, and whether it caused a prune.
+  void PointScore(const bool pruned)
+  {
+    if (!Enabled)
+      return;
+
+    ++numPointScores;
+    if (pruned)
+      ++numPointPrunes;
+  }
+
+  //! Count the given number of calls to BaseCase().
+  void BaseCase(const size_t count = 1) { if (Enabled) numBaseCases += count; }
+
+  //! Add the counts of another traversal.
+  TraversalStatistics& operator+=(const TraversalStatistics& other)
+  {
+    numVisited += other.numVisited;
+    numScores += other.numScores;
+    numPrunes += other.numPrunes;
+    numRescores += other.numRescores;
+    numRescorePrunes += other.numRescorePrunes;
+    numPointScores += other.numPointScores;
+    numPointPrunes += other.numPointPrunes;
+    numBaseCases += other.numBaseCases;
+
+    if (other.visitsPerDepth.size() > visitsPerDepth.size())
+      visitsPerDepth.resize(other.visitsPerDepth.size(), 0);
+    for (size_t i = 0; i < other.visitsPerDepth.size(); ++i)
+      visitsPerDepth[i] += other.visitsPerDepth[i];
+
+    return *this;
+  }
+
+  //! Get the number of nodes (or node combinations) visited.
+  size_t NumVisited() const { return numVisited; }
+  //! Modify the number of nodes (or node combinations) visited.
+  size_t& NumVisited() { return numVisited; }
+
+  //! Get the number of calls to Score() with a node (combination).
+  size_t NumScores() const { return numScores; }
+  //! Modify the number of calls to Score() with a node (combination).
+  size_t& NumScores() { return numScores; }
+
+  //! Get the number of prunes.
+  size_t NumPrunes() const { return numPrunes; }
+  //! Modify the number of prunes.
+  size_t& NumPrunes() { return numPrunes; }
+
+  //! Get the number of calls to Rescore().
+  size_t NumRescores() const { return numRescores; }
+  //! Modify the number of calls to Rescore().
+  size_t& NumRescores() { return numRescores; }
+
+  //! Get the number of calls to Rescore() which caused a prune.
+  size_t NumRescorePrunes() const { return numRescorePrunes; }
+  //! Modify the number of calls to Rescore() which caused a prune.
+  size_t& NumRescorePrunes() { return numRescorePrunes; }
+
+  //! Get the number of calls to Score() with a single query point.
+  size_t NumPointScores() const { return numPointScores; }
+  //! Modify the number of calls to Score() with a single query point.
+  size_t& NumPointScores() { return numPointScores; }
+
+  //! Get the number of calls to Score() with a single query point which caused
+  //! a prune.
+  size_t NumPointPrunes() const { return numPointPrunes; }
+  //! Modify the number of calls to Score() with a single query point which
+  //! caused a prune.
+  size_t& NumPointPrunes() { return numPointPrunes; }
+
+  //! Get the number of calls to BaseCase().
+  size_t NumBaseCases() const { return numBaseCases; }
+  //! Modify the number of calls to BaseCase().
+  size_t& NumBaseCases() { return numBaseCases; }
+
+  //! Get the number of nodes (or node combinations) visited at each depth.
+  const std::vector<size_t>& VisitsPerDepth() const { return visitsPerDepth; }
+
+  /**
+   * Returns a string representation of this object, with one counter per line;
+   * this is what the --stats option of the programs prints.
+   */
+  std::string ToString() const
+  {
+    std::ostringstream convert;
+    if (!Enabled)
+    {
+      convert << "Traversal statistics were compiled out (see "
+          << "MLPACK_NO_TRAVERSAL_STATISTICS)." << std::endl;
+      return convert.str();
+    }
+
+    convert << "Nodes visited: " << numVisited << std::endl;
+    convert << "Scores: " << numScores << std::endl;
+    convert << "Prunes: " << numPrunes << std::endl;
+    convert << "Rescores: " << numRescores << " (" << numRescorePrunes
+        << " caused a prune)" << std::endl;
+    convert << "Point scores: " << numPointScores << " (" << numPointPrunes
+        << " caused a prune)" << std::endl;
+    convert << "Base cases: " << numBaseCases << std::endl;
+    convert << "Nodes visited per depth:";
+    for (size_t i = 0; i < visitsPerDepth.size(); ++i)
+      convert << " " << visitsPerDepth[i];
+    convert << std::endl;
+    return convert.str();
+  }
+
+ private:
+  //! The number of nodes (or node combinations) visited.
+  size_t numVisited;
+  //! The number of calls to Score() with a node (combination).
+  size_t numScores;
+  //! The number of prunes.
+  size_t numPrunes;
+  //! The number of calls to Rescore().
+  size_t numRescores;
+  //! The number of calls to Rescore() which caused a prune.
+  size_t numRescorePrunes;
+  //! The number of calls to Score() with a single query point.
+  size_t numPointScores;
+  //! The number of calls to Score() with a single query point which caused a
+  //! prune.
+  size_t numPointPrunes;
+  //! The number of calls to BaseCase().
+  size_t numBaseCases;
+  //! The number of nodes (or node combinations) visited at each depth.
+  std::vector<size_t> visitsPerDepth;
+};
+
+}; // namespace tree
+}; // namespace mlpack
+
+#endif
@@ -8,6 +8,7 @@
 #include <boost/program_options.hpp>
 #include <boost/any.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <fstream>
 #include <iostream>
 #include <string>
 
@@ -65,9 +66,9 @@ CLI::~CLI()
     Print();
 
     Log::Info << "Program timers:" << std::endl;
+    std::map<std::string, timeval> timers = timer.GetAllTimers();
     std::map<std::string, timeval>::iterator it;
-    for (it = timer.GetAllTimers().begin(); it != timer.GetAllTimers().end();
-        ++it)
+    for (it = timers.begin(); it != timers.end(); ++it)
     {
       std::string i = (*it).first;
       Log::Info << "  " << i << ": ";
@@ -75,6 +76,18 @@ CLI::~CLI()
     }
   }
 
+  // Write every timer to a file, if the user asked for it.
+  if (HasParam("timer_file") && !HasParam("help") && !HasParam("info"))
+  {
+    const std::string timerFile = GetParam<std::string>("timer_file");
+    std::ofstream stream(timerFile.c_str());
+    if (stream.is_open())
+      timer.PrintJSON(stream);
+    else
+      Log::Warn << "Could not open '" << timerFile << "' to write timers to."
+          << std::endl;
+  }
+
   // Notify the user if we are debugging, but only if we actually parsed the
   // options.  This way this output doesn't show up inexplicably for someone who
   // may not have wanted it there (i.e. in Boost unit tests).
@@ -407,6 +420,11 @@ void CLI::ParseCommandLine(int argc, char** line)
   UpdateGmap();
   DefaultMessages();
   RequiredOptions();
+
+  // The percentiles of the timers are only written to the timer file, so the
+  // histograms of the run times are only needed if there is one.
+  if (HasParam("timer_file"))
+    GetSingleton().timer.EnablePercentiles();
 }
 
 /*
@@ -473,6 +491,9 @@ void CLI::ParseStream(std::istream& stream)
   DefaultMessages();
   RequiredOptions();
 
+  if (HasParam("timer_file"))
+    GetSingleton().timer.EnablePercentiles();
+
   Timer::Start("total_time");
 }
 
@@ -742,3 +763,6 @@ PARAM_STRING("info", "Get help on a specific module or option.", "", "");
 PARAM_FLAG("verbose", "Display informational messages and the full list of "
     "parameters and timers at the end of execution.", "v");
 PARAM_FLAG("version", "Display the version of mlpack.", "V");
+PARAM_STRING("timer_file", "If specified, every timer (with its nesting, number "
+    "of runs and percentiles) is written to this file as JSON at the end of "
+    "execution.", "", "");
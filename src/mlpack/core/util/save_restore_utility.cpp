@@ -4,15 +4,174 @@
  * @author Michael Fox
  *
  * The SaveRestoreUtility provides helper functions in saving and
- *   restoring models.  The current output file type is XML.
+ *   restoring models.  Models are stored as XML or in a binary format.
  */
 #include <mlpack/core.hpp>
+#include <mlpack/core/data/mapped_file.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <stdint.h>
 
 using namespace mlpack;
 using namespace mlpack::util;
 
+namespace {
+
+//! The start of every binary model file.
+const char binaryMagic[16] = { 'M', 'L', 'P', 'A', 'C', 'K', '_', 'M', 'O',
+    'D', 'E', 'L', '_', 'B', 'I', 'N' };
+//! The version of the binary format.
+const uint32_t binaryVersion = 1;
+//! The alignment of matrix elements in the binary format.
+const size_t binaryAlignment = 16;
+
+//! Return whether the given file should be in the binary format.
+bool IsBinaryFile(const std::string& filename)
+{
+  const size_t ext = filename.rfind('.');
+  if (ext == std::string::npos)
+    return false;
+
+  std::string extension = filename.substr(ext + 1);
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+      ::tolower);
+  return (extension == "bin");
+}
+
+//! Return whether the machine is little-endian.
+bool IsLittleEndian()
+{
+  const uint16_t one = 1;
+  return (*((const unsigned char*) &one) == 1);
+}
+
+//! Reverse the bytes of each element of the given size, on big-endian
+//! machines.
+void ToLittleEndian(std::string& elements, const size_t elementSize)
+{
+  if (IsLittleEndian() || elementSize <= 1)
+    return;
+
+  for (size_t i = 0; i + elementSize <= elements.size(); i += elementSize)
+    std::reverse(elements.begin() + i, elements.begin() + i + elementSize);
+}
+
+//! Write an unsigned integer with the given number of bytes.
+void WriteInteger(std::ostream& stream,
+                  size_t& offset,
+                  const uint64_t value,
+                  const size_t bytes = 8)
+{
+  char buffer[8];
+  for (size_t i = 0; i < bytes; ++i)
+    buffer[i] = (char) ((value >> (8 * i)) & 0xFF);
+  stream.write(buffer, bytes);
+  offset += bytes;
+}
+
+//! Write a string as its length and its characters.
+void WriteString(std::ostream& stream, size_t& offset, const std::string& str)
+{
+  WriteInteger(stream, offset, str.size());
+  stream.write(str.data(), str.size());
+  offset += str.size();
+}
+
+//! Read an unsigned integer with the given number of bytes.
+bool ReadInteger(const char*& position,
+                 const char* end,
+                 uint64_t& value,
+                 const size_t bytes = 8)
+{
+  if ((size_t) (end - position) < bytes)
+    return false;
+
+  value = 0;
+  for (size_t i = 0; i < bytes; ++i)
+    value |= ((uint64_t) (unsigned char) position[i]) << (8 * i);
+  position += bytes;
+  return true;
+}
+
+//! Read a string stored as its length and its characters.
+bool ReadString(const char*& position, const char* end, std::string& str)
+{
+  uint64_t length;
+  if (!ReadInteger(position, end, length) ||
+      (uint64_t) (end - position) < length)
+    return false;
+
+  str.assign(position, (size_t) length);
+  position += length;
+  return true;
+}
+
+//! Convert the given elements to CSV text, if they are of the type eT.
+template<typename eT>
+bool ElementsToText(const std::string& type,
+                    const size_t rows,
+                    const size_t cols,
+                    const std::string& elements,
+                    std::string& text)
+{
+  arma::Mat<eT> temp;
+  if (type != arma::diskio::gen_bin_header(temp) ||
+      elements.size() != rows * cols * sizeof(eT))
+    return false;
+
+  temp.set_size(rows, cols);
+  if (temp.n_elem > 0)
+    memcpy(temp.memptr(), elements.data(), elements.size());
+
+  std::ostringstream output;
+  arma::diskio::save_csv_ascii(temp, output);
+  text = output.str();
+  return true;
+}
+
+} // anonymous namespace
+
 bool SaveRestoreUtility::ReadFile(const std::string& filename)
 {
+  if (IsBinaryFile(filename))
+  {
+    data::MappedFile file;
+    if (!file.Open(filename))
+    {
+      Log::Fatal << "Could not open binary model file '" << filename << "'!"
+          << std::endl;
+    }
+
+    const char* begin = file.Data();
+    const char* end = begin + file.Size();
+    const char* position = begin;
+
+    uint64_t version;
+    if (file.Size() < sizeof(binaryMagic) ||
+        memcmp(begin, binaryMagic, sizeof(binaryMagic)) != 0)
+    {
+      Log::Fatal << "'" << filename << "' is not a binary model file!"
+          << std::endl;
+    }
+
+    position += sizeof(binaryMagic);
+    if (!ReadInteger(position, end, version, 4) || version != binaryVersion)
+    {
+      Log::Fatal << "Binary model file '" << filename << "' has unknown "
+          << "version!" << std::endl;
+    }
+
+    if (!ReadBinary(begin, position, end))
+    {
+      Log::Fatal << "Could not load binary model file '" << filename
+          << "'; it is corrupt or truncated!" << std::endl;
+    }
+
+    return true;
+  }
+
   xmlDocPtr xmlDocTree = NULL;
   if (NULL == (xmlDocTree = xmlReadFile(filename.c_str(), NULL, 0)))
   {
@@ -28,6 +187,7 @@ bool SaveRestoreUtility::ReadFile(const std::string& filename)
 void SaveRestoreUtility::ReadFile(xmlNode* n)
 {
   parameters.clear();
+  matrices.clear();
   xmlNodePtr current = NULL;
   for (current = n; current; current = current->next)
   {
@@ -49,6 +209,22 @@ void SaveRestoreUtility::ReadFile(xmlNode* n)
 
 bool SaveRestoreUtility::WriteFile(const std::string& filename)
 {
+  if (IsBinaryFile(filename))
+  {
+    std::ofstream stream(filename.c_str(), std::ios::out | std::ios::binary);
+    if (!stream.is_open())
+      return false;
+
+    size_t offset = 0;
+    stream.write(binaryMagic, sizeof(binaryMagic));
+    offset += sizeof(binaryMagic);
+    WriteInteger(stream, offset, binaryVersion, 4);
+    WriteBinary(stream, offset);
+
+    stream.close();
+    return !stream.fail();
+  }
+
   bool success = false;
   xmlDocPtr xmlDocTree = xmlNewDoc(BAD_CAST "1.0");
   xmlNodePtr root = xmlNewNode(NULL, BAD_CAST "root");
@@ -70,6 +246,12 @@ void SaveRestoreUtility::WriteFile(xmlNode* n)
     xmlNewChild(n, NULL, BAD_CAST(*it).first.c_str(),
         BAD_CAST(*it).second.c_str());
   }
+  for (std::map<std::string, MatrixParameter>::const_iterator it =
+       matrices.begin(); it != matrices.end(); ++it)
+  {
+    xmlNewChild(n, NULL, BAD_CAST(*it).first.c_str(),
+        BAD_CAST MatrixToText((*it).second).c_str());
+  }
   xmlNodePtr child;
   for (std::map<std::string, SaveRestoreUtility>::iterator it =
        children.begin(); it != children.end(); ++it)
@@ -79,6 +261,163 @@ void SaveRestoreUtility::WriteFile(xmlNode* n)
   }
 }
 
+void SaveRestoreUtility::WriteBinary(std::ostream& stream,
+                                     size_t& offset) const
+{
+  WriteInteger(stream, offset, parameters.size());
+  for (std::map<std::string, std::string>::const_iterator it =
+       parameters.begin(); it != parameters.end(); ++it)
+  {
+    WriteString(stream, offset, (*it).first);
+    WriteString(stream, offset, (*it).second);
+  }
+
+  WriteInteger(stream, offset, matrices.size());
+  for (std::map<std::string, MatrixParameter>::const_iterator it =
+       matrices.begin(); it != matrices.end(); ++it)
+  {
+    const MatrixParameter& matrix = (*it).second;
+    WriteString(stream, offset, (*it).first);
+    WriteString(stream, offset, matrix.type);
+    WriteInteger(stream, offset, matrix.rows);
+    WriteInteger(stream, offset, matrix.cols);
+    WriteInteger(stream, offset, matrix.elements.size());
+
+    // Pad, so that the elements are aligned in the file.
+    const char padding[binaryAlignment] = { 0 };
+    const size_t pad = (binaryAlignment - (offset % binaryAlignment)) %
+        binaryAlignment;
+    stream.write(padding, pad);
+    offset += pad;
+
+    const size_t elements = matrix.rows * matrix.cols;
+    if (IsLittleEndian() || elements == 0)
+    {
+      stream.write(matrix.elements.data(), matrix.elements.size());
+    }
+    else
+    {
+      std::string swapped(matrix.elements);
+      ToLittleEndian(swapped, swapped.size() / elements);
+      stream.write(swapped.data(), swapped.size());
+    }
+    offset += matrix.elements.size();
+  }
+
+  WriteInteger(stream, offset, children.size());
+  for (std::map<std::string, SaveRestoreUtility>::const_iterator it =
+       children.begin(); it != children.end(); ++it)
+  {
+    WriteString(stream, offset, (*it).first);
+    (*it).second.WriteBinary(stream, offset);
+  }
+}
+
+bool SaveRestoreUtility::ReadBinary(const char* begin,
+                                    const char*& position,
+                                    const char* end)
+{
+  parameters.clear();
+  matrices.clear();
+  children.clear();
+
+  uint64_t count;
+  if (!ReadInteger(position, end, count))
+    return false;
+  for (uint64_t i = 0; i < count; ++i)
+  {
+    std::string name;
+    if (!ReadString(position, end, name) ||
+        !ReadString(position, end, parameters[name]))
+      return false;
+  }
+
+  if (!ReadInteger(position, end, count))
+    return false;
+  for (uint64_t i = 0; i < count; ++i)
+  {
+    std::string name;
+    if (!ReadString(position, end, name))
+      return false;
+
+    MatrixParameter& matrix = matrices[name];
+    uint64_t rows, cols, size;
+    if (!ReadString(position, end, matrix.type) ||
+        !ReadInteger(position, end, rows) ||
+        !ReadInteger(position, end, cols) ||
+        !ReadInteger(position, end, size))
+      return false;
+
+    // Every element takes a whole number of bytes, so the size must be a
+    // multiple of the number of elements (and at least that large); this also
+    // catches overflow of rows * cols.
+    if (cols != 0 && rows > std::numeric_limits<uint64_t>::max() / cols)
+      return false;
+    const uint64_t elements = rows * cols;
+    if ((elements == 0 && size != 0) ||
+        (elements != 0 && (size < elements || size % elements != 0)))
+      return false;
+
+    const size_t offset = (size_t) (position - begin);
+    position += (binaryAlignment - (offset % binaryAlignment)) %
+        binaryAlignment;
+    if (position > end || (uint64_t) (end - position) < size)
+      return false;
+
+    matrix.rows = (size_t) rows;
+    matrix.cols = (size_t) cols;
+    matrix.elements.assign(position, (size_t) size);
+    position += size;
+
+    if (elements > 0)
+      ToLittleEndian(matrix.elements, (size_t) (size / elements));
+  }
+
+  if (!ReadInteger(position, end, count))
+    return false;
+  for (uint64_t i = 0; i < count; ++i)
+  {
+    std::string name;
+    if (!ReadString(position, end, name) ||
+        !children[name].ReadBinary(begin, position, end))
+      return false;
+  }
+
+  return true;
+}
+
+std::string SaveRestoreUtility::MatrixToText(const MatrixParameter& matrix)
+{
+  std::string text;
+  if (ElementsToText<double>(matrix.type, matrix.rows, matrix.cols,
+          matrix.elements, text) ||
+      ElementsToText<float>(matrix.type, matrix.rows, matrix.cols,
+          matrix.elements, text) ||
+      ElementsToText<arma::uword>(matrix.type, matrix.rows, matrix.cols,
+          matrix.elements, text) ||
+      ElementsToText<arma::sword>(matrix.type, matrix.rows, matrix.cols,
+          matrix.elements, text) ||
+      ElementsToText<size_t>(matrix.type, matrix.rows, matrix.cols,
+          matrix.elements, text) ||
+      ElementsToText<arma::u32>(matrix.type, matrix.rows, matrix.cols,
+          matrix.elements, text) ||
+      ElementsToText<arma::s32>(matrix.type, matrix.rows, matrix.cols,
+          matrix.elements, text) ||
+      ElementsToText<arma::u16>(matrix.type, matrix.rows, matrix.cols,
+          matrix.elements, text) ||
+      ElementsToText<arma::s16>(matrix.type, matrix.rows, matrix.cols,
+          matrix.elements, text) ||
+      ElementsToText<arma::u8>(matrix.type, matrix.rows, matrix.cols,
+          matrix.elements, text) ||
+      ElementsToText<arma::s8>(matrix.type, matrix.rows, matrix.cols,
+          matrix.elements, text))
+    return text;
+
+  Log::Warn << "SaveRestoreUtility: cannot convert a matrix of type '"
+      << matrix.type << "' to text." << std::endl;
+  return text;
+}
+
 std::string SaveRestoreUtility::LoadParameter(std::string& str,
                                               const std::string& name) const
 {
@@ -118,6 +457,8 @@ void SaveRestoreUtility::SaveParameter(const char c, const std::string& name)
   std::ostringstream output;
   output << temp;
   parameters[name] = output.str();
+
+  matrices.erase(name);
 }
 
 void SaveRestoreUtility::AddChild(SaveRestoreUtility& mn, const std::string&
@@ -125,3 +466,31 @@ void SaveRestoreUtility::AddChild(SaveRestoreUtility& mn, const std::string&
 {
   children[name] = mn;
 }
+
+bool SaveRestoreUtility::IsCoordinateText(const std::string& text)
+{
+  // Coordinate text has three fields separated by whitespace on each line,
+  // while CSV text separates the fields of a line by commas.
+  if (text.find(',') != std::string::npos)
+    return false;
+
+  std::istringstream input(text);
+  std::string line;
+  bool lines = false;
+  while (std::getline(input, line))
+  {
+    std::istringstream lineInput(line);
+    std::string field;
+    size_t fields = 0;
+    while (lineInput >> field)
+      ++fields;
+
+    if (fields == 0)
+      continue;
+    if (fields != 3)
+      return false;
+    lines = true;
+  }
+
+  return lines;
+}
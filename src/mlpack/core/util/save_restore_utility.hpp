@@ -3,7 +3,8 @@
  * @author Neil Slagle
  *
  * The SaveRestoreUtility provides helper functions in saving and
- *   restoring models.  The current output file type is XML.
+ *   restoring models.  Models are stored as XML or, if the file has the
+ *   extension .bin, in a compact binary format.
  *
  * @experimental
  */
@@ -24,6 +25,26 @@
 namespace mlpack {
 namespace util {
 
+/**
+ * The SaveRestoreUtility holds the parameters of a model (and of its child
+ * models), and reads and writes them to disk.  The format of the file is given
+ * by its extension: files ending in .bin are binary, and any other file is
+ * XML.
+ *
+ * Scalar parameters are held as strings in both formats.  Dense Armadillo
+ * matrices are held as their raw memory, so in the binary format they are
+ * stored exactly and without any parsing or formatting; in the XML format they
+ * are converted to (and from) CSV text, as before.
+ *
+ * The binary format is a 16-byte magic string and a 32-bit version, followed
+ * by the root node.  A node is its number of parameters and their names and
+ * values, its number of matrices and their names, element types, sizes and
+ * elements, and its number of children and their names and nodes.  Strings
+ * are stored as their length and characters; all integers and matrix elements
+ * are little-endian, and matrix elements are aligned to 16 bytes from the start
+ * of the file, so a mapped file could be used in place.  The file is read with
+ * a memory map (see data::MappedFile).
+ */
 class SaveRestoreUtility
 {
  private:
@@ -32,6 +53,27 @@ class SaveRestoreUtility
    */
   std::map<std::string, std::string> parameters;
 
+  /**
+   * A dense matrix, held as the raw memory of its elements.
+   */
+  struct MatrixParameter
+  {
+    //! The Armadillo binary header of the element type (like
+    //! "ARMA_MAT_BIN_FN008").
+    std::string type;
+    //! The number of rows.
+    size_t rows;
+    //! The number of columns.
+    size_t cols;
+    //! The elements, in column-major order.
+    std::string elements;
+  };
+
+  /**
+   * matrices contains a list of names and dense matrices in binary form.
+   */
+  std::map<std::string, MatrixParameter> matrices;
+
   /**
    * children contains a list of names in string format and child
    * models in the model hierarchy in SaveRestoreUtility format
@@ -49,12 +91,14 @@ class SaveRestoreUtility
   ~SaveRestoreUtility() { parameters.clear(); }
 
   /**
-   * ReadFile reads an XML tree from a file.
+   * ReadFile reads a model from a file; files with the extension .bin are read
+   * as binary, and anything else as XML.
    */
   bool ReadFile(const std::string& filename);
 
   /**
-   * WriteFile writes the XML tree to a file.
+   * WriteFile writes the model to a file; if the extension is .bin, the binary
+   * format is used, and otherwise XML.
    */
   bool WriteFile(const std::string& filename);
 
@@ -144,13 +188,13 @@ class SaveRestoreUtility
   /**
    * Return the children.
    */
-  const std::map<std::string, SaveRestoreUtility> Children() const { return
+  const std::map<std::string, SaveRestoreUtility>& Children() const { return
     children; }
 
   /**
-   * Return modifiable copy of the children.
+   * Modify the children.
    */
-  std::map<std::string, SaveRestoreUtility> Children() { return children; }
+  std::map<std::string, SaveRestoreUtility>& Children() { return children; }
 
  private:
   /**
@@ -162,6 +206,30 @@ class SaveRestoreUtility
    * ReadFile reads an XML tree recursively.
    */
   void ReadFile(xmlNode* n);
+
+  /**
+   * Write this node (and its children) in the binary format.  The given offset
+   * is the position of the stream from the start of the file, and is updated.
+   */
+  void WriteBinary(std::ostream& stream, size_t& offset) const;
+
+  /**
+   * Read this node (and its children) in the binary format, starting at the
+   * given position; the position is moved to the end of the node.  Returns
+   * false if the data is not a valid node.
+   */
+  bool ReadBinary(const char* begin, const char*& position, const char* end);
+
+  /**
+   * Convert the given matrix to CSV text, for the XML format.
+   */
+  static std::string MatrixToText(const MatrixParameter& matrix);
+
+  /**
+   * Return whether the given text holds a sparse matrix in coordinate format
+   * (as written by SaveParameter() for sparse matrices) instead of CSV.
+   */
+  static bool IsCoordinateText(const std::string& text);
 };
 
 } /* namespace util */
@@ -3,7 +3,7 @@
  * @author Neil Slagle
  *
  * The SaveRestoreUtility provides helper functions in saving and
- *   restoring models.  The current output file type is XML.
+ *   restoring models.  Models are stored as XML or in a binary format.
  */
 #ifndef __MLPACK_CORE_UTIL_SAVE_RESTORE_UTILITY_IMPL_HPP
 #define __MLPACK_CORE_UTIL_SAVE_RESTORE_UTILITY_IMPL_HPP
@@ -12,6 +12,8 @@
 #include "save_restore_utility.hpp"
 #include "log.hpp"
 
+#include <cstring>
+
 namespace mlpack {
 namespace util {
 
@@ -50,14 +52,51 @@ arma::Mat<eT>& SaveRestoreUtility::LoadParameter(
     arma::Mat<eT>& t,
     const std::string& name) const
 {
+  // If the matrix is held in binary form with the same element type, it can
+  // just be copied.
+  std::map<std::string, MatrixParameter>::const_iterator matrixIt =
+      matrices.find(name);
+  if (matrixIt != matrices.end() &&
+      (*matrixIt).second.type == arma::diskio::gen_bin_header(t))
+  {
+    const MatrixParameter& matrix = (*matrixIt).second;
+    if (matrix.elements.size() % sizeof(eT) != 0 ||
+        matrix.elements.size() / sizeof(eT) != matrix.rows * matrix.cols)
+    {
+      Log::Fatal << "LoadParameter(): error while loading node '" << name
+          << "': the size of the matrix is wrong.\n";
+    }
+
+    t.set_size(matrix.rows, matrix.cols);
+    if (t.n_elem > 0)
+      memcpy(t.memptr(), matrix.elements.data(), matrix.elements.size());
+
+    return t;
+  }
+
+  // Otherwise the matrix is parsed from text; this is the case for matrices
+  // read from XML, and for matrices of another element type.
   std::map<std::string, std::string>::const_iterator it = parameters.find(name);
-  if (it != parameters.end())
+  if (matrixIt != matrices.end() || it != parameters.end())
   {
-    std::string value = (*it).second;
+    std::string value = (matrixIt != matrices.end()) ?
+        MatrixToText((*matrixIt).second) : (*it).second;
     std::istringstream input(value);
 
+    // A sparse matrix can be loaded as a dense matrix too.
     std::string err; // Store a possible error message.
-    if (!arma::diskio::load_csv_ascii(t, input, err))
+    if (matrixIt == matrices.end() && IsCoordinateText(value))
+    {
+      arma::SpMat<eT> sparse;
+      if (!arma::diskio::load_coord_ascii(sparse, input, err))
+      {
+        Log::Fatal << "LoadParameter(): error while loading node '" << name
+            << "': " << err << ".\n";
+      }
+
+      t = arma::Mat<eT>(sparse);
+    }
+    else if (!arma::diskio::load_csv_ascii(t, input, err))
     {
       Log::Fatal << "LoadParameter(): error while loading node '" << name
           << "': " << err << ".\n";
@@ -77,6 +116,15 @@ arma::SpMat<eT>& SaveRestoreUtility::LoadParameter(
     arma::SpMat<eT>& t,
     const std::string& name) const
 {
+  // A dense matrix can be loaded as a sparse matrix too.
+  if (matrices.find(name) != matrices.end())
+  {
+    arma::Mat<eT> dense;
+    LoadParameter(dense, name);
+    t = arma::SpMat<eT>(dense);
+    return t;
+  }
+
   std::map<std::string, std::string>::const_iterator it = parameters.find(name);
   if (it != parameters.end())
   {
@@ -127,16 +175,20 @@ void SaveRestoreUtility::SaveParameter(
     const arma::Base<eT, T1>& t,
     const std::string& name)
 {
-  // Create a matrix to give to save_csv_ascii().  This may incur a copy,
-  // depending on the compiler's intelligence.  But the disk bandwidth is going
-  // to be the main slowdown anyway...
+  // Evaluate the expression into a matrix.  This may incur a copy, depending
+  // on the compiler's intelligence.
   arma::Mat<eT> temp(t.get_ref());
 
-  // Use save_csv_ascii().  This is *slightly* imprecise and it may be better to
-  // store this raw.  But this is readable...
-  std::ostringstream output;
-  arma::diskio::save_csv_ascii(temp, output);
-  parameters[name] = output.str();
+  // Hold the raw elements; they are only converted to text if the model is
+  // written as XML.
+  MatrixParameter& matrix = matrices[name];
+  matrix.type = arma::diskio::gen_bin_header(temp);
+  matrix.rows = temp.n_rows;
+  matrix.cols = temp.n_cols;
+  matrix.elements.assign((const char*) temp.memptr(),
+      temp.n_elem * sizeof(eT));
+
+  parameters.erase(name);
 }
 
 // Print sparse Armadillo matrices specially, in order to preserve precision.
@@ -156,6 +208,8 @@ void SaveRestoreUtility::SaveParameter(
   std::ostringstream output;
   arma::diskio::save_coord_ascii(temp, output);
   parameters[name] = output.str();
+
+  matrices.erase(name);
 }
 
 template<typename T>
@@ -171,6 +225,8 @@ void SaveRestoreUtility::SaveParameter(
   // store this as an actual binary number.
   output << std::setprecision(15) << t;
   parameters[name] = output.str();
+
+  matrices.erase(name);
 }
 
 template<typename T>
@@ -185,6 +241,8 @@ void SaveRestoreUtility::SaveParameter(const std::vector<T>& t,
   std::string vectorAsStr = output.str();
   vectorAsStr.erase(vectorAsStr.length() - 1);
   parameters[name] = vectorAsStr;
+
+  matrices.erase(name);
 }
 
 }; // namespace util
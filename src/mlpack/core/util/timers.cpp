@@ -9,24 +9,278 @@
 #include "cli.hpp"
 #include "log.hpp"
 
+#include <atomic>
+#include <cmath>
+#include <limits>
 #include <map>
 #include <string>
+#include <stdint.h>
 
 using namespace mlpack;
 
-// On Windows machines, we need to define timersub.
-#ifdef _WIN32
-inline void timersub(const timeval* tvp, const timeval* uvp, timeval* vvp)
+namespace {
+
+//! The number of histogram buckets per doubling of the run time; the width of
+//! a bucket is about 4%, so percentiles are accurate to about 2%.
+const size_t bucketsPerOctave = 16;
+//! The number of histogram buckets (enough for any 64-bit number of
+//! nanoseconds).
+const size_t buckets = 64 * bucketsPerOctave;
+
+//! The identifier of the next Timers object.
+std::atomic<size_t> nextTimersId(1);
+
+//! Return whether the given path belongs to the given timer name or path.
+bool PathMatches(const std::string& path, const std::string& name)
+{
+  if (path.size() < name.size() ||
+      path.compare(path.size() - name.size(), name.size(), name) != 0)
+    return false;
+
+  return (path.size() == name.size() ||
+      path[path.size() - name.size() - 1] == '/');
+}
+
+//! Print the given string as a JSON string.
+void PrintJSONString(std::ostream& stream, const std::string& str)
 {
-  vvp->tv_sec = tvp->tv_sec - uvp->tv_sec;
-  vvp->tv_usec = tvp->tv_usec - uvp->tv_usec;
-  if (vvp->tv_usec < 0)
+  stream << '"';
+  for (size_t i = 0; i < str.size(); ++i)
   {
-     --vvp->tv_sec;
-     vvp->tv_usec += 1000000;
+    const char c = str[i];
+    if (c == '"' || c == '\\')
+    {
+      stream << '\\' << c;
+    }
+    else if ((unsigned char) c < 0x20)
+    {
+      const char* hex = "0123456789abcdef";
+      stream << "\\u00" << hex[(c >> 4) & 0xF] << hex[c & 0xF];
+    }
+    else
+    {
+      stream << c;
+    }
   }
+  stream << '"';
 }
-#endif
+
+} // anonymous namespace
+
+/**
+ * The accumulated runs of a timer: the number of runs, their total, the
+ * shortest and longest run, and, if percentiles are enabled, a histogram of the
+ * run times with buckets of logarithmically increasing width, which gives the
+ * percentiles.
+ */
+struct Timers::Record
+{
+  Record() :
+      count(0),
+      threads(0),
+      total(0),
+      min(std::numeric_limits<uint64_t>::max()),
+      max(0)
+  { }
+
+  //! Add a run of the given number of nanoseconds.
+  void Add(const uint64_t nanoseconds, const bool withHistogram)
+  {
+    ++count;
+    total += nanoseconds;
+    min = std::min(min, nanoseconds);
+    max = std::max(max, nanoseconds);
+
+    if (withHistogram)
+    {
+      if (histogram.empty())
+        histogram.resize(buckets, 0);
+      ++histogram[Bucket(nanoseconds)];
+    }
+  }
+
+  //! Add the runs of another record.
+  void Merge(const Record& other)
+  {
+    if (other.count == 0)
+      return;
+
+    count += other.count;
+    threads += std::max(other.threads, size_t(1));
+    total += other.total;
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+
+    if (!other.histogram.empty())
+    {
+      if (histogram.empty())
+        histogram.resize(buckets, 0);
+      for (size_t i = 0; i < buckets; ++i)
+        histogram[i] += other.histogram[i];
+    }
+  }
+
+  //! Get the given quantile of the run times, in nanoseconds (0 if there is no
+  //! histogram).
+  double Quantile(const double q) const
+  {
+    if (count == 0 || histogram.empty())
+      return 0.0;
+
+    // The histogram may not hold every run, if percentiles were enabled after
+    // the timer was first run.
+    uint64_t histogramCount = 0;
+    for (size_t i = 0; i < buckets; ++i)
+      histogramCount += histogram[i];
+
+    const uint64_t target = std::max(uint64_t(1),
+        (uint64_t) std::ceil(q * histogramCount));
+    uint64_t seen = 0;
+    size_t bucket = 0;
+    for (; bucket < buckets; ++bucket)
+    {
+      seen += histogram[bucket];
+      if (seen >= target)
+        break;
+    }
+
+    // Use the geometric middle of the bucket, but never go outside the range
+    // of the runs.
+    const double value = std::pow(2.0, (bucket + 0.5) / bucketsPerOctave);
+    return std::min(std::max(value, double(min)), double(max));
+  }
+
+  //! Get the statistics, in seconds.
+  TimerStatistics Statistics() const
+  {
+    TimerStatistics s;
+    s.count = count;
+    s.total = total * 1e-9;
+    s.min = (count == 0) ? 0.0 : (min * 1e-9);
+    s.max = max * 1e-9;
+    s.p50 = Quantile(0.5) * 1e-9;
+    s.p99 = Quantile(0.99) * 1e-9;
+    return s;
+  }
+
+  //! Get the total as a timeval.
+  timeval Total() const
+  {
+    timeval t;
+    t.tv_sec = (long) (total / 1000000000);
+    t.tv_usec = (long) ((total % 1000000000) / 1000);
+    return t;
+  }
+
+  //! Get the histogram bucket of the given number of nanoseconds.
+  static size_t Bucket(const uint64_t nanoseconds)
+  {
+    if (nanoseconds <= 1)
+      return 0;
+
+    return std::min(buckets - 1, (size_t) (bucketsPerOctave *
+        std::log2((double) nanoseconds)));
+  }
+
+  //! The name the timer was started with (the last part of its path).
+  std::string name;
+  //! The number of runs.
+  size_t count;
+  //! The number of threads the runs happened on (set when merging).
+  size_t threads;
+  //! The total time of all runs, in nanoseconds.
+  uint64_t total;
+  //! The shortest run, in nanoseconds.
+  uint64_t min;
+  //! The longest run, in nanoseconds.
+  uint64_t max;
+  //! The number of runs in each bucket (empty unless percentiles are enabled).
+  std::vector<uint64_t> histogram;
+};
+
+/**
+ * A timer of one thread at one path.  The timers started while it is running
+ * are its children, so the nodes of a thread form a tree whose paths are the
+ * paths of the timers; the path strings are only built when the timers are
+ * reported.
+ */
+struct Timers::Node
+{
+  Node() : lastChild(NULL) { }
+
+  //! Get the child with the given name, creating it if necessary.
+  Node* Child(const std::string& name)
+  {
+    // The same timer is usually started again and again in a loop.
+    if (lastChild != NULL && lastChild->record.name == name)
+      return lastChild;
+
+    for (size_t i = 0; i < children.size(); ++i)
+    {
+      if (children[i]->record.name == name)
+      {
+        lastChild = children[i].get();
+        return lastChild;
+      }
+    }
+
+    children.push_back(std::unique_ptr<Node>(new Node()));
+    lastChild = children.back().get();
+    lastChild->record.name = name;
+    return lastChild;
+  }
+
+  //! Add the record of this node and its descendants to the given map, by
+  //! path.
+  void CollectPaths(const std::string& path,
+                    std::map<std::string, Record>& byPath) const
+  {
+    for (size_t i = 0; i < children.size(); ++i)
+    {
+      const Node& child = *children[i];
+      const std::string childPath = path.empty() ? child.record.name :
+          (path + "/" + child.record.name);
+
+      // A timer that is still running for the first time has no runs yet.
+      if (child.record.count > 0)
+      {
+        Record& record = byPath[childPath];
+        record.name = child.record.name;
+        record.Merge(child.record);
+      }
+
+      child.CollectPaths(childPath, byPath);
+    }
+  }
+
+  //! The runs of the timer (unused for the root).
+  Record record;
+  //! The timers started while this one was running.
+  std::vector<std::unique_ptr<Node> > children;
+  //! The child that was last started.
+  Node* lastChild;
+};
+
+/**
+ * The timers of one thread: the tree of timers, and the timers that are
+ * running.  Only its own thread modifies it.
+ */
+struct Timers::ThreadTimers
+{
+  //! A running timer.
+  struct Running
+  {
+    //! The node of the timer.
+    Node* node;
+    //! The time the timer was started.
+    std::chrono::steady_clock::time_point start;
+  };
+
+  //! The root of the tree of timers (not itself a timer).
+  Node root;
+  //! The running timers, in the order they were started.
+  std::vector<Running> running;
+};
 
 /**
  * Start the given timer.
@@ -52,19 +306,63 @@ timeval Timer::Get(const std::string& name)
   return CLI::GetSingleton().timer.GetTimer(name);
 }
 
+/**
+ * Get the statistics of the given timer.
+ */
+TimerStatistics Timer::GetStatistics(const std::string& name)
+{
+  return CLI::GetSingleton().timer.GetStatistics(name);
+}
+
+/**
+ * Keep histograms of the run times from now on.
+ */
+void Timer::EnablePercentiles()
+{
+  CLI::GetSingleton().timer.EnablePercentiles();
+}
+
+Timers::Timers() : id(nextTimersId++), percentiles(false)
+{
+  // Nothing else to do.
+}
+
+Timers::~Timers()
+{
+  // The timers of each thread are released when both this object and the
+  // thread are done with them.
+}
+
 std::map<std::string, timeval>& Timers::GetAllTimers()
 {
+  const std::map<std::string, Record> byPath = CollectPaths();
+
+  std::map<std::string, Record> byName;
+  std::map<std::string, Record>::const_iterator it;
+  for (it = byPath.begin(); it != byPath.end(); ++it)
+    byName[(*it).second.name].Merge((*it).second);
+
+  timers.clear();
+  for (it = byName.begin(); it != byName.end(); ++it)
+    timers[(*it).first] = (*it).second.Total();
+
   return timers;
 }
 
 timeval Timers::GetTimer(const std::string& timerName)
 {
-  return timers[timerName];
+  return Collect(timerName).Total();
+}
+
+TimerStatistics Timers::GetStatistics(const std::string& timerName)
+{
+  return Collect(timerName).Statistics();
 }
 
 void Timers::PrintTimer(const std::string& timerName)
 {
-  timeval& t = timers[timerName];
+  const Record record = Collect(timerName);
+  const timeval t = record.Total();
   Log::Info << t.tv_sec << "." << std::setw(6) << std::setfill('0')
       << t.tv_usec << "s";
 
@@ -114,143 +412,126 @@ void Timers::PrintTimer(const std::string& timerName)
     Log::Info << ")";
   }
 
+  // For timers that were run many times, the distribution is interesting too.
+  if (record.count > 1 && !record.histogram.empty())
+  {
+    const TimerStatistics s = record.Statistics();
+    Log::Info << " [" << s.count << " runs; median " << s.p50 << "s, 99th "
+        << "percentile " << s.p99 << "s]";
+  }
+
   Log::Info << std::endl;
 }
 
-void Timers::GetTime(timeval* tv)
+void Timers::PrintJSON(std::ostream& stream)
 {
-#if defined(__MACH__) && defined(__APPLE__)
-
-  static mach_timebase_info_data_t info;
-
-  // If this is the first time we've run, get the timebase.
-  // We can use denom == 0 to indicate that sTimebaseInfo is
-  // uninitialised.
-  if (info.denom == 0) {
-    (void) mach_timebase_info(&info);
-  }
+  // Add up the runs of each path over all threads.
+  const std::map<std::string, Record> byPath = CollectPaths();
 
-  // Hope that the multiplication doesn't overflow.
-  uint64_t nsecs = mach_absolute_time() * info.numer / info.denom;
-  tv->tv_sec = nsecs / 1e9;
-  tv->tv_usec = (nsecs / 1e3) - (tv->tv_sec * 1e6);
-
-#elif defined(_POSIX_VERSION)
-#if defined(_POSIX_TIMERS) && (_POSIX_TIMERS > 0)
-
-  // Get the right clock_id.
-#if defined(CLOCK_MONOTONIC_PRECISE)
-  static const clockid_t id = CLOCK_MONOTONIC_PRECISE;
-#elif defined(CLOCK_MONOTONIC_RAW)
-  static const clockid_t id = CLOCK_MONOTONIC_RAW;
-#elif defined(CLOCK_MONOTONIC)
-  static const clockid_t id = CLOCK_MONOTONIC;
-#elif defined(CLOCK_REALTIME)
-  static const clockid_t id = CLOCK_REALTIME;
-#else
-  static const clockid_t id = ((clockid_t) - 1);
-#endif // CLOCK
-
-  struct timespec ts;
-
-  // Returns the current value tp for the specified clock_id.
-  if (clock_gettime(id, &ts) != -1 && id != ((clockid_t) - 1))
+  const std::streamsize precision = stream.precision(9);
+  stream << "{" << std::endl << "  \"timers\": {";
+  std::map<std::string, Record>::const_iterator it;
+  for (it = byPath.begin(); it != byPath.end(); ++it)
   {
-    tv->tv_sec = ts.tv_sec;
-    tv->tv_usec = ts.tv_nsec / 1e3;
+    const TimerStatistics s = (*it).second.Statistics();
+    stream << ((it == byPath.begin()) ? "" : ",") << std::endl << "    ";
+    PrintJSONString(stream, (*it).first);
+    stream << ": { \"count\": " << s.count << ", \"threads\": "
+        << (*it).second.threads << ", \"total\": " << s.total << ", \"min\": "
+        << s.min << ", \"max\": " << s.max << ", \"mean\": "
+        << (s.total / s.count);
+    if (!(*it).second.histogram.empty())
+      stream << ", \"p50\": " << s.p50 << ", \"p99\": " << s.p99;
+    stream << " }";
   }
+  stream << std::endl << "  }" << std::endl << "}" << std::endl;
+  stream.precision(precision);
+}
 
-  // Fallback for the clock_gettime function.
-  gettimeofday(tv, NULL);
-
-#endif  // _POSIX_TIMERS
-#elif defined(_WIN32)
+void Timers::StartTimer(const std::string& timerName)
+{
+  ThreadTimers& local = Local();
 
-  static double frequency = 0.0;
-  static LARGE_INTEGER offset;
+  Node* parent = local.running.empty() ? &local.root :
+      local.running.back().node;
 
-  // If this is the first time we've run, get the frequency.
-  // We use frequency == 0.0 to indicate that
-  // QueryPerformanceFrequency is uninitialised.
-  if (frequency == 0.0)
-  {
-    LARGE_INTEGER pF;
-    if (!QueryPerformanceFrequency(&pF))
-    {
-      // Fallback for the QueryPerformanceCounter function.
-      FileTimeToTimeVal(tv);
-    }
-    else
-    {
-      QueryPerformanceCounter(&offset);
-      frequency = (double)pF.QuadPart / 1000000.0;
-    }
-  }
+  ThreadTimers::Running running;
+  running.node = parent->Child(timerName);
+  local.running.push_back(running);
 
-  if (frequency != 0.0)
-  {
-    LARGE_INTEGER pC;
-    // Get the current performance-counter value.
-    QueryPerformanceCounter(&pC);
-
-    pC.QuadPart -= offset.QuadPart;
-    double microseconds = (double)pC.QuadPart / frequency;
-    pC.QuadPart = microseconds;
-    tv->tv_sec = (long)pC.QuadPart / 1000000;
-    tv->tv_usec = (long)(pC.QuadPart % 1000000);
-  }
-
-#endif
+  // Take the time last, so the bookkeeping isn't timed.
+  local.running.back().start = std::chrono::steady_clock::now();
 }
 
-void Timers::StartTimer(const std::string& timerName)
+void Timers::StopTimer(const std::string& timerName)
 {
-  timeval tmp;
-  tmp.tv_sec = 0;
-  tmp.tv_usec = 0;
+  // Take the time first, so the bookkeeping isn't timed.
+  const std::chrono::steady_clock::time_point now =
+      std::chrono::steady_clock::now();
+
+  ThreadTimers& local = Local();
+
+  // Find the most recently started timer with this name; usually it is the
+  // last one.
+  size_t i = local.running.size();
+  while (i > 0 && local.running[i - 1].node->record.name != timerName)
+    --i;
+  if (i == 0)
+    return;
+
+  const ThreadTimers::Running& running = local.running[i - 1];
+  running.node->record.Add(
+      (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+      now - running.start).count(), percentiles);
+
+  local.running.erase(local.running.begin() + (i - 1));
+}
 
-  GetTime(&tmp);
+Timers::ThreadTimers& Timers::Local()
+{
+  // Each thread remembers its timers for the last Timers object it used.
+  static thread_local size_t owner = 0;
+  static thread_local std::shared_ptr<ThreadTimers> state;
 
-  // Check to see if the timer already exists.  If it does, we'll subtract the
-  // old value.
-  if (timers.count(timerName) == 1)
+  if (owner != id)
   {
-    timeval tmpDelta;
-
-    timersub(&tmp, &timers[timerName], &tmpDelta);
+    state.reset(new ThreadTimers());
+    owner = id;
 
-    tmp = tmpDelta;
+    // This is the only time a thread takes the lock.
+    std::lock_guard<std::mutex> guard(lock);
+    threads.push_back(state);
   }
 
-  timers[timerName] = tmp;
+  return *state;
 }
 
-#ifdef _WIN32
-void Timers::FileTimeToTimeVal(timeval* tv)
+std::map<std::string, Timers::Record> Timers::CollectPaths()
 {
-  FILETIME ftime;
-  uint64_t ptime = 0;
-  // Acquire the file time.
-  GetSystemTimeAsFileTime(&ftime);
-  // Now convert FILETIME to timeval.
-  ptime |= ftime.dwHighDateTime;
-  ptime = ptime << 32;
-  ptime |= ftime.dwLowDateTime;
-  ptime /= 10;
-  ptime -= DELTA_EPOCH_IN_MICROSECS;
-
-  tv->tv_sec = (long) (ptime / 1000000UL);
-  tv->tv_usec = (long) (ptime % 1000000UL);
+  std::vector<std::shared_ptr<ThreadTimers> > allThreads;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    allThreads = threads;
+  }
+
+  std::map<std::string, Record> byPath;
+  for (size_t i = 0; i < allThreads.size(); ++i)
+    allThreads[i]->root.CollectPaths("", byPath);
+
+  return byPath;
 }
-#endif // _WIN32
 
-void Timers::StopTimer(const std::string& timerName)
+Timers::Record Timers::Collect(const std::string& timerName)
 {
-  timeval delta, b, a = timers[timerName];
+  const std::map<std::string, Record> byPath = CollectPaths();
 
-  GetTime(&b);
+  Record result;
+  std::map<std::string, Record>::const_iterator it;
+  for (it = byPath.begin(); it != byPath.end(); ++it)
+  {
+    if ((*it).second.name == timerName || PathMatches((*it).first, timerName))
+      result.Merge((*it).second);
+  }
 
-  // Calculate the delta time.
-  timersub(&b, &a, &delta);
-  timers[timerName] = delta;
+  return result;
 }
@@ -8,56 +8,65 @@
 #ifndef __MLPACK_CORE_UTILITIES_TIMERS_HPP
 #define __MLPACK_CORE_UTILITIES_TIMERS_HPP
 
+#include <atomic>
+#include <chrono>
+#include <iostream>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
-#if defined(__unix__) || defined(__unix)
-  #include <time.h>       // clock_gettime()
-  #include <sys/time.h>   // timeval, gettimeofday()
-  #include <unistd.h>     // flags like  _POSIX_VERSION
-#elif defined(__MACH__) && defined(__APPLE__)
-  #include <mach/mach_time.h>   // mach_timebase_info,
-                                // mach_absolute_time()
-
-  // TEMPORARY
-  #include <time.h>       // clock_gettime()
-  #include <sys/time.h>   // timeval, gettimeofday()
-  #include <unistd.h>     // flags like  _POSIX_VERSION
-#elif defined(_WIN32)
+#if defined(_WIN32)
   #ifndef NOMINMAX
     #define NOMINMAX // Don't define min and max macros.
   #endif
-  #include <windows.h>  // GetSystemTimeAsFileTime(),
-                        // QueryPerformanceFrequency(),
-                        // QueryPerformanceCounter()
   #include <winsock.h>  // timeval on windows
   #undef NOMINMAX
-
-  // uint64_t isn't defined on every windows.
-  #if !defined(HAVE_UINT64_T)
-    #if SIZEOF_UNSIGNED_LONG == 8
-      typedef unsigned long uint64_t;
-    #else
-      typedef unsigned long long  uint64_t;
-    #endif  // SIZEOF_UNSIGNED_LONG
-  #endif  // HAVE_UINT64_T
-
-  //gettimeofday has no equivalent will need to write extra code for that.
-  #if defined(_MSC_VER) || defined(_MSC_EXTENSIONS)
-    #define DELTA_EPOCH_IN_MICROSECS 11644473600000000Ui64
-  #else
-    #define DELTA_EPOCH_IN_MICROSECS 11644473600000000ULL
-  #endif // _MSC_VER, _MSC_EXTENSIONS
 #else
-  #error "unknown OS"
+  #include <sys/time.h> // timeval
 #endif
 
 namespace mlpack {
 
 /**
- * The timer class provides a way for MLPACK methods to be timed.  The three
- * methods contained in this class allow a named timer to be started and
- * stopped, and its value to be obtained.
+ * Statistics of a timer over every time it was run.  All times are in seconds.
+ */
+struct TimerStatistics
+{
+  //! The number of times the timer was run.
+  size_t count;
+  //! The total time of all runs.
+  double total;
+  //! The shortest run.
+  double min;
+  //! The longest run.
+  double max;
+  //! The median run time (accurate to about 2%; 0 unless percentiles are
+  //! enabled).
+  double p50;
+  //! The 99th percentile of the run time (accurate to about 2%; 0 unless
+  //! percentiles are enabled).
+  double p99;
+};
+
+/**
+ * The timer class provides a way for MLPACK methods to be timed.  The methods
+ * contained in this class allow a named timer to be started and stopped, and
+ * its value to be obtained.
+ *
+ * Timers may be used from any thread, including inside OpenMP parallel
+ * regions; each thread keeps its own timers without any locking, and the values
+ * reported are the sums over all threads (so a timer run on four threads at
+ * once for one second reports four seconds).  The timers of other threads are
+ * only read when the timers are reported, so a timer should not be read while
+ * another thread is still running timers.
+ *
+ * Timers nest: a timer started while another timer is running on the same
+ * thread is recorded under the path of the running timers, like
+ * "tree_building/split".  Get() and GetStatistics() accept either a plain name,
+ * which collects the timer from every path it was run under, or a path (or the
+ * end of a path).
  */
 class Timer
 {
@@ -68,78 +77,169 @@ class Timer
    * both runs -- that is, MLPACK timers are additive for each time they are
    * run, and do not reset.
    *
-   * @note Undefined behavior will occur if a timer is started twice.
-   *
    * @param name Name of timer to be started.
    */
   static void Start(const std::string& name);
 
   /**
-   * Stop the given timer.
-   *
-   * @note Undefined behavior will occur if a timer is started twice.
+   * Stop the given timer.  Stopping a timer that is not running on this thread
+   * does nothing.
    *
    * @param name Name of timer to be stopped.
    */
   static void Stop(const std::string& name);
 
   /**
-   * Get the value of the given timer.
+   * Get the value of the given timer: the total time of all of its completed
+   * runs.
    *
-   * @param name Name of timer to return value of.
+   * @param name Name (or path) of timer to return value of.
    */
   static timeval Get(const std::string& name);
+
+  /**
+   * Get the number of runs, total time and percentiles of the given timer.
+   *
+   * @param name Name (or path) of timer to return statistics of.
+   */
+  static TimerStatistics GetStatistics(const std::string& name);
+
+  /**
+   * Keep a histogram of the run times of every timer from now on, so that the
+   * percentiles are available.  This costs some memory for each timer, so it
+   * is off by default; it is turned on by the --timer_file option.
+   */
+  static void EnablePercentiles();
+};
+
+/**
+ * A timer which is started when it is constructed and stopped when it goes out
+ * of scope, which is convenient for timing a block of code (or a function with
+ * many returns).
+ *
+ * @code
+ * {
+ *   ScopedTimer t("tree_building");
+ *   // Build the tree...
+ * }
+ * @endcode
+ */
+class ScopedTimer
+{
+ public:
+  //! Start the given timer.
+  ScopedTimer(const std::string& name) : name(name) { Timer::Start(name); }
+  //! Stop the timer.
+  ~ScopedTimer() { Timer::Stop(name); }
+
+ private:
+  //! The name of the timer.
+  std::string name;
 };
 
 class Timers
 {
  public:
-  //! Nothing to do for the constructor.
-  Timers() { }
+  //! Create an empty set of timers.
+  Timers();
+
+  //! Release the timers of every thread.
+  ~Timers();
 
   /**
-   * Returns a copy of all the timers used via this interface.
+   * Returns all the timers used via this interface, by name (the runs under
+   * every path are added up).  The map is brought up to date by every call.
    */
   std::map<std::string, timeval>& GetAllTimers();
 
   /**
    * Returns a copy of the timer specified.
    *
-   * @param timerName The name of the timer in question.
+   * @param timerName The name (or path) of the timer in question.
    */
   timeval GetTimer(const std::string& timerName);
 
+  /**
+   * Returns the statistics of the timer specified.
+   *
+   * @param timerName The name (or path) of the timer in question.
+   */
+  TimerStatistics GetStatistics(const std::string& timerName);
+
   /**
    * Prints the specified timer.  If it took longer than a minute to complete
-   * the timer will be displayed in days, hours, and minutes as well.
+   * the timer will be displayed in days, hours, and minutes as well.  If it was
+   * run more than once, the number of runs and the median and 99th percentile
+   * run times are displayed too.
    *
    * @param timerName The name of the timer in question.
    */
   void PrintTimer(const std::string& timerName);
 
   /**
-   * Initializes a timer, available like a normal value specified on
-   * the command line.  Timers are of type timeval.  If a timer is started, then
-   * stopped, then re-started, then stopped, the final timer value will be the
-   * length of both runs of the timer.
-   *
-   * @param timerName The name of the timer in question.
-   */
+   * Print every timer, by path, as a JSON object.  Each timer has its number of
+   * runs, the number of threads it was run on, and its total, shortest,
+   * longest, mean, median and 99th percentile run time in seconds.
+   *
+   * @param stream Stream to print to.
+   */
+  void PrintJSON(std::ostream& stream);
+
+  /**
+   * Initializes a timer, available like a normal value specified on
+   * the command line.  If a timer is started, then stopped, then re-started,
+   * then stopped, the final timer value will be the length of both runs of the
+   * timer.
+   *
+   * @param timerName The name of the timer in question.
+   */
   void StartTimer(const std::string& timerName);
 
   /**
-   * Halts the timer, and replaces it's value with
-   * the delta time from it's start
-   *
-   * @param timerName The name of the timer in question.
-   */
+   * Halts the timer, and adds the time since it was started to it.
+   *
+   * @param timerName The name of the timer in question.
+   */
   void StopTimer(const std::string& timerName);
 
+  /**
+   * Keep a histogram of the run times of every timer from now on, so that the
+   * percentiles are available.
+   */
+  void EnablePercentiles() { percentiles = true; }
+
  private:
+  //! The timers of a single thread.
+  struct ThreadTimers;
+  //! A timer of a single thread, at one path.
+  struct Node;
+  //! The accumulated runs of a timer.
+  struct Record;
+
+  //! Get the timers of the calling thread, creating them if necessary.
+  ThreadTimers& Local();
+
+  //! Add up the runs of every timer whose path matches the given name.
+  Record Collect(const std::string& timerName);
+
+  //! Add up the runs of every timer of every thread, by path.
+  std::map<std::string, Record> CollectPaths();
+
+  //! A unique identifier, so threads can tell different Timers apart.
+  size_t id;
+  //! Whether or not to keep histograms of the run times.
+  std::atomic<bool> percentiles;
+  //! The totals returned by GetAllTimers().
   std::map<std::string, timeval> timers;
-
-  void FileTimeToTimeVal(timeval* tv);
-  void GetTime(timeval* tv);
+  //! Protects the list of threads.
+  std::mutex lock;
+  //! The timers of every thread that has used a timer.
+  std::vector<std::shared_ptr<ThreadTimers> > threads;
+
+  //! Copying would share the timers of each thread.
+  Timers(const Timers& other);
+  //! Copying would share the timers of each thread.
+  Timers& operator=(const Timers& other);
 };
 
 }; // namespace mlpack
@@ -181,6 +181,9 @@ class CF
 
   /**
    * Generates the given number of recommendations for the specified users.
+   * The estimated ratings are computed for blocks of users at once with one
+   * matrix multiplication, and with OpenMP, the blocks are split between
+   * threads.
    *
    * @param numRecs Number of Recommendations
    * @param recommendations Matrix to save recommendations
@@ -238,20 +241,12 @@ class CF
   arma::sp_mat cleanedData;
 
   /**
-   * Helper function to insert a point into the recommendation matrices.
-   *
-   * @param queryIndex Index of point whose recommendations we are inserting
-   *     into.
-   * @param pos Position in list to insert into.
-   * @param neighbor Index of item being inserted as a recommendation.
-   * @param value Value of recommendation.
+   * Comparator for the heap of candidate recommendations, which are (estimated
+   * rating, item) pairs; a candidate is better than another if it has a higher
+   * rating, or the same rating and a lower item index.
    */
-  void InsertNeighbor(const size_t queryIndex,
-                      const size_t pos,
-                      const size_t neighbor,
-                      const double value,
-                      arma::Mat<size_t>& recommendations,
-                      arma::mat& values) const;
+  static bool BetterRecommendation(const std::pair<double, size_t>& a,
+                                   const std::pair<double, size_t>& b);
 
 }; // class CF
 
@@ -191,55 +191,107 @@ void CF<FactorizerType>::GetRecommendations(const size_t numRecs,
   arma::mat resultingDistances; // Temporary storage.
   a.Search(query, numUsersForSimilarity, neighborhood, resultingDistances);
 
-  // Generate recommendations for each query user by finding the maximum numRecs
-  // elements in the averages matrix.
+  // The estimated rating of each item for a query user is the average of the
+  // ratings of its neighbors, W * h.col(neighbor).  That is W times the average
+  // of the neighbors' columns of H, so we average those first, and then compute
+  // the estimated ratings of a block of users at once with one matrix
+  // multiplication.  The blocks are kept small enough that the ratings of a
+  // block (one column per user) take at most 16MB, even with many items.
+  const size_t blockSize = std::max((size_t) 1, std::min((size_t) 128,
+      (size_t) (1 << 21) / std::max((size_t) 1, (size_t) w.n_rows)));
+  const size_t numBlocks = (users.n_elem + blockSize - 1) / blockSize;
+
   recommendations.set_size(numRecs, users.n_elem);
   recommendations.fill(cleanedData.n_rows); // Invalid item number.
-  arma::mat values(numRecs, users.n_elem);
-  values.fill(-DBL_MAX); // The smallest possible value.
-  for (size_t i = 0; i < users.n_elem; i++)
+
+  // Whether we could find numRecs un-rated items for each user; the warnings
+  // are issued outside of the parallel region.
+  std::vector<char> incomplete(users.n_elem, 0);
+
+  // The users are independent, so each thread takes whole blocks of them.
+  #pragma omp parallel
   {
-    // First, calculate average of neighborhood values.
-    arma::vec averages;
-    averages.zeros(cleanedData.n_rows);
+    arma::mat averageH;
+    arma::mat ratings;
 
-    for (size_t j = 0; j < neighborhood.n_rows; ++j)
-      averages += w * h.col(neighborhood(j, i));
-    averages /= neighborhood.n_rows;
+    // The best numRecs candidates of the current user, kept as a heap whose
+    // top is the worst of them.
+    std::vector<std::pair<double, size_t> > candidates;
+    candidates.reserve(numRecs);
 
-    // Look through the averages column corresponding to the current user.
-    for (size_t j = 0; j < averages.n_rows; ++j)
+    #pragma omp for schedule(dynamic)
+    for (size_t block = 0; block < numBlocks; ++block)
     {
-      // Ensure that the user hasn't already rated the item.
-      if (cleanedData(j, users(i)) != 0.0)
-        continue; // The user already rated the item.
+      const size_t begin = block * blockSize;
+      const size_t count = std::min(blockSize, users.n_elem - begin);
+
+      // First, calculate average of neighborhood values.
+      averageH.zeros(h.n_rows, count);
+      for (size_t i = 0; i < count; ++i)
+      {
+        for (size_t j = 0; j < neighborhood.n_rows; ++j)
+          averageH.col(i) += h.col(neighborhood(j, begin + i));
+        averageH.col(i) /= neighborhood.n_rows;
+      }
 
-      // Is the estimated value better than the worst candidate?
-      const double value = averages[j];
-      if (value > values(values.n_rows - 1, i))
+      ratings = w * averageH;
+
+      for (size_t i = 0; i < count; ++i)
       {
-        // It should be inserted.  Which position?
-        size_t insertPosition = values.n_rows - 1;
-        while (insertPosition > 0)
+        const size_t user = users(begin + i);
+        const double* userRatings = ratings.colptr(i);
+        candidates.clear();
+
+        // Walk the items, skipping the ones the user has already rated; those
+        // are the nonzero rows of the user's column of the data, in order.
+        size_t k = cleanedData.col_ptrs[user];
+        const size_t end = cleanedData.col_ptrs[user + 1];
+        for (size_t j = 0; j < ratings.n_rows; ++j)
         {
-          if (value <= values(insertPosition - 1, i))
-            break; // The current value is the right one.
-          insertPosition--;
+          while (k < end && cleanedData.row_indices[k] < j)
+            ++k;
+          if (k < end && cleanedData.row_indices[k] == j &&
+              cleanedData.values[k] != 0.0)
+            continue; // The user already rated the item.
+
+          // Is the estimated value better than the worst candidate?  If the
+          // values are the same, the item with the lower index wins.
+          const double value = userRatings[j];
+          if (candidates.size() < numRecs)
+          {
+            candidates.push_back(std::make_pair(value, j));
+            std::push_heap(candidates.begin(), candidates.end(),
+                BetterRecommendation);
+          }
+          else if (numRecs > 0 && value > candidates.front().first)
+          {
+            std::pop_heap(candidates.begin(), candidates.end(),
+                BetterRecommendation);
+            candidates.back() = std::make_pair(value, j);
+            std::push_heap(candidates.begin(), candidates.end(),
+                BetterRecommendation);
+          }
         }
 
-        // Now insert it into the list.
-        InsertNeighbor(i, insertPosition, j, value, recommendations,
-            values);
+        // Sorting the heap puts the best recommendation first.
+        std::sort_heap(candidates.begin(), candidates.end(),
+            BetterRecommendation);
+        for (size_t j = 0; j < candidates.size(); ++j)
+          recommendations(j, begin + i) = candidates[j].second;
+
+        if (candidates.size() < numRecs)
+          incomplete[begin + i] = 1;
       }
     }
+  }
 
-    // If we were not able to come up with enough recommendations, issue a
-    // warning.
-    if (recommendations(values.n_rows - 1, i) == cleanedData.n_rows + 1)
-      Log::Warn << "Could not provide " << values.n_rows << " recommendations "
+  // If we were not able to come up with enough recommendations, issue a
+  // warning.
+  for (size_t i = 0; i < users.n_elem; ++i)
+    if (incomplete[i])
+      Log::Warn << "Could not provide " << numRecs << " recommendations "
           << "for user " << users(i) << " (not enough un-rated items)!"
           << std::endl;
-  }
 }
 
 // Predict the rating for a single user/item combination.
@@ -366,36 +418,16 @@ void CF<FactorizerType>::CleanData(const arma::mat& data, arma::sp_mat& cleanedD
 }
 
 /**
- * Helper function to insert a point into the recommendation matrices.
- *
- * @param queryIndex Index of point whose recommendations we are inserting into.
- * @param pos Position in list to insert into.
- * @param neighbor Index of item being inserted as a recommendation.
- * @param value Value of recommendation.
+ * Comparator for the heap of candidate recommendations: a candidate is better
+ * than another if its estimated rating is higher, or if the ratings are equal
+ * and its item index is lower.
  */
 template<typename FactorizerType>
-void CF<FactorizerType>::InsertNeighbor(const size_t queryIndex,
-                                        const size_t pos,
-                                        const size_t neighbor,
-                                        const double value,
-                                        arma::Mat<size_t>& recommendations,
-                                        arma::mat& values) const
+bool CF<FactorizerType>::BetterRecommendation(
+    const std::pair<double, size_t>& a,
+    const std::pair<double, size_t>& b)
 {
-  // We only memmove() if there is actually a need to shift something.
-  if (pos < (recommendations.n_rows - 1))
-  {
-    const int len = (values.n_rows - 1) - pos;
-    memmove(values.colptr(queryIndex) + (pos + 1),
-        values.colptr(queryIndex) + pos,
-        sizeof(double) * len);
-    memmove(recommendations.colptr(queryIndex) + (pos + 1),
-        recommendations.colptr(queryIndex) + pos,
-        sizeof(size_t) * len);
-  }
-
-  // Now put the new information in the right index.
-  values(pos, queryIndex) = value;
-  recommendations(pos, queryIndex) = neighbor;
+  return (a.first > b.first) || (a.first == b.first && a.second < b.second);
 }
 
 // Return string of object.
@@ -27,6 +27,7 @@
 #include <mlpack/core/metrics/lmetric.hpp>
 
 #include <mlpack/core/tree/binary_space_tree.hpp>
+#include <mlpack/core/tree/traversal_statistics.hpp>
 
 namespace mlpack {
 namespace emst /** Euclidean Minimum Spanning Trees. */ {
@@ -110,6 +111,9 @@ class DualTreeBoruvka
   //! The instantiated metric.
   MetricType metric;
 
+  //! The statistics of the tree traversals of the last computation.
+  tree::TraversalStatistics statistics;
+
   //! For sorting the edge list after the computation.
   struct SortEdgesHelper
   {
@@ -169,6 +173,10 @@ class DualTreeBoruvka
    */
   void ComputeMST(arma::mat& results);
 
+  //! Get the statistics of the tree traversals of the last call to
+  //! ComputeMST(), added up over every iteration.
+  const tree::TraversalStatistics& Statistics() const { return statistics; }
+
   /**
    * Returns a string representation of this object.
    */
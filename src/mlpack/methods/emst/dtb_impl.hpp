@@ -112,6 +112,7 @@ void DualTreeBoruvka<MetricType, TreeType>::ComputeMST(arma::mat& results)
   Timer::Start("emst/mst_computation");
 
   totalDist = 0; // Reset distance.
+  statistics.Reset();
 
   typedef DTBRules<MetricType, TreeType> RuleType;
   RuleType rules(data, connections, neighborsDistances, neighborsInComponent,
@@ -129,6 +130,7 @@ void DualTreeBoruvka<MetricType, TreeType>::ComputeMST(arma::mat& results)
     {
       typename TreeType::template DualTreeTraverser<RuleType> traverser(rules);
       traverser.Traverse(*tree, *tree);
+      statistics += traverser.Statistics();
     }
 
     AddAllEdges();
@@ -8,6 +8,7 @@
 #define __MLPACK_METHODS_EMST_DTB_RULES_HPP
 
 #include <mlpack/core.hpp>
+#include <mlpack/core/metrics/block_evaluate.hpp>
 
 #include "../neighbor_search/ns_traversal_info.hpp"
 
@@ -27,6 +28,17 @@ class DTBRules
 
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
 
+  /**
+   * Prepare for the base cases between all points in the given query leaf and
+   * reference leaf.  If the metric supports it (see
+   * metric::BlockEvaluateTraits), the whole block of distances is computed at
+   * once and then used by the following calls to BaseCase().
+   *
+   * @param queryNode Query leaf.
+   * @param referenceNode Reference leaf.
+   */
+  void PrepareBaseCases(TreeType& queryNode, TreeType& referenceNode);
+
   /**
    * Get the score for recursion order.  A low score indicates priority for
    * recursion, while DBL_MAX indicates that the node should not be recursed
@@ -141,6 +153,13 @@ class DTBRules
   //! The instantiated metric.
   MetricType& metric;
 
+  //! Distances between the points of the last prepared leaf pair.
+  arma::mat blockDistances;
+  //! The first query point of the last prepared leaf pair.
+  size_t blockQueryBegin;
+  //! The first reference point of the last prepared leaf pair.
+  size_t blockReferenceBegin;
+
   /**
    * Update the bound for the given query node.
    */
@@ -25,6 +25,8 @@ DTBRules(const arma::mat& dataSet,
   neighborsInComponent(neighborsInComponent),
   neighborsOutComponent(neighborsOutComponent),
   metric(metric),
+  blockQueryBegin(0),
+  blockReferenceBegin(0),
   baseCases(0),
   scores(0)
 {
@@ -49,8 +51,15 @@ double DTBRules<MetricType, TreeType>::BaseCase(const size_t queryIndex,
   if (queryComponentIndex != referenceComponentIndex)
   {
     ++baseCases;
-    double distance = metric.Evaluate(dataSet.col(queryIndex),
-                                      dataSet.col(referenceIndex));
+    // Use the prepared block of distances if this pair is in it.
+    const size_t blockRow = queryIndex - blockQueryBegin;
+    const size_t blockCol = referenceIndex - blockReferenceBegin;
+    double distance;
+    if (blockRow < blockDistances.n_rows && blockCol < blockDistances.n_cols)
+      distance = blockDistances(blockRow, blockCol);
+    else
+      distance = metric.Evaluate(dataSet.col(queryIndex),
+                                 dataSet.col(referenceIndex));
 
     if (distance < neighborsDistances[queryComponentIndex])
     {
@@ -70,6 +79,20 @@ double DTBRules<MetricType, TreeType>::BaseCase(const size_t queryIndex,
   return newUpperBound;
 }
 
+template<typename MetricType, typename TreeType>
+void DTBRules<MetricType, TreeType>::PrepareBaseCases(TreeType& queryNode,
+                                                      TreeType& referenceNode)
+{
+  if (!metric::BlockEvaluateTraits<MetricType, arma::mat>::IsFaster(
+      dataSet.n_rows))
+    return;
+
+  metric::BlockEvaluate(metric, dataSet, queryNode.Begin(), queryNode.Count(),
+      dataSet, referenceNode.Begin(), referenceNode.Count(), blockDistances);
+  blockQueryBegin = queryNode.Begin();
+  blockReferenceBegin = referenceNode.Begin();
+}
+
 template<typename MetricType, typename TreeType>
 double DTBRules<MetricType, TreeType>::Score(const size_t queryIndex,
                                              TreeType& referenceNode)
@@ -40,6 +40,8 @@ PARAM_FLAG("naive", "Compute the MST using O(n^2) naive algorithm.", "n");
 PARAM_INT("leaf_size", "Leaf size in the kd-tree.  One-element leaves give the "
     "empirically best performance, but at the cost of greater memory "
     "requirements.", "l", 1);
+PARAM_FLAG("stats", "If true, print the number of prunes, scores, base cases "
+    "and nodes visited by the tree traversals (with --verbose).", "");
 
 using namespace mlpack;
 using namespace mlpack::emst;
@@ -98,6 +100,9 @@ int main(int argc, char* argv[])
     arma::mat results;
     dtb.ComputeMST(results);
 
+    if (CLI::HasParam("stats"))
+      Log::Info << dtb.Statistics().ToString();
+
     // Unmap the results.
     arma::mat unmappedResults(results.n_rows, results.n_cols);
     for (size_t i = 0; i < results.n_cols; ++i)
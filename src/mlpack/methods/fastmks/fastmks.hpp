@@ -12,6 +12,7 @@
 #include <mlpack/core/metrics/ip_metric.hpp>
 #include "fastmks_stat.hpp"
 #include <mlpack/core/tree/cover_tree.hpp>
+#include <mlpack/core/tree/traversal_statistics.hpp>
 
 namespace mlpack {
 namespace fastmks /** Fast max-kernel search. */ {
@@ -180,6 +181,11 @@ class FastMKS
   //! Modify whether or not single-tree search is used.
   bool& SingleMode() { return singleMode; }
 
+  //! Get the statistics of the tree traversals of all searches.
+  const tree::TraversalStatistics& Statistics() const { return statistics; }
+  //! Modify the statistics of the tree traversals (good for a reset).
+  tree::TraversalStatistics& Statistics() { return statistics; }
+
   /**
    * Returns a string representation of this object.
    */
@@ -201,6 +207,9 @@ class FastMKS
   //! The instantiated inner-product metric induced by the given kernel.
   metric::IPMetric<KernelType> metric;
 
+  //! The statistics of the tree traversals.
+  tree::TraversalStatistics statistics;
+
   //! Utility function.  Copied too many times from too many places.
   void InsertNeighbor(arma::Mat<size_t>& indices,
                       arma::mat& products,
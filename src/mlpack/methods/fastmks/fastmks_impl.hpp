@@ -139,6 +139,7 @@ void FastMKS<KernelType, TreeType>::Search(
 
     for (size_t i = 0; i < querySet.n_cols; ++i)
       traverser.Traverse(i, *referenceTree);
+    statistics += traverser.Statistics();
 
     Log::Info << rules.BaseCases() << " base cases." << std::endl;
     Log::Info << rules.Scores() << " scores." << std::endl;
@@ -183,6 +184,7 @@ void FastMKS<KernelType, TreeType>::Search(TreeType* queryTree,
   typename TreeType::template DualTreeTraverser<RuleType> traverser(rules);
 
   traverser.Traverse(*queryTree, *referenceTree);
+  statistics += traverser.Statistics();
 
   Log::Info << rules.BaseCases() << " base cases." << std::endl;
   Log::Info << rules.Scores() << " scores." << std::endl;
@@ -244,6 +246,7 @@ void FastMKS<KernelType, TreeType>::Search(const size_t k,
 
     for (size_t i = 0; i < referenceSet.n_cols; ++i)
       traverser.Traverse(i, *referenceTree);
+    statistics += traverser.Statistics();
 
     // Save the number of pruned nodes.
     const size_t numPrunes = traverser.NumPrunes();
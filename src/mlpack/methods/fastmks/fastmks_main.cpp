@@ -56,6 +56,8 @@ PARAM_STRING("kernel", "Kernel type to use: 'linear', 'polynomial', 'cosine', "
 PARAM_FLAG("naive", "If true, O(n^2) naive mode is used for computation.", "N");
 PARAM_FLAG("single", "If true, single-tree search is used (as opposed to "
     "dual-tree search.", "S");
+PARAM_FLAG("stats", "If true, print the number of prunes, scores, base cases "
+    "and nodes visited by the cover tree traversal (with --verbose).", "");
 
 // Cover tree parameter.
 PARAM_DOUBLE("base", "Base to use during cover tree construction.", "b", 2.0);
@@ -98,6 +100,9 @@ void RunFastMKS(const arma::mat& referenceData,
 
     // Now search with it.
     fastmks.Search(k, indices, kernels);
+
+    if (CLI::HasParam("stats"))
+      Log::Info << fastmks.Statistics().ToString();
   }
 }
 
@@ -133,6 +138,9 @@ void RunFastMKS(const arma::mat& referenceData,
 
     // Now search with it.
     fastmks.Search(&queryTree, k, indices, kernels);
+
+    if (CLI::HasParam("stats"))
+      Log::Info << fastmks.Statistics().ToString();
   }
 }
 
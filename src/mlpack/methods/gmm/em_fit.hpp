@@ -31,6 +31,16 @@ namespace gmm {
  *
  * This method should create 'clusters' clusters, and return the assignment of
  * each point to a cluster.
+ *
+ * Both steps of each EM iteration run on all OpenMP threads.  The probability
+ * of each block of observations under each component is computed as a
+ * separate task (E-step).  For the M-step, the blocks are split into a fixed
+ * number of contiguous groups (at most 64); the weighted means and covariances
+ * of each group are summed in block order as a separate task, and the sums of
+ * the groups are then added up in group order, so the memory used does not
+ * grow with the number of observations.  Since the grouping depends only on
+ * the number of observations, the results do not depend on the number of
+ * threads, and a serial build gives the same results.
  */
 template<typename InitialClusteringType = kmeans::KMeans<>,
          typename CovarianceConstraintPolicy = PositiveDefiniteConstraint>
@@ -137,6 +147,41 @@ class EMFit
                          std::vector<distribution::GaussianDistribution>& dists,
                          arma::vec& weights);
 
+  /**
+   * Calculate the probability of each observation under each component,
+   * multiplied by the weight of the component (so that each row sums to the
+   * likelihood of the observation).  This is parallelized over blocks of
+   * observations and components.
+   *
+   * @param observations List of observations.
+   * @param dists Components of the model.
+   * @param weights A priori weights of the components.
+   * @param probabilities Matrix to store the probabilities in (one row per
+   *     observation, one column per component).
+   */
+  void ComponentProbabilities(
+      const arma::mat& observations,
+      const std::vector<distribution::GaussianDistribution>& dists,
+      const arma::vec& weights,
+      arma::mat& probabilities) const;
+
+  /**
+   * Update the mean and covariance of each component from the weight of each
+   * observation for each component (the M-step).  Components with no weight
+   * are not updated.  The sums over the observations are accumulated in a
+   * fixed number of groups of blocks, so the result does not depend on the
+   * number of threads.
+   *
+   * @param observations List of observations.
+   * @param condProb Weight of each observation for each component.
+   * @param probRowSums Sum of the weights of each component.
+   * @param dists Components to update.
+   */
+  void UpdateComponents(const arma::mat& observations,
+                        const arma::mat& condProb,
+                        const arma::vec& probRowSums,
+                        std::vector<distribution::GaussianDistribution>& dists);
+
   /**
    * Calculate the log-likelihood of a model.  Yes, this is reimplemented in the
    * GMM code.  Intuition suggests that the log-likelihood is not the best way
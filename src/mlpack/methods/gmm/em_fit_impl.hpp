@@ -55,16 +55,10 @@ void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
 
     // Calculate the conditional probabilities of choosing a particular
     // Gaussian given the observations and the present theta value.
-    for (size_t i = 0; i < dists.size(); i++)
-    {
-      // Store conditional probabilities into condProb vector for each
-      // Gaussian.  First we make an alias of the condProb vector.
-      arma::vec condProbAlias = condProb.unsafe_col(i);
-      dists[i].Probability(observations, condProbAlias);
-      condProbAlias *= weights[i];
-    }
+    ComponentProbabilities(observations, dists, weights, condProb);
 
     // Normalize row-wise.
+    #pragma omp parallel for schedule(static)
     for (size_t i = 0; i < condProb.n_rows; i++)
     {
       // Avoid dividing by zero; if the probability for everything is 0, we
@@ -77,29 +71,9 @@ void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
     // Store the sum of the probability of each state over all the observations.
     arma::vec probRowSums = trans(arma::sum(condProb, 0 /* columnwise */));
 
-    // Calculate the new value of the means using the updated conditional
-    // probabilities.
-    for (size_t i = 0; i < dists.size(); i++)
-    {
-      // Don't update if there's no probability of the Gaussian having points.
-      if (probRowSums[i] != 0)
-        dists[i].Mean() = (observations * condProb.col(i)) / probRowSums[i];
-
-      // Calculate the new value of the covariances using the updated
-      // conditional probabilities and the updated means.
-      arma::mat tmp = observations - (dists[i].Mean() *
-          arma::ones<arma::rowvec>(observations.n_cols));
-      arma::mat tmpB = tmp % (arma::ones<arma::vec>(observations.n_rows) *
-          trans(condProb.col(i)));
-
-      // Don't update if there's no probability of the Gaussian having points.
-      if (probRowSums[i] != 0.0) {
-        arma::mat covariance = (tmp * trans(tmpB)) / probRowSums[i];
-        // Apply covariance constraint.
-        constraint.ApplyConstraint(covariance);
-        dists[i].Covariance(std::move(covariance));
-      }
-    }
+    // Calculate the new values of the means and covariances using the updated
+    // conditional probabilities.
+    UpdateComponents(observations, condProb, probRowSums, dists);
 
     // Calculate the new values for omega using the updated conditional
     // probabilities.
@@ -138,16 +112,10 @@ void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
   {
     // Calculate the conditional probabilities of choosing a particular
     // Gaussian given the observations and the present theta value.
-    for (size_t i = 0; i < dists.size(); i++)
-    {
-      // Store conditional probabilities into condProb vector for each
-      // Gaussian.  First we make an alias of the condProb vector.
-      arma::vec condProbAlias = condProb.unsafe_col(i);
-      dists[i].Probability(observations, condProbAlias);
-      condProbAlias *= weights[i];
-    }
+    ComponentProbabilities(observations, dists, weights, condProb);
 
     // Normalize row-wise.
+    #pragma omp parallel for schedule(static)
     for (size_t i = 0; i < condProb.n_rows; i++)
     {
       // Avoid dividing by zero; if the probability for everything is 0, we
@@ -157,37 +125,19 @@ void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
         condProb.row(i) /= probSum;
     }
 
-    // This will store the sum of probabilities of each state over all the
-    // observations.
-    arma::vec probRowSums(dists.size());
-
-    // Calculate the new value of the means using the updated conditional
-    // probabilities.
+    // The weight of each point for each Gaussian is the conditional
+    // probability of each point being from Gaussian i multiplied by the
+    // probability of the point being from this mixture model.
     for (size_t i = 0; i < dists.size(); i++)
-    {
-      // Calculate the sum of probabilities of points, which is the
-      // conditional probability of each point being from Gaussian i
-      // multiplied by the probability of the point being from this mixture
-      // model.
-      probRowSums[i] = accu(condProb.col(i) % probabilities);
+      condProb.col(i) %= probabilities;
 
-      dists[i].Mean() = (observations * (condProb.col(i) % probabilities)) /
-        probRowSums[i];
-
-      // Calculate the new value of the covariances using the updated
-      // conditional probabilities and the updated means.
-      arma::mat tmp = observations - (dists[i].Mean() *
-          arma::ones<arma::rowvec>(observations.n_cols));
-      arma::mat tmpB = tmp % (arma::ones<arma::vec>(observations.n_rows) *
-          trans(condProb.col(i) % probabilities));
-
-      arma::mat cov = (tmp * trans(tmpB)) / probRowSums[i];
-
-      // Apply covariance constraint.
-      constraint.ApplyConstraint(cov);
+    // This will store the sum of probabilities of each state over all the
+    // observations.
+    arma::vec probRowSums = trans(arma::sum(condProb, 0 /* columnwise */));
 
-      dists[i].Covariance(std::move(cov));
-    }
+    // Calculate the new values of the means and covariances using the updated
+    // conditional probabilities.
+    UpdateComponents(observations, condProb, probRowSums, dists);
 
     // Calculate the new values for omega using the updated conditional
     // probabilities.
@@ -269,31 +219,151 @@ InitialClustering(const arma::mat& observations,
 }
 
 template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
-double EMFit<InitialClusteringType, CovarianceConstraintPolicy>::LogLikelihood(
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::
+ComponentProbabilities(
     const arma::mat& observations,
     const std::vector<distribution::GaussianDistribution>& dists,
-    const arma::vec& weights) const
+    const arma::vec& weights,
+    arma::mat& probabilities) const
 {
-  double logLikelihood = 0;
+  probabilities.set_size(observations.n_cols, dists.size());
 
-  arma::vec phis;
-  arma::mat likelihoods(dists.size(), observations.n_cols);
+  // Each block of observations for each component is a separate task, so that
+  // there is enough work for every thread whether there are many components or
+  // many observations.
+  const size_t blockSize = 1024;
+  const size_t blocks = (observations.n_cols + blockSize - 1) / blockSize;
+
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t task = 0; task < blocks * dists.size(); ++task)
+  {
+    const size_t i = task / blocks;
+    const size_t begin = (task % blocks) * blockSize;
+    const size_t count = std::min(blockSize,
+        (size_t) observations.n_cols - begin);
+
+    // Alias the block of observations without copying it.
+    const arma::mat block(const_cast<double*>(observations.colptr(begin)),
+        observations.n_rows, count, false, true);
+
+    arma::vec phis;
+    dists[i].Probability(block, phis);
+    probabilities.submat(begin, i, begin + count - 1, i) = weights[i] * phis;
+  }
+}
 
+template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::
+UpdateComponents(const arma::mat& observations,
+                 const arma::mat& condProb,
+                 const arma::vec& probRowSums,
+                 std::vector<distribution::GaussianDistribution>& dists)
+{
+  const size_t dimensionality = observations.n_rows;
+  const size_t blockSize = 1024;
+  const size_t blocks = (observations.n_cols + blockSize - 1) / blockSize;
+
+  // The blocks are split into a fixed number of contiguous groups, each of
+  // which is summed in block order; the sums of the groups are then added up
+  // in group order.  The grouping depends only on the number of observations,
+  // so the result is the same for any number of threads (and without OpenMP).
+  const size_t groups = std::max((size_t) 1, std::min(blocks, (size_t) 64));
+
+  // First, the weighted sums of the observations, for the means.
+  std::vector<arma::mat> meanSums(groups);
+
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t g = 0; g < groups; ++g)
+  {
+    meanSums[g].zeros(dimensionality, dists.size());
+    for (size_t b = g * blocks / groups; b < (g + 1) * blocks / groups; ++b)
+    {
+      const size_t begin = b * blockSize;
+      const size_t end = std::min(begin + blockSize,
+          (size_t) observations.n_cols) - 1;
+      meanSums[g] += observations.cols(begin, end) * condProb.rows(begin, end);
+    }
+  }
+
+  for (size_t g = 1; g < groups; ++g)
+    meanSums[0] += meanSums[g];
+
+  // Don't update if there's no probability of the Gaussian having points.
   for (size_t i = 0; i < dists.size(); ++i)
+    if (probRowSums[i] != 0.0)
+      dists[i].Mean() = meanSums[0].col(i) / probRowSums[i];
+
+  // Now the weighted sums of the outer products of the differences from the
+  // updated means, for the covariances.
+  std::vector<arma::cube> covarianceSums(groups);
+
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t g = 0; g < groups; ++g)
   {
-    dists[i].Probability(observations, phis);
-    likelihoods.row(i) = weights(i) * trans(phis);
+    covarianceSums[g].zeros(dimensionality, dimensionality, dists.size());
+
+    arma::mat diffs, weightedDiffs;
+    for (size_t b = g * blocks / groups; b < (g + 1) * blocks / groups; ++b)
+    {
+      const size_t begin = b * blockSize;
+      const size_t end = std::min(begin + blockSize,
+          (size_t) observations.n_cols) - 1;
+
+      for (size_t i = 0; i < dists.size(); ++i)
+      {
+        if (probRowSums[i] == 0.0)
+          continue;
+
+        diffs = observations.cols(begin, end) - (dists[i].Mean() *
+            arma::ones<arma::rowvec>(end - begin + 1));
+        weightedDiffs = diffs % (arma::ones<arma::vec>(dimensionality) *
+            trans(condProb.submat(begin, i, end, i)));
+        covarianceSums[g].slice(i) += diffs * trans(weightedDiffs);
+      }
+    }
   }
-  // Now sum over every point.
+
+  for (size_t i = 0; i < dists.size(); ++i)
+  {
+    // Don't update if there's no probability of the Gaussian having points.
+    if (probRowSums[i] == 0.0)
+      continue;
+
+    arma::mat covariance = covarianceSums[0].slice(i);
+    for (size_t g = 1; g < groups; ++g)
+      covariance += covarianceSums[g].slice(i);
+    covariance /= probRowSums[i];
+
+    // Apply covariance constraint.
+    constraint.ApplyConstraint(covariance);
+    dists[i].Covariance(std::move(covariance));
+  }
+}
+
+template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+double EMFit<InitialClusteringType, CovarianceConstraintPolicy>::LogLikelihood(
+    const arma::mat& observations,
+    const std::vector<distribution::GaussianDistribution>& dists,
+    const arma::vec& weights) const
+{
+  arma::mat likelihoods;
+  ComponentProbabilities(observations, dists, weights, likelihoods);
+
+  // Now sum over every point.  The logarithms are added up in order afterwards,
+  // so that the result doesn't depend on the number of threads.
+  arma::vec logLikelihoods(observations.n_cols);
+  #pragma omp parallel for schedule(static)
+  for (size_t j = 0; j < observations.n_cols; ++j)
+    logLikelihoods[j] = log(accu(likelihoods.row(j)));
+
   for (size_t j = 0; j < observations.n_cols; ++j)
   {
-    if (accu(likelihoods.col(j)) == 0)
+    if (logLikelihoods[j] == -std::numeric_limits<double>::infinity())
       Log::Info << "Likelihood of point " << j << " is 0!  It is probably an "
           << "outlier." << std::endl;
-    logLikelihood += log(accu(likelihoods.col(j)));
   }
 
-  return logLikelihood;
+  return arma::accu(logLikelihoods);
 }
 
 }; // namespace gmm
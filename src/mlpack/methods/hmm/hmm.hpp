@@ -10,6 +10,7 @@
 #define __MLPACK_METHODS_HMM_HMM_HPP
 
 #include <mlpack/core.hpp>
+#include "hmm_transition.hpp"
 
 namespace mlpack {
 namespace hmm /** Hidden Markov Models. */ {
@@ -73,9 +74,20 @@ namespace hmm /** Hidden Markov Models. */ {
  * (with Predict()), generate a sequence (with Generate()), or estimate the
  * probabilities of each state for a sequence of observations (with Estimate()).
  *
+ * The transition matrix may also be sparse (arma::sp_mat, given as the MatType
+ * template parameter).  Then the forward-backward algorithm, the Viterbi
+ * algorithm and training take time proportional to the number of nonzero
+ * transitions instead of the square of the number of states, which makes
+ * left-to-right or banded HMMs with thousands of states practical.  Training
+ * never adds transitions: with Baum-Welch, the nonzero pattern of the initial
+ * transition matrix is kept, and with labeled data, only the transitions seen
+ * in the state sequences are nonzero.
+ *
  * @tparam Distribution Type of emission distribution for this HMM.
+ * @tparam MatType Type of transition matrix (arma::mat or arma::sp_mat).
  */
-template<typename Distribution = distribution::DiscreteDistribution>
+template<typename Distribution = distribution::DiscreteDistribution,
+         typename MatType = arma::mat>
 class HMM
 {
  public:
@@ -128,7 +140,7 @@ class HMM
    *      (Baum-Welch).
    */
   HMM(const arma::vec& initial,
-      const arma::mat& transition,
+      const MatType& transition,
       const std::vector<Distribution>& emission,
       const double tolerance = 1e-5);
 
@@ -297,9 +309,9 @@ class HMM
   arma::vec& Initial() { return initial; }
 
   //! Return the transition matrix.
-  const arma::mat& Transition() const { return transition; }
+  const MatType& Transition() const { return transition; }
   //! Return a modifiable transition matrix reference.
-  arma::mat& Transition() { return transition; }
+  MatType& Transition() { return transition; }
 
   //! Return the emission distributions.
   const std::vector<Distribution>& Emission() const { return emission; }
@@ -362,11 +374,56 @@ class HMM
                 const arma::vec& scales,
                 arma::mat& backwardProb) const;
 
+  /**
+   * Compute the log-probability of each observation in the given data sequence
+   * under the emission distribution of each hidden state, all at once.  The
+   * returned matrix has rows equal to the number of hidden states and columns
+   * equal to the number of observations.  Gaussian emissions are evaluated a
+   * block at a time with GaussianDistribution::LogProbability().
+   *
+   * @param dataSeq Data sequence to compute emission probabilities for.
+   * @param logEmissionProb Matrix in which the log-probabilities will be saved.
+   */
+  void LogEmissionProbabilities(const arma::mat& dataSeq,
+                                arma::mat& logEmissionProb) const;
+
+  /**
+   * The Forward algorithm, given the log-probabilities of each emission (from
+   * LogEmissionProbabilities()).  Each step is one matrix-vector product with
+   * the transition matrix.  The logarithms of the scaling factors are returned,
+   * so that they can't underflow; their sum is the log-likelihood of the
+   * sequence.
+   *
+   * @param logEmissionProb Log-probabilities of each observation under each
+   *     state.
+   * @param logScales Vector in which the logarithms of the scaling factors will
+   *     be saved.
+   * @param forwardProb Matrix in which forward probabilities will be saved.
+   */
+  void ForwardFromEmissions(const arma::mat& logEmissionProb,
+                            arma::vec& logScales,
+                            arma::mat& forwardProb) const;
+
+  /**
+   * The Backward algorithm, given the log-probabilities of each emission (from
+   * LogEmissionProbabilities()) and the logarithms of the scaling factors
+   * found by ForwardFromEmissions().  Each step is one matrix-vector product
+   * with the transposed transition matrix.
+   *
+   * @param logEmissionProb Log-probabilities of each observation under each
+   *     state.
+   * @param logScales Vector of the logarithms of the scaling factors.
+   * @param backwardProb Matrix in which backward probabilities will be saved.
+   */
+  void BackwardFromEmissions(const arma::mat& logEmissionProb,
+                             const arma::vec& logScales,
+                             arma::mat& backwardProb) const;
+
   //! Set of emission probability distributions; one for each state.
   std::vector<Distribution> emission;
 
   //! Transition probability matrix.
-  arma::mat transition;
+  MatType transition;
 
  private:
   //! Initial state probability vector.
@@ -0,0 +1,111 @@
+/**
+ * @file hmm_filter.hpp
+ *
+ * An online filter for HMMs, which takes one observation at a time and keeps
+ * the posterior distribution of the current hidden state.
+ */
+#ifndef __MLPACK_METHODS_HMM_HMM_FILTER_HPP
+#define __MLPACK_METHODS_HMM_HMM_FILTER_HPP
+
+#include <mlpack/core.hpp>
+#include "hmm.hpp"
+
+namespace mlpack {
+namespace hmm {
+
+/**
+ * An online (streaming) version of the forward algorithm.  HMM::Filter() and
+ * HMM::Estimate() need the whole observation sequence at once; an HMMFilter
+ * instead ingests one observation at a time with Update(), and after each one
+ * holds P(X_t | o_{1:t}), the posterior distribution of the current hidden
+ * state given every observation so far.  Each update is one matrix-vector
+ * product with the transition matrix and one evaluation of each emission
+ * distribution, so it takes O(states^2) time, and all of the storage is
+ * allocated when the filter is created.
+ *
+ * The filter refers to the given HMM, which must outlive it; changes to the
+ * HMM's parameters take effect at the next call to Update().
+ *
+ * @code
+ * extern HMM<GaussianDistribution> hmm;
+ * HMMFilter<GaussianDistribution> filter(hmm);
+ *
+ * extern arma::vec observation; // Filled in by the sensor, in a loop.
+ * const arma::vec& posterior = filter.Update(observation);
+ * @endcode
+ *
+ * @tparam Distribution Type of emission distribution of the HMM.
+ * @tparam MatType Type of transition matrix of the HMM.
+ */
+template<typename Distribution = distribution::DiscreteDistribution,
+         typename MatType = arma::mat>
+class HMMFilter
+{
+ public:
+  /**
+   * Create a filter for the given HMM, which has not seen any observations.
+   *
+   * @param hmm HMM to filter observations with.
+   */
+  HMMFilter(const HMM<Distribution, MatType>& hmm);
+
+  /**
+   * Forget every observation, so that the next call to Update() starts a new
+   * sequence from the initial state probabilities.
+   */
+  void Reset();
+
+  /**
+   * Take the next observation of the sequence, and update the posterior
+   * distribution of the current hidden state.
+   *
+   * @param observation Next observation.
+   * @return The posterior probability of each hidden state, P(X_t | o_{1:t}).
+   */
+  const arma::vec& Update(const arma::vec& observation);
+
+  //! Get the posterior probability of each hidden state after the last update.
+  const arma::vec& Posterior() const { return posterior; }
+
+  //! Get the emission probabilities of the last observation, divided by the
+  //! largest of them.
+  const arma::vec& ScaledEmission() const { return scaledEmission; }
+
+  //! Get the log-likelihood of the observations so far.
+  double LogLikelihood() const { return logLikelihood; }
+
+  //! Get the number of observations since the filter was created or reset.
+  size_t Steps() const { return steps; }
+
+  //! Get the HMM.
+  const HMM<Distribution, MatType>& Model() const { return hmm; }
+
+ private:
+  //! The HMM to filter observations with.
+  const HMM<Distribution, MatType>& hmm;
+
+  //! The posterior probability of each state, P(X_t | o_{1:t}).
+  arma::vec posterior;
+  //! The predicted probability of each state, P(X_t | o_{1:t - 1}).
+  arma::vec predicted;
+  //! The log-probability of the last observation under each state.
+  arma::vec logEmission;
+  //! The emission probabilities of the last observation, divided by the
+  //! largest of them.
+  arma::vec scaledEmission;
+  //! Storage for the log-probability of one emission.
+  arma::vec logProbability;
+
+  //! The log-likelihood of the observations so far.
+  double logLikelihood;
+  //! The number of observations so far.
+  size_t steps;
+};
+
+}; // namespace hmm
+}; // namespace mlpack
+
+// Include implementation.
+#include "hmm_filter_impl.hpp"
+
+#endif
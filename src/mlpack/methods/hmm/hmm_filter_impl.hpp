@@ -0,0 +1,86 @@
+/**
+ * @file hmm_filter_impl.hpp
+ *
+ * Implementation of the online HMM filter.
+ */
+#ifndef __MLPACK_METHODS_HMM_HMM_FILTER_IMPL_HPP
+#define __MLPACK_METHODS_HMM_HMM_FILTER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "hmm_filter.hpp"
+
+namespace mlpack {
+namespace hmm {
+
+template<typename Distribution, typename MatType>
+HMMFilter<Distribution, MatType>::HMMFilter(
+    const HMM<Distribution, MatType>& hmm) :
+    hmm(hmm),
+    posterior(hmm.Transition().n_rows),
+    predicted(hmm.Transition().n_rows),
+    logEmission(hmm.Transition().n_rows),
+    scaledEmission(hmm.Transition().n_rows),
+    logProbability(1),
+    logLikelihood(0.0),
+    steps(0)
+{
+  posterior.zeros();
+  scaledEmission.zeros();
+}
+
+template<typename Distribution, typename MatType>
+void HMMFilter<Distribution, MatType>::Reset()
+{
+  posterior.zeros();
+  scaledEmission.zeros();
+  logLikelihood = 0.0;
+  steps = 0;
+}
+
+template<typename Distribution, typename MatType>
+const arma::vec& HMMFilter<Distribution, MatType>::Update(
+    const arma::vec& observation)
+{
+  if (observation.n_elem != hmm.Dimensionality())
+    Log::Fatal << "HMMFilter::Update(): observation has dimensionality "
+        << observation.n_elem << " (expected " << hmm.Dimensionality()
+        << " dimensions)." << std::endl;
+
+  // Predict the current state from the last posterior; before the first
+  // observation, that is the initial state distribution.
+  if (steps == 0)
+    predicted = hmm.Initial();
+  else
+    TransitionTimes(hmm.Transition(), posterior, predicted);
+
+  // Evaluate each emission distribution on the observation, which is aliased as
+  // a one-column matrix so that Gaussians can stay in log-space.
+  const arma::mat observationMat(const_cast<double*>(observation.memptr()),
+      observation.n_elem, 1, false, true);
+  for (size_t state = 0; state < logEmission.n_elem; state++)
+  {
+    EmissionLogProbabilities(hmm.Emission()[state], observationMat,
+        logProbability);
+    logEmission[state] = logProbability[0];
+  }
+
+  // Divide the emission probabilities by the largest one before leaving
+  // log-space, just like HMM::ForwardFromEmissions().
+  const double maxLogProb = logEmission.max();
+  scaledEmission = arma::exp(logEmission - maxLogProb);
+
+  // Now condition on the observation, and normalize.
+  posterior = predicted % scaledEmission;
+  const double scale = arma::accu(posterior);
+  posterior /= scale;
+
+  logLikelihood += std::log(scale) + maxLogProb;
+  ++steps;
+
+  return posterior;
+}
+
+}; // namespace hmm
+}; // namespace mlpack
+
+#endif
@@ -0,0 +1,129 @@
+/**
+ * @file hmm_fixed_lag_smoother.hpp
+ *
+ * An online fixed-lag smoother for HMMs, which takes one observation at a time
+ * and estimates the hidden state a fixed number of steps in the past.
+ */
+#ifndef __MLPACK_METHODS_HMM_HMM_FIXED_LAG_SMOOTHER_HPP
+#define __MLPACK_METHODS_HMM_HMM_FIXED_LAG_SMOOTHER_HPP
+
+#include <mlpack/core.hpp>
+#include "hmm_filter.hpp"
+
+namespace mlpack {
+namespace hmm {
+
+/**
+ * An online fixed-lag smoother.  Like HMMFilter, it ingests one observation at
+ * a time with Update(), but once it has seen more than lag observations, each
+ * update also gives P(X_{t - lag} | o_{1:t}): the posterior of the hidden state
+ * lag steps ago, given the lag observations that came after it as well.  That
+ * estimate is much better than the filtered one, at the cost of a delay of lag
+ * steps.  With a lag as long as the sequence, this gives the same results as
+ * HMM::Estimate().
+ *
+ * The forward probabilities and emission probabilities of the last lag + 1
+ * steps are kept in preallocated windows, and each update runs the backward
+ * algorithm over the window, so an update takes O(lag * states^2) time.  When
+ * the sequence ends, Flush() gives the estimates of the last steps, which have
+ * no lagged estimate yet.
+ *
+ * @code
+ * extern HMM<GaussianDistribution> hmm;
+ * HMMFixedLagSmoother<GaussianDistribution> smoother(hmm, 10);
+ *
+ * extern arma::vec observation; // Filled in by the sensor, in a loop.
+ * if (smoother.Update(observation))
+ *   std::cout << smoother.Smoothed(); // State estimate from 10 steps ago.
+ * @endcode
+ *
+ * @tparam Distribution Type of emission distribution of the HMM.
+ * @tparam MatType Type of transition matrix of the HMM.
+ */
+template<typename Distribution = distribution::DiscreteDistribution,
+         typename MatType = arma::mat>
+class HMMFixedLagSmoother
+{
+ public:
+  /**
+   * Create a smoother for the given HMM with the given lag, which has not seen
+   * any observations.
+   *
+   * @param hmm HMM to smooth observations with.
+   * @param lag Number of observations to wait for before estimating a state.
+   */
+  HMMFixedLagSmoother(const HMM<Distribution, MatType>& hmm, const size_t lag);
+
+  /**
+   * Forget every observation, so that the next call to Update() starts a new
+   * sequence.
+   */
+  void Reset();
+
+  /**
+   * Take the next observation of the sequence.  If at least lag + 1
+   * observations have been seen, the posterior of the hidden state lag steps
+   * before this observation is computed, and true is returned; then it can be
+   * retrieved with Smoothed().
+   *
+   * @param observation Next observation.
+   * @return Whether a new smoothed estimate is available.
+   */
+  bool Update(const arma::vec& observation);
+
+  /**
+   * At the end of a sequence, compute the posteriors of the hidden states which
+   * Update() has not given estimates for yet (the last lag steps, or all of
+   * them if the sequence is shorter than that), given every observation.  Each
+   * column of the returned matrix corresponds to one of those steps, in order.
+   *
+   * @param smoothedSeq Matrix to store posteriors in.
+   */
+  void Flush(arma::mat& smoothedSeq);
+
+  //! Get the posterior of the hidden state lag steps ago.
+  const arma::vec& Smoothed() const { return smoothed; }
+
+  //! Get the posterior of the current hidden state, P(X_t | o_{1:t}).
+  const arma::vec& Filtered() const { return filter.Posterior(); }
+
+  //! Get the log-likelihood of the observations so far.
+  double LogLikelihood() const { return filter.LogLikelihood(); }
+
+  //! Get the number of observations since the smoother was created or reset.
+  size_t Steps() const { return filter.Steps(); }
+
+  //! Get the lag.
+  size_t Lag() const { return lag; }
+
+ private:
+  //! Run one step of the backward algorithm from the given step.
+  void BackwardStep(const size_t step);
+
+  //! The filter, which gives the forward probabilities.
+  HMMFilter<Distribution, MatType> filter;
+  //! The number of observations to wait before estimating a state.
+  size_t lag;
+
+  //! The forward probabilities of the last lag + 1 steps; step t is in column
+  //! t % (lag + 1).
+  arma::mat forwardWindow;
+  //! The scaled emission probabilities of the last lag + 1 steps, stored like
+  //! forwardWindow.
+  arma::mat emissionWindow;
+
+  //! The (normalized) backward probabilities.
+  arma::vec backward;
+  //! Storage for the backward algorithm.
+  arma::vec weightedBackward;
+  //! The posterior of the hidden state lag steps ago.
+  arma::vec smoothed;
+};
+
+}; // namespace hmm
+}; // namespace mlpack
+
+// Include implementation.
+#include "hmm_fixed_lag_smoother_impl.hpp"
+
+#endif
@@ -0,0 +1,100 @@
+/**
+ * @file hmm_fixed_lag_smoother_impl.hpp
+ *
+ * Implementation of the online fixed-lag HMM smoother.
+ */
+#ifndef __MLPACK_METHODS_HMM_HMM_FIXED_LAG_SMOOTHER_IMPL_HPP
+#define __MLPACK_METHODS_HMM_HMM_FIXED_LAG_SMOOTHER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "hmm_fixed_lag_smoother.hpp"
+
+namespace mlpack {
+namespace hmm {
+
+template<typename Distribution, typename MatType>
+HMMFixedLagSmoother<Distribution, MatType>::HMMFixedLagSmoother(
+    const HMM<Distribution, MatType>& hmm,
+    const size_t lag) :
+    filter(hmm),
+    lag(lag),
+    forwardWindow(hmm.Transition().n_rows, lag + 1),
+    emissionWindow(hmm.Transition().n_rows, lag + 1),
+    backward(hmm.Transition().n_rows),
+    weightedBackward(hmm.Transition().n_rows),
+    smoothed(hmm.Transition().n_rows)
+{
+  smoothed.zeros();
+}
+
+template<typename Distribution, typename MatType>
+void HMMFixedLagSmoother<Distribution, MatType>::Reset()
+{
+  filter.Reset();
+  smoothed.zeros();
+}
+
+template<typename Distribution, typename MatType>
+bool HMMFixedLagSmoother<Distribution, MatType>::Update(
+    const arma::vec& observation)
+{
+  filter.Update(observation);
+
+  const size_t t = filter.Steps() - 1;
+  forwardWindow.col(t % (lag + 1)) = filter.Posterior();
+  emissionWindow.col(t % (lag + 1)) = filter.ScaledEmission();
+
+  if (t < lag)
+    return false;
+
+  // Run the backward algorithm from the current step back to step t - lag.
+  backward.ones();
+  for (size_t step = t; step > t - lag; --step)
+    BackwardStep(step);
+
+  smoothed = forwardWindow.col((t - lag) % (lag + 1)) % backward;
+  smoothed /= arma::accu(smoothed);
+
+  return true;
+}
+
+template<typename Distribution, typename MatType>
+void HMMFixedLagSmoother<Distribution, MatType>::Flush(
+    arma::mat& smoothedSeq)
+{
+  const size_t steps = std::min(lag, (size_t) filter.Steps());
+  smoothedSeq.set_size(backward.n_elem, steps);
+  if (steps == 0)
+    return;
+
+  // One backward pass from the last step gives every remaining estimate.
+  const size_t t = filter.Steps() - 1;
+  backward.ones();
+  for (size_t i = 0; i < steps; ++i)
+  {
+    const size_t step = t - i;
+    const size_t column = steps - 1 - i;
+    smoothedSeq.col(column) = forwardWindow.col(step % (lag + 1)) % backward;
+    smoothedSeq.col(column) /= arma::accu(smoothedSeq.col(column));
+
+    if (i + 1 < steps)
+      BackwardStep(step);
+  }
+}
+
+template<typename Distribution, typename MatType>
+void HMMFixedLagSmoother<Distribution, MatType>::BackwardStep(const size_t step)
+{
+  // This is the recursion of HMM::BackwardFromEmissions(), but the backward
+  // probabilities are just normalized to sum to 1, since only their ratios
+  // matter for the posterior.
+  weightedBackward = backward % emissionWindow.col(step % (lag + 1));
+  TransposedTransitionTimes(filter.Model().Transition(), weightedBackward,
+      backward);
+  backward /= arma::accu(backward);
+}
+
+}; // namespace hmm
+}; // namespace mlpack
+
+#endif
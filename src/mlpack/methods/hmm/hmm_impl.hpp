@@ -12,6 +12,10 @@
 // Just in case...
 #include "hmm.hpp"
 
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
 namespace mlpack {
 namespace hmm {
 
@@ -19,12 +23,13 @@ namespace hmm {
  * Create the Hidden Markov Model with the given number of hidden states and the
  * given number of emission states.
  */
-template<typename Distribution>
-HMM<Distribution>::HMM(const size_t states,
-                       const Distribution emissions,
-                       const double tolerance) :
+template<typename Distribution, typename MatType>
+HMM<Distribution, MatType>::HMM(const size_t states,
+                                const Distribution emissions,
+                                const double tolerance) :
     emission(states, /* default distribution */ emissions),
-    transition(arma::ones<arma::mat>(states, states) / (double) states),
+    transition(arma::mat(arma::ones<arma::mat>(states, states) /
+        (double) states)),
     initial(arma::ones<arma::vec>(states) / (double) states),
     dimensionality(emissions.Dimensionality()),
     tolerance(tolerance)
@@ -34,11 +39,11 @@ HMM<Distribution>::HMM(const size_t states,
  * Create the Hidden Markov Model with the given transition matrix and the given
  * emission probability matrix.
  */
-template<typename Distribution>
-HMM<Distribution>::HMM(const arma::vec& initial,
-                       const arma::mat& transition,
-                       const std::vector<Distribution>& emission,
-                       const double tolerance) :
+template<typename Distribution, typename MatType>
+HMM<Distribution, MatType>::HMM(const arma::vec& initial,
+                                const MatType& transition,
+                                const std::vector<Distribution>& emission,
+                                const double tolerance) :
     emission(emission),
     transition(transition),
     initial(initial),
@@ -71,8 +76,8 @@ HMM<Distribution>::HMM(const arma::vec& initial,
  *
  * @param dataSeq Set of data sequences to train on.
  */
-template<typename Distribution>
-void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
+template<typename Distribution, typename MatType>
+void HMM<Distribution, MatType>::Train(const std::vector<arma::mat>& dataSeq)
 {
   // We should allow a guess at the transition and emission matrices.
   double loglik = 0;
@@ -81,10 +86,14 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
   // Maximum iterations?
   size_t iterations = 1000;
 
-  // Find length of all sequences and ensure they are the correct size.
+  // Find length of all sequences and ensure they are the correct size.  The
+  // observations of each sequence go into one contiguous range of the emission
+  // list, starting at its offset.
   size_t totalLength = 0;
+  std::vector<size_t> offsets(dataSeq.size());
   for (size_t seq = 0; seq < dataSeq.size(); seq++)
   {
+    offsets[seq] = totalLength;
     totalLength += dataSeq[seq].n_cols;
 
     if (dataSeq[seq].n_rows != dimensionality)
@@ -94,83 +103,123 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
   }
 
   // These are used later for training of each distribution.  We initialize it
-  // all now so we don't have to do any allocation later on.
+  // all now so we don't have to do any allocation later on.  The observations
+  // don't change between iterations, so they are only copied once.
   std::vector<arma::vec> emissionProb(transition.n_cols,
       arma::vec(totalLength));
   arma::mat emissionList(dimensionality, totalLength);
+  for (size_t seq = 0; seq < dataSeq.size(); seq++)
+    if (dataSeq[seq].n_cols > 0)
+      emissionList.cols(offsets[seq], offsets[seq] + dataSeq[seq].n_cols - 1) =
+          dataSeq[seq];
+
+  // The sequences are independent within an iteration, so each thread runs the
+  // E-step on its share of the sequences and accumulates its own expected
+  // counts; these are added up in order once per iteration, so the result only
+  // depends on the number of threads through rounding.
+  size_t threads = 1;
+#ifdef _OPENMP
+  threads = (size_t) omp_get_max_threads();
+#endif
 
   // This should be the Baum-Welch algorithm (EM for HMM estimation). This
   // follows the procedure outlined in Elliot, Aggoun, and Moore's book "Hidden
   // Markov Models: Estimation and Control", pp. 36-40.
   for (size_t iter = 0; iter < iterations; iter++)
   {
-    // Clear new transition matrix and emission probabilities.
-    arma::vec newInitial(transition.n_rows);
-    newInitial.zeros();
-    arma::mat newTransition(transition.n_rows, transition.n_cols);
-    newTransition.zeros();
-
-    // Reset log likelihood.
-    loglik = 0;
+    // Clear new transition matrix and emission probabilities.  The expected
+    // transition counts are kept for each stored value of the transition
+    // matrix, so a sparse transition matrix stays sparse.
+    std::vector<arma::vec> newInitials(threads);
+    std::vector<arma::vec> newTransitions(threads);
+    for (size_t t = 0; t < threads; ++t)
+    {
+      newInitials[t].zeros(transition.n_rows);
+      newTransitions[t].zeros(TransitionValues(transition));
+    }
 
-    // Sum over time.
-    size_t sumTime = 0;
+    // The log-likelihood of each sequence.
+    arma::vec logLikelihoods(dataSeq.size());
 
-    // Loop over each sequence.
-    for (size_t seq = 0; seq < dataSeq.size(); seq++)
+    #pragma omp parallel
     {
-      arma::mat stateProb;
+      size_t thread = 0;
+#ifdef _OPENMP
+      thread = (size_t) omp_get_thread_num();
+#endif
+
+      arma::mat logEmissionProb;
       arma::mat forward;
       arma::mat backward;
-      arma::vec scales;
-
-      // Add the log-likelihood of this sequence.  This is the E-step.
-      loglik += Estimate(dataSeq[seq], stateProb, forward, backward, scales);
-
-      // Now re-estimate the parameters.  This is the M-step.
-      //   pi_i = sum_d ((1 / P(seq[d])) sum_t (f(i, 0) b(i, 0))
-      //   T_ij = sum_d ((1 / P(seq[d])) sum_t (f(i, t) T_ij E_i(seq[d][t]) b(i,
-      //           t + 1)))
-      //   E_ij = sum_d ((1 / P(seq[d])) sum_{t | seq[d][t] = j} f(i, t) b(i, t)
-      // We store the new estimates in a different matrix.
-      for (size_t t = 0; t < dataSeq[seq].n_cols; t++)
+      arma::vec logScales;
+      arma::mat weightedBackward;
+
+      // Loop over each sequence.
+      #pragma omp for schedule(static)
+      for (size_t seq = 0; seq < dataSeq.size(); seq++)
       {
-        for (size_t j = 0; j < transition.n_cols; j++)
+        const size_t length = dataSeq[seq].n_cols;
+
+        // Find the log-likelihood of this sequence.  This is the E-step.  The
+        // emission probabilities are computed once and shared between the
+        // forward and backward passes and the M-step.
+        LogEmissionProbabilities(dataSeq[seq], logEmissionProb);
+        ForwardFromEmissions(logEmissionProb, logScales, forward);
+        BackwardFromEmissions(logEmissionProb, logScales, backward);
+        const arma::mat stateProb = forward % backward;
+        logLikelihoods[seq] = accu(logScales);
+
+        // Now re-estimate the parameters.  This is the M-step.
+        //   pi_i = sum_d ((1 / P(seq[d])) sum_t (f(i, 0) b(i, 0))
+        //   T_ij = sum_d ((1 / P(seq[d])) sum_t (f(i, t) T_ij E_i(seq[d][t])
+        //           b(i, t + 1)))
+        //   E_ij = sum_d ((1 / P(seq[d])) sum_{t | seq[d][t] = j} f(i, t)
+        //           b(i, t)
+        // We store the new estimates in a different matrix.
+        newInitials[thread] += stateProb.col(0);
+
+        if (length > 1)
         {
-          // Add to estimate of initial probability for state j.
-          newInitial[j] = stateProb(j, 0);
-
-          if (t < dataSeq[seq].n_cols - 1)
-          {
-            // Estimate of T_ij (probability of transition from state j to state
-            // i).  We postpone multiplication of the old T_ij until later.
-            for (size_t i = 0; i < transition.n_rows; i++)
-              newTransition(i, j) += forward(j, t) * backward(i, t + 1) *
-                  emission[i].Probability(dataSeq[seq].unsafe_col(t + 1)) /
-                  scales[t + 1];
-          }
-
-          // Add to list of emission observations, for Distribution::Estimate().
-          emissionList.col(sumTime) = dataSeq[seq].col(t);
-          emissionProb[j][sumTime] = stateProb(j, t);
+          // Estimate of T_ij (probability of transition from state j to state
+          // i), summed over t; for a dense transition matrix this is one
+          // matrix multiplication.  We postpone multiplication of the old T_ij
+          // until later.
+          weightedBackward.set_size(transition.n_rows, length - 1);
+          for (size_t t = 1; t < length; t++)
+            weightedBackward.col(t - 1) = backward.col(t) %
+                arma::exp(logEmissionProb.col(t) - logScales[t]);
+
+          AccumulateTransitions(transition, weightedBackward, forward,
+              newTransitions[thread]);
         }
-        sumTime++;
+
+        // Store the state probabilities of each observation, for
+        // Distribution::Estimate().
+        if (length > 0)
+          for (size_t j = 0; j < transition.n_cols; j++)
+            emissionProb[j].subvec(offsets[seq], offsets[seq] + length - 1) =
+                trans(stateProb.row(j));
       }
     }
 
+    // Add up the contributions of each thread.
+    arma::vec newInitial = newInitials[0];
+    arma::vec newTransition = newTransitions[0];
+    for (size_t t = 1; t < threads; ++t)
+    {
+      newInitial += newInitials[t];
+      newTransition += newTransitions[t];
+    }
+    loglik = arma::accu(logLikelihoods);
+
     // Normalize the new initial probabilities.
     if (dataSeq.size() == 0)
       initial = newInitial / dataSeq.size();
 
-    // Assign the new transition matrix.  We use %= (element-wise
-    // multiplication) because every element of the new transition matrix must
-    // still be multiplied by the old elements (this is the multiplication we
-    // earlier postponed).
-    transition %= newTransition;
-
-    // Now we normalize the transition matrix.
-    for (size_t i = 0; i < transition.n_cols; i++)
-      transition.col(i) /= accu(transition.col(i));
+    // Assign the new transition matrix.  Every element of the new transition
+    // matrix must still be multiplied by the old elements (this is the
+    // multiplication we earlier postponed), and then it is normalized.
+    ReestimateTransitions(transition, newTransition);
 
     // Now estimate emission probabilities.
     for (size_t state = 0; state < transition.n_cols; state++)
@@ -193,9 +242,10 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
  * Train the model using the given labeled observations; the transition and
  * emission matrices are directly estimated.
  */
-template<typename Distribution>
-void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq,
-                              const std::vector<arma::Col<size_t> >& stateSeq)
+template<typename Distribution, typename MatType>
+void HMM<Distribution, MatType>::Train(
+    const std::vector<arma::mat>& dataSeq,
+    const std::vector<arma::Col<size_t> >& stateSeq)
 {
   // Simple error checking.
   if (dataSeq.size() != stateSeq.size())
@@ -206,7 +256,6 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq,
   }
 
   initial.zeros();
-  transition.zeros();
 
   // Estimate the transition and emission matrices directly from the
   // observations.  The emission list holds the time indices for observations
@@ -231,33 +280,17 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq,
           << dimensionality << " dimensions)." << std::endl;
     }
 
-    // Loop over each observation in the sequence.  For estimation of the
-    // transition matrix, we must ignore the last observation.
+    // Loop over each observation in the sequence.
     initial[stateSeq[seq][0]]++;
-    for (size_t t = 0; t < dataSeq[seq].n_cols - 1; t++)
-    {
-      transition(stateSeq[seq][t + 1], stateSeq[seq][t])++;
+    for (size_t t = 0; t < dataSeq[seq].n_cols; t++)
       emissionList[stateSeq[seq][t]].push_back(std::make_pair(seq, t));
-    }
-
-    // Last observation.
-    emissionList[stateSeq[seq][stateSeq[seq].n_elem - 1]].push_back(
-        std::make_pair(seq, stateSeq[seq].n_elem - 1));
   }
 
   // Normalize initial weights.
   initial /= accu(initial);
 
-  // Normalize transition matrix.
-  for (size_t col = 0; col < transition.n_cols; col++)
-  {
-    // If the transition probability sum is greater than 0 in this column, the
-    // emission probability sum will also be greater than 0.  We want to avoid
-    // division by 0.
-    double sum = accu(transition.col(col));
-    if (sum > 0)
-      transition.col(col) /= sum;
-  }
+  // Estimate the transition matrix from the counts of each transition.
+  EstimateTransitions(transition, stateSeq);
 
   // Estimate emission matrix.
   for (size_t state = 0; state < transition.n_cols; state++)
@@ -279,32 +312,38 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq,
  * Estimate the probabilities of each hidden state at each time step for each
  * given data observation.
  */
-template<typename Distribution>
-double HMM<Distribution>::Estimate(const arma::mat& dataSeq,
-                                   arma::mat& stateProb,
-                                   arma::mat& forwardProb,
-                                   arma::mat& backwardProb,
-                                   arma::vec& scales) const
+template<typename Distribution, typename MatType>
+double HMM<Distribution, MatType>::Estimate(const arma::mat& dataSeq,
+                                            arma::mat& stateProb,
+                                            arma::mat& forwardProb,
+                                            arma::mat& backwardProb,
+                                            arma::vec& scales) const
 {
-  // First run the forward-backward algorithm.
-  Forward(dataSeq, scales, forwardProb);
-  Backward(dataSeq, scales, backwardProb);
+  // First run the forward-backward algorithm.  The emission probabilities are
+  // only computed once for both passes.
+  arma::mat logEmissionProb;
+  arma::vec logScales;
+  LogEmissionProbabilities(dataSeq, logEmissionProb);
+  ForwardFromEmissions(logEmissionProb, logScales, forwardProb);
+  BackwardFromEmissions(logEmissionProb, logScales, backwardProb);
+  scales = exp(logScales);
 
   // Now assemble the state probability matrix based on the forward and backward
   // probabilities.
   stateProb = forwardProb % backwardProb;
 
-  // Finally assemble the log-likelihood and return it.
-  return accu(log(scales));
+  // Finally assemble the log-likelihood and return it.  This is taken from the
+  // logarithms of the scales, which don't underflow.
+  return accu(logScales);
 }
 
 /**
  * Estimate the probabilities of each hidden state at each time step for each
  * given data observation.
  */
-template<typename Distribution>
-double HMM<Distribution>::Estimate(const arma::mat& dataSeq,
-                                   arma::mat& stateProb) const
+template<typename Distribution, typename MatType>
+double HMM<Distribution, MatType>::Estimate(const arma::mat& dataSeq,
+                                            arma::mat& stateProb) const
 {
   // We don't need to save these.
   arma::mat forwardProb, backwardProb;
@@ -318,11 +357,11 @@ double HMM<Distribution>::Estimate(const arma::mat& dataSeq,
  * stored in the dataSequence parameter, and the state sequence is stored in
  * the stateSequence parameter.
  */
-template<typename Distribution>
-void HMM<Distribution>::Generate(const size_t length,
-                                 arma::mat& dataSequence,
-                                 arma::Col<size_t>& stateSequence,
-                                 const size_t startState) const
+template<typename Distribution, typename MatType>
+void HMM<Distribution, MatType>::Generate(const size_t length,
+                                          arma::mat& dataSequence,
+                                          arma::Col<size_t>& stateSequence,
+                                          const size_t startState) const
 {
   // Set vectors to the right size.
   stateSequence.set_size(length);
@@ -346,16 +385,7 @@ void HMM<Distribution>::Generate(const size_t length,
 
     // Now find where our random value sits in the probability distribution of
     // state changes.
-    double probSum = 0;
-    for (size_t st = 0; st < transition.n_rows; st++)
-    {
-      probSum += transition(st, stateSequence[t - 1]);
-      if (randValue <= probSum)
-      {
-        stateSequence[t] = st;
-        break;
-      }
-    }
+    stateSequence[t] = NextState(transition, stateSequence[t - 1], randValue);
 
     // Now choose the emission.
     dataSequence.col(t) = emission[stateSequence[t]].Random();
@@ -367,50 +397,49 @@ void HMM<Distribution>::Generate(const size_t length,
  * using the Viterbi algorithm. Returns the log-likelihood of the most likely
  * sequence.
  */
-template<typename Distribution>
-double HMM<Distribution>::Predict(const arma::mat& dataSeq,
-                                  arma::Col<size_t>& stateSeq) const
+template<typename Distribution, typename MatType>
+double HMM<Distribution, MatType>::Predict(const arma::mat& dataSeq,
+                                           arma::Col<size_t>& stateSeq) const
 {
   // This is an implementation of the Viterbi algorithm for finding the most
-  // probable sequence of states to produce the observed data sequence.  We
-  // don't use log-likelihoods to save that little bit of time, but we'll
-  // calculate the log-likelihood at the end of it all.
+  // probable sequence of states to produce the observed data sequence.  It
+  // works entirely with log-probabilities, so long sequences don't underflow.
   stateSeq.set_size(dataSeq.n_cols);
-  arma::mat logStateProb(transition.n_rows, dataSeq.n_cols);
-  arma::mat stateSeqBack(transition.n_rows, dataSeq.n_cols);
+  if (dataSeq.n_cols == 0)
+    return 0.0;
+
+  const size_t states = transition.n_rows;
+  arma::mat logStateProb(states, dataSeq.n_cols);
+  arma::Mat<size_t> stateSeqBack(states, dataSeq.n_cols);
 
-  // Store the logs of the transposed transition matrix.  This is because we
-  // will be using the rows of the transition matrix.
-  arma::mat logTrans(log(trans(transition)));
+  // The log-probabilities of each stored transition.
+  arma::vec logTrans;
+  LogTransitionValues(transition, logTrans);
+
+  arma::mat logEmissionProb;
+  LogEmissionProbabilities(dataSeq, logEmissionProb);
 
   // The calculation of the first state is slightly different; the probability
   // of the first state being state j is the maximum probability that the state
   // came to be j from another state.
-  logStateProb.col(0).zeros();
-  for (size_t state = 0; state < transition.n_rows; state++)
-  {
-    logStateProb(state, 0) = log(initial[state] *
-        emission[state].Probability(dataSeq.unsafe_col(0)));
+  logStateProb.col(0) = log(initial) + logEmissionProb.col(0);
+  for (size_t state = 0; state < states; state++)
     stateSeqBack(state, 0) = state;
-  }
 
-  // Store the best first state.
-  arma::uword index;
+  arma::vec best(states);
   for (size_t t = 1; t < dataSeq.n_cols; t++)
   {
-    // Assemble the state probability for this element.
-    // Given that we are in state j, we use state with the highest probability
-    // of being the previous state.
-    for (size_t j = 0; j < transition.n_rows; j++)
-    {
-      arma::vec prob = logStateProb.col(t - 1) + logTrans.col(j);
-      logStateProb(j, t) = prob.max(index) +
-          log(emission[j].Probability(dataSeq.unsafe_col(t)));
-        stateSeqBack(j, t) = index;
-    }
+    // Given that we are in state j, we use the state with the highest
+    // probability of being the previous state.  This is a (max, +) product of
+    // the log-transition matrix with the last column.
+    const arma::vec last = logStateProb.unsafe_col(t - 1);
+    MaxPlusStep(transition, logTrans, last, best, stateSeqBack.colptr(t));
+
+    logStateProb.col(t) = best + logEmissionProb.col(t);
   }
 
   // Backtrack to find the most probable state sequence.
+  arma::uword index;
   logStateProb.unsafe_col(dataSeq.n_cols - 1).max(index);
   stateSeq[dataSeq.n_cols - 1] = index;
   for (size_t t = 2; t <= dataSeq.n_cols; t++)
@@ -423,34 +452,51 @@ double HMM<Distribution>::Predict(const arma::mat& dataSeq,
 /**
  * Compute the log-likelihood of the given data sequence.
  */
-template<typename Distribution>
-double HMM<Distribution>::LogLikelihood(const arma::mat& dataSeq) const
+template<typename Distribution, typename MatType>
+double HMM<Distribution, MatType>::LogLikelihood(const arma::mat& dataSeq) const
 {
+  arma::mat logEmissionProb;
   arma::mat forward;
-  arma::vec scales;
+  arma::vec logScales;
 
-  Forward(dataSeq, scales, forward);
+  LogEmissionProbabilities(dataSeq, logEmissionProb);
+  ForwardFromEmissions(logEmissionProb, logScales, forward);
 
-  // The log-likelihood is the log of the scales for each time step.
-  return accu(log(scales));
+  // The log-likelihood is the sum of the log of the scales for each time step.
+  return accu(logScales);
 }
 
 /**
  * HMM filtering.
  */
-template<typename Distribution>
-void HMM<Distribution>::Filter(const arma::mat& dataSeq,
-                               arma::mat& filterSeq,
-                               size_t ahead) const
+template<typename Distribution, typename MatType>
+void HMM<Distribution, MatType>::Filter(const arma::mat& dataSeq,
+                                        arma::mat& filterSeq,
+                                        size_t ahead) const
 {
   // First run the forward algorithm.
   arma::mat forwardProb;
   arma::vec scales;
   Forward(dataSeq, scales, forwardProb);
 
-  // Propagate state ahead.
+  // Propagate state ahead, by applying the transition matrix to each column
+  // ahead times.
   if (ahead != 0)
-    forwardProb = pow(transition, ahead) * forwardProb;
+  {
+    arma::vec state;
+    arma::vec propagated;
+    for (size_t t = 0; t < forwardProb.n_cols; t++)
+    {
+      state = forwardProb.col(t);
+      for (size_t step = 0; step < ahead; step++)
+      {
+        TransitionTimes(transition, state, propagated);
+        state = propagated;
+      }
+
+      forwardProb.col(t) = state;
+    }
+  }
 
   // Compute expected emissions.
   // Will not work for distributions without a Mean() function.
@@ -462,9 +508,9 @@ void HMM<Distribution>::Filter(const arma::mat& dataSeq,
 /**
  * HMM smoothing.
  */
-template<typename Distribution>
-void HMM<Distribution>::Smooth(const arma::mat& dataSeq,
-                               arma::mat& smoothSeq) const
+template<typename Distribution, typename MatType>
+void HMM<Distribution, MatType>::Smooth(const arma::mat& dataSeq,
+                                        arma::mat& smoothSeq) const
 {
   // First run the forward algorithm.
   arma::mat stateProb;
@@ -480,81 +526,149 @@ void HMM<Distribution>::Smooth(const arma::mat& dataSeq,
 /**
  * The Forward procedure (part of the Forward-Backward algorithm).
  */
+template<typename Distribution, typename MatType>
+void HMM<Distribution, MatType>::Forward(const arma::mat& dataSeq,
+                                         arma::vec& scales,
+                                         arma::mat& forwardProb) const
+{
+  arma::mat logEmissionProb;
+  LogEmissionProbabilities(dataSeq, logEmissionProb);
+  ForwardFromEmissions(logEmissionProb, scales, forwardProb);
+  scales = exp(scales);
+}
+
+template<typename Distribution, typename MatType>
+void HMM<Distribution, MatType>::Backward(const arma::mat& dataSeq,
+                                          const arma::vec& scales,
+                                          arma::mat& backwardProb) const
+{
+  arma::mat logEmissionProb;
+  LogEmissionProbabilities(dataSeq, logEmissionProb);
+  BackwardFromEmissions(logEmissionProb, log(scales), backwardProb);
+}
+
+/**
+ * The log-probabilities of a set of observations under a single emission
+ * distribution.  Distributions only need to be able to give the probability of
+ * one observation...
+ */
 template<typename Distribution>
-void HMM<Distribution>::Forward(const arma::mat& dataSeq,
-                                arma::vec& scales,
-                                arma::mat& forwardProb) const
+void EmissionLogProbabilities(const Distribution& distribution,
+                              const arma::mat& dataSeq,
+                              arma::vec& logProbabilities)
 {
-  // Our goal is to calculate the forward probabilities:
-  //  P(X_k | o_{1:k}) for all possible states X_k, for each time point k.
-  forwardProb.zeros(transition.n_rows, dataSeq.n_cols);
-  scales.zeros(dataSeq.n_cols);
-
-  // The first entry in the forward algorithm uses the initial state
-  // probabilities.  Note that MATLAB assumes that the starting state (at
-  // t = -1) is state 0; this is not our assumption here.  To force that
-  // behavior, you could append a single starting state to every single data
-  // sequence and that should produce results in line with MATLAB.
+  logProbabilities.set_size(dataSeq.n_cols);
+  for (size_t t = 0; t < dataSeq.n_cols; t++)
+    logProbabilities[t] = std::log(distribution.Probability(
+        dataSeq.unsafe_col(t)));
+}
+
+/**
+ * ...but Gaussians can evaluate all of them at once, in log-space.
+ */
+inline void EmissionLogProbabilities(
+    const distribution::GaussianDistribution& distribution,
+    const arma::mat& dataSeq,
+    arma::vec& logProbabilities)
+{
+  distribution.LogProbability(dataSeq, logProbabilities);
+}
+
+template<typename Distribution, typename MatType>
+void HMM<Distribution, MatType>::LogEmissionProbabilities(
+    const arma::mat& dataSeq,
+    arma::mat& logEmissionProb) const
+{
+  logEmissionProb.set_size(transition.n_rows, dataSeq.n_cols);
+
+  arma::vec logProbabilities;
   for (size_t state = 0; state < transition.n_rows; state++)
-    forwardProb(state, 0) = initial(state) *
-        emission[state].Probability(dataSeq.unsafe_col(0));
+  {
+    EmissionLogProbabilities(emission[state], dataSeq, logProbabilities);
+    logEmissionProb.row(state) = trans(logProbabilities);
+  }
+}
 
-  // Then normalize the column.
-  scales[0] = accu(forwardProb.col(0));
-  forwardProb.col(0) /= scales[0];
+template<typename Distribution, typename MatType>
+void HMM<Distribution, MatType>::ForwardFromEmissions(
+    const arma::mat& logEmissionProb,
+    arma::vec& logScales,
+    arma::mat& forwardProb) const
+{
+  // Our goal is to calculate the forward probabilities:
+  //  P(X_k | o_{1:k}) for all possible states X_k, for each time point k.
+  forwardProb.set_size(transition.n_rows, logEmissionProb.n_cols);
+  logScales.set_size(logEmissionProb.n_cols);
 
-  // Now compute the probabilities for each successive observation.
-  for (size_t t = 1; t < dataSeq.n_cols; t++)
+  arma::vec emissionProb;
+  arma::vec predicted;
+  for (size_t t = 0; t < logEmissionProb.n_cols; t++)
   {
-    for (size_t j = 0; j < transition.n_rows; j++)
+    // Divide the emission probabilities by the largest one before leaving
+    // log-space, so that they don't all underflow when the observation is
+    // unlikely under every state.  The factor goes back into the (log-)scale.
+    const double maxLogProb = logEmissionProb.col(t).max();
+    emissionProb = arma::exp(logEmissionProb.col(t) - maxLogProb);
+
+    // The first entry in the forward algorithm uses the initial state
+    // probabilities.  Note that MATLAB assumes that the starting state (at
+    // t = -1) is state 0; this is not our assumption here.  To force that
+    // behavior, you could append a single starting state to every single data
+    // sequence and that should produce results in line with MATLAB.
+    //
+    // After that, the forward probability of state j at time t is the sum over
+    // all states of the probability of the previous state transitioning to the
+    // current state, times the probability of emitting the given observation.
+    if (t == 0)
+    {
+      forwardProb.col(t) = initial % emissionProb;
+    }
+    else
     {
-      // The forward probability of state j at time t is the sum over all states
-      // of the probability of the previous state transitioning to the current
-      // state and emitting the given observation.
-      forwardProb(j, t) = accu(forwardProb.col(t - 1) %
-          trans(transition.row(j))) *
-          emission[j].Probability(dataSeq.unsafe_col(t));
+      TransitionTimes(transition, forwardProb.unsafe_col(t - 1), predicted);
+      forwardProb.col(t) = predicted % emissionProb;
     }
 
     // Normalize probability.
-    scales[t] = accu(forwardProb.col(t));
-    forwardProb.col(t) /= scales[t];
+    const double scale = accu(forwardProb.col(t));
+    forwardProb.col(t) /= scale;
+    logScales[t] = std::log(scale) + maxLogProb;
   }
 }
 
-template<typename Distribution>
-void HMM<Distribution>::Backward(const arma::mat& dataSeq,
-                                 const arma::vec& scales,
-                                 arma::mat& backwardProb) const
+template<typename Distribution, typename MatType>
+void HMM<Distribution, MatType>::BackwardFromEmissions(
+    const arma::mat& logEmissionProb,
+    const arma::vec& logScales,
+    arma::mat& backwardProb) const
 {
   // Our goal is to calculate the backward probabilities:
   //  P(X_k | o_{k + 1:T}) for all possible states X_k, for each time point k.
-  backwardProb.zeros(transition.n_rows, dataSeq.n_cols);
+  backwardProb.set_size(transition.n_rows, logEmissionProb.n_cols);
+  if (logEmissionProb.n_cols == 0)
+    return;
 
   // The last element probability is 1.
-  backwardProb.col(dataSeq.n_cols - 1).fill(1);
-
-  // Now step backwards through all other observations.
-  for (size_t t = dataSeq.n_cols - 2; t + 1 > 0; t--)
+  backwardProb.col(logEmissionProb.n_cols - 1).fill(1);
+
+  // Now step backwards through all other observations.  The backward
+  // probability of state j at time t is the sum over all states of the
+  // probability of the next state having been a transition from the current
+  // state multiplied by the probability of each of those states emitting the
+  // given observation, normalized by the weights from the forward algorithm.
+  arma::vec weightedBackward;
+  arma::vec previous;
+  for (size_t t = logEmissionProb.n_cols - 1; t > 0; t--)
   {
-    for (size_t j = 0; j < transition.n_rows; j++)
-    {
-      // The backward probability of state j at time t is the sum over all state
-      // of the probability of the next state having been a transition from the
-      // current state multiplied by the probability of each of those states
-      // emitting the given observation.
-      for (size_t state = 0; state < transition.n_rows; state++)
-        backwardProb(j, t) += transition(state, j) * backwardProb(state, t + 1)
-            * emission[state].Probability(dataSeq.unsafe_col(t + 1));
-
-      // Normalize by the weights from the forward algorithm.
-      backwardProb(j, t) /= scales[t + 1];
-    }
+    weightedBackward = backwardProb.col(t) %
+        arma::exp(logEmissionProb.col(t) - logScales[t]);
+    TransposedTransitionTimes(transition, weightedBackward, previous);
+    backwardProb.col(t - 1) = previous;
   }
 }
 
-template<typename Distribution>
-std::string HMM<Distribution>::ToString() const
+template<typename Distribution, typename MatType>
+std::string HMM<Distribution, MatType>::ToString() const
 {
   std::ostringstream convert;
   convert << "HMM [" << this << "]" << std::endl;
@@ -566,8 +680,8 @@ std::string HMM<Distribution>::ToString() const
 }
 
 //! Save to SaveRestoreUtility
-template<typename Distribution>
-void HMM<Distribution>::Save(util::SaveRestoreUtility& sr) const
+template<typename Distribution, typename MatType>
+void HMM<Distribution, MatType>::Save(util::SaveRestoreUtility& sr) const
 {
   //  Save parameters.
   sr.SaveParameter(Type(), "type");
@@ -589,8 +703,8 @@ void HMM<Distribution>::Save(util::SaveRestoreUtility& sr) const
 }
 
 //! Load from SaveRestoreUtility
-template<typename Distribution>
-void HMM<Distribution>::Load(const util::SaveRestoreUtility& sr)
+template<typename Distribution, typename MatType>
+void HMM<Distribution, MatType>::Load(const util::SaveRestoreUtility& sr)
 {
   // Load parameters.
   sr.LoadParameter(dimensionality, "dimensionality");
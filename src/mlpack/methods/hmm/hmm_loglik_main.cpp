@@ -14,10 +14,17 @@
 PROGRAM_INFO("Hidden Markov Model (HMM) Sequence Log-Likelihood", "This "
     "utility takes an already-trained HMM (--model_file) and evaluates the "
     "log-likelihood of a given sequence of observations (--input_file).  The "
-    "computed log-likelihood is given directly to stdout.");
+    "computed log-likelihood is given directly to stdout."
+    "\n\n"
+    "If --sparse is given, the transition matrix of the HMM is held as a "
+    "sparse matrix, so that the forward algorithm takes time proportional to "
+    "the number of nonzero transitions instead of the square of the number of "
+    "states.  This is much faster for HMMs with many states and few "
+    "transitions out of each state, like left-to-right HMMs.");
 
 PARAM_STRING_REQ("input_file", "File containing observations,", "i");
 PARAM_STRING_REQ("model_file", "File containing HMM (XML).", "m");
+PARAM_FLAG("sparse", "Hold the transition matrix as a sparse matrix.", "S");
 
 using namespace mlpack;
 using namespace mlpack::hmm;
@@ -27,6 +34,13 @@ using namespace mlpack::gmm;
 using namespace arma;
 using namespace std;
 
+// Load the HMM with the given type of transition matrix, and compute the
+// log-likelihood of the sequence.
+template<typename MatType>
+double LogLikelihood(SaveRestoreUtility& sr,
+                     const string& type,
+                     mat& dataSeq);
+
 int main(int argc, char** argv)
 {
   // Parse command line options.
@@ -45,10 +59,24 @@ int main(int argc, char** argv)
   string type;
   sr.LoadParameter(type, "hmm_type");
 
+  double loglik = 0;
+  if (CLI::HasParam("sparse"))
+    loglik = LogLikelihood<sp_mat>(sr, type, dataSeq);
+  else
+    loglik = LogLikelihood<mat>(sr, type, dataSeq);
+
+  cout << loglik << endl;
+}
+
+template<typename MatType>
+double LogLikelihood(SaveRestoreUtility& sr,
+                     const string& type,
+                     mat& dataSeq)
+{
   double loglik = 0;
   if (type == "discrete")
   {
-    HMM<DiscreteDistribution> hmm(1, DiscreteDistribution(1));
+    HMM<DiscreteDistribution, MatType> hmm(1, DiscreteDistribution(1));
 
     LoadHMM(hmm, sr);
 
@@ -60,11 +88,13 @@ int main(int argc, char** argv)
       Log::Fatal << "Only one-dimensional discrete observations allowed for "
           << "discrete HMMs!" << endl;
 
+    Timer::Start("log_likelihood");
     loglik = hmm.LogLikelihood(dataSeq);
+    Timer::Stop("log_likelihood");
   }
   else if (type == "gaussian")
   {
-    HMM<GaussianDistribution> hmm(1, GaussianDistribution(1));
+    HMM<GaussianDistribution, MatType> hmm(1, GaussianDistribution(1));
 
     LoadHMM(hmm, sr);
 
@@ -74,11 +104,13 @@ int main(int argc, char** argv)
           << "does not match HMM Gaussian dimensionality ("
           << hmm.Emission()[0].Mean().n_elem << ")!" << endl;
 
+    Timer::Start("log_likelihood");
     loglik = hmm.LogLikelihood(dataSeq);
+    Timer::Stop("log_likelihood");
   }
   else if (type == "gmm")
   {
-    HMM<GMM<> > hmm(1, GMM<>(1, 1));
+    HMM<GMM<>, MatType> hmm(1, GMM<>(1, 1));
 
     LoadHMM(hmm, sr);
 
@@ -88,13 +120,15 @@ int main(int argc, char** argv)
           << "does not match HMM Gaussian dimensionality ("
           << hmm.Emission()[0].Dimensionality() << ")!" << endl;
 
+    Timer::Start("log_likelihood");
     loglik = hmm.LogLikelihood(dataSeq);
+    Timer::Stop("log_likelihood");
   }
   else
   {
-    Log::Fatal << "Unknown HMM type '" << type << "' in file '" << modelFile
-        << "'!" << endl;
+    Log::Fatal << "Unknown HMM type '" << type << "' in file '"
+        << CLI::GetParam<string>("model_file") << "'!" << endl;
   }
 
-  cout << loglik << endl;
+  return loglik;
 }
@@ -28,7 +28,17 @@ PROGRAM_INFO("Hidden Markov Model (HMM) Training", "This program allows a "
     "\n\n"
     "Optionally, a pre-created HMM model can be used as a guess for the "
     "transition matrix and emission probabilities; this is specifiable with "
-    "--model_file.");
+    "--model_file."
+    "\n\n"
+    "If --sparse is given, the transition matrix is held as a sparse matrix, "
+    "so that training takes time proportional to the number of nonzero "
+    "transitions instead of the square of the number of states; this is much "
+    "faster for HMMs with many states and few transitions out of each state, "
+    "like left-to-right HMMs.  Training never adds transitions, so the "
+    "transitions which are allowed come from the model given with "
+    "--model_file, or, with labeled training, from the labels; a freshly "
+    "initialized HMM (no --model_file and no labels) starts with a fully dense "
+    "transition matrix, so --sparse gives no speedup for it.");
 
 PARAM_STRING_REQ("input_file", "File containing input observations.", "i");
 PARAM_STRING_REQ("type", "Type of HMM: discrete | gaussian | gmm.", "t");
@@ -47,6 +57,8 @@ PARAM_STRING("output_file", "File to save trained HMM to (XML).", "o",
     "output_hmm.xml");
 PARAM_INT("seed", "Random seed.  If 0, 'std::time(NULL)' is used.", "s", 0);
 PARAM_DOUBLE("tolerance", "Tolerance of the Baum-Welch algorithm.", "T", 1e-5);
+PARAM_FLAG("sparse", "Hold the transition matrix as a sparse matrix (a "
+    "freshly initialized, unlabeled HMM is fully dense).", "S");
 
 using namespace mlpack;
 using namespace mlpack::hmm;
@@ -57,6 +69,11 @@ using namespace mlpack::math;
 using namespace arma;
 using namespace std;
 
+// Train an HMM with the given type of transition matrix on the given sequences,
+// and save it.
+template<typename MatType>
+void Train(vector<mat>& trainSeq, const vector<arma::Col<size_t> >& labelSeq);
+
 int main(int argc, char** argv)
 {
   // Parse command line options.
@@ -72,11 +89,9 @@ int main(int argc, char** argv)
   const string inputFile = CLI::GetParam<string>("input_file");
   const string labelsFile = CLI::GetParam<string>("labels_file");
   const string modelFile = CLI::GetParam<string>("model_file");
-  const string outputFile = CLI::GetParam<string>("output_file");
   const string type = CLI::GetParam<string>("type");
   const int states = CLI::GetParam<int>("states");
   const bool batch = CLI::HasParam("batch");
-  const double tolerance = CLI::GetParam<double>("tolerance");
 
   // Validate number of states.
   if (states == 0 && modelFile == "")
@@ -203,6 +218,22 @@ int main(int argc, char** argv)
   }
 
   // Now, train the HMM, since we have loaded the input data.
+  if (CLI::HasParam("sparse"))
+    Train<sp_mat>(trainSeq, labelSeq);
+  else
+    Train<mat>(trainSeq, labelSeq);
+}
+
+template<typename MatType>
+void Train(vector<mat>& trainSeq, const vector<arma::Col<size_t> >& labelSeq)
+{
+  const string labelsFile = CLI::GetParam<string>("labels_file");
+  const string modelFile = CLI::GetParam<string>("model_file");
+  const string outputFile = CLI::GetParam<string>("output_file");
+  const string type = CLI::GetParam<string>("type");
+  const int states = CLI::GetParam<int>("states");
+  const double tolerance = CLI::GetParam<double>("tolerance");
+
   if (type == "discrete")
   {
     // Verify observations are valid.
@@ -213,7 +244,8 @@ int main(int argc, char** argv)
             << "HMMs!" << endl;
 
     // Do we have a model to preload?
-    HMM<DiscreteDistribution> hmm(1, DiscreteDistribution(1), tolerance);
+    HMM<DiscreteDistribution, MatType> hmm(1, DiscreteDistribution(1),
+        tolerance);
 
     if (modelFile != "")
     {
@@ -238,7 +270,7 @@ int main(int argc, char** argv)
           << endl;
 
       // Create HMM object.
-      hmm = HMM<DiscreteDistribution>(size_t(states),
+      hmm = HMM<DiscreteDistribution, MatType>(size_t(states),
           DiscreteDistribution(maxEmission), tolerance);
     }
 
@@ -257,7 +289,8 @@ int main(int argc, char** argv)
   else if (type == "gaussian")
   {
     // Create HMM object.
-    HMM<GaussianDistribution> hmm(1, GaussianDistribution(1), tolerance);
+    HMM<GaussianDistribution, MatType> hmm(1, GaussianDistribution(1),
+        tolerance);
 
     // Do we have a model to load?
     size_t dimensionality = 0;
@@ -274,7 +307,7 @@ int main(int argc, char** argv)
       // Find dimension of the data.
       dimensionality = trainSeq[0].n_rows;
 
-      hmm = HMM<GaussianDistribution>(size_t(states),
+      hmm = HMM<GaussianDistribution, MatType>(size_t(states),
           GaussianDistribution(dimensionality), tolerance);
     }
 
@@ -300,7 +333,7 @@ int main(int argc, char** argv)
   else if (type == "gmm")
   {
     // Create HMM object.
-    HMM<GMM<> > hmm(1, GMM<>(1, 1));
+    HMM<GMM<>, MatType> hmm(1, GMM<>(1, 1));
 
     // Do we have a model to load?
     size_t dimensionality = 0;
@@ -327,7 +360,7 @@ int main(int argc, char** argv)
         Log::Fatal << "Invalid number of gaussians (" << gaussians << "); must "
             << "be greater than or equal to 1." << endl;
 
-      hmm = HMM<GMM<> >(size_t(states), GMM<>(size_t(gaussians),
+      hmm = HMM<GMM<>, MatType>(size_t(states), GMM<>(size_t(gaussians),
           dimensionality), tolerance);
     }
 
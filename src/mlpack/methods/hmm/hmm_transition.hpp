@@ -0,0 +1,386 @@
+/**
+ * @file hmm_transition.hpp
+ *
+ * The operations the HMM class needs on its transition matrix, for dense
+ * (arma::mat) and sparse (arma::sp_mat) transition matrices.  For a sparse
+ * transition matrix, each of them takes time proportional to the number of
+ * nonzero transitions instead of the square of the number of states, so
+ * left-to-right and banded HMMs with many states are cheap.
+ *
+ * Some of these work on the "stored values" of the transition matrix: for a
+ * dense matrix these are all of its elements in column-major order, and for a
+ * sparse matrix they are its nonzero elements, in the order of sp_mat::values.
+ */
+#ifndef __MLPACK_METHODS_HMM_HMM_TRANSITION_HPP
+#define __MLPACK_METHODS_HMM_HMM_TRANSITION_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace hmm {
+
+//! Return the number of stored values of a dense transition matrix.
+inline size_t TransitionValues(const arma::mat& transition)
+{
+  return transition.n_elem;
+}
+
+//! Return the number of stored values of a sparse transition matrix.
+inline size_t TransitionValues(const arma::sp_mat& transition)
+{
+  return transition.n_nonzero;
+}
+
+/**
+ * Compute y = T x; that is, given the probability x of each state, the
+ * probability of each state after one more step.
+ *
+ * @param transition Transition matrix.
+ * @param x Probability of each state.
+ * @param y Vector to store the result in.
+ */
+inline void TransitionTimes(const arma::mat& transition,
+                            const arma::vec& x,
+                            arma::vec& y)
+{
+  y = transition * x;
+}
+
+//! Compute y = T x for a sparse transition matrix.
+inline void TransitionTimes(const arma::sp_mat& transition,
+                            const arma::vec& x,
+                            arma::vec& y)
+{
+  y.zeros(transition.n_rows);
+  for (size_t j = 0; j < transition.n_cols; ++j)
+    for (size_t k = transition.col_ptrs[j]; k < transition.col_ptrs[j + 1]; ++k)
+      y[transition.row_indices[k]] += transition.values[k] * x[j];
+}
+
+/**
+ * Compute y = T^T x, as is needed by the backward algorithm.
+ *
+ * @param transition Transition matrix.
+ * @param x Vector to multiply.
+ * @param y Vector to store the result in.
+ */
+inline void TransposedTransitionTimes(const arma::mat& transition,
+                                      const arma::vec& x,
+                                      arma::vec& y)
+{
+  y = trans(transition) * x;
+}
+
+//! Compute y = T^T x for a sparse transition matrix.
+inline void TransposedTransitionTimes(const arma::sp_mat& transition,
+                                      const arma::vec& x,
+                                      arma::vec& y)
+{
+  y.set_size(transition.n_cols);
+  for (size_t j = 0; j < transition.n_cols; ++j)
+  {
+    double sum = 0.0;
+    for (size_t k = transition.col_ptrs[j]; k < transition.col_ptrs[j + 1]; ++k)
+      sum += transition.values[k] * x[transition.row_indices[k]];
+    y[j] = sum;
+  }
+}
+
+/**
+ * Compute the logarithm of each stored value of the transition matrix, for the
+ * Viterbi algorithm.
+ *
+ * @param transition Transition matrix.
+ * @param logValues Vector to store the logarithms in.
+ */
+inline void LogTransitionValues(const arma::mat& transition,
+                                arma::vec& logValues)
+{
+  logValues.set_size(transition.n_elem);
+  for (size_t k = 0; k < transition.n_elem; ++k)
+    logValues[k] = std::log(transition[k]);
+}
+
+//! Compute the logarithm of each nonzero of a sparse transition matrix.
+inline void LogTransitionValues(const arma::sp_mat& transition,
+                                arma::vec& logValues)
+{
+  logValues.set_size(transition.n_nonzero);
+  for (size_t k = 0; k < transition.n_nonzero; ++k)
+    logValues[k] = std::log(transition.values[k]);
+}
+
+/**
+ * One step of the Viterbi algorithm: for each state j, find
+ * best[j] = max_i (last[i] + log T(j, i)), and the state i which gives the
+ * maximum (the first one, if there are ties; 0 if no state can transition to
+ * j).  This runs over the columns of the transition matrix, so the inner loop
+ * is contiguous.
+ *
+ * @param transition Transition matrix.
+ * @param logValues Logarithms of the stored values of the transition matrix.
+ * @param last Log-probability of each state at the last step.
+ * @param best Vector to store the best log-probability of each state in.
+ * @param back Array to store the best previous state of each state in.
+ */
+inline void MaxPlusStep(const arma::mat& transition,
+                        const arma::vec& logValues,
+                        const arma::vec& last,
+                        arma::vec& best,
+                        size_t* back)
+{
+  const size_t states = transition.n_rows;
+  best.set_size(states);
+  best.fill(-std::numeric_limits<double>::infinity());
+  std::fill(back, back + states, (size_t) 0);
+
+  for (size_t i = 0; i < transition.n_cols; ++i)
+  {
+    const double lastProb = last[i];
+    const double* logTransCol = logValues.memptr() + i * states;
+    for (size_t j = 0; j < states; ++j)
+    {
+      const double prob = lastProb + logTransCol[j];
+      if (prob > best[j])
+      {
+        best[j] = prob;
+        back[j] = i;
+      }
+    }
+  }
+}
+
+//! One step of the Viterbi algorithm for a sparse transition matrix.
+inline void MaxPlusStep(const arma::sp_mat& transition,
+                        const arma::vec& logValues,
+                        const arma::vec& last,
+                        arma::vec& best,
+                        size_t* back)
+{
+  const size_t states = transition.n_rows;
+  best.set_size(states);
+  best.fill(-std::numeric_limits<double>::infinity());
+  std::fill(back, back + states, (size_t) 0);
+
+  for (size_t i = 0; i < transition.n_cols; ++i)
+  {
+    const double lastProb = last[i];
+    for (size_t k = transition.col_ptrs[i]; k < transition.col_ptrs[i + 1]; ++k)
+    {
+      const size_t j = transition.row_indices[k];
+      const double prob = lastProb + logValues[k];
+      if (prob > best[j])
+      {
+        best[j] = prob;
+        back[j] = i;
+      }
+    }
+  }
+}
+
+/**
+ * Add the expected number of times each transition was taken in a sequence
+ * (up to the postponed multiplication by the transition probability) to the
+ * given counts of each stored value of the transition matrix, for the
+ * Baum-Welch algorithm.  For the transition from state j to state i, that is
+ * sum_t weightedBackward(i, t) * forward(j, t).
+ *
+ * @param transition Transition matrix.
+ * @param weightedBackward Backward probabilities of steps 1 to T - 1, times
+ *     the emission probabilities and divided by the scales.
+ * @param forward Forward probabilities of steps 0 to T - 1 (the last column is
+ *     not used).
+ * @param counts Expected counts of each stored value, to add to.
+ */
+inline void AccumulateTransitions(const arma::mat& transition,
+                                  const arma::mat& weightedBackward,
+                                  const arma::mat& forward,
+                                  arma::vec& counts)
+{
+  // Alias the counts as a matrix, and find all of the sums with one matrix
+  // multiplication.
+  arma::mat countsMat(counts.memptr(), transition.n_rows, transition.n_cols,
+      false, true);
+  countsMat += weightedBackward *
+      trans(forward.cols(0, weightedBackward.n_cols - 1));
+}
+
+//! Accumulate expected transition counts for a sparse transition matrix.
+inline void AccumulateTransitions(const arma::sp_mat& transition,
+                                  const arma::mat& weightedBackward,
+                                  const arma::mat& forward,
+                                  arma::vec& counts)
+{
+  for (size_t t = 0; t < weightedBackward.n_cols; ++t)
+  {
+    const double* weightedCol = weightedBackward.colptr(t);
+    for (size_t j = 0; j < transition.n_cols; ++j)
+    {
+      const double forwardProb = forward(j, t);
+      if (forwardProb == 0.0)
+        continue;
+
+      for (size_t k = transition.col_ptrs[j]; k < transition.col_ptrs[j + 1];
+           ++k)
+        counts[k] += weightedCol[transition.row_indices[k]] * forwardProb;
+    }
+  }
+}
+
+/**
+ * Finish the Baum-Welch re-estimation of the transition matrix: multiply each
+ * stored value by its expected count (the multiplication that was postponed),
+ * and normalize each column to sum to 1.
+ *
+ * @param transition Transition matrix to re-estimate.
+ * @param counts Expected counts of each stored value.
+ */
+inline void ReestimateTransitions(arma::mat& transition,
+                                  const arma::vec& counts)
+{
+  const arma::mat countsMat(const_cast<double*>(counts.memptr()),
+      transition.n_rows, transition.n_cols, false, true);
+  transition %= countsMat;
+
+  for (size_t i = 0; i < transition.n_cols; ++i)
+    transition.col(i) /= accu(transition.col(i));
+}
+
+//! Finish the Baum-Welch re-estimation of a sparse transition matrix.
+//! Transitions whose expected count is zero are dropped.
+inline void ReestimateTransitions(arma::sp_mat& transition,
+                                  const arma::vec& counts)
+{
+  arma::umat locations(2, transition.n_nonzero);
+  arma::vec values(transition.n_nonzero);
+  for (size_t j = 0; j < transition.n_cols; ++j)
+  {
+    double sum = 0.0;
+    for (size_t k = transition.col_ptrs[j]; k < transition.col_ptrs[j + 1]; ++k)
+    {
+      locations(0, k) = transition.row_indices[k];
+      locations(1, k) = j;
+      values[k] = transition.values[k] * counts[k];
+      sum += values[k];
+    }
+
+    for (size_t k = transition.col_ptrs[j]; k < transition.col_ptrs[j + 1]; ++k)
+      values[k] /= sum;
+  }
+
+  transition = arma::sp_mat(locations, values, transition.n_rows,
+      transition.n_cols);
+}
+
+/**
+ * Estimate the transition matrix directly from labeled state sequences: each
+ * column is the normalized count of transitions out of that state.  Columns
+ * for states that are never left are all zero.  The size of the transition
+ * matrix is not changed.
+ *
+ * @param transition Transition matrix to estimate.
+ * @param stateSeq Sequences of hidden states.
+ */
+inline void EstimateTransitions(arma::mat& transition,
+                                const std::vector<arma::Col<size_t> >& stateSeq)
+{
+  transition.zeros();
+  for (size_t seq = 0; seq < stateSeq.size(); ++seq)
+    for (size_t t = 0; t + 1 < stateSeq[seq].n_elem; ++t)
+      transition(stateSeq[seq][t + 1], stateSeq[seq][t])++;
+
+  for (size_t col = 0; col < transition.n_cols; ++col)
+  {
+    // If the transition probability sum is greater than 0 in this column, the
+    // emission probability sum will also be greater than 0.  We want to avoid
+    // division by 0.
+    const double sum = accu(transition.col(col));
+    if (sum > 0)
+      transition.col(col) /= sum;
+  }
+}
+
+//! Estimate a sparse transition matrix from labeled state sequences; only the
+//! transitions which are observed are nonzero.
+inline void EstimateTransitions(arma::sp_mat& transition,
+                                const std::vector<arma::Col<size_t> >& stateSeq)
+{
+  // Count each observed transition, keyed by (from, to) so that the counts come
+  // out in column-major order.
+  std::map<std::pair<size_t, size_t>, double> counts;
+  arma::vec sums;
+  sums.zeros(transition.n_cols);
+  for (size_t seq = 0; seq < stateSeq.size(); ++seq)
+  {
+    for (size_t t = 0; t + 1 < stateSeq[seq].n_elem; ++t)
+    {
+      counts[std::make_pair(stateSeq[seq][t], stateSeq[seq][t + 1])] += 1.0;
+      sums[stateSeq[seq][t]] += 1.0;
+    }
+  }
+
+  arma::umat locations(2, counts.size());
+  arma::vec values(counts.size());
+  size_t k = 0;
+  for (std::map<std::pair<size_t, size_t>, double>::const_iterator it =
+       counts.begin(); it != counts.end(); ++it, ++k)
+  {
+    locations(0, k) = it->first.second;
+    locations(1, k) = it->first.first;
+    values[k] = it->second / sums[it->first.first];
+  }
+
+  transition = arma::sp_mat(locations, values, transition.n_rows,
+      transition.n_cols);
+}
+
+/**
+ * Draw the state after the given state, given a uniform random number in
+ * [0, 1).
+ *
+ * @param transition Transition matrix.
+ * @param state Current state.
+ * @param r Uniform random number.
+ */
+inline size_t NextState(const arma::mat& transition,
+                        const size_t state,
+                        const double r)
+{
+  // Find where our random value sits in the probability distribution of state
+  // changes.
+  double probSum = 0;
+  for (size_t st = 0; st < transition.n_rows; ++st)
+  {
+    probSum += transition(st, state);
+    if (r <= probSum)
+      return st;
+  }
+
+  // Only reached if the column sums to slightly less than r.
+  return transition.n_rows - 1;
+}
+
+//! Draw the state after the given state, for a sparse transition matrix.
+inline size_t NextState(const arma::sp_mat& transition,
+                        const size_t state,
+                        const double r)
+{
+  double probSum = 0;
+  size_t next = state;
+  for (size_t k = transition.col_ptrs[state];
+       k < transition.col_ptrs[state + 1]; ++k)
+  {
+    next = transition.row_indices[k];
+    probSum += transition.values[k];
+    if (r <= probSum)
+      return next;
+  }
+
+  // Only reached if the column sums to slightly less than r.
+  return next;
+}
+
+}; // namespace hmm
+}; // namespace mlpack
+
+#endif
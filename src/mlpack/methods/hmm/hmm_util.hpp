@@ -17,28 +17,33 @@ namespace hmm {
  * Save an HMM to file (deprecated).
  *
  * @tparam Distribution Distribution type of HMM.
+ * @tparam MatType Transition matrix type of HMM.
  * @param sr SaveRestoreUtility to use.
  */
-template<typename Distribution>
-void SaveHMM(const HMM<Distribution>& hmm, util::SaveRestoreUtility& sr);
+template<typename Distribution, typename MatType>
+void SaveHMM(const HMM<Distribution, MatType>& hmm,
+             util::SaveRestoreUtility& sr);
 
 /**
  * Load an HMM from file (deprecated).
  *
  * @tparam Distribution Distribution type of HMM.
+ * @tparam MatType Transition matrix type of HMM.
  * @param sr SaveRestoreUtility to use.
  */
-template<typename Distribution>
-void LoadHMM(HMM<Distribution>& hmm, util::SaveRestoreUtility& sr);
+template<typename Distribution, typename MatType>
+void LoadHMM(HMM<Distribution, MatType>& hmm, util::SaveRestoreUtility& sr);
 
 /**
  * Converter for HMMs saved using older MLPACK versions.
  *
  * @tparam Distribution Distribution type of HMM.
+ * @tparam MatType Transition matrix type of HMM.
  * @param sr SaveRestoreUtility to use.
  */
-template<typename Distribution>
-void ConvertHMM(HMM<Distribution>& hmm, const util::SaveRestoreUtility& sr);
+template<typename Distribution, typename MatType>
+void ConvertHMM(HMM<Distribution, MatType>& hmm,
+                const util::SaveRestoreUtility& sr);
 
 }; // namespace hmm
 }; // namespace mlpack
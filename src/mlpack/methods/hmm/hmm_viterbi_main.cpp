@@ -16,12 +16,23 @@ PROGRAM_INFO("Hidden Markov Model (HMM) Viterbi State Prediction", "This "
     "utility takes an already-trained HMM (--model_file) and evaluates the "
     "most probably hidden state sequence of a given sequence of observations "
     "(--input_file), using the Viterbi algorithm.  The computed state sequence "
-    "is saved to the specified output file (--output_file).");
+    "is saved to the specified output file (--output_file)."
+    "\n\n"
+    "If --sparse is given, the transition matrix of the HMM is held as a "
+    "sparse matrix, so that the Viterbi algorithm takes time proportional to "
+    "the number of nonzero transitions instead of the square of the number of "
+    "states.  This is much faster for HMMs with many states and few "
+    "transitions out of each state, like left-to-right HMMs.  Transitions are "
+    "never added, so the HMM is only as sparse as the model in --model_file; "
+    "an HMM trained by hmm_train without --model_file or labels starts with a "
+    "fully dense transition matrix, and --sparse does not help it.");
 
 PARAM_STRING_REQ("input_file", "File containing observations,", "i");
 PARAM_STRING_REQ("model_file", "File containing HMM (XML).", "m");
 PARAM_STRING("output_file", "File to save predicted state sequence to.", "o",
     "output.csv");
+PARAM_FLAG("sparse", "Hold the transition matrix as a sparse matrix (this "
+    "only helps if the model's transition matrix has few nonzeros).", "S");
 
 using namespace mlpack;
 using namespace mlpack::hmm;
@@ -31,6 +42,14 @@ using namespace mlpack::gmm;
 using namespace arma;
 using namespace std;
 
+// Load the HMM with the given type of transition matrix, and run the Viterbi
+// algorithm.
+template<typename MatType>
+void RunViterbi(SaveRestoreUtility& sr,
+                const string& type,
+                mat& dataSeq,
+                arma::Col<size_t>& sequence);
+
 int main(int argc, char** argv)
 {
   // Parse command line options.
@@ -50,9 +69,25 @@ int main(int argc, char** argv)
   sr.LoadParameter(type, "hmm_type");
 
   arma::Col<size_t> sequence;
+  if (CLI::HasParam("sparse"))
+    RunViterbi<sp_mat>(sr, type, dataSeq, sequence);
+  else
+    RunViterbi<mat>(sr, type, dataSeq, sequence);
+
+  // Save output.
+  const string outputFile = CLI::GetParam<string>("output_file");
+  data::Save(outputFile, sequence, true);
+}
+
+template<typename MatType>
+void RunViterbi(SaveRestoreUtility& sr,
+                const string& type,
+                mat& dataSeq,
+                arma::Col<size_t>& sequence)
+{
   if (type == "discrete")
   {
-    HMM<DiscreteDistribution> hmm(1, DiscreteDistribution(1));
+    HMM<DiscreteDistribution, MatType> hmm(1, DiscreteDistribution(1));
 
     LoadHMM(hmm, sr);
 
@@ -64,11 +99,13 @@ int main(int argc, char** argv)
       Log::Fatal << "Only one-dimensional discrete observations allowed for "
           << "discrete HMMs!" << endl;
 
+    Timer::Start("viterbi");
     hmm.Predict(dataSeq, sequence);
+    Timer::Stop("viterbi");
   }
   else if (type == "gaussian")
   {
-    HMM<GaussianDistribution> hmm(1, GaussianDistribution(1));
+    HMM<GaussianDistribution, MatType> hmm(1, GaussianDistribution(1));
 
     LoadHMM(hmm, sr);
 
@@ -78,11 +115,13 @@ int main(int argc, char** argv)
           << "does not match HMM Gaussian dimensionality ("
           << hmm.Emission()[0].Mean().n_elem << ")!" << endl;
 
+    Timer::Start("viterbi");
     hmm.Predict(dataSeq, sequence);
+    Timer::Stop("viterbi");
   }
   else if (type == "gmm")
   {
-    HMM<GMM<> > hmm(1, GMM<>(1, 1));
+    HMM<GMM<>, MatType> hmm(1, GMM<>(1, 1));
 
     LoadHMM(hmm, sr);
 
@@ -92,15 +131,13 @@ int main(int argc, char** argv)
           << "does not match HMM Gaussian dimensionality ("
           << hmm.Emission()[0].Dimensionality() << ")!" << endl;
 
+    Timer::Start("viterbi");
     hmm.Predict(dataSeq, sequence);
+    Timer::Stop("viterbi");
   }
   else
   {
-    Log::Fatal << "Unknown HMM type '" << type << "' in file '" << modelFile
-        << "'!" << endl;
+    Log::Fatal << "Unknown HMM type '" << type << "' in file '"
+        << CLI::GetParam<string>("model_file") << "'!" << endl;
   }
-
-  // Save output.
-  const string outputFile = CLI::GetParam<string>("output_file");
-  data::Save(outputFile, sequence, true);
 }
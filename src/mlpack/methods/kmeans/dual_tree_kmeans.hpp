@@ -13,6 +13,7 @@
 #include <mlpack/core/tree/binary_space_tree.hpp>
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
 #include <mlpack/core/tree/cover_tree.hpp>
+#include <mlpack/core/tree/traversal_statistics.hpp>
 
 #include "dual_tree_kmeans_statistic.hpp"
 
@@ -61,6 +62,11 @@ class DualTreeKMeans
   //! Modify the number of distance calculations.
   size_t& DistanceCalculations() { return distanceCalculations; }
 
+  //! Get the statistics of the tree traversals of every iteration.
+  const tree::TraversalStatistics& Statistics() const { return statistics; }
+  //! Modify the statistics of the tree traversals (good for a reset).
+  tree::TraversalStatistics& Statistics() { return statistics; }
+
  private:
   //! The original dataset reference.
   const MatType& datasetOrig; // Maybe not necessary.
@@ -76,6 +82,8 @@ class DualTreeKMeans
 
   //! Track distance calculations.
   size_t distanceCalculations;
+  //! The statistics of the tree traversals.
+  tree::TraversalStatistics statistics;
   //! Track iteration number.
   size_t iteration;
 
@@ -159,6 +159,7 @@ double DualTreeKMeans<MetricType, MatType, TreeType>::Iterate(
   // Set the number of pruned centroids in the root to 0.
   tree->Stat().Pruned() = 0;
   traverser.Traverse(*tree, *centroidTree);
+  statistics += traverser.Statistics();
   distanceCalculations += rules.BaseCases() + rules.Scores();
 
   Timer::Start("tree_mod");
@@ -180,6 +180,51 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
   return std::sqrt(cNorm);
 }
 
+template<typename MetricType, typename MatType>
+void ElkanKMeans<MetricType, MatType>::Bounds(arma::mat& bounds) const
+{
+  bounds.set_size(2 + lowerBounds.n_rows, assignments.n_elem);
+  for (size_t i = 0; i < assignments.n_elem; ++i)
+  {
+    bounds(0, i) = (double) assignments[i];
+    bounds(1, i) = upperBounds(i);
+  }
+
+  if (assignments.n_elem > 0)
+    bounds.rows(2, bounds.n_rows - 1) = lowerBounds;
+}
+
+template<typename MetricType, typename MatType>
+void ElkanKMeans<MetricType, MatType>::SetBounds(const arma::mat& bounds,
+                                                 const size_t clusters)
+{
+  if (bounds.n_cols > 0 && bounds.n_rows != 2 + clusters)
+    Log::Fatal << "ElkanKMeans::SetBounds(): bounds have " << bounds.n_rows
+        << " rows, but should have " << (2 + clusters) << "!" << std::endl;
+  if (bounds.n_cols > dataset.n_cols)
+    Log::Fatal << "ElkanKMeans::SetBounds(): bounds given for "
+        << bounds.n_cols << " points, but the dataset only has "
+        << dataset.n_cols << " points!" << std::endl;
+
+  // New points get the same bounds as every point gets in the first iteration.
+  lowerBounds.zeros(clusters, dataset.n_cols);
+  upperBounds.set_size(dataset.n_cols);
+  upperBounds.fill(DBL_MAX);
+  assignments.zeros(dataset.n_cols);
+
+  for (size_t i = 0; i < bounds.n_cols; ++i)
+  {
+    if (bounds(0, i) < 0 || (size_t) bounds(0, i) >= clusters)
+      Log::Fatal << "ElkanKMeans::SetBounds(): point " << i << " is "
+          << "assigned to cluster " << bounds(0, i) << ", but there are only "
+          << clusters << " clusters!" << std::endl;
+
+    assignments[i] = (size_t) bounds(0, i);
+    upperBounds(i) = bounds(1, i);
+    lowerBounds.col(i) = bounds.submat(2, i, 1 + clusters, i);
+  }
+}
+
 } // namespace kmeans
 } // namespace mlpack
 
@@ -32,6 +32,28 @@ class HamerlyKMeans
                  arma::mat& newCentroids,
                  arma::Col<size_t>& counts);
 
+  /**
+   * Get the bounds of each point, so that a later run can start from them with
+   * SetBounds().  Column i holds the assignment of point i, the upper bound on
+   * its distance to that cluster, and the lower bound on its distance to any
+   * other cluster.  The bounds are valid for the centroids returned by the last
+   * call to Iterate().
+   *
+   * @param bounds Matrix to store the bounds in (3 x points).
+   */
+  void Bounds(arma::mat& bounds) const;
+
+  /**
+   * Start from the given bounds (from Bounds()) instead of computing distances
+   * to every centroid for every point in the first iteration.  The first call
+   * to Iterate() must be given the centroids the bounds were saved with.  The
+   * points past the last column of the bounds are treated as new points.
+   *
+   * @param bounds Saved bounds.
+   * @param clusters Number of clusters.
+   */
+  void SetBounds(const arma::mat& bounds, const size_t clusters);
+
   size_t DistanceCalculations() const { return distanceCalculations; }
 
  private:
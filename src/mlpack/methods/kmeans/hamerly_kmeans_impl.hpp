@@ -169,6 +169,50 @@ double HamerlyKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
   return std::sqrt(centroidMovement);
 }
 
+template<typename MetricType, typename MatType>
+void HamerlyKMeans<MetricType, MatType>::Bounds(arma::mat& bounds) const
+{
+  bounds.set_size(3, assignments.n_elem);
+  for (size_t i = 0; i < assignments.n_elem; ++i)
+  {
+    bounds(0, i) = (double) assignments[i];
+    bounds(1, i) = upperBounds(i);
+    bounds(2, i) = lowerBounds(i);
+  }
+}
+
+template<typename MetricType, typename MatType>
+void HamerlyKMeans<MetricType, MatType>::SetBounds(const arma::mat& bounds,
+                                                   const size_t clusters)
+{
+  if (bounds.n_cols > 0 && bounds.n_rows != 3)
+    Log::Fatal << "HamerlyKMeans::SetBounds(): bounds have " << bounds.n_rows
+        << " rows, but should have 3!" << std::endl;
+  if (bounds.n_cols > dataset.n_cols)
+    Log::Fatal << "HamerlyKMeans::SetBounds(): bounds given for "
+        << bounds.n_cols << " points, but the dataset only has "
+        << dataset.n_cols << " points!" << std::endl;
+
+  // New points get the same bounds as every point gets in the first iteration.
+  upperBounds.set_size(dataset.n_cols);
+  upperBounds.fill(DBL_MAX);
+  lowerBounds.zeros(dataset.n_cols);
+  assignments.zeros(dataset.n_cols);
+  minClusterDistances.set_size(clusters);
+
+  for (size_t i = 0; i < bounds.n_cols; ++i)
+  {
+    if (bounds(0, i) < 0 || (size_t) bounds(0, i) >= clusters)
+      Log::Fatal << "HamerlyKMeans::SetBounds(): point " << i << " is "
+          << "assigned to cluster " << bounds(0, i) << ", but there are only "
+          << clusters << " clusters!" << std::endl;
+
+    assignments[i] = (size_t) bounds(0, i);
+    upperBounds(i) = bounds(1, i);
+    lowerBounds(i) = bounds(2, i);
+  }
+}
+
 } // namespace kmeans
 } // namespace mlpack
 
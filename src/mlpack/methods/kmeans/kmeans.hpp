@@ -147,6 +147,65 @@ class KMeans
                const bool initialAssignmentGuess = false,
                const bool initialCentroidGuess = false);
 
+  /**
+   * Perform k-means clustering on the data, warm-started from an earlier
+   * clustering, returning a list of cluster assignments, the centroids of each
+   * cluster, and the bounds the Lloyd step kept for each point.  This is for
+   * re-clustering a dataset which changed a little since the last run: only
+   * the points whose bounds can't show that their cluster stayed the same are
+   * compared to every centroid, so it converges in a few cheap iterations.
+   *
+   * If bounds is not empty, centroids must hold the centroids of the run which
+   * saved the bounds, and column i of bounds holds the bounds of point i.
+   * Points which were removed since then must have their columns removed from
+   * bounds too, and points which were added must come after all of the other
+   * points (they have no bounds yet).  If bounds is empty, the centroids are
+   * found like the other overloads do (or taken from centroids if
+   * initialCentroidGuess is true).  Either way, bounds holds the final bounds
+   * afterwards, and can be saved for the next run.
+   *
+   * This can only be used with Lloyd step types which keep bounds: ElkanKMeans
+   * and HamerlyKMeans.
+   *
+   * @param data Dataset to cluster.
+   * @param clusters Number of clusters to compute.
+   * @param assignments Vector to store cluster assignments in.
+   * @param centroids Matrix in which centroids are stored.
+   * @param bounds Bounds of an earlier run (or an empty matrix); overwritten
+   *      with the final bounds.
+   * @param initialCentroidGuess If true, then it is assumed that centroids
+   *      contains the initial centroids of each cluster.
+   */
+  void Cluster(const MatType& data,
+               const size_t clusters,
+               arma::Col<size_t>& assignments,
+               arma::mat& centroids,
+               arma::mat& bounds,
+               const bool initialCentroidGuess = false);
+
+  /**
+   * Perform k-means clustering on a dataset which is read from disk in blocks
+   * (out-of-core), returning the centroids of each cluster in the centroids
+   * matrix.  Each iteration is one pass over the file, so the dataset never has
+   * to fit in memory.  Optionally, the initial centroids can be specified by
+   * filling the centroids matrix with the initial centroids and specifying
+   * initialGuess = true.
+   *
+   * A uniform sample of BlockSize() points is kept in memory; the initial
+   * partition policy is run on the sample, and so is the empty cluster policy.
+   * The Lloyd step type is not used: each pass is a naive assignment step.
+   *
+   * @param reader Reader for the dataset to cluster.
+   * @param clusters Number of clusters to compute.
+   * @param centroids Matrix in which centroids are stored.
+   * @param initialGuess If true, then it is assumed that centroids contains the
+   *      initial cluster centroids.
+   */
+  void Cluster(data::StreamReader<typename MatType::elem_type>& reader,
+               const size_t clusters,
+               arma::mat& centroids,
+               const bool initialGuess = false);
+
   //! Get the maximum number of iterations.
   size_t MaxIterations() const { return maxIterations; }
   //! Set the maximum number of iterations.
@@ -172,6 +231,25 @@ class KMeans
   std::string ToString() const;
 
  private:
+  //! Check the given initial centroids, or (if initialGuess is false) calculate
+  //! them from the partition given by the initial partition policy.
+  void InitialCentroids(const MatType& data,
+                        const size_t clusters,
+                        arma::mat& centroids,
+                        const bool initialGuess);
+
+  //! Run Lloyd iterations with the given step until the centroids converge or
+  //! the maximum number of iterations is reached.
+  void Iterate(const MatType& data,
+               const size_t clusters,
+               arma::mat& centroids,
+               LloydStepType<MetricType, MatType>& lloydStep);
+
+  //! Assign each point to its closest centroid.
+  void Assign(const MatType& data,
+              const arma::mat& centroids,
+              arma::Col<size_t>& assignments);
+
   //! Maximum number of iterations before giving up.
   size_t maxIterations;
   //! Instantiated distance metric.
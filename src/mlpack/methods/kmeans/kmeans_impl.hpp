@@ -64,6 +64,32 @@ Cluster(const MatType& data,
   Cluster(data, clusters, assignments, centroids, initialGuess);
 }
 
+/**
+ * Perform k-means clustering on the data, returning the centroids of each
+ * cluster.
+ */
+template<typename MetricType,
+         typename InitialPartitionPolicy,
+         typename EmptyClusterPolicy,
+         template<class, class> class LloydStepType,
+         typename MatType>
+void KMeans<
+    MetricType,
+    InitialPartitionPolicy,
+    EmptyClusterPolicy,
+    LloydStepType,
+    MatType>::
+Cluster(const MatType& data,
+        const size_t clusters,
+        arma::mat& centroids,
+        const bool initialGuess)
+{
+  InitialCentroids(data, clusters, centroids, initialGuess);
+
+  LloydStepType<MetricType, MatType> lloydStep(data, metric);
+  Iterate(data, clusters, centroids, lloydStep);
+}
+
 /**
  * Perform k-means clustering on the data, returning a list of cluster
  * assignments and the centroids of each cluster.
@@ -81,8 +107,106 @@ void KMeans<
     MatType>::
 Cluster(const MatType& data,
         const size_t clusters,
+        arma::Col<size_t>& assignments,
         arma::mat& centroids,
-        const bool initialGuess)
+        const bool initialAssignmentGuess,
+        const bool initialCentroidGuess)
+{
+  // Now, the initial assignments.  First determine if they are necessary.
+  if (initialAssignmentGuess)
+  {
+    if (assignments.n_elem != data.n_cols)
+      Log::Fatal << "KMeans::Cluster(): initial cluster assignments (length "
+          << assignments.n_elem << ") not the same size as the dataset (size "
+          << data.n_cols << ")!" << std::endl;
+
+    // Calculate initial centroids.
+    arma::Col<size_t> counts;
+    counts.zeros(clusters);
+    centroids.zeros(data.n_rows, clusters);
+    for (size_t i = 0; i < data.n_cols; ++i)
+    {
+      centroids.col(assignments[i]) += arma::vec(data.col(i));
+      counts[assignments[i]]++;
+    }
+
+    for (size_t i = 0; i < clusters; ++i)
+      if (counts[i] != 0)
+        centroids.col(i) /= counts[i];
+  }
+
+  Cluster(data, clusters, centroids,
+      initialAssignmentGuess || initialCentroidGuess);
+
+  // Calculate final assignments.
+  Assign(data, centroids, assignments);
+}
+
+/**
+ * Perform k-means clustering on the data, starting from the bounds of an
+ * earlier clustering.
+ */
+template<typename MetricType,
+         typename InitialPartitionPolicy,
+         typename EmptyClusterPolicy,
+         template<class, class> class LloydStepType,
+         typename MatType>
+void KMeans<
+    MetricType,
+    InitialPartitionPolicy,
+    EmptyClusterPolicy,
+    LloydStepType,
+    MatType>::
+Cluster(const MatType& data,
+        const size_t clusters,
+        arma::Col<size_t>& assignments,
+        arma::mat& centroids,
+        arma::mat& bounds,
+        const bool initialCentroidGuess)
+{
+  if (bounds.n_cols > data.n_cols)
+    Log::Fatal << "KMeans::Cluster(): bounds given for " << bounds.n_cols
+        << " points, but the dataset only has " << data.n_cols << " points!"
+        << std::endl;
+
+  // The bounds are only valid for the centroids they were saved with.
+  InitialCentroids(data, clusters, centroids,
+      initialCentroidGuess || bounds.n_cols > 0);
+
+  LloydStepType<MetricType, MatType> lloydStep(data, metric);
+  if (bounds.n_cols > 0)
+  {
+    Log::Info << "KMeans::Cluster(): reusing the bounds of " << bounds.n_cols
+        << " points; " << (data.n_cols - bounds.n_cols) << " points are new."
+        << std::endl;
+    lloydStep.SetBounds(bounds, clusters);
+  }
+
+  Iterate(data, clusters, centroids, lloydStep);
+
+  // Save the bounds for the next run, and calculate final assignments.
+  lloydStep.Bounds(bounds);
+  Assign(data, centroids, assignments);
+}
+
+/**
+ * Check the initial centroids, or calculate them with the partitioner.
+ */
+template<typename MetricType,
+         typename InitialPartitionPolicy,
+         typename EmptyClusterPolicy,
+         template<class, class> class LloydStepType,
+         typename MatType>
+void KMeans<
+    MetricType,
+    InitialPartitionPolicy,
+    EmptyClusterPolicy,
+    LloydStepType,
+    MatType>::
+InitialCentroids(const MatType& data,
+                 const size_t clusters,
+                 arma::mat& centroids,
+                 const bool initialGuess)
 {
   // Make sure we have more points than clusters.
   if (clusters > data.n_cols)
@@ -130,13 +254,32 @@ Cluster(const MatType& data,
       if (counts[i] != 0)
         centroids.col(i) /= counts[i];
   }
+}
 
+/**
+ * Run Lloyd iterations with the given step until convergence.
+ */
+template<typename MetricType,
+         typename InitialPartitionPolicy,
+         typename EmptyClusterPolicy,
+         template<class, class> class LloydStepType,
+         typename MatType>
+void KMeans<
+    MetricType,
+    InitialPartitionPolicy,
+    EmptyClusterPolicy,
+    LloydStepType,
+    MatType>::
+Iterate(const MatType& data,
+        const size_t clusters,
+        arma::mat& centroids,
+        LloydStepType<MetricType, MatType>& lloydStep)
+{
   // Counts of points in each cluster.
   arma::Col<size_t> counts(clusters);
 
   size_t iteration = 0;
 
-  LloydStepType<MetricType, MatType> lloydStep(data, metric);
   arma::mat centroidsOther;
   double cNorm;
 
@@ -191,8 +334,7 @@ Cluster(const MatType& data,
 }
 
 /**
- * Perform k-means clustering on the data, returning a list of cluster
- * assignments and the centroids of each cluster.
+ * Assign each point to its closest centroid.
  */
 template<typename MetricType,
          typename InitialPartitionPolicy,
@@ -205,28 +347,115 @@ void KMeans<
     EmptyClusterPolicy,
     LloydStepType,
     MatType>::
-Cluster(const MatType& data,
+Assign(const MatType& data,
+       const arma::mat& centroids,
+       arma::Col<size_t>& assignments)
+{
+  assignments.set_size(data.n_cols);
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    // Find the closest centroid to this point.
+    double minDistance = std::numeric_limits<double>::infinity();
+    size_t closestCluster = centroids.n_cols; // Invalid value.
+
+    for (size_t j = 0; j < centroids.n_cols; j++)
+    {
+      const double distance = metric.Evaluate(data.col(i), centroids.col(j));
+
+      if (distance < minDistance)
+      {
+        minDistance = distance;
+        closestCluster = j;
+      }
+    }
+
+    Log::Assert(closestCluster != centroids.n_cols);
+    assignments[i] = closestCluster;
+  }
+}
+
+/**
+ * Perform out-of-core k-means clustering on a dataset read in blocks, returning
+ * the centroids of each cluster.
+ */
+template<typename MetricType,
+         typename InitialPartitionPolicy,
+         typename EmptyClusterPolicy,
+         template<class, class> class LloydStepType,
+         typename MatType>
+void KMeans<
+    MetricType,
+    InitialPartitionPolicy,
+    EmptyClusterPolicy,
+    LloydStepType,
+    MatType>::
+Cluster(data::StreamReader<typename MatType::elem_type>& reader,
         const size_t clusters,
-        arma::Col<size_t>& assignments,
         arma::mat& centroids,
-        const bool initialAssignmentGuess,
-        const bool initialCentroidGuess)
+        const bool initialGuess)
 {
-  // Now, the initial assignments.  First determine if they are necessary.
-  if (initialAssignmentGuess)
+  typedef arma::Mat<typename MatType::elem_type> BlockType;
+
+  const size_t dimensionality = reader.Dimensionality();
+  if (clusters == 0)
+    Log::Warn << "KMeans::Cluster(): zero clusters requested.  This probably "
+        << "isn't going to work.  Brace for crash." << std::endl;
+
+  // Check validity of initial guess.
+  if (initialGuess)
   {
-    if (assignments.n_elem != data.n_cols)
-      Log::Fatal << "KMeans::Cluster(): initial cluster assignments (length "
-          << assignments.n_elem << ") not the same size as the dataset (size "
-          << data.n_cols << ")!" << std::endl;
+    if (centroids.n_cols != clusters)
+      Log::Fatal << "KMeans::Cluster(): wrong number of initial cluster "
+        << "centroids (" << centroids.n_cols << ", should be " << clusters
+        << ")!" << std::endl;
+
+    if (centroids.n_rows != dimensionality)
+      Log::Fatal << "KMeans::Cluster(): initial cluster centroids have wrong "
+        << " dimensionality (" << centroids.n_rows << ", should be "
+        << dimensionality << ")!" << std::endl;
+  }
+
+  // A uniform sample of the points is collected (by reservoir sampling) during
+  // the first pass over the data.  If there is no initial guess, that pass is
+  // just for the sample, which is then partitioned.  The sample is held in
+  // double precision, like the centroids, whatever the element type of the
+  // stream is.
+  const size_t sampleSize = std::max(reader.BlockSize(), clusters);
+  arma::mat sample(dimensionality, sampleSize);
+  size_t seen = 0;
+  BlockType block;
+
+  if (!initialGuess)
+  {
+    reader.Reset();
+    while (reader.NextBlock(block))
+    {
+      for (size_t i = 0; i < block.n_cols; ++i, ++seen)
+      {
+        const size_t slot = (seen < sampleSize) ? seen :
+            (size_t) (math::Random() * (seen + 1));
+        if (slot < sampleSize)
+          sample.col(slot) = arma::conv_to<arma::vec>::from(block.col(i));
+      }
+    }
+
+    if (seen < sampleSize)
+      sample.resize(dimensionality, seen);
+
+    if (clusters > seen)
+      Log::Warn << "KMeans::Cluster(): more clusters requested than points "
+          << "given." << std::endl;
+
+    arma::Col<size_t> assignments;
+    partitioner.Cluster(sample, clusters, assignments);
 
     // Calculate initial centroids.
     arma::Col<size_t> counts;
     counts.zeros(clusters);
-    centroids.zeros(data.n_rows, clusters);
-    for (size_t i = 0; i < data.n_cols; ++i)
+    centroids.zeros(dimensionality, clusters);
+    for (size_t i = 0; i < sample.n_cols; ++i)
     {
-      centroids.col(assignments[i]) += arma::vec(data.col(i));
+      centroids.col(assignments[i]) += sample.col(i);
       counts[assignments[i]]++;
     }
 
@@ -235,31 +464,129 @@ Cluster(const MatType& data,
         centroids.col(i) /= counts[i];
   }
 
-  Cluster(data, clusters, centroids,
-      initialAssignmentGuess || initialCentroidGuess);
+  arma::Col<size_t> counts(clusters);
+  arma::mat newCentroids;
+  size_t iteration = 0;
+  size_t distanceCalculations = 0;
+  double cNorm;
 
-  // Calculate final assignments.
-  assignments.set_size(data.n_cols);
-  for (size_t i = 0; i < data.n_cols; ++i)
+  do
   {
-    // Find the closest centroid to this point.
-    double minDistance = std::numeric_limits<double>::infinity();
-    size_t closestCluster = centroids.n_cols; // Invalid value.
+    newCentroids.zeros(dimensionality, clusters);
+    counts.zeros(clusters);
 
-    for (size_t j = 0; j < centroids.n_cols; j++)
+    reader.Reset();
+    while (reader.NextBlock(block))
     {
-      const double distance = metric.Evaluate(data.col(i), centroids.col(j));
+      for (size_t i = 0; i < block.n_cols; ++i)
+      {
+        const arma::vec point = arma::conv_to<arma::vec>::from(block.col(i));
 
-      if (distance < minDistance)
+        // Find the closest centroid to this point.
+        double minDistance = std::numeric_limits<double>::infinity();
+        size_t closestCluster = centroids.n_cols; // Invalid value.
+
+        for (size_t j = 0; j < centroids.n_cols; j++)
+        {
+          const double distance = metric.Evaluate(point, centroids.col(j));
+
+          if (distance < minDistance)
+          {
+            minDistance = distance;
+            closestCluster = j;
+          }
+        }
+
+        Log::Assert(closestCluster != centroids.n_cols);
+        newCentroids.col(closestCluster) += point;
+        counts(closestCluster)++;
+
+        // The sample still has to be collected if there was an initial guess.
+        if (initialGuess && iteration == 0)
+        {
+          const size_t slot = (seen < sampleSize) ? seen :
+              (size_t) (math::Random() * (seen + 1));
+          if (slot < sampleSize)
+            sample.col(slot) = point;
+          ++seen;
+        }
+      }
+
+      distanceCalculations += centroids.n_cols * block.n_cols;
+    }
+
+    if (initialGuess && iteration == 0 && seen < sampleSize)
+      sample.resize(dimensionality, seen);
+
+    // Now normalize the centroids.
+    for (size_t i = 0; i < clusters; ++i)
+      if (counts(i) != 0)
+        newCentroids.col(i) /= counts(i);
+      else
+        newCentroids.col(i).fill(DBL_MAX); // Invalid value.
+
+    // Calculate cluster distortion for this iteration.
+    cNorm = 0.0;
+    for (size_t i = 0; i < clusters; ++i)
+      cNorm += std::pow(metric.Evaluate(centroids.col(i),
+          newCentroids.col(i)), 2.0);
+    cNorm = std::sqrt(cNorm);
+    distanceCalculations += clusters;
+
+    // The whole dataset isn't available to the empty cluster policy, so it is
+    // given the sample, with the counts of the sample.
+    if (arma::any(counts == 0) && sample.n_cols > 0)
+    {
+      arma::Col<size_t> sampleCounts;
+      sampleCounts.zeros(clusters);
+      for (size_t i = 0; i < sample.n_cols; ++i)
       {
-        minDistance = distance;
-        closestCluster = j;
+        double minDistance = std::numeric_limits<double>::infinity();
+        size_t closestCluster = 0;
+        for (size_t j = 0; j < clusters; j++)
+        {
+          const double distance = metric.Evaluate(sample.col(i),
+              newCentroids.col(j));
+          if (distance < minDistance)
+          {
+            minDistance = distance;
+            closestCluster = j;
+          }
+        }
+
+        sampleCounts[closestCluster]++;
+      }
+
+      for (size_t i = 0; i < clusters; i++)
+      {
+        if (counts[i] == 0)
+        {
+          Log::Info << "Cluster " << i << " is empty.\n";
+          emptyClusterAction.EmptyCluster(sample, i, newCentroids,
+              sampleCounts, metric);
+        }
       }
     }
 
-    Log::Assert(closestCluster != centroids.n_cols);
-    assignments[i] = closestCluster;
+    centroids.swap(newCentroids);
+
+    iteration++;
+    Log::Info << "KMeans::Cluster(): iteration " << iteration << ", residual "
+        << cNorm << ".\n";
+
+  } while (cNorm > 1e-5 && iteration != maxIterations);
+
+  if (iteration != maxIterations)
+  {
+    Log::Info << "KMeans::Cluster(): converged after " << iteration
+        << " iterations." << std::endl;
+  }
+  else
+  {
+    Log::Info << "KMeans::Cluster(): terminated after limit of " << iteration
+        << " iterations." << std::endl;
   }
+  Log::Info << distanceCalculations << " distance calculations." << std::endl;
 }
 
 template<typename MetricType,
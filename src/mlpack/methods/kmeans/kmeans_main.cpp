@@ -9,10 +9,13 @@
 #include "kmeans.hpp"
 #include "allow_empty_clusters.hpp"
 #include "refined_start.hpp"
+#include "kmeans_plus_plus.hpp"
+#include "kmeans_parallel.hpp"
 #include "elkan_kmeans.hpp"
 #include "hamerly_kmeans.hpp"
 #include "pelleg_moore_kmeans.hpp"
 #include "dual_tree_kmeans.hpp"
+#include "mini_batch_kmeans.hpp"
 
 using namespace mlpack;
 using namespace mlpack::kmeans;
@@ -34,6 +37,14 @@ PROGRAM_INFO("K-Means Clustering", "This program performs K-Means clustering "
     "to be used in each sample, the --percentage parameter is used (it should "
     "be a value between 0.0 and 1.0)."
     "\n\n"
+    "Instead, the initial centroids can be chosen with k-means++ (Arthur and "
+    "Vassilvitskii, 2007) by specifying --kmeans_plus_plus (-K), or with its "
+    "scalable variant k-means|| (Bahmani et al., 2012), which takes only a few "
+    "passes over the data and is much faster for large numbers of clusters, by "
+    "specifying --kmeans_parallel (-L).  The number of rounds of k-means|| is "
+    "given by --rounds, and the number of candidates drawn in each round is "
+    "--oversampling times the number of clusters."
+    "\n\n"
     "There are several options available for the algorithm used for each Lloyd "
     "iteration, specified with the --algorithm (-a) option.  The standard O(kN)"
     " approach can be used ('naive').  Other options include the Pelleg-Moore "
@@ -41,6 +52,27 @@ PROGRAM_INFO("K-Means Clustering", "This program performs K-Means clustering "
     "algorithm ('elkan'), and Hamerly's modification to Elkan's algorithm "
     "('hamerly')."
     "\n\n"
+    "For very large datasets, mini-batch k-means ('mini-batch') can be used; "
+    "each iteration then only looks at a random sample of --batch_size (-b) "
+    "points, and moves each centroid towards its points with a learning rate "
+    "that decreases over time.  The result is close to that of the other "
+    "algorithms at a fraction of the cost; since the centroids move a little at "
+    "every iteration, --max_iterations should usually be set."
+    "\n\n"
+    "Datasets which do not fit in memory can be clustered by specifying "
+    "--block_size (-B); the dataset is then read from disk in blocks of that "
+    "many points at every iteration.  In this case only the centroids can be "
+    "saved (with --centroid_file), and the 'naive' algorithm is always used."
+    "\n\n"
+    "A dataset which changed a little since it was last clustered can be "
+    "re-clustered quickly with the 'elkan' or 'hamerly' algorithms by giving "
+    "--bounds_file (-O) and passing the centroids of the last run with "
+    "--initial_centroids (-I).  The bounds on the distances from each point to "
+    "the centroids are then read from that file (if it exists) and saved to it "
+    "after clustering.  Points added since the last run must be at the end of "
+    "the dataset, and the columns of removed points must be removed from the "
+    "bounds file."
+    "\n\n"
     "As of October 2014, the --overclustering option has been removed.  If you "
     "want this support back, let us know -- file a bug at "
     "https://github.com/mlpack/mlpack/ or get in touch through another means.");
@@ -76,8 +108,28 @@ PARAM_INT("samplings", "Number of samplings to perform for refined start (use "
 PARAM_DOUBLE("percentage", "Percentage of dataset to use for each refined start"
     " sampling (use when --refined_start is specified).", "p", 0.02);
 
+// Parameters for k-means++ and k-means||.
+PARAM_FLAG("kmeans_plus_plus", "Use k-means++ to choose initial points.", "K");
+PARAM_FLAG("kmeans_parallel", "Use k-means|| (scalable k-means++) to choose "
+    "initial points.", "L");
+PARAM_INT("rounds", "Number of rounds of sampling for k-means|| (use when "
+    "--kmeans_parallel is specified).", "", 5);
+PARAM_DOUBLE("oversampling", "Number of candidates drawn in each round of "
+    "k-means||, as a multiple of the number of clusters (use when "
+    "--kmeans_parallel is specified).", "", 2.0);
+
 PARAM_STRING("algorithm", "Algorithm to use for the Lloyd iteration ('naive', "
-    "'pelleg-moore', 'elkan', 'hamerly', or 'dtnn').", "a", "naive");
+    "'pelleg-moore', 'elkan', 'hamerly', 'dualtree', 'dualtree-covertree', or "
+    "'mini-batch').", "a", "naive");
+PARAM_INT("batch_size", "Number of points in each batch for mini-batch k-means "
+    "(use when --algorithm mini-batch is specified).", "b", 1000);
+
+PARAM_STRING("bounds_file", "File to read the bounds of an earlier run from (if "
+    "it exists) and to save the bounds to (use with --algorithm elkan or "
+    "--algorithm hamerly).", "O", "");
+
+PARAM_INT("block_size", "If nonzero, read the dataset from disk in blocks of "
+    "this many points instead of loading it (out-of-core clustering).", "B", 0);
 
 // Given the type of initial partition policy, figure out the empty cluster
 // policy and run k-means.
@@ -95,6 +147,69 @@ template<typename InitialPartitionPolicy,
          template<class, class> class LloydStepType>
 void RunKMeans(const InitialPartitionPolicy& ipp);
 
+// Cluster, reusing the bounds in --bounds_file (if it exists) and saving the new
+// bounds to it.
+template<typename KMeansType>
+void ClusterWithSavedBounds(KMeansType& kmeans,
+                            const arma::mat& dataset,
+                            const size_t clusters,
+                            arma::Col<size_t>& assignments,
+                            arma::mat& centroids,
+                            const bool initialCentroidGuess);
+
+// Only ElkanKMeans and HamerlyKMeans keep bounds, so this does nothing for the
+// other algorithms (they are rejected when the options are checked).
+template<typename KMeansType>
+void ClusterWithBounds(KMeansType& /* kmeans */,
+                       const arma::mat& /* dataset */,
+                       const size_t /* clusters */,
+                       arma::Col<size_t>& /* assignments */,
+                       arma::mat& /* centroids */,
+                       const bool /* initialCentroidGuess */)
+{ }
+
+template<typename InitialPartitionPolicy, typename EmptyClusterPolicy>
+void ClusterWithBounds(KMeans<metric::EuclideanDistance,
+                              InitialPartitionPolicy,
+                              EmptyClusterPolicy,
+                              ElkanKMeans>& kmeans,
+                       const arma::mat& dataset,
+                       const size_t clusters,
+                       arma::Col<size_t>& assignments,
+                       arma::mat& centroids,
+                       const bool initialCentroidGuess)
+{
+  ClusterWithSavedBounds(kmeans, dataset, clusters, assignments, centroids,
+      initialCentroidGuess);
+}
+
+template<typename InitialPartitionPolicy, typename EmptyClusterPolicy>
+void ClusterWithBounds(KMeans<metric::EuclideanDistance,
+                              InitialPartitionPolicy,
+                              EmptyClusterPolicy,
+                              HamerlyKMeans>& kmeans,
+                       const arma::mat& dataset,
+                       const size_t clusters,
+                       arma::Col<size_t>& assignments,
+                       arma::mat& centroids,
+                       const bool initialCentroidGuess)
+{
+  ClusterWithSavedBounds(kmeans, dataset, clusters, assignments, centroids,
+      initialCentroidGuess);
+}
+
+// KMeans constructs the Lloyd step with only the dataset and the metric, so
+// this passes the batch size given on the command line to MiniBatchKMeans.
+template<typename MetricType, typename MatType>
+class CLIMiniBatchKMeans : public MiniBatchKMeans<MetricType, MatType>
+{
+ public:
+  CLIMiniBatchKMeans(const MatType& dataset, MetricType& metric) :
+      MiniBatchKMeans<MetricType, MatType>(dataset, metric,
+          (size_t) CLI::GetParam<int>("batch_size"))
+  { }
+};
+
 int main(int argc, char** argv)
 {
   CLI::ParseCommandLine(argc, argv);
@@ -108,6 +223,12 @@ int main(int argc, char** argv)
   // Now, start building the KMeans type that we'll be using.  Start with the
   // initial partition policy.  The call to FindEmptyClusterPolicy<> results in
   // a call to RunKMeans<> and the algorithm is completed.
+  if ((size_t) CLI::HasParam("refined_start") +
+      (size_t) CLI::HasParam("kmeans_plus_plus") +
+      (size_t) CLI::HasParam("kmeans_parallel") > 1)
+    Log::Fatal << "Only one of --refined_start, --kmeans_plus_plus and "
+        << "--kmeans_parallel may be specified!" << endl;
+
   if (CLI::HasParam("refined_start"))
   {
     const int samplings = CLI::GetParam<int>("samplings");
@@ -122,6 +243,25 @@ int main(int argc, char** argv)
 
     FindEmptyClusterPolicy<RefinedStart>(RefinedStart(samplings, percentage));
   }
+  else if (CLI::HasParam("kmeans_plus_plus"))
+  {
+    FindEmptyClusterPolicy<KMeansPlusPlus>(KMeansPlusPlus());
+  }
+  else if (CLI::HasParam("kmeans_parallel"))
+  {
+    const int rounds = CLI::GetParam<int>("rounds");
+    const double oversampling = CLI::GetParam<double>("oversampling");
+
+    if (rounds < 0)
+      Log::Fatal << "Number of rounds (" << rounds << ") must be greater than "
+          << "or equal to 0!" << endl;
+    if (oversampling <= 0.0)
+      Log::Fatal << "Oversampling factor (" << oversampling << ") must be "
+          << "greater than 0.0!" << endl;
+
+    FindEmptyClusterPolicy<KMeansParallel>(KMeansParallel(oversampling,
+        (size_t) rounds));
+  }
   else
   {
     FindEmptyClusterPolicy<RandomPartition>(RandomPartition());
@@ -160,9 +300,13 @@ void FindLloydStepType(const InitialPartitionPolicy& ipp)
         CoverTreeDualTreeKMeans>(ipp);
   else if (algorithm == "naive")
     RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy, NaiveKMeans>(ipp);
+  else if (algorithm == "mini-batch")
+    RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy,
+        CLIMiniBatchKMeans>(ipp);
   else
     Log::Fatal << "Unknown algorithm: '" << algorithm << "'.  Supported options"
-        << " are 'naive', 'pelleg-moore', 'elkan', and 'hamerly'." << endl;
+        << " are 'naive', 'pelleg-moore', 'elkan', 'hamerly', 'dualtree', "
+        << "'dualtree-covertree', and 'mini-batch'." << endl;
 }
 
 // Given the template parameters, sanitize/load input and run k-means.
@@ -205,9 +349,37 @@ void RunKMeans(const InitialPartitionPolicy& ipp)
         << "no results will be saved." << std::endl;
   }
 
-  // Load our dataset.
-  arma::mat dataset;
-  data::Load(inputFile, dataset, true); // Fatal upon failure.
+  if (CLI::GetParam<int>("batch_size") <= 0)
+  {
+    Log::Fatal << "Invalid batch size (" << CLI::GetParam<int>("batch_size")
+        << ")! Must be greater than 0." << endl;
+  }
+
+  if (CLI::HasParam("bounds_file"))
+  {
+    const string algorithm = CLI::GetParam<string>("algorithm");
+    if (algorithm != "elkan" && algorithm != "hamerly")
+      Log::Fatal << "--bounds_file can only be used with --algorithm elkan or "
+          << "--algorithm hamerly." << endl;
+    if (CLI::HasParam("block_size"))
+      Log::Fatal << "--bounds_file cannot be used with --block_size." << endl;
+    if (!CLI::HasParam("centroid_file"))
+      Log::Warn << "--centroid_file is not set; the saved bounds can only be "
+          << "used with the final centroids." << endl;
+  }
+
+  const int blockSize = CLI::GetParam<int>("block_size");
+  if (blockSize < 0)
+  {
+    Log::Fatal << "Invalid block size (" << blockSize << ")! Must be greater "
+        << "than or equal to 0." << endl;
+  }
+  else if (blockSize > 0 && (CLI::HasParam("output_file") ||
+      CLI::HasParam("in_place")))
+  {
+    Log::Fatal << "--output_file and --in_place cannot be used with "
+        << "--block_size; only the centroids can be saved." << endl;
+  }
 
   arma::mat centroids;
 
@@ -220,26 +392,52 @@ void RunKMeans(const InitialPartitionPolicy& ipp)
     if (clusters == 0)
       clusters = centroids.n_cols;
 
-    if (CLI::HasParam("refined_start"))
+    if (CLI::HasParam("refined_start") ||
+        CLI::HasParam("kmeans_plus_plus") ||
+        CLI::HasParam("kmeans_parallel"))
       Log::Warn << "Initial centroids are specified, but will be ignored "
-          << "because --refined_start is also specified!" << endl;
+          << "because an initial point strategy is also specified!" << endl;
     else
       Log::Info << "Using initial centroid guesses from '" <<
           initialCentroidsFile << "'." << endl;
   }
 
-  Timer::Start("clustering");
   KMeans<metric::EuclideanDistance,
          InitialPartitionPolicy,
          EmptyClusterPolicy,
          LloydStepType> kmeans(maxIterations, metric::EuclideanDistance(), ipp);
 
-  if (CLI::HasParam("output_file") || CLI::HasParam("in_place"))
+  if (blockSize > 0)
+  {
+    // Cluster out-of-core, without loading the dataset.
+    data::StreamReader<> reader(inputFile, (size_t) blockSize, true);
+
+    Timer::Start("clustering");
+    kmeans.Cluster(reader, clusters, centroids, initialCentroidGuess);
+    Timer::Stop("clustering");
+
+    if (CLI::HasParam("centroid_file"))
+      data::Save(CLI::GetParam<std::string>("centroid_file"), centroids);
+
+    return;
+  }
+
+  // Load our dataset.
+  arma::mat dataset;
+  data::Load(inputFile, dataset, true); // Fatal upon failure.
+
+  Timer::Start("clustering");
+  if (CLI::HasParam("output_file") || CLI::HasParam("in_place") ||
+      CLI::HasParam("bounds_file"))
   {
     // We need to get the assignments.
     arma::Col<size_t> assignments;
-    kmeans.Cluster(dataset, clusters, assignments, centroids,
-        false, initialCentroidGuess);
+    if (CLI::HasParam("bounds_file"))
+      ClusterWithBounds(kmeans, dataset, clusters, assignments, centroids,
+          initialCentroidGuess);
+    else
+      kmeans.Cluster(dataset, clusters, assignments, centroids,
+          false, initialCentroidGuess);
     Timer::Stop("clustering");
 
     // Now figure out what to do with our results.
@@ -256,7 +454,7 @@ void RunKMeans(const InitialPartitionPolicy& ipp)
       // Save the dataset.
       data::Save(inputFile, dataset);
     }
-    else
+    else if (CLI::HasParam("output_file"))
     {
       if (CLI::HasParam("labels_only"))
       {
@@ -291,3 +489,33 @@ void RunKMeans(const InitialPartitionPolicy& ipp)
   if (CLI::HasParam("centroid_file"))
     data::Save(CLI::GetParam<std::string>("centroid_file"), centroids);
 }
+
+template<typename KMeansType>
+void ClusterWithSavedBounds(KMeansType& kmeans,
+                            const arma::mat& dataset,
+                            const size_t clusters,
+                            arma::Col<size_t>& assignments,
+                            arma::mat& centroids,
+                            const bool initialCentroidGuess)
+{
+  const string boundsFile = CLI::GetParam<string>("bounds_file");
+
+  // The bounds file doesn't exist before the first run.
+  arma::mat bounds;
+  if (std::ifstream(boundsFile.c_str()).good())
+  {
+    if (!initialCentroidGuess)
+      Log::Fatal << "The bounds in '" << boundsFile << "' can only be used with "
+          << "the centroids they were saved with; specify them with "
+          << "--initial_centroids." << endl;
+
+    data::Load(boundsFile, bounds, true);
+    Log::Info << "Loaded the bounds of " << bounds.n_cols << " points from '"
+        << boundsFile << "'." << endl;
+  }
+
+  kmeans.Cluster(dataset, clusters, assignments, centroids, bounds,
+      initialCentroidGuess);
+
+  data::Save(boundsFile, bounds);
+}
@@ -0,0 +1,98 @@
+/**
+ * @file kmeans_parallel.hpp
+ *
+ * The scalable k-means++ ("k-means||") initialization of Bahmani et al., which
+ * oversamples candidate centroids in a few passes over the data and then
+ * reclusters the candidates.
+ */
+#ifndef __MLPACK_METHODS_KMEANS_KMEANS_PARALLEL_HPP
+#define __MLPACK_METHODS_KMEANS_KMEANS_PARALLEL_HPP
+
+#include <mlpack/core.hpp>
+#include "kmeans_plus_plus.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * An InitialPartitionPolicy which chooses initial centroids with k-means||.
+ * Instead of the k passes over the data that KMeansPlusPlus takes, a few rounds
+ * are run, and in each round every point is made a candidate centroid
+ * independently with probability l * d^2 / phi, where d is its distance to the
+ * closest candidate so far, phi is the sum of those squared distances, and l
+ * (the oversampling factor times k) is the expected number of new candidates.
+ * Then each candidate is weighted by the number of points closest to it, the
+ * candidates are clustered with weighted k-means++, and each point is assigned
+ * to the cluster of its closest candidate.  This is an implementation of the
+ * following paper:
+ *
+ * @code
+ * @article{bahmani2012scalable,
+ *   title={Scalable k-means++},
+ *   author={Bahmani, Bahman and Moseley, Benjamin and Vattani, Andrea and
+ *       Kumar, Ravi and Vassilvitskii, Sergei},
+ *   journal={Proceedings of the VLDB Endowment},
+ *   volume={5},
+ *   number={7},
+ *   pages={622--633},
+ *   year={2012}
+ * }
+ * @endcode
+ *
+ * The distances to the candidates are updated with OpenMP threads.
+ */
+class KMeansParallel
+{
+ public:
+  /**
+   * Create the KMeansParallel object, optionally specifying the oversampling
+   * factor and the number of rounds.
+   *
+   * @param oversampling Expected number of candidates drawn in each round, as
+   *     a multiple of the number of clusters.
+   * @param rounds Number of rounds of sampling.
+   */
+  KMeansParallel(const double oversampling = 2.0,
+                 const size_t rounds = 5) :
+      oversampling(oversampling), rounds(rounds) { }
+
+  /**
+   * Partition the given dataset into the given number of clusters with
+   * k-means||.
+   *
+   * @tparam MatType Type of data (arma::mat or arma::sp_mat).
+   * @param data Dataset to partition.
+   * @param clusters Number of clusters to split dataset into.
+   * @param assignments Vector to store cluster assignments into.  Values will
+   *     be between 0 and (clusters - 1).
+   */
+  template<typename MatType>
+  void Cluster(const MatType& data,
+               const size_t clusters,
+               arma::Col<size_t>& assignments) const;
+
+  //! Get the oversampling factor.
+  double Oversampling() const { return oversampling; }
+  //! Modify the oversampling factor.
+  double& Oversampling() { return oversampling; }
+
+  //! Get the number of rounds of sampling.
+  size_t Rounds() const { return rounds; }
+  //! Modify the number of rounds of sampling.
+  size_t& Rounds() { return rounds; }
+
+ private:
+  //! The expected number of candidates drawn in each round, as a multiple of
+  //! the number of clusters.
+  double oversampling;
+  //! The number of rounds of sampling.
+  size_t rounds;
+};
+
+}; // namespace kmeans
+}; // namespace mlpack
+
+// Include implementation.
+#include "kmeans_parallel_impl.hpp"
+
+#endif
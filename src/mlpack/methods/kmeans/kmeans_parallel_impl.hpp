@@ -0,0 +1,106 @@
+/**
+ * @file kmeans_parallel_impl.hpp
+ *
+ * Implementation of the k-means|| initialization.
+ */
+#ifndef __MLPACK_METHODS_KMEANS_KMEANS_PARALLEL_IMPL_HPP
+#define __MLPACK_METHODS_KMEANS_KMEANS_PARALLEL_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "kmeans_parallel.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MatType>
+void KMeansParallel::Cluster(const MatType& data,
+                             const size_t clusters,
+                             arma::Col<size_t>& assignments) const
+{
+  const size_t n = data.n_cols;
+  assignments.zeros(n);
+  if (n == 0 || clusters == 0)
+    return;
+
+  // The squared distance of each point to its closest candidate, and the index
+  // of that candidate.
+  arma::vec minDistances(n);
+  minDistances.fill(std::numeric_limits<double>::infinity());
+  arma::Col<size_t> closest(n);
+
+  // The first candidate is a random point.
+  std::vector<size_t> candidates;
+  candidates.push_back((size_t) math::RandInt(n));
+
+  const double l = oversampling * clusters;
+  size_t known = 0; // Candidates whose distances have been computed.
+  for (size_t round = 0; round <= rounds; ++round)
+  {
+    // Update the distances with the candidates of the last round.
+    const size_t newCandidates = candidates.size() - known;
+    arma::mat centroids(data.n_rows, newCandidates);
+    for (size_t j = 0; j < newCandidates; ++j)
+      centroids.col(j) = arma::vec(data.col(candidates[known + j]));
+
+    double cost = 0.0;
+    #pragma omp parallel for schedule(static) reduction(+:cost)
+    for (size_t i = 0; i < n; ++i)
+    {
+      for (size_t j = 0; j < newCandidates; ++j)
+      {
+        const double distance = metric::SquaredEuclideanDistance::Evaluate(
+            data.col(i), centroids.col(j));
+        if (distance < minDistances[i])
+        {
+          minDistances[i] = distance;
+          closest[i] = known + j;
+        }
+      }
+
+      cost += minDistances[i];
+    }
+
+    known = candidates.size();
+    if (round == rounds || cost == 0.0)
+      break;
+
+    // Draw the next candidates.  The random number generator can't be shared
+    // between threads, so this is serial, but it is only O(N).
+    for (size_t i = 0; i < n; ++i)
+      if (math::Random() < l * minDistances[i] / cost)
+        candidates.push_back(i);
+  }
+
+  Log::Info << "KMeansParallel::Cluster(): " << candidates.size()
+      << " candidate centroids." << std::endl;
+
+  // With too few candidates, each one is its own cluster.
+  if (candidates.size() <= clusters)
+  {
+    assignments = closest;
+    return;
+  }
+
+  // Weight each candidate by the number of points closest to it, and cluster
+  // the candidates.
+  arma::vec weights;
+  weights.zeros(candidates.size());
+  for (size_t i = 0; i < n; ++i)
+    weights[closest[i]] += 1.0;
+
+  arma::mat candidateData(data.n_rows, candidates.size());
+  for (size_t j = 0; j < candidates.size(); ++j)
+    candidateData.col(j) = arma::vec(data.col(candidates[j]));
+
+  arma::Col<size_t> candidateAssignments;
+  KMeansPlusPlus::Cluster(candidateData, weights, clusters,
+      candidateAssignments);
+
+  for (size_t i = 0; i < n; ++i)
+    assignments[i] = candidateAssignments[closest[i]];
+}
+
+}; // namespace kmeans
+}; // namespace mlpack
+
+#endif
@@ -0,0 +1,87 @@
+/**
+ * @file kmeans_plus_plus.hpp
+ *
+ * The k-means++ initialization of Arthur and Vassilvitskii, which picks the
+ * initial centroids one at a time, each with probability proportional to its
+ * squared distance from the centroids already picked.
+ */
+#ifndef __MLPACK_METHODS_KMEANS_KMEANS_PLUS_PLUS_HPP
+#define __MLPACK_METHODS_KMEANS_KMEANS_PLUS_PLUS_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * An InitialPartitionPolicy which chooses initial centroids with k-means++
+ * ("D^2 sampling"): the first centroid is a random point, and each further
+ * centroid is a point chosen with probability proportional to its squared
+ * Euclidean distance to the closest centroid chosen so far.  Each point is then
+ * assigned to its closest centroid.  This is an implementation of the following
+ * paper:
+ *
+ * @code
+ * @inproceedings{arthur2007k,
+ *   title={k-means++: The advantages of careful seeding},
+ *   author={Arthur, David and Vassilvitskii, Sergei},
+ *   booktitle={Proceedings of the Eighteenth Annual ACM-SIAM Symposium on
+ *       Discrete Algorithms (SODA '07)},
+ *   pages={1027--1035},
+ *   year={2007}
+ * }
+ * @endcode
+ *
+ * Choosing k centroids takes O(kN) distance calculations; the distances are
+ * updated with OpenMP threads, but the centroids still have to be picked one
+ * after another.  For large k, KMeansParallel needs far fewer passes over the
+ * data.
+ */
+class KMeansPlusPlus
+{
+ public:
+  //! Empty constructor, required by the InitialPartitionPolicy policy.
+  KMeansPlusPlus() { }
+
+  /**
+   * Partition the given dataset into the given number of clusters by choosing
+   * the centroids with k-means++ and assigning each point to the closest one.
+   *
+   * @tparam MatType Type of data (arma::mat or arma::sp_mat).
+   * @param data Dataset to partition.
+   * @param clusters Number of clusters to split dataset into.
+   * @param assignments Vector to store cluster assignments into.  Values will
+   *     be between 0 and (clusters - 1).
+   */
+  template<typename MatType>
+  static void Cluster(const MatType& data,
+                      const size_t clusters,
+                      arma::Col<size_t>& assignments);
+
+  /**
+   * Partition the given weighted dataset into the given number of clusters by
+   * choosing the centroids with k-means++, where each point is chosen with
+   * probability proportional to its weight times its squared distance.  This is
+   * what KMeansParallel uses to recluster its candidate centroids.
+   *
+   * @tparam MatType Type of data (arma::mat or arma::sp_mat).
+   * @param data Dataset to partition.
+   * @param weights Non-negative weight of each point.
+   * @param clusters Number of clusters to split dataset into.
+   * @param assignments Vector to store cluster assignments into.  Values will
+   *     be between 0 and (clusters - 1).
+   */
+  template<typename MatType>
+  static void Cluster(const MatType& data,
+                      const arma::vec& weights,
+                      const size_t clusters,
+                      arma::Col<size_t>& assignments);
+};
+
+}; // namespace kmeans
+}; // namespace mlpack
+
+// Include implementation.
+#include "kmeans_plus_plus_impl.hpp"
+
+#endif
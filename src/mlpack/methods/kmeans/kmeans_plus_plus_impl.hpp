@@ -0,0 +1,122 @@
+/**
+ * @file kmeans_plus_plus_impl.hpp
+ *
+ * Implementation of the k-means++ initialization.
+ */
+#ifndef __MLPACK_METHODS_KMEANS_KMEANS_PLUS_PLUS_IMPL_HPP
+#define __MLPACK_METHODS_KMEANS_KMEANS_PLUS_PLUS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "kmeans_plus_plus.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MatType>
+void KMeansPlusPlus::Cluster(const MatType& data,
+                             const size_t clusters,
+                             arma::Col<size_t>& assignments)
+{
+  arma::vec weights;
+  weights.ones(data.n_cols);
+  Cluster(data, weights, clusters, assignments);
+}
+
+template<typename MatType>
+void KMeansPlusPlus::Cluster(const MatType& data,
+                             const arma::vec& weights,
+                             const size_t clusters,
+                             arma::Col<size_t>& assignments)
+{
+  const size_t n = data.n_cols;
+  assignments.zeros(n);
+  if (n == 0 || clusters == 0)
+    return;
+
+  if (weights.n_elem != n)
+    Log::Fatal << "KMeansPlusPlus::Cluster(): " << weights.n_elem
+        << " weights given for " << n << " points!" << std::endl;
+
+  // The squared distance of each point to its closest centroid so far.
+  arma::vec minDistances(n);
+  minDistances.fill(std::numeric_limits<double>::infinity());
+
+  // The points are split into a fixed number of chunks (independent of the
+  // number of threads, so the result only depends on the random seed), and the
+  // sum of the probabilities in each chunk is kept, so that a point can be
+  // drawn without a serial pass over all of them.
+  const size_t chunkSize = std::max((size_t) 1, (n + 255) / 256);
+  const size_t chunks = (n + chunkSize - 1) / chunkSize;
+  arma::vec chunkSums(chunks);
+
+  // The first centroid is drawn with probability proportional to its weight.
+  for (size_t c = 0; c < chunks; ++c)
+  {
+    const size_t end = std::min(n, (c + 1) * chunkSize);
+    chunkSums[c] = arma::accu(weights.subvec(c * chunkSize, end - 1));
+  }
+  const arma::vec* probabilities = &weights;
+
+  arma::vec products(n);
+  arma::vec centroid;
+  for (size_t cluster = 0; cluster < clusters; ++cluster)
+  {
+    // Draw the next centroid.  If every point is already a centroid (or has
+    // weight zero), pick any point; the cluster will end up empty.
+    size_t next = (size_t) math::RandInt(n);
+    const double total = arma::accu(chunkSums);
+    if (total > 0.0)
+    {
+      double r = math::Random() * total;
+      size_t c = 0;
+      while (c < chunks - 1 && r >= chunkSums[c])
+        r -= chunkSums[c++];
+
+      const size_t end = std::min(n, (c + 1) * chunkSize);
+      for (size_t i = c * chunkSize; i < end; ++i)
+      {
+        if ((*probabilities)[i] > 0.0)
+        {
+          // Floating-point error may leave r slightly too large; then the last
+          // possible point in the chunk is taken.
+          next = i;
+          r -= (*probabilities)[i];
+          if (r < 0.0)
+            break;
+        }
+      }
+    }
+
+    centroid = arma::vec(data.col(next));
+
+    // Update the distances to the closest centroid, and the sums of each chunk.
+    #pragma omp parallel for schedule(static)
+    for (size_t c = 0; c < chunks; ++c)
+    {
+      const size_t end = std::min(n, (c + 1) * chunkSize);
+      double sum = 0.0;
+      for (size_t i = c * chunkSize; i < end; ++i)
+      {
+        const double distance = metric::SquaredEuclideanDistance::Evaluate(
+            data.col(i), centroid);
+        if (distance < minDistances[i])
+        {
+          minDistances[i] = distance;
+          assignments[i] = cluster;
+        }
+
+        products[i] = weights[i] * minDistances[i];
+        sum += products[i];
+      }
+
+      chunkSums[c] = sum;
+    }
+
+    probabilities = &products;
+  }
+}
+
+}; // namespace kmeans
+}; // namespace mlpack
+
+#endif
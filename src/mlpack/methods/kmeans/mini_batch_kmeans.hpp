@@ -0,0 +1,138 @@
+/**
+ * @file mini_batch_kmeans.hpp
+ *
+ * An implementation of a step of mini-batch k-means (Sculley, 2010), which
+ * updates the centroids with a small random sample of the points instead of
+ * the whole dataset.
+ */
+#ifndef __MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_HPP
+#define __MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_HPP
+
+#include <mlpack/core.hpp>
+#include <mlpack/core/metrics/block_evaluate.hpp>
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * This is an implementation of a single step of mini-batch k-means, from the
+ * following paper:
+ *
+ * @code
+ * @inproceedings{sculley2010web,
+ *   title={Web-scale k-means clustering},
+ *   author={Sculley, D.},
+ *   booktitle={Proceedings of the 19th International Conference on World Wide
+ *       Web (WWW '10)},
+ *   pages={1177--1178},
+ *   year={2010}
+ * }
+ * @endcode
+ *
+ * Each call to Iterate() draws a batch of points uniformly at random (with
+ * replacement) from the dataset, finds the closest centroid to each of them,
+ * and then moves each centroid towards its points one at a time with a
+ * learning rate of 1 / (number of points ever assigned to that centroid).  So
+ * each step costs O(kb) instead of O(kN) for a batch size of b, and since the
+ * learning rates shrink, the centroids settle down much like Lloyd's algorithm
+ * would.  The counts returned by Iterate() are the total number of points
+ * assigned to each centroid so far, so the empty cluster policy is only called
+ * for centroids that have never been assigned a point.
+ *
+ * Because the learning rates are kept between calls, a MiniBatchKMeans object
+ * can also be fed batches from somewhere else with Update(), such as the blocks
+ * of a data::StreamReader.
+ *
+ * When used with KMeans, the batch size is the default; to use another batch
+ * size, derive a class whose constructor passes it (kmeans_main.cpp does this).
+ *
+ * @param MetricType Type of metric used with this implementation.
+ * @param MatType Matrix type (arma::mat or arma::sp_mat).
+ */
+template<typename MetricType, typename MatType>
+class MiniBatchKMeans
+{
+ public:
+  /**
+   * Construct the MiniBatchKMeans object with the given dataset and metric.
+   *
+   * @param dataset Dataset.
+   * @param metric Instantiated metric.
+   * @param batchSize Number of points to use for each step.
+   */
+  MiniBatchKMeans(const MatType& dataset,
+                  MetricType& metric,
+                  const size_t batchSize = 1000);
+
+  /**
+   * Run a single step of mini-batch k-means on a random batch of points,
+   * putting the updated centroids into the newCentroids matrix.  Returns the
+   * distance the centroids moved (the square root of the sum of the squared
+   * distances each centroid moved).
+   *
+   * @param centroids Current cluster centroids.
+   * @param newCentroids New cluster centroids.
+   * @param counts Number of points assigned to each centroid so far.
+   */
+  double Iterate(const arma::mat& centroids,
+                 arma::mat& newCentroids,
+                 arma::Col<size_t>& counts);
+
+  /**
+   * Move the given centroids towards the given batch of points, with one point
+   * per column, updating the learning rates.  The batch does not have to come
+   * from the dataset.
+   *
+   * @param batch Points to update the centroids with.
+   * @param centroids Centroids to update.
+   */
+  template<typename BatchType>
+  void Update(const BatchType& batch, arma::mat& centroids);
+
+  //! Get the number of points used for each step.
+  size_t BatchSize() const { return batchSize; }
+  //! Modify the number of points used for each step.
+  size_t& BatchSize() { return batchSize; }
+
+  //! Get the number of points assigned to each centroid so far.
+  const arma::Col<size_t>& Counts() const { return clusterCounts; }
+
+  //! Return the number of distance calculations.
+  size_t DistanceCalculations() const { return distanceCalculations; }
+
+ private:
+  //! Find the closest centroid to each point in the batch, using
+  //! metric::BlockEvaluate() if it is faster for the metric.
+  void Assign(const arma::mat& batch,
+              const arma::mat& centroids,
+              arma::Col<size_t>& assignments);
+
+  //! Find the closest centroid to each point in the batch, one pair at a time,
+  //! for sparse (or other) data.
+  template<typename BatchType>
+  void Assign(const BatchType& batch,
+              const arma::mat& centroids,
+              arma::Col<size_t>& assignments);
+
+  //! The dataset.
+  const MatType& dataset;
+  //! The instantiated metric.
+  MetricType& metric;
+  //! The number of points used for each step.
+  size_t batchSize;
+
+  //! The number of points ever assigned to each centroid; the learning rate of
+  //! a centroid is the inverse of its count.
+  arma::Col<size_t> clusterCounts;
+
+  //! Number of distance calculations.
+  size_t distanceCalculations;
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+// Include implementation.
+#include "mini_batch_kmeans_impl.hpp"
+
+#endif
@@ -0,0 +1,155 @@
+/**
+ * @file mini_batch_kmeans_impl.hpp
+ *
+ * Implementation of a step of mini-batch k-means.
+ */
+#ifndef __MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_IMPL_HPP
+#define __MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "mini_batch_kmeans.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MetricType, typename MatType>
+MiniBatchKMeans<MetricType, MatType>::MiniBatchKMeans(const MatType& dataset,
+                                                      MetricType& metric,
+                                                      const size_t batchSize) :
+    dataset(dataset),
+    metric(metric),
+    batchSize(batchSize),
+    distanceCalculations(0)
+{
+  if (batchSize == 0)
+    Log::Fatal << "MiniBatchKMeans: the batch size must be positive!"
+        << std::endl;
+}
+
+// Run a single step on a random batch.
+template<typename MetricType, typename MatType>
+double MiniBatchKMeans<MetricType, MatType>::Iterate(
+    const arma::mat& centroids,
+    arma::mat& newCentroids,
+    arma::Col<size_t>& counts)
+{
+  // Draw the batch.  It is always dense, so that the L2 distances to the
+  // centroids can be found with a matrix multiplication.
+  arma::mat batch(dataset.n_rows, batchSize);
+  for (size_t i = 0; i < batchSize; ++i)
+    batch.col(i) = arma::vec(dataset.col(math::RandInt(dataset.n_cols)));
+
+  newCentroids = centroids;
+  Update(batch, newCentroids);
+  counts = clusterCounts;
+
+  // Calculate how far the centroids moved.
+  double cNorm = 0.0;
+  for (size_t i = 0; i < centroids.n_cols; ++i)
+  {
+    cNorm += std::pow(metric.Evaluate(centroids.col(i), newCentroids.col(i)),
+        2.0);
+  }
+  distanceCalculations += centroids.n_cols;
+
+  return std::sqrt(cNorm);
+}
+
+template<typename MetricType, typename MatType>
+template<typename BatchType>
+void MiniBatchKMeans<MetricType, MatType>::Update(const BatchType& batch,
+                                                  arma::mat& centroids)
+{
+  if (clusterCounts.n_elem != centroids.n_cols)
+    clusterCounts.zeros(centroids.n_cols);
+
+  // The assignments are all made with the centroids from before the batch, so
+  // they can be found in parallel.
+  arma::Col<size_t> assignments;
+  Assign(batch, centroids, assignments);
+  distanceCalculations += centroids.n_cols * batch.n_cols;
+
+  // Take a gradient step for each point, with a learning rate for each
+  // centroid that decreases as it is assigned more points.
+  for (size_t i = 0; i < batch.n_cols; ++i)
+  {
+    const size_t cluster = assignments[i];
+    ++clusterCounts[cluster];
+    const double eta = 1.0 / (double) clusterCounts[cluster];
+    centroids.col(cluster) += eta * (arma::vec(batch.col(i)) -
+        centroids.col(cluster));
+  }
+}
+
+template<typename MetricType, typename MatType>
+void MiniBatchKMeans<MetricType, MatType>::Assign(
+    const arma::mat& batch,
+    const arma::mat& centroids,
+    arma::Col<size_t>& assignments)
+{
+  if (!metric::BlockEvaluateTraits<MetricType, arma::mat>::IsFaster(
+      batch.n_rows))
+  {
+    Assign<arma::mat>(batch, centroids, assignments);
+    return;
+  }
+
+  arma::mat distances;
+  metric::BlockEvaluate(metric, centroids, 0, centroids.n_cols, batch, 0,
+      batch.n_cols, distances);
+
+  assignments.set_size(batch.n_cols);
+  for (size_t i = 0; i < batch.n_cols; ++i)
+  {
+    double minDistance = std::numeric_limits<double>::infinity();
+    size_t closestCluster = centroids.n_cols; // Invalid value.
+
+    for (size_t j = 0; j < centroids.n_cols; ++j)
+    {
+      if (distances(j, i) < minDistance)
+      {
+        minDistance = distances(j, i);
+        closestCluster = j;
+      }
+    }
+
+    Log::Assert(closestCluster != centroids.n_cols);
+    assignments[i] = closestCluster;
+  }
+}
+
+template<typename MetricType, typename MatType>
+template<typename BatchType>
+void MiniBatchKMeans<MetricType, MatType>::Assign(
+    const BatchType& batch,
+    const arma::mat& centroids,
+    arma::Col<size_t>& assignments)
+{
+  assignments.set_size(batch.n_cols);
+
+  #pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < batch.n_cols; ++i)
+  {
+    // Find the closest centroid to this point.
+    double minDistance = std::numeric_limits<double>::infinity();
+    size_t closestCluster = centroids.n_cols; // Invalid value.
+
+    for (size_t j = 0; j < centroids.n_cols; ++j)
+    {
+      const double distance = metric.Evaluate(batch.col(i), centroids.col(j));
+      if (distance < minDistance)
+      {
+        minDistance = distance;
+        closestCluster = j;
+      }
+    }
+
+    Log::Assert(closestCluster != centroids.n_cols);
+    assignments[i] = closestCluster;
+  }
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
@@ -9,6 +9,8 @@
 #ifndef __MLPACK_METHODS_KMEANS_NAIVE_KMEANS_HPP
 #define __MLPACK_METHODS_KMEANS_NAIVE_KMEANS_HPP
 
+#include <mlpack/core/metrics/block_evaluate.hpp>
+
 namespace mlpack {
 namespace kmeans {
 
@@ -18,6 +20,13 @@ namespace kmeans {
  * looking for the mlpack::kmeans::KMeans class instead of this one.  This class
  * is used by KMeans as the actual implementation of the Lloyd iteration.
  *
+ * The points are split into blocks, which are handed out to OpenMP threads;
+ * each thread sums the points assigned to each centroid by itself, and the sums
+ * are added up at the end of the iteration.  The distances between a block of
+ * points and all of the centroids are computed at once, which for the L2
+ * distance on dense data is a single matrix multiplication (see
+ * metric::BlockEvaluate()).
+ *
  * @param MetricType Type of metric used with this implementation.
  * @param MatType Matrix type (arma::mat or arma::sp_mat).
  */
@@ -44,9 +53,31 @@ class NaiveKMeans
                  arma::mat& newCentroids,
                  arma::Col<size_t>& counts);
 
+  //! Return the number of distance calculations.
   size_t DistanceCalculations() const { return distanceCalculations; }
 
  private:
+  /**
+   * Compute the distance between every centroid and every point in columns
+   * [begin, begin + count) of the dataset, storing them in the centroids x
+   * count matrix distances.  For dense data this uses metric::BlockEvaluate()
+   * if it is faster for the metric.
+   */
+  void BlockDistances(const arma::mat& centroids,
+                      const arma::mat& points,
+                      const size_t begin,
+                      const size_t count,
+                      arma::mat& distances);
+
+  //! Compute the distances of a block of points one pair at a time, for
+  //! sparse (or other) data.
+  template<typename PointMatType>
+  void BlockDistances(const arma::mat& centroids,
+                      const PointMatType& points,
+                      const size_t begin,
+                      const size_t count,
+                      arma::mat& distances);
+
   //! The dataset.
   const MatType& dataset;
   //! The instantiated metric.
@@ -32,29 +32,56 @@ double NaiveKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
   newCentroids.zeros(centroids.n_rows, centroids.n_cols);
   counts.zeros(centroids.n_cols);
 
-  // Find the closest centroid to each point and update the new centroids.
-  for (size_t i = 0; i < dataset.n_cols; i++)
+  // Keep the distances of a block (about 2MB of them) in cache, even when
+  // there are many centroids.
+  const size_t blockSize = std::min((size_t) 1024, std::max((size_t) 16,
+      (size_t) 262144 / std::max((size_t) 1, (size_t) centroids.n_cols)));
+  const size_t blocks = (dataset.n_cols + blockSize - 1) / blockSize;
+
+  #pragma omp parallel
   {
-    // Find the closest centroid to this point.
-    double minDistance = std::numeric_limits<double>::infinity();
-    size_t closestCluster = centroids.n_cols; // Invalid value.
+    // The sums and counts of the points this thread assigns.
+    arma::mat threadCentroids;
+    threadCentroids.zeros(centroids.n_rows, centroids.n_cols);
+    arma::Col<size_t> threadCounts;
+    threadCounts.zeros(centroids.n_cols);
+    arma::mat distances;
 
-    for (size_t j = 0; j < centroids.n_cols; j++)
+    #pragma omp for schedule(static)
+    for (size_t b = 0; b < blocks; ++b)
     {
-      const double distance = metric.Evaluate(dataset.col(i), centroids.col(j));
+      const size_t begin = b * blockSize;
+      const size_t count = std::min(blockSize, (size_t) dataset.n_cols - begin);
+      BlockDistances(centroids, dataset, begin, count, distances);
 
-      if (distance < minDistance)
+      // Find the closest centroid to each point and update the new centroids.
+      for (size_t i = 0; i < count; ++i)
       {
-        minDistance = distance;
-        closestCluster = j;
+        double minDistance = std::numeric_limits<double>::infinity();
+        size_t closestCluster = centroids.n_cols; // Invalid value.
+
+        for (size_t j = 0; j < centroids.n_cols; ++j)
+        {
+          if (distances(j, i) < minDistance)
+          {
+            minDistance = distances(j, i);
+            closestCluster = j;
+          }
+        }
+
+        Log::Assert(closestCluster != centroids.n_cols);
+
+        threadCentroids.col(closestCluster) +=
+            arma::vec(dataset.col(begin + i));
+        threadCounts(closestCluster)++;
       }
     }
 
-    Log::Assert(closestCluster != centroids.n_cols);
-
-    // We now have the minimum distance centroid index.  Update that centroid.
-    newCentroids.col(closestCluster) += arma::vec(dataset.col(i));
-    counts(closestCluster)++;
+    #pragma omp critical(NaiveKMeansMerge)
+    {
+      newCentroids += threadCentroids;
+      counts += threadCounts;
+    }
   }
 
   // Now normalize the centroid.
@@ -78,6 +105,45 @@ double NaiveKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
   return std::sqrt(cNorm);
 }
 
+template<typename MetricType, typename MatType>
+void NaiveKMeans<MetricType, MatType>::BlockDistances(
+    const arma::mat& centroids,
+    const arma::mat& points,
+    const size_t begin,
+    const size_t count,
+    arma::mat& distances)
+{
+  if (metric::BlockEvaluateTraits<MetricType, arma::mat>::IsFaster(
+      points.n_rows))
+  {
+    metric::BlockEvaluate(metric, centroids, 0, centroids.n_cols, points, begin,
+        count, distances);
+    return;
+  }
+
+  distances.set_size(centroids.n_cols, count);
+  for (size_t i = 0; i < count; ++i)
+    for (size_t j = 0; j < centroids.n_cols; ++j)
+      distances(j, i) = metric.Evaluate(points.col(begin + i),
+          centroids.col(j));
+}
+
+template<typename MetricType, typename MatType>
+template<typename PointMatType>
+void NaiveKMeans<MetricType, MatType>::BlockDistances(
+    const arma::mat& centroids,
+    const PointMatType& points,
+    const size_t begin,
+    const size_t count,
+    arma::mat& distances)
+{
+  distances.set_size(centroids.n_cols, count);
+  for (size_t i = 0; i < count; ++i)
+    for (size_t j = 0; j < centroids.n_cols; ++j)
+      distances(j, i) = metric.Evaluate(points.col(begin + i),
+          centroids.col(j));
+}
+
 } // namespace kmeans
 } // namespace mlpack
 
@@ -13,8 +13,9 @@ LogisticRegressionFunction::LogisticRegressionFunction(
     const arma::mat& predictors,
     const arma::vec& responses,
     const double lambda) :
-    predictors(predictors),
-    responses(responses),
+    predictors(&predictors),
+    responses(&responses),
+    totalPoints(predictors.n_cols),
     lambda(lambda)
 {
   initialPoint = arma::zeros<arma::mat>(predictors.n_rows + 1, 1);
@@ -26,8 +27,9 @@ LogisticRegressionFunction::LogisticRegressionFunction(
     const arma::mat& initialPoint,
     const double lambda) :
     initialPoint(initialPoint),
-    predictors(predictors),
-    responses(responses),
+    predictors(&predictors),
+    responses(&responses),
+    totalPoints(predictors.n_cols),
     lambda(lambda)
 {
   //to check if initialPoint is compatible with predictors
@@ -36,6 +38,70 @@ LogisticRegressionFunction::LogisticRegressionFunction(
     this->initialPoint = arma::zeros<arma::mat>(predictors.n_rows + 1, 1);
 }
 
+LogisticRegressionFunction::LogisticRegressionFunction(
+    const LogisticRegressionFunction& other) :
+    initialPoint(other.initialPoint),
+    predictors(other.predictors),
+    responses(other.responses),
+    blockPredictors(other.blockPredictors),
+    blockResponses(other.blockResponses),
+    totalPoints(other.totalPoints),
+    lambda(other.lambda)
+{
+  // The pointers must not refer to the block of the other function.
+  if (other.predictors == &other.blockPredictors)
+  {
+    predictors = &blockPredictors;
+    responses = &blockResponses;
+  }
+}
+
+LogisticRegressionFunction& LogisticRegressionFunction::operator=(
+    const LogisticRegressionFunction& other)
+{
+  if (this == &other)
+    return *this;
+
+  initialPoint = other.initialPoint;
+  blockPredictors = other.blockPredictors;
+  blockResponses = other.blockResponses;
+  totalPoints = other.totalPoints;
+  lambda = other.lambda;
+
+  // The pointers must not refer to the block of the other function.
+  if (other.predictors == &other.blockPredictors)
+  {
+    predictors = &blockPredictors;
+    responses = &blockResponses;
+  }
+  else
+  {
+    predictors = other.predictors;
+    responses = other.responses;
+  }
+
+  return *this;
+}
+
+/**
+ * Use the given block of points (with the responses as the last row) as the
+ * dataset, which has totalPoints points in all.
+ */
+void LogisticRegressionFunction::SetBlock(const arma::mat& block,
+                                          const size_t totalPoints)
+{
+  if (block.n_rows != initialPoint.n_rows)
+    Log::Fatal << "LogisticRegressionFunction::SetBlock(): block has "
+        << block.n_rows << " rows, but should have " << initialPoint.n_rows
+        << " (the predictors and the responses)." << std::endl;
+
+  blockPredictors = block.rows(0, block.n_rows - 2);
+  blockResponses = arma::trans(block.row(block.n_rows - 1));
+  predictors = &blockPredictors;
+  responses = &blockResponses;
+  this->totalPoints = (totalPoints == 0) ? block.n_cols : totalPoints;
+}
+
 /**
  * Evaluate the logistic regression objective function given the estimated
  * parameters.
@@ -51,14 +117,16 @@ double LogisticRegressionFunction::Evaluate(const arma::mat& parameters)
   // multiplied by the squared l2-norm of the parameters then divided by two.
 
   // For the regularization, we ignore the first term, which is the intercept
-  // term.
-  const double regularization = 0.5 * lambda *
+  // term.  If this is only a block of the dataset, it gets its share of the
+  // regularization, so that the sum over the blocks is the objective of the
+  // whole dataset.
+  const double regularization = 0.5 * lambda * BlockShare() *
       arma::dot(parameters.col(0).subvec(1, parameters.n_elem - 1),
                 parameters.col(0).subvec(1, parameters.n_elem - 1));
 
   // Calculate vectors of sigmoids.  The intercept term is parameters(0, 0) and
   // does not need to be multiplied by any of the predictors.
-  const arma::vec exponents = parameters(0, 0) + predictors.t() *
+  const arma::vec exponents = parameters(0, 0) + predictors->t() *
       parameters.col(0).subvec(1, parameters.n_elem - 1);
   const arma::vec sigmoid = 1.0 / (1.0 + arma::exp(-exponents));
 
@@ -67,9 +135,9 @@ double LogisticRegressionFunction::Evaluate(const arma::mat& parameters)
   // doesn't actually affect the optimization result, so we'll just ignore those
   // terms for computational efficiency.
   double result = 0.0;
-  for (size_t i = 0; i < responses.n_elem; ++i)
+  for (size_t i = 0; i < responses->n_elem; ++i)
   {
-    if (responses[i] == 1)
+    if ((*responses)[i] == 1)
       result += log(sigmoid[i]);
     else
       result += log(1.0 - sigmoid[i]);
@@ -87,18 +155,19 @@ double LogisticRegressionFunction::Evaluate(const arma::mat& parameters)
 double LogisticRegressionFunction::Evaluate(const arma::mat& parameters,
                                             const size_t i) const
 {
-  // Calculate the regularization term.  We must divide by the number of points,
-  // so that sum(Evaluate(parameters, [1:points])) == Evaluate(parameters).
-  const double regularization = lambda * (1.0 / (2.0 * predictors.n_cols)) *
+  // Calculate the regularization term.  We must divide by the number of points
+  // (of the whole dataset, not of the block, if SetBlock() was called), so that
+  // sum(Evaluate(parameters, [1:points])) == Evaluate(parameters).
+  const double regularization = lambda * (1.0 / (2.0 * totalPoints)) *
       arma::dot(parameters.col(0).subvec(1, parameters.n_elem - 1),
                 parameters.col(0).subvec(1, parameters.n_elem - 1));
 
   // Calculate sigmoid.
-  const double exponent = parameters(0, 0) + arma::dot(predictors.col(i),
+  const double exponent = parameters(0, 0) + arma::dot(predictors->col(i),
       parameters.col(0).subvec(1, parameters.n_elem - 1));
   const double sigmoid = 1.0 / (1.0 + std::exp(-exponent));
 
-  if (responses[i] == 1)
+  if ((*responses)[i] == 1)
     return -log(sigmoid) + regularization;
   else
     return -log(1.0 - sigmoid) + regularization;
@@ -108,17 +177,18 @@ double LogisticRegressionFunction::Evaluate(const arma::mat& parameters,
 void LogisticRegressionFunction::Gradient(const arma::mat& parameters,
                                           arma::mat& gradient) const
 {
-  // Regularization term.
+  // Regularization term (the share of the block, if SetBlock() was called).
   arma::mat regularization;
-  regularization = lambda * parameters.col(0).subvec(1, parameters.n_elem - 1);
+  regularization = lambda * BlockShare() *
+      parameters.col(0).subvec(1, parameters.n_elem - 1);
 
   const arma::vec sigmoids = 1 / (1 + arma::exp(-parameters(0, 0)
-      - predictors.t() * parameters.col(0).subvec(1, parameters.n_elem - 1)));
+      - predictors->t() * parameters.col(0).subvec(1, parameters.n_elem - 1)));
 
   gradient.set_size(parameters.n_elem);
-  gradient[0] = -arma::accu(responses - sigmoids);
-  gradient.col(0).subvec(1, parameters.n_elem - 1) = -predictors * (responses -
-      sigmoids) + regularization;
+  gradient[0] = -arma::accu(*responses - sigmoids);
+  gradient.col(0).subvec(1, parameters.n_elem - 1) = -(*predictors) *
+      (*responses - sigmoids) + regularization;
 }
 
 /**
@@ -133,14 +203,14 @@ void LogisticRegressionFunction::Gradient(const arma::mat& parameters,
   // Calculate the regularization term.
   arma::mat regularization;
   regularization = lambda * parameters.col(0).subvec(1, parameters.n_elem - 1)
-      / predictors.n_cols;
+      / totalPoints;
 
   const double sigmoid = 1.0 / (1.0 + std::exp(-parameters(0, 0)
-      - arma::dot(predictors.col(i), parameters.col(0).subvec(1,
+      - arma::dot(predictors->col(i), parameters.col(0).subvec(1,
       parameters.n_elem - 1))));
 
   gradient.set_size(parameters.n_elem);
-  gradient[0] = -(responses[i] - sigmoid);
-  gradient.col(0).subvec(1, parameters.n_elem - 1) = -predictors.col(i)
-      * (responses[i] - sigmoid) + regularization;
+  gradient[0] = -((*responses)[i] - sigmoid);
+  gradient.col(0).subvec(1, parameters.n_elem - 1) = -predictors->col(i)
+      * ((*responses)[i] - sigmoid) + regularization;
 }
@@ -31,6 +31,16 @@ class LogisticRegressionFunction
                              const arma::mat& initialPoint,
                              const double lambda = 0);
 
+  /**
+   * Copy the given function.  If SetBlock() was called on it, the copy holds
+   * its own copy of the block; otherwise it refers to the same predictors and
+   * responses.
+   */
+  LogisticRegressionFunction(const LogisticRegressionFunction& other);
+
+  //! Copy the given function, in the same way as the copy constructor.
+  LogisticRegressionFunction& operator=(const LogisticRegressionFunction& other);
+
   //! Return the initial point for the optimization.
   const arma::mat& InitialPoint() const { return initialPoint; }
   //! Modify the initial point for the optimization.
@@ -42,9 +52,25 @@ class LogisticRegressionFunction
   double& Lambda() { return lambda; }
 
   //! Return the matrix of predictors.
-  const arma::mat& Predictors() const { return predictors; }
+  const arma::mat& Predictors() const { return *predictors; }
   //! Return the vector of responses.
-  const arma::vec& Responses() const { return responses; }
+  const arma::vec& Responses() const { return *responses; }
+
+  /**
+   * Use the given block of points as the dataset instead of the predictors and
+   * responses given to the constructor; the responses are the last row of the
+   * block.  The block is copied.  This is used by SGD when the dataset is read
+   * from disk in blocks (see SGD::Optimize()).
+   *
+   * The regularization is spread over all the points of the dataset, not just
+   * those of the block, so the total number of points must be given; then the
+   * objective summed over all the blocks is the objective of the whole dataset.
+   *
+   * @param block Predictors, with the responses as the last row.
+   * @param totalPoints Number of points in the whole dataset (if 0, the block
+   *     is taken to be the whole dataset).
+   */
+  void SetBlock(const arma::mat& block, const size_t totalPoints = 0);
 
   /**
    * Evaluate the logistic regression log-likelihood function with the given
@@ -102,17 +128,32 @@ class LogisticRegressionFunction
   const arma::mat& GetInitialPoint() const { return initialPoint; }
 
   //! Return the number of separable functions (the number of predictor points).
-  size_t NumFunctions() const { return predictors.n_cols; }
+  size_t NumFunctions() const { return predictors->n_cols; }
 
  private:
   //! The initial point, from which to start the optimization.
   arma::mat initialPoint;
   //! The matrix of data points (predictors).
-  const arma::mat& predictors;
+  const arma::mat* predictors;
   //! The vector of responses to the input data points.
-  const arma::vec& responses;
+  const arma::vec* responses;
+  //! The predictors of the current block, if SetBlock() was called.
+  arma::mat blockPredictors;
+  //! The responses of the current block, if SetBlock() was called.
+  arma::vec blockResponses;
+  //! The number of points in the whole dataset, which the regularization is
+  //! spread over.
+  size_t totalPoints;
   //! The regularization parameter for L2-regularization.
   double lambda;
+
+  //! The share of the regularization that the current points get: the fraction
+  //! of the dataset in the block, if SetBlock() was called, and 1 otherwise.
+  double BlockShare() const
+  {
+    return (predictors == &blockPredictors) ?
+        (predictors->n_cols / (double) totalPoints) : 1.0;
+  }
 };
 
 }; // namespace regression
@@ -77,6 +77,19 @@ class NaiveBayesClassifier
                        const size_t classes,
                        const bool incrementalVariance = false);
 
+  /**
+   * Train the classifier on a dataset which is read from disk in blocks
+   * (out-of-core), so that the training set never has to fit in memory.  The
+   * labels are expected to be the last row of each block, and must already be
+   * integers between 0 and classes - 1 (see data::NormalizeLabels()).  The data
+   * is only read once, with the incremental algorithm for the variance.
+   *
+   * @param reader Reader for the training data points and their labels.
+   * @param classes Number of classes in this classifier.
+   */
+  NaiveBayesClassifier(data::StreamReader<typename MatType::elem_type>& reader,
+                       const size_t classes);
+
   /**
    * Given a bunch of data points, this function evaluates the class of each of
    * those data points, and puts it in the vector 'results'.
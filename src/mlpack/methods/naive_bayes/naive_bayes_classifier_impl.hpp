@@ -100,6 +100,70 @@ NaiveBayesClassifier<MatType>::NaiveBayesClassifier(
   probabilities /= data.n_cols;
 }
 
+template<typename MatType>
+NaiveBayesClassifier<MatType>::NaiveBayesClassifier(
+    data::StreamReader<typename MatType::elem_type>& reader,
+    const size_t classes)
+{
+  if (reader.Dimensionality() < 2)
+    Log::Fatal << "NaiveBayesClassifier: the training data must have at least "
+        << "one feature and the label." << std::endl;
+
+  const size_t dimensionality = reader.Dimensionality() - 1;
+
+  probabilities.zeros(classes);
+  means.zeros(dimensionality, classes);
+  variances.zeros(dimensionality, classes);
+
+  Log::Info << "Training Naive Bayes classifier on '" << reader.Filename()
+      << "' with " << dimensionality << " features each." << std::endl;
+
+  // Reading the data twice would double the time spent on the disk, so the
+  // one-pass incremental algorithm is used.
+  size_t points = 0;
+  arma::Mat<typename MatType::elem_type> block;
+  reader.Reset();
+  while (reader.NextBlock(block))
+  {
+    for (size_t j = 0; j < block.n_cols; ++j, ++points)
+    {
+      const double rawLabel = block(dimensionality, j);
+      const size_t label = (size_t) rawLabel;
+      if (rawLabel < 0 || label >= classes || double(label) != rawLabel)
+        Log::Fatal << "NaiveBayesClassifier: invalid label " << rawLabel
+            << " for point " << points << "; labels must be integers between 0"
+            << " and " << (classes - 1) << "." << std::endl;
+
+      ++probabilities[label];
+
+      const arma::vec point = arma::conv_to<arma::vec>::from(
+          block.col(j).subvec(0, dimensionality - 1));
+      arma::vec delta = point - means.col(label);
+      means.col(label) += delta / probabilities[label];
+      variances.col(label) += delta % (point - means.col(label));
+    }
+  }
+
+  if (points == 0)
+    Log::Fatal << "NaiveBayesClassifier: '" << reader.Filename() << "' contains "
+        << "no points." << std::endl;
+
+  Log::Info << "Trained on " << points << " examples." << std::endl;
+
+  for (size_t i = 0; i < classes; ++i)
+  {
+    if (probabilities[i] > 2)
+      variances.col(i) /= (probabilities[i] - 1);
+  }
+
+  // Ensure that the variances are invertible.
+  for (size_t i = 0; i < variances.n_elem; ++i)
+    if (variances[i] == 0.0)
+      variances[i] = 1e-50;
+
+  probabilities /= points;
+}
+
 template<typename MatType>
 void NaiveBayesClassifier<MatType>::Classify(const MatType& data,
                                              arma::Col<size_t>& results)
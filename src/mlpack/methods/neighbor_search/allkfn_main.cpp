@@ -13,6 +13,7 @@
 
 #include "neighbor_search.hpp"
 #include "unmap.hpp"
+#include "ns_index.hpp"
 
 using namespace std;
 using namespace mlpack;
@@ -37,11 +38,15 @@ PROGRAM_INFO("All K-Furthest-Neighbors",
     "neighbors output file corresponds to the index of the point in the "
     "reference set which is the i'th furthest neighbor from the point in the "
     "query set with index j.  Row i and column j in the distances output file "
-    "corresponds to the distance between those two points.");
+    "corresponds to the distance between those two points."
+    "\n\n"
+    "The kd-tree built on the reference set can be saved to a binary index "
+    "file with --save_index, and loaded again with --load_index instead of "
+    "--reference_file, so that it does not need to be rebuilt for every run.");
 
 // Define our input parameters that this program will take.
-PARAM_STRING_REQ("reference_file", "File containing the reference dataset.",
-    "r");
+PARAM_STRING("reference_file", "File containing the reference dataset.",
+    "r", "");
 PARAM_INT_REQ("k", "Number of furthest neighbors to find.", "k");
 PARAM_STRING_REQ("distances_file", "File to output distances into.", "d");
 PARAM_STRING_REQ("neighbors_file", "File to output neighbors into.", "n");
@@ -54,6 +59,12 @@ PARAM_FLAG("single_mode", "If true, single-tree search is used (as opposed to "
     "dual-tree search).", "s");
 PARAM_FLAG("r_tree", "If true, use an R-Tree to perform the search "
     "(experimental, may be slow.).", "T");
+PARAM_STRING("save_index", "If specified, the kd-tree built on the reference "
+    "set is saved to this index file.", "", "");
+PARAM_STRING("load_index", "If specified, the kd-tree and reference set are "
+    "loaded from this index file instead of --reference_file.", "", "");
+PARAM_FLAG("stats", "If true, print the number of prunes, scores, base cases "
+    "and nodes visited by the tree traversal (with --verbose).", "");
 
 int main(int argc, char *argv[])
 {
@@ -62,6 +73,8 @@ int main(int argc, char *argv[])
 
   // Get all the parameters.
   string referenceFile = CLI::GetParam<string>("reference_file");
+  const string saveIndexFile = CLI::GetParam<string>("save_index");
+  const string loadIndexFile = CLI::GetParam<string>("load_index");
 
   string distancesFile = CLI::GetParam<string>("distances_file");
   string neighborsFile = CLI::GetParam<string>("neighbors_file");
@@ -73,12 +86,41 @@ int main(int argc, char *argv[])
   bool naive = CLI::HasParam("naive");
   bool singleMode = CLI::HasParam("single_mode");
 
+  // Exactly one of the reference set and an index must be given.
+  if ((referenceFile == "") == (loadIndexFile == ""))
+  {
+    Log::Fatal << "Exactly one of --reference_file and --load_index must be "
+        << "specified." << endl;
+  }
+
+  // Indices are only supported for kd-trees.
+  if ((saveIndexFile != "" || loadIndexFile != "") &&
+      (naive || CLI::HasParam("r_tree")))
+  {
+    Log::Fatal << "--save_index and --load_index cannot be used with --naive "
+        << "or --r_tree." << endl;
+  }
+
+  typedef BinarySpaceTree<bound::HRectBound<2>,
+      NeighborSearchStat<FurthestNeighborSort>> KDTreeType;
+
   arma::mat referenceData;
   arma::mat queryData; // So it doesn't go out of scope.
-  data::Load(referenceFile, referenceData, true);
+  std::vector<size_t> oldFromNewRefs;
+  KDTreeType* kdRefTree = NULL;
+  if (loadIndexFile != "")
+  {
+    kdRefTree = LoadIndex<KDTreeType>(loadIndexFile, referenceData,
+        oldFromNewRefs, true);
+  }
+  else
+  {
+    data::Load(referenceFile, referenceData, true);
 
-  Log::Info << "Loaded reference data from '" << referenceFile << "' ("
-      << referenceData.n_rows << " x " << referenceData.n_cols << ")." << endl;
+    Log::Info << "Loaded reference data from '" << referenceFile << "' ("
+        << referenceData.n_rows << " x " << referenceData.n_cols << ")."
+        << endl;
+  }
 
   // Sanity check on k value: must be greater than 0, must be less than the
   // number of reference points.
@@ -124,21 +166,25 @@ int main(int argc, char *argv[])
   if (!CLI::HasParam("r_tree"))
   {
     // Use default kd-tree.
-    std::vector<size_t> oldFromNewRefs;
-
-    typedef BinarySpaceTree<bound::HRectBound<2>,
-        NeighborSearchStat<FurthestNeighborSort>> TreeType;
+    typedef KDTreeType TreeType;
 
     // Build trees by hand, so we can save memory: if we pass a tree to
-    // NeighborSearch, it does not copy the matrix.
-    Log::Info << "Building reference tree..." << endl;
-    Timer::Start("reference_tree_building");
-    TreeType refTree(referenceData, oldFromNewRefs, leafSize);
-    Timer::Stop("reference_tree_building");
+    // NeighborSearch, it does not copy the matrix.  If the tree was loaded
+    // from an index, it is already built.
+    if (kdRefTree == NULL)
+    {
+      Log::Info << "Building reference tree..." << endl;
+      Timer::Start("reference_tree_building");
+      kdRefTree = new TreeType(referenceData, oldFromNewRefs, leafSize);
+      Timer::Stop("reference_tree_building");
+    }
+
+    if (saveIndexFile != "")
+      SaveIndex(saveIndexFile, *kdRefTree, oldFromNewRefs, true);
 
     std::vector<size_t> oldFromNewQueries;
 
-    AllkFN allkfn(&refTree, singleMode);
+    AllkFN allkfn(kdRefTree, singleMode);
 
     arma::mat distancesOut(distances.n_rows, distances.n_cols);
     arma::Mat<size_t> neighborsOut(neighbors.n_rows, neighbors.n_cols);
@@ -171,6 +217,8 @@ int main(int argc, char *argv[])
     }
 
     Log::Info << "Neighbors computed." << endl;
+    if (CLI::HasParam("stats"))
+      Log::Info << allkfn.Statistics().ToString();
 
     // We have to map back to the original indices from before the tree
     // construction.
@@ -185,6 +233,8 @@ int main(int argc, char *argv[])
     else
       Unmap(neighborsOut, distancesOut, oldFromNewRefs, oldFromNewRefs, neighbors,
           distances);
+
+    delete kdRefTree;
   }
   else
   {
@@ -234,6 +284,8 @@ int main(int argc, char *argv[])
       allkfn.Search(k, neighbors, distances);
     }
     Log::Info << "Neighbors computed." << endl;
+    if (CLI::HasParam("stats"))
+      Log::Info << allkfn.Statistics().ToString();
   }
 
   // Save output.
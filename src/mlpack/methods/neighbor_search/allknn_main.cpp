@@ -7,13 +7,19 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/core/tree/cover_tree.hpp>
+#include <mlpack/core/tree/flat_binary_space_tree.hpp>
 
 #include <string>
 #include <fstream>
 #include <iostream>
 
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
 #include "neighbor_search.hpp"
 #include "unmap.hpp"
+#include "ns_index.hpp"
 
 using namespace std;
 using namespace mlpack;
@@ -39,11 +45,26 @@ PROGRAM_INFO("All K-Nearest-Neighbors",
     "neighbors output file corresponds to the index of the point in the "
     "reference set which is the i'th nearest neighbor from the point in the "
     "query set with index j.  Row i and column j in the distances output file "
-    "corresponds to the distance between those two points.");
+    "corresponds to the distance between those two points."
+    "\n\n"
+    "The kd-tree built on the reference set can be saved to a binary index "
+    "file with --save_index, and loaded again with --load_index instead of "
+    "--reference_file, so that it does not need to be rebuilt for every run."
+    "\n\n"
+    "With --float, the data is loaded and searched in single precision, which "
+    "halves the memory used by the datasets and the output distances.  This is "
+    "only supported with kd-trees (and --naive)."
+    "\n\n"
+    "With --flat_layout, the kd-tree is stored in one contiguous array of "
+    "nodes instead of one allocation per node, which can make the search "
+    "faster for large trees.  The nodes are stored either level by level "
+    "('breadth_first') or in van Emde Boas order ('van_emde_boas').  The "
+    "results are the same as with the regular kd-tree, so the search times "
+    "reported with --verbose can be compared directly.");
 
 // Define our input parameters that this program will take.
-PARAM_STRING_REQ("reference_file", "File containing the reference dataset.",
-    "r");
+PARAM_STRING("reference_file", "File containing the reference dataset.",
+    "r", "");
 PARAM_STRING_REQ("distances_file", "File to output distances into.", "d");
 PARAM_STRING_REQ("neighbors_file", "File to output neighbors into.", "n");
 
@@ -62,6 +83,181 @@ PARAM_FLAG("r_tree", "If true, use an R-Tree to perform the search "
 PARAM_FLAG("random_basis", "Before tree-building, project the data onto a "
     "random orthogonal basis.", "R");
 PARAM_INT("seed", "Random seed (if 0, std::time(NULL) is used).", "s", 0);
+PARAM_INT("threads", "Number of threads to use for single-tree search and "
+    "dual-tree kd-tree search (if 0, the OpenMP default is used).", "t", 0);
+PARAM_STRING("save_index", "If specified, the kd-tree built on the reference "
+    "set is saved to this index file.", "", "");
+PARAM_STRING("load_index", "If specified, the kd-tree and reference set are "
+    "loaded from this index file instead of --reference_file.", "", "");
+PARAM_FLAG("float", "If true, load the data and compute the neighbors in "
+    "single precision (kd-tree and naive search only).", "f");
+PARAM_STRING("flat_layout", "If specified, store the kd-tree in one contiguous "
+    "array of nodes, in the given order ('breadth_first' or 'van_emde_boas').",
+    "", "");
+PARAM_FLAG("stats", "If true, print the number of prunes, scores, base cases "
+    "and nodes visited by the tree traversal (with --verbose).", "");
+
+/**
+ * Compute the k nearest neighbors with a kd-tree which is stored in one array
+ * in the order given by LayoutType.  The results are unmapped into the given
+ * neighbors and distances.
+ */
+template<typename LayoutType>
+void SearchFlat(arma::mat& referenceData,
+                arma::mat& queryData,
+                const bool hasQueries,
+                const size_t k,
+                const size_t leafSize,
+                const bool singleMode,
+                arma::Mat<size_t>& neighbors,
+                arma::mat& distances)
+{
+  typedef FlatBinarySpaceTree<NeighborSearchStat<NearestNeighborSort>,
+      arma::mat, LayoutType> TreeType;
+  typedef NeighborSearch<NearestNeighborSort, metric::EuclideanDistance,
+      TreeType> AllkNNType;
+
+  std::vector<size_t> oldFromNewRefs;
+  std::vector<size_t> oldFromNewQueries;
+
+  Log::Info << "Building reference tree..." << endl;
+  Timer::Start("tree_building");
+  TreeType refTree(referenceData, oldFromNewRefs, leafSize);
+  Timer::Stop("tree_building");
+  Log::Info << "Tree built (" << refTree.TreeSize() << " nodes)." << endl;
+
+  AllkNNType allknn(&refTree, singleMode);
+
+  arma::mat distancesOut;
+  arma::Mat<size_t> neighborsOut;
+
+  Log::Info << "Computing " << k << " nearest neighbors..." << endl;
+  if (hasQueries && !singleMode)
+  {
+    Log::Info << "Building query tree..." << endl;
+    Timer::Start("tree_building");
+    TreeType queryTree(queryData, oldFromNewQueries, leafSize);
+    Timer::Stop("tree_building");
+
+    allknn.Search(&queryTree, k, neighborsOut, distancesOut);
+    Unmap(neighborsOut, distancesOut, oldFromNewRefs, oldFromNewQueries,
+        neighbors, distances);
+  }
+  else if (hasQueries)
+  {
+    allknn.Search(queryData, k, neighborsOut, distancesOut);
+    Unmap(neighborsOut, distancesOut, oldFromNewRefs, neighbors, distances);
+  }
+  else
+  {
+    allknn.Search(k, neighborsOut, distancesOut);
+    Unmap(neighborsOut, distancesOut, oldFromNewRefs, oldFromNewRefs,
+        neighbors, distances);
+  }
+
+  Log::Info << "Neighbors computed." << endl;
+  if (CLI::HasParam("stats"))
+    Log::Info << allknn.Statistics().ToString();
+}
+
+/**
+ * Compute the k nearest neighbors with a kd-tree (or naively) in single
+ * precision, and save the results.
+ */
+void SearchFloat(const string& referenceFile,
+                 const string& queryFile,
+                 const size_t k,
+                 const size_t leafSize,
+                 const bool naive,
+                 const bool singleMode,
+                 const string& distancesFile,
+                 const string& neighborsFile)
+{
+  arma::fmat referenceData;
+  arma::fmat queryData;
+  data::Load(referenceFile, referenceData, true);
+  Log::Info << "Loaded reference data from '" << referenceFile << "' ("
+      << referenceData.n_rows << " x " << referenceData.n_cols << ")." << endl;
+
+  if (queryFile != "")
+  {
+    data::Load(queryFile, queryData, true);
+    Log::Info << "Loaded query data from '" << queryFile << "' ("
+      << queryData.n_rows << " x " << queryData.n_cols << ")." << endl;
+  }
+
+  if (k > referenceData.n_cols)
+  {
+    Log::Fatal << "Invalid k: " << k << "; must be greater than 0 and less ";
+    Log::Fatal << "than or equal to the number of reference points (";
+    Log::Fatal << referenceData.n_cols << ")." << endl;
+  }
+
+  typedef BinarySpaceTree<bound::HRectBound<2>,
+      NeighborSearchStat<NearestNeighborSort>, arma::fmat> TreeType;
+  typedef NeighborSearch<NearestNeighborSort, metric::EuclideanDistance,
+      TreeType, TreeType::ParallelDualTreeTraverser> AllkNNType;
+
+  arma::Mat<size_t> neighbors;
+  arma::fmat distances;
+
+  if (naive)
+  {
+    AllkNNType allknn(referenceData, true);
+
+    if (queryFile != "")
+      allknn.Search(queryData, k, neighbors, distances);
+    else
+      allknn.Search(k, neighbors, distances);
+  }
+  else
+  {
+    std::vector<size_t> oldFromNewRefs;
+    std::vector<size_t> oldFromNewQueries;
+
+    Log::Info << "Building reference tree..." << endl;
+    Timer::Start("tree_building");
+    TreeType refTree(referenceData, oldFromNewRefs, leafSize);
+    Timer::Stop("tree_building");
+
+    AllkNNType allknn(&refTree, singleMode);
+
+    arma::fmat distancesOut;
+    arma::Mat<size_t> neighborsOut;
+
+    Log::Info << "Computing " << k << " nearest neighbors..." << endl;
+    if (queryFile != "" && !singleMode)
+    {
+      Log::Info << "Building query tree..." << endl;
+      Timer::Start("tree_building");
+      TreeType queryTree(queryData, oldFromNewQueries, leafSize);
+      Timer::Stop("tree_building");
+
+      allknn.Search(&queryTree, k, neighborsOut, distancesOut);
+      Unmap(neighborsOut, distancesOut, oldFromNewRefs, oldFromNewQueries,
+          neighbors, distances);
+    }
+    else if (queryFile != "")
+    {
+      allknn.Search(queryData, k, neighborsOut, distancesOut);
+      Unmap(neighborsOut, distancesOut, oldFromNewRefs, neighbors, distances);
+    }
+    else
+    {
+      allknn.Search(k, neighborsOut, distancesOut);
+      Unmap(neighborsOut, distancesOut, oldFromNewRefs, oldFromNewRefs,
+          neighbors, distances);
+    }
+
+    if (CLI::HasParam("stats"))
+      Log::Info << allknn.Statistics().ToString();
+  }
+
+  Log::Info << "Neighbors computed." << endl;
+
+  data::Save(distancesFile, distances);
+  data::Save(neighborsFile, neighbors);
+}
 
 int main(int argc, char *argv[])
 {
@@ -75,7 +271,10 @@ int main(int argc, char *argv[])
 
   // Get all the parameters.
   const string referenceFile = CLI::GetParam<string>("reference_file");
+  const string saveIndexFile = CLI::GetParam<string>("save_index");
+  const string loadIndexFile = CLI::GetParam<string>("load_index");
   const string queryFile = CLI::GetParam<string>("query_file");
+  const string flatLayout = CLI::GetParam<string>("flat_layout");
 
   const string distancesFile = CLI::GetParam<string>("distances_file");
   const string neighborsFile = CLI::GetParam<string>("neighbors_file");
@@ -88,12 +287,106 @@ int main(int argc, char *argv[])
   bool singleMode = CLI::HasParam("single_mode");
   const bool randomBasis = CLI::HasParam("random_basis");
 
+  // Sanity check on the number of threads.
+  if (CLI::GetParam<int>("threads") < 0)
+  {
+    Log::Fatal << "Invalid number of threads: " << CLI::GetParam<int>("threads")
+        << ".  Must be 0 or greater." << endl;
+  }
+#ifdef _OPENMP
+  if (CLI::GetParam<int>("threads") > 0)
+    omp_set_num_threads(CLI::GetParam<int>("threads"));
+#else
+  if (CLI::GetParam<int>("threads") > 1)
+    Log::Warn << "--threads ignored because mlpack was compiled without OpenMP."
+        << endl;
+#endif
+
+  // Exactly one of the reference set and an index must be given.
+  if ((referenceFile == "") == (loadIndexFile == ""))
+  {
+    Log::Fatal << "Exactly one of --reference_file and --load_index must be "
+        << "specified." << endl;
+  }
+
+  // Sanity check on leaf size.
+  if (lsInt < 1)
+  {
+    Log::Fatal << "Invalid leaf size: " << lsInt << ".  Must be greater "
+        "than 0." << endl;
+  }
+  size_t leafSize = lsInt;
+
+  // Single precision is only implemented for kd-trees.
+  if (CLI::HasParam("float"))
+  {
+    if (CLI::HasParam("cover_tree") || CLI::HasParam("r_tree") ||
+        randomBasis || saveIndexFile != "" || loadIndexFile != "" ||
+        flatLayout != "")
+    {
+      Log::Fatal << "--float cannot be used with --cover_tree, --r_tree, "
+          << "--random_basis, --save_index, --load_index, or --flat_layout."
+          << endl;
+    }
+
+    if (singleMode && naive)
+      Log::Warn << "--single_mode ignored because --naive is present." << endl;
+
+    SearchFloat(referenceFile, queryFile, k, leafSize, naive, singleMode,
+        distancesFile, neighborsFile);
+    return 0;
+  }
+
+  // Indices are only supported for kd-trees; a random basis would also need to
+  // be stored to be applied to the query set.
+  if ((saveIndexFile != "" || loadIndexFile != "") && (naive ||
+      CLI::HasParam("cover_tree") || CLI::HasParam("r_tree") || randomBasis))
+  {
+    Log::Fatal << "--save_index and --load_index cannot be used with --naive, "
+        << "--cover_tree, --r_tree, or --random_basis." << endl;
+  }
+
+  // The flat layout is only available for kd-trees, and indices can only hold
+  // regular kd-trees.
+  if (flatLayout != "")
+  {
+    if (flatLayout != "breadth_first" && flatLayout != "van_emde_boas")
+    {
+      Log::Fatal << "Invalid --flat_layout '" << flatLayout << "'; must be "
+          << "'breadth_first' or 'van_emde_boas'." << endl;
+    }
+
+    if (naive || CLI::HasParam("cover_tree") || CLI::HasParam("r_tree") ||
+        saveIndexFile != "" || loadIndexFile != "")
+    {
+      Log::Fatal << "--flat_layout cannot be used with --naive, --cover_tree, "
+          << "--r_tree, --save_index, or --load_index." << endl;
+    }
+  }
+
+  // The kd-tree type; it is declared here so that an index can be loaded
+  // before the sanity checks on the reference set.  The parallel traverser is
+  // equivalent to the default traverser when only one thread is used.
+  typedef BinarySpaceTree<bound::HRectBound<2>,
+      NeighborSearchStat<NearestNeighborSort>> KDTreeType;
+
   arma::mat referenceData;
   arma::mat queryData; // So it doesn't go out of scope.
-  data::Load(referenceFile, referenceData, true);
+  std::vector<size_t> oldFromNewRefs;
+  KDTreeType* kdRefTree = NULL;
+  if (loadIndexFile != "")
+  {
+    kdRefTree = LoadIndex<KDTreeType>(loadIndexFile, referenceData,
+        oldFromNewRefs, true);
+  }
+  else
+  {
+    data::Load(referenceFile, referenceData, true);
 
-  Log::Info << "Loaded reference data from '" << referenceFile << "' ("
-      << referenceData.n_rows << " x " << referenceData.n_cols << ")." << endl;
+    Log::Info << "Loaded reference data from '" << referenceFile << "' ("
+        << referenceData.n_rows << " x " << referenceData.n_cols << ")."
+        << endl;
+  }
 
   if (queryFile != "")
   {
@@ -111,14 +404,6 @@ int main(int argc, char *argv[])
     Log::Fatal << referenceData.n_cols << ")." << endl;
   }
 
-  // Sanity check on leaf size.
-  if (lsInt < 1)
-  {
-    Log::Fatal << "Invalid leaf size: " << lsInt << ".  Must be greater "
-        "than 0." << endl;
-  }
-  size_t leafSize = lsInt;
-
   // Naive mode overrides single mode.
   if (singleMode && naive)
   {
@@ -171,7 +456,17 @@ int main(int argc, char *argv[])
   arma::Mat<size_t> neighbors;
   arma::mat distances;
 
-  if (naive)
+  if (flatLayout == "breadth_first")
+  {
+    SearchFlat<BreadthFirstLayout>(referenceData, queryData, queryFile != "",
+        k, leafSize, singleMode, neighbors, distances);
+  }
+  else if (flatLayout == "van_emde_boas")
+  {
+    SearchFlat<VanEmdeBoasLayout>(referenceData, queryData, queryFile != "",
+        k, leafSize, singleMode, neighbors, distances);
+  }
+  else if (naive)
   {
     AllkNN allknn(referenceData, false, naive);
 
@@ -185,21 +480,26 @@ int main(int argc, char *argv[])
     if (!CLI::HasParam("r_tree"))
     {
       // We're using the kd-tree.
-      // Mappings for when we build the tree.
-      std::vector<size_t> oldFromNewRefs;
-
-      // Convenience typedef.
-      typedef BinarySpaceTree<bound::HRectBound<2>,
-          NeighborSearchStat<NearestNeighborSort>> TreeType;
+      // Convenience typedefs.
+      typedef KDTreeType TreeType;
+      typedef NeighborSearch<NearestNeighborSort, metric::EuclideanDistance,
+          TreeType, TreeType::ParallelDualTreeTraverser> AllkNNType;
 
       // Build trees by hand, so we can save memory: if we pass a tree to
-      // NeighborSearch, it does not copy the matrix.
-      Log::Info << "Building reference tree..." << endl;
-      Timer::Start("tree_building");
-      TreeType refTree(referenceData, oldFromNewRefs, leafSize);
-      Timer::Stop("tree_building");
+      // NeighborSearch, it does not copy the matrix.  If the tree was loaded
+      // from an index, it is already built.
+      if (kdRefTree == NULL)
+      {
+        Log::Info << "Building reference tree..." << endl;
+        Timer::Start("tree_building");
+        kdRefTree = new TreeType(referenceData, oldFromNewRefs, leafSize);
+        Timer::Stop("tree_building");
+      }
+
+      if (saveIndexFile != "")
+        SaveIndex(saveIndexFile, *kdRefTree, oldFromNewRefs, true);
 
-      AllkNN allknn(&refTree, singleMode);
+      AllkNNType allknn(kdRefTree, singleMode);
 
       std::vector<size_t> oldFromNewQueries;
 
@@ -234,6 +534,8 @@ int main(int argc, char *argv[])
       }
 
       Log::Info << "Neighbors computed." << endl;
+      if (CLI::HasParam("stats"))
+        Log::Info << allknn.Statistics().ToString();
 
       // We have to map back to the original indices from before the tree
       // construction.
@@ -248,6 +550,8 @@ int main(int argc, char *argv[])
       else
         Unmap(neighborsOut, distancesOut, oldFromNewRefs, oldFromNewRefs,
             neighbors, distances);
+
+      delete kdRefTree;
     }
     else
     {
@@ -299,6 +603,9 @@ int main(int argc, char *argv[])
         Log::Info << "Computing " << k << " nearest neighbors..." << endl;
         allknn.Search(k, neighbors, distances);
       }
+
+      if (CLI::HasParam("stats"))
+        Log::Info << allknn.Statistics().ToString();
     }
   }
   else // Cover trees.
@@ -347,6 +654,8 @@ int main(int argc, char *argv[])
     }
 
     Log::Info << "Neighbors computed." << endl;
+    if (CLI::HasParam("stats"))
+      Log::Info << allknn.Statistics().ToString();
   }
 
   // Save put.
@@ -11,10 +11,13 @@
 #include <mlpack/core.hpp>
 #include <vector>
 #include <string>
+#include <limits>
+#include <algorithm>
 
 #include <mlpack/core/tree/binary_space_tree.hpp>
 #include <mlpack/core/tree/rectangle_tree.hpp>
 #include <mlpack/core/tree/binary_space_tree/binary_space_tree.hpp>
+#include <mlpack/core/tree/traversal_statistics.hpp>
 
 #include <mlpack/core/metrics/lmetric.hpp>
 #include "neighbor_search_stat.hpp"
@@ -53,6 +56,10 @@ template<typename SortPolicy = NearestNeighborSort,
 class NeighborSearch
 {
  public:
+  //! The type of the elements of the dataset, which is also the type of the
+  //! output distances (so a tree built on arma::fmat gives float distances).
+  typedef typename TreeType::Mat::elem_type ElemType;
+
   /**
    * Initialize the NeighborSearch object, passing a reference dataset (this is
    * the dataset which is searched).  Optionally, perform the computation in
@@ -120,7 +127,8 @@ class NeighborSearch
    * If querySet contains only a few query points, the extra cost of building a
    * tree on the points for dual-tree search may not be warranted, and it may be
    * worthwhile to set singleMode = false (either in the constructor or with
-   * SingleMode()).
+   * SingleMode()).  In single-tree mode, the query points are split between
+   * the available OpenMP threads.
    *
    * @param querySet Set of query points (can be just one point).
    * @param k Number of neighbors to search for.
@@ -131,7 +139,7 @@ class NeighborSearch
   void Search(const typename TreeType::Mat& querySet,
               const size_t k,
               arma::Mat<size_t>& neighbors,
-              arma::mat& distances);
+              arma::Mat<ElemType>& distances);
 
   /**
    * Given a pre-built query tree, search for the nearest neighbors of each
@@ -149,7 +157,7 @@ class NeighborSearch
   void Search(TreeType* queryTree,
               const size_t k,
               arma::Mat<size_t>& neighbors,
-              arma::mat& distances);
+              arma::Mat<ElemType>& distances);
 
   /**
    * Search for the nearest neighbors of every point in the reference set.  This
@@ -166,7 +174,7 @@ class NeighborSearch
    */
   void Search(const size_t k,
               arma::Mat<size_t>& neighbors,
-              arma::mat& distances);
+              arma::Mat<ElemType>& distances);
 
   //! Returns a string representation of this object.
   std::string ToString() const;
@@ -182,6 +190,11 @@ class NeighborSearch
   //! Modify the number of node combination scores.
   size_t& Scores() { return scores; }
 
+  //! Return the statistics of the tree traversals of all searches.
+  const tree::TraversalStatistics& Statistics() const { return statistics; }
+  //! Modify the statistics of the tree traversals (good for a reset).
+  tree::TraversalStatistics& Statistics() { return statistics; }
+
   //! Access whether or not search is done in single-tree mode.
   bool SingleMode() const { return singleMode; }
   //! Modify whether or not search is done in single-tree mode.
@@ -211,10 +224,34 @@ class NeighborSearch
   //! Instantiation of metric.
   MetricType metric;
 
+  /**
+   * Return the distance that the results are initialized with.  This is
+   * SortPolicy::WorstDistance(), clamped to the largest value ElemType can
+   * hold (DBL_MAX does not fit in a float).
+   */
+  static ElemType InitialDistance()
+  {
+    return (ElemType) std::min(SortPolicy::WorstDistance(),
+        (double) std::numeric_limits<ElemType>::max());
+  }
+
   //! The total number of base cases.
   size_t baseCases;
   //! The total number of scores (applicable for non-naive search).
   size_t scores;
+  //! The statistics of the tree traversals.
+  tree::TraversalStatistics statistics;
+
+  /**
+   * Perform single-tree search for each of the given number of query points,
+   * in parallel if possible, accumulating the number of scores and base cases
+   * into the given rules and the traversal statistics into 'statistics'.
+   *
+   * @param rules Rules to use for the traversals.
+   * @param numQueries Number of query points.
+   */
+  template<typename RuleType>
+  void SingleTreeSearch(RuleType& rules, const size_t numQueries);
 
 }; // class NeighborSearch
 
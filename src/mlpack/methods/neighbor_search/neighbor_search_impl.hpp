@@ -125,7 +125,7 @@ void NeighborSearch<SortPolicy, MetricType, TreeType, TraversalType>::Search(
     const typename TreeType::Mat& querySet,
     const size_t k,
     arma::Mat<size_t>& neighbors,
-    arma::mat& distances)
+    arma::Mat<ElemType>& distances)
 {
   Timer::Start("computing_neighbors");
 
@@ -137,13 +137,13 @@ void NeighborSearch<SortPolicy, MetricType, TreeType, TraversalType>::Search(
   // To avoid an extra copy, we will store the neighbors and distances in a
   // separate matrix.
   arma::Mat<size_t>* neighborPtr = &neighbors;
-  arma::mat* distancePtr = &distances;
+  arma::Mat<ElemType>* distancePtr = &distances;
 
   // Mapping is only necessary if the tree rearranges points.
   if (tree::TreeTraits<TreeType>::RearrangesDataset)
   {
     if (!singleMode && !naive)
-      distancePtr = new arma::mat; // Query indices need to be mapped.
+      distancePtr = new arma::Mat<ElemType>; // Query indices need to be mapped.
 
     if (treeOwner)
       neighborPtr = new arma::Mat<size_t>; // All indices need mapping.
@@ -153,7 +153,7 @@ void NeighborSearch<SortPolicy, MetricType, TreeType, TraversalType>::Search(
   neighborPtr->set_size(k, querySet.n_cols);
   neighborPtr->fill(size_t() - 1);
   distancePtr->set_size(k, querySet.n_cols);
-  distancePtr->fill(SortPolicy::WorstDistance());
+  distancePtr->fill(InitialDistance());
 
   // If we will be building a tree and it will modify the query set, make a copy
   // of the dataset.
@@ -181,12 +181,8 @@ void NeighborSearch<SortPolicy, MetricType, TreeType, TraversalType>::Search(
   }
   else if (singleMode)
   {
-    // Create the traverser.
-    typename TreeType::template SingleTreeTraverser<RuleType> traverser(rules);
-
-    // Now have it traverse for each point.
-    for (size_t i = 0; i < querySet.n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
+    // Traverse the reference tree for each query point.
+    SingleTreeSearch(rules, querySet.n_cols);
 
     scores += rules.Scores();
     baseCases += rules.BaseCases();
@@ -208,6 +204,7 @@ void NeighborSearch<SortPolicy, MetricType, TreeType, TraversalType>::Search(
     TraversalType<RuleType> traverser(rules);
 
     traverser.Traverse(*queryTree, *referenceTree);
+    statistics += traverser.Statistics();
 
     scores += rules.Scores();
     baseCases += rules.BaseCases();
@@ -218,6 +215,9 @@ void NeighborSearch<SortPolicy, MetricType, TreeType, TraversalType>::Search(
     delete queryTree;
   }
 
+  // The candidate lists are heaps until they are sorted.
+  rules.SortResults();
+
   Timer::Stop("computing_neighbors");
 
   // Map points back to original indices, if necessary.
@@ -288,7 +288,7 @@ void NeighborSearch<SortPolicy, MetricType, TreeType, TraversalType>::Search(
     TreeType* queryTree,
     const size_t k,
     arma::Mat<size_t>& neighbors,
-    arma::mat& distances)
+    arma::Mat<ElemType>& distances)
 {
   Timer::Start("computing_neighbors");
 
@@ -309,7 +309,7 @@ void NeighborSearch<SortPolicy, MetricType, TreeType, TraversalType>::Search(
   neighborPtr->set_size(k, querySet.n_cols);
   neighborPtr->fill(size_t() - 1);
   distances.set_size(k, querySet.n_cols);
-  distances.fill(SortPolicy::WorstDistance());
+  distances.fill(InitialDistance());
 
   // Create the helper object for the traversal.
   typedef NeighborSearchRules<SortPolicy, MetricType, TreeType> RuleType;
@@ -318,10 +318,14 @@ void NeighborSearch<SortPolicy, MetricType, TreeType, TraversalType>::Search(
   // Create the traverser.
   TraversalType<RuleType> traverser(rules);
   traverser.Traverse(*queryTree, *referenceTree);
+  statistics += traverser.Statistics();
 
   scores += rules.Scores();
   baseCases += rules.BaseCases();
 
+  // The candidate lists are heaps until they are sorted.
+  rules.SortResults();
+
   Timer::Stop("computing_neighbors");
 
   // Do we need to map indices?
@@ -347,17 +351,17 @@ template<typename SortPolicy,
 void NeighborSearch<SortPolicy, MetricType, TreeType, TraversalType>::Search(
     const size_t k,
     arma::Mat<size_t>& neighbors,
-    arma::mat& distances)
+    arma::Mat<ElemType>& distances)
 {
   Timer::Start("computing_neighbors");
 
   arma::Mat<size_t>* neighborPtr = &neighbors;
-  arma::mat* distancePtr = &distances;
+  arma::Mat<ElemType>* distancePtr = &distances;
 
   if (tree::TreeTraits<TreeType>::RearrangesDataset && treeOwner)
   {
     // We will always need to rearrange in this case.
-    distancePtr = new arma::mat;
+    distancePtr = new arma::Mat<ElemType>;
     neighborPtr = new arma::Mat<size_t>;
   }
 
@@ -365,7 +369,7 @@ void NeighborSearch<SortPolicy, MetricType, TreeType, TraversalType>::Search(
   neighborPtr->set_size(k, referenceSet.n_cols);
   neighborPtr->fill(size_t() - 1);
   distancePtr->set_size(k, referenceSet.n_cols);
-  distancePtr->fill(SortPolicy::WorstDistance());
+  distancePtr->fill(InitialDistance());
 
   // Create the helper object for the traversal.
   typedef NeighborSearchRules<SortPolicy, MetricType, TreeType> RuleType;
@@ -383,12 +387,8 @@ void NeighborSearch<SortPolicy, MetricType, TreeType, TraversalType>::Search(
   }
   else if (singleMode)
   {
-    // Create the traverser.
-    typename TreeType::template SingleTreeTraverser<RuleType> traverser(rules);
-
-    // Now have it traverse for each point.
-    for (size_t i = 0; i < referenceSet.n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
+    // Traverse the reference tree for each query point.
+    SingleTreeSearch(rules, referenceSet.n_cols);
 
     scores += rules.Scores();
     baseCases += rules.BaseCases();
@@ -402,6 +402,7 @@ void NeighborSearch<SortPolicy, MetricType, TreeType, TraversalType>::Search(
     TraversalType<RuleType> traverser(rules);
 
     traverser.Traverse(*referenceTree, *referenceTree);
+    statistics += traverser.Statistics();
 
     scores += rules.Scores();
     baseCases += rules.BaseCases();
@@ -410,6 +411,9 @@ void NeighborSearch<SortPolicy, MetricType, TreeType, TraversalType>::Search(
     Log::Info << rules.BaseCases() << " base cases were calculated.\n";
   }
 
+  // The candidate lists are heaps until they are sorted.
+  rules.SortResults();
+
   Timer::Stop("computing_neighbors");
 
   // Do we need to map the reference indices?
@@ -435,6 +439,54 @@ void NeighborSearch<SortPolicy, MetricType, TreeType, TraversalType>::Search(
   }
 }
 
+/**
+ * Run a single-tree traversal for each query point.  The query points are
+ * independent, so they are split between OpenMP threads; each thread uses its
+ * own copy of the rules (which all write to disjoint columns of the same result
+ * matrices), and the counts of scores and base cases are summed into the given
+ * rules afterwards, as are the traversal statistics of each thread.
+ */
+template<typename SortPolicy,
+         typename MetricType,
+         typename TreeType,
+         template<typename> class TraversalType>
+template<typename RuleType>
+void NeighborSearch<SortPolicy, MetricType, TreeType, TraversalType>::
+    SingleTreeSearch(RuleType& rules, const size_t numQueries)
+{
+  size_t totalScores = 0;
+  size_t totalBaseCases = 0;
+
+  // If the first point of each node is its centroid, the rules cache distances
+  // in the statistics of reference nodes, so the traversals are not independent
+  // and must run serially.
+  #pragma omp parallel if (!tree::TreeTraits<TreeType>::FirstPointIsCentroid) \
+      reduction(+:totalScores, totalBaseCases)
+  {
+    RuleType threadRules(rules);
+    threadRules.Scores() = 0;
+    threadRules.BaseCases() = 0;
+
+    typename TreeType::template SingleTreeTraverser<RuleType>
+        traverser(threadRules);
+
+    // Queries near each other in the dataset are often near each other in
+    // space, so hand them out in small contiguous chunks.
+    #pragma omp for schedule(dynamic, 16)
+    for (size_t i = 0; i < numQueries; ++i)
+      traverser.Traverse(i, *referenceTree);
+
+    totalScores += threadRules.Scores();
+    totalBaseCases += threadRules.BaseCases();
+
+    #pragma omp critical(NeighborSearchStatistics)
+    statistics += traverser.Statistics();
+  }
+
+  rules.Scores() += totalScores;
+  rules.BaseCases() += totalBaseCases;
+}
+
 // Return a String of the Object.
 template<typename SortPolicy,
          typename MetricType,
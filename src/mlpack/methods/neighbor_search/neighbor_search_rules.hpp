@@ -8,6 +8,8 @@
 #ifndef __MLPACK_METHODS_NEIGHBOR_SEARCH_NEIGHBOR_SEARCH_RULES_HPP
 #define __MLPACK_METHODS_NEIGHBOR_SEARCH_NEIGHBOR_SEARCH_RULES_HPP
 
+#include <mlpack/core/metrics/block_evaluate.hpp>
+
 #include "ns_traversal_info.hpp"
 
 namespace mlpack {
@@ -17,10 +19,13 @@ template<typename SortPolicy, typename MetricType, typename TreeType>
 class NeighborSearchRules
 {
  public:
+  //! The type of the elements of the dataset and of the distances.
+  typedef typename TreeType::Mat::elem_type ElemType;
+
   NeighborSearchRules(const typename TreeType::Mat& referenceSet,
                       const typename TreeType::Mat& querySet,
                       arma::Mat<size_t>& neighbors,
-                      arma::mat& distances,
+                      arma::Mat<ElemType>& distances,
                       MetricType& metric,
                       const bool sameSet = false);
   /**
@@ -33,6 +38,17 @@ class NeighborSearchRules
    */
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
 
+  /**
+   * Prepare for the base cases between all points in the given query leaf and
+   * reference leaf.  If the metric supports it (see
+   * metric::BlockEvaluateTraits), the whole block of distances is computed at
+   * once and then used by the following calls to BaseCase().
+   *
+   * @param queryNode Query leaf.
+   * @param referenceNode Reference leaf.
+   */
+  void PrepareBaseCases(TreeType& queryNode, TreeType& referenceNode);
+
   /**
    * Get the score for recursion order.  A low score indicates priority for
    * recursion, while DBL_MAX indicates that the node should not be recursed
@@ -93,6 +109,14 @@ class NeighborSearchRules
   //! Modify the number of scores that have been performed.
   size_t& Scores() { return scores; }
 
+  /**
+   * Sort the candidate list of each query point so that the best neighbor is
+   * first.  During the traversal, each column of the neighbors and distances
+   * matrices holds a heap with the worst candidate at the top, so this must be
+   * called once the traversal (or naive search) is finished.
+   */
+  void SortResults();
+
   //! Convenience typedef.
   typedef NeighborSearchTraversalInfo<TreeType> TraversalInfoType;
 
@@ -108,11 +132,13 @@ class NeighborSearchRules
   //! The query set.
   const typename TreeType::Mat& querySet;
 
-  //! The matrix the resultant neighbor indices should be stored in.
+  //! The matrix the resultant neighbor indices should be stored in.  Each
+  //! column is a heap of candidates until SortResults() is called.
   arma::Mat<size_t>& neighbors;
 
-  //! The matrix the resultant neighbor distances should be stored in.
-  arma::mat& distances;
+  //! The matrix the resultant neighbor distances should be stored in.  Each
+  //! column is a heap of candidates until SortResults() is called.
+  arma::Mat<ElemType>& distances;
 
   //! The instantiated metric.
   MetricType& metric;
@@ -127,6 +153,13 @@ class NeighborSearchRules
   //! The last base case result.
   double lastBaseCase;
 
+  //! Distances between the points of the last prepared leaf pair.
+  arma::Mat<ElemType> blockDistances;
+  //! The first query point of the last prepared leaf pair.
+  size_t blockQueryBegin;
+  //! The first reference point of the last prepared leaf pair.
+  size_t blockReferenceBegin;
+
   //! The number of base cases that have been performed.
   size_t baseCases;
   //! The number of scores that have been performed.
@@ -142,18 +175,40 @@ class NeighborSearchRules
   double CalculateBound(TreeType& queryNode) const;
 
   /**
-   * Insert a point into the neighbors and distances matrices; this is a helper
-   * function.
+   * Insert a point into the candidate heap held in the neighbors and distances
+   * matrices, replacing the current worst candidate; this is a helper function.
    *
    * @param queryIndex Index of point whose neighbors we are inserting into.
-   * @param pos Position in list to insert into.
    * @param neighbor Index of reference point which is being inserted.
    * @param distance Distance from query point to reference point.
    */
   void InsertNeighbor(const size_t queryIndex,
-                      const size_t pos,
                       const size_t neighbor,
                       const double distance);
+
+  /**
+   * Compare two candidates for sorting: the better distance comes first, and
+   * ties are broken by the smaller reference index.
+   */
+  static bool CandidateComparison(const std::pair<double, size_t>& a,
+                                  const std::pair<double, size_t>& b)
+  {
+    if (SortPolicy::IsBetter(a.first, b.first))
+      return true;
+    return (a.first == b.first) && (a.second < b.second);
+  }
+
+  /**
+   * Return whether a point or node whose best possible distance is the given
+   * distance may still improve a candidate list whose worst candidate is at
+   * the given bound.  A tie at SortPolicy::WorstDistance() may, because that
+   * is the distance of the slots that have not been filled yet.
+   */
+  static bool CanImprove(const double distance, const double bound)
+  {
+    return SortPolicy::IsBetter(distance, bound) ||
+        ((distance == bound) && (bound == SortPolicy::WorstDistance()));
+  }
 };
 
 }; // namespace neighbor
@@ -10,6 +10,8 @@
 // In case it hasn't been included yet.
 #include "neighbor_search_rules.hpp"
 
+#include <algorithm>
+
 namespace mlpack {
 namespace neighbor {
 
@@ -18,7 +20,7 @@ NeighborSearchRules<SortPolicy, MetricType, TreeType>::NeighborSearchRules(
     const typename TreeType::Mat& referenceSet,
     const typename TreeType::Mat& querySet,
     arma::Mat<size_t>& neighbors,
-    arma::mat& distances,
+    arma::Mat<ElemType>& distances,
     MetricType& metric,
     const bool sameSet) :
     referenceSet(referenceSet),
@@ -29,6 +31,8 @@ NeighborSearchRules<SortPolicy, MetricType, TreeType>::NeighborSearchRules(
     sameSet(sameSet),
     lastQueryIndex(querySet.n_cols),
     lastReferenceIndex(referenceSet.n_cols),
+    blockQueryBegin(0),
+    blockReferenceBegin(0),
     baseCases(0),
     scores(0)
 {
@@ -53,20 +57,26 @@ BaseCase(const size_t queryIndex, const size_t referenceIndex)
   if ((lastQueryIndex == queryIndex) && (lastReferenceIndex == referenceIndex))
     return lastBaseCase;
 
-  double distance = metric.Evaluate(querySet.col(queryIndex),
-                                    referenceSet.col(referenceIndex));
+  // Use the prepared block of distances if this pair is in it.
+  const size_t blockRow = queryIndex - blockQueryBegin;
+  const size_t blockCol = referenceIndex - blockReferenceBegin;
+  double distance;
+  if (blockRow < blockDistances.n_rows && blockCol < blockDistances.n_cols)
+    distance = blockDistances(blockRow, blockCol);
+  else
+    distance = metric.Evaluate(querySet.col(queryIndex),
+                               referenceSet.col(referenceIndex));
   ++baseCases;
 
-  // If this distance is better than any of the current candidates, the
-  // SortDistance() function will give us the position to insert it into.
-  arma::vec queryDist = distances.unsafe_col(queryIndex);
-  arma::Col<size_t> queryIndices = neighbors.unsafe_col(queryIndex);
-  const size_t insertPosition = SortPolicy::SortDistance(queryDist,
-      queryIndices, distance);
-
-  // SortDistance() returns (size_t() - 1) if we shouldn't add it.
-  if (insertPosition != (size_t() - 1))
-    InsertNeighbor(queryIndex, insertPosition, referenceIndex, distance);
+  // The candidate list is a heap with the worst candidate at the top, so we
+  // only need to compare against that candidate to see if this point should be
+  // inserted.  A tie with the worst candidate is only inserted if that slot has
+  // not been filled yet; otherwise a query point with fewer than k references
+  // at a better distance than SortPolicy::WorstDistance() (such as duplicates
+  // for furthest neighbor search) would be left with unfilled slots.
+  if ((neighbors(0, queryIndex) == (size_t() - 1)) ||
+      SortPolicy::IsBetter(distance, distances(0, queryIndex)))
+    InsertNeighbor(queryIndex, referenceIndex, distance);
 
   // Cache this information for the next time BaseCase() is called.
   lastQueryIndex = queryIndex;
@@ -76,6 +86,22 @@ BaseCase(const size_t queryIndex, const size_t referenceIndex)
   return distance;
 }
 
+template<typename SortPolicy, typename MetricType, typename TreeType>
+void NeighborSearchRules<SortPolicy, MetricType, TreeType>::PrepareBaseCases(
+    TreeType& queryNode,
+    TreeType& referenceNode)
+{
+  if (!metric::BlockEvaluateTraits<MetricType,
+      typename TreeType::Mat>::IsFaster(querySet.n_rows))
+    return;
+
+  metric::BlockEvaluate(metric, querySet, queryNode.Begin(), queryNode.Count(),
+      referenceSet, referenceNode.Begin(), referenceNode.Count(),
+      blockDistances);
+  blockQueryBegin = queryNode.Begin();
+  blockReferenceBegin = referenceNode.Begin();
+}
+
 template<typename SortPolicy, typename MetricType, typename TreeType>
 inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Score(
     const size_t queryIndex,
@@ -111,10 +137,11 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Score(
         &referenceNode);
   }
 
-  // Compare against the best k'th distance for this query point so far.
-  const double bestDistance = distances(distances.n_rows - 1, queryIndex);
+  // Compare against the best k'th distance for this query point so far (this is
+  // the top of the candidate heap).
+  const double bestDistance = distances(0, queryIndex);
 
-  return (SortPolicy::IsBetter(distance, bestDistance)) ? distance : DBL_MAX;
+  return CanImprove(distance, bestDistance) ? distance : DBL_MAX;
 }
 
 template<typename SortPolicy, typename MetricType, typename TreeType>
@@ -128,9 +155,9 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Rescore(
     return oldScore;
 
   // Just check the score again against the distances.
-  const double bestDistance = distances(distances.n_rows - 1, queryIndex);
+  const double bestDistance = distances(0, queryIndex);
 
-  return (SortPolicy::IsBetter(oldScore, bestDistance)) ? oldScore : DBL_MAX;
+  return CanImprove(oldScore, bestDistance) ? oldScore : DBL_MAX;
 }
 
 template<typename SortPolicy, typename MetricType, typename TreeType>
@@ -276,7 +303,7 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Score(
     distance = SortPolicy::BestNodeToNodeDistance(&queryNode, &referenceNode);
   }
 
-  if (SortPolicy::IsBetter(distance, bestDistance))
+  if (CanImprove(distance, bestDistance))
   {
     // Set traversal information.
     traversalInfo.LastQueryNode() = &queryNode;
@@ -306,7 +333,7 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Rescore(
   // Update our bound.
   const double bestDistance = CalculateBound(queryNode);
 
-  return (SortPolicy::IsBetter(oldScore, bestDistance)) ? oldScore : DBL_MAX;
+  return CanImprove(oldScore, bestDistance) ? oldScore : DBL_MAX;
 }
 
 // Calculate the bound for a given query node in its current state and update
@@ -348,7 +375,7 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::
   // Loop over points held in the node.
   for (size_t i = 0; i < queryNode.NumPoints(); ++i)
   {
-    const double distance = distances(distances.n_rows - 1, queryNode.Point(i));
+    const double distance = distances(0, queryNode.Point(i));
     if (SortPolicy::IsBetter(worstDistance, distance))
       worstDistance = distance;
     if (SortPolicy::IsBetter(distance, bestDistance))
@@ -413,35 +440,75 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::
 }
 
 /**
- * Helper function to insert a point into the neighbors and distances matrices.
+ * Helper function to insert a point into the candidate heap of a query point.
+ * The top of the heap (row 0 of the query point's column) is replaced and the
+ * new candidate is sifted down to its place, so that each candidate in the heap
+ * is no better than either of its children.
  *
  * @param queryIndex Index of point whose neighbors we are inserting into.
- * @param pos Position in list to insert into.
  * @param neighbor Index of reference point which is being inserted.
  * @param distance Distance from query point to reference point.
  */
 template<typename SortPolicy, typename MetricType, typename TreeType>
 void NeighborSearchRules<SortPolicy, MetricType, TreeType>::InsertNeighbor(
     const size_t queryIndex,
-    const size_t pos,
     const size_t neighbor,
     const double distance)
 {
-  // We only memmove() if there is actually a need to shift something.
-  if (pos < (distances.n_rows - 1))
+  ElemType* queryDistances = distances.colptr(queryIndex);
+  size_t* queryNeighbors = neighbors.colptr(queryIndex);
+  const size_t k = distances.n_rows;
+
+  size_t pos = 0;
+  while (2 * pos + 1 < k)
   {
-    int len = (distances.n_rows - 1) - pos;
-    memmove(distances.colptr(queryIndex) + (pos + 1),
-        distances.colptr(queryIndex) + pos,
-        sizeof(double) * len);
-    memmove(neighbors.colptr(queryIndex) + (pos + 1),
-        neighbors.colptr(queryIndex) + pos,
-        sizeof(size_t) * len);
+    // Find the worse of the two children.  Of two slots at the same distance,
+    // one that has not been filled yet is the worse, so that unfilled slots
+    // stay at the top of the heap until they are filled.
+    size_t child = 2 * pos + 1;
+    if ((child + 1 < k) &&
+        (SortPolicy::IsBetter(queryDistances[child], queryDistances[child + 1])
+        || ((queryDistances[child] == queryDistances[child + 1]) &&
+            (queryNeighbors[child + 1] == (size_t() - 1)))))
+      ++child;
+
+    // Stop if the new candidate is no better than that child.
+    if (!SortPolicy::IsBetter(distance, queryDistances[child]) &&
+        !((distance == queryDistances[child]) &&
+          (queryNeighbors[child] == (size_t() - 1))))
+      break;
+
+    queryDistances[pos] = queryDistances[child];
+    queryNeighbors[pos] = queryNeighbors[child];
+    pos = child;
   }
 
-  // Now put the new information in the right index.
-  distances(pos, queryIndex) = distance;
-  neighbors(pos, queryIndex) = neighbor;
+  queryDistances[pos] = distance;
+  queryNeighbors[pos] = neighbor;
+}
+
+/**
+ * Sort the candidate heap of each query point so that the best candidate is
+ * first.  Ties are broken by the index of the reference point.
+ */
+template<typename SortPolicy, typename MetricType, typename TreeType>
+void NeighborSearchRules<SortPolicy, MetricType, TreeType>::SortResults()
+{
+  std::vector<std::pair<double, size_t> > candidates(distances.n_rows);
+
+  for (size_t i = 0; i < distances.n_cols; ++i)
+  {
+    for (size_t j = 0; j < distances.n_rows; ++j)
+      candidates[j] = std::make_pair(distances(j, i), neighbors(j, i));
+
+    std::sort(candidates.begin(), candidates.end(), CandidateComparison);
+
+    for (size_t j = 0; j < distances.n_rows; ++j)
+    {
+      distances(j, i) = candidates[j].first;
+      neighbors(j, i) = candidates[j].second;
+    }
+  }
 }
 
 }; // namespace neighbor
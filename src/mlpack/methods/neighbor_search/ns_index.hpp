@@ -0,0 +1,72 @@
+/**
+ * @file ns_index.hpp
+ *
+ * Functions to save a reference tree (along with its rearranged dataset and the
+ * mapping back to the original point indices) to a binary index file, and to
+ * load it again, so that the tree does not need to be rebuilt for every search.
+ */
+#ifndef __MLPACK_METHODS_NEIGHBOR_SEARCH_NS_INDEX_HPP
+#define __MLPACK_METHODS_NEIGHBOR_SEARCH_NS_INDEX_HPP
+
+#include <mlpack/core.hpp>
+#include <string>
+#include <vector>
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * Save a built reference tree to a binary index file.  The file holds the
+ * (rearranged) dataset the tree was built on, the oldFromNew mapping given by
+ * the tree constructor, and the structure and bounds of the tree itself.  Data
+ * is written in the native byte order, so index files are not portable between
+ * machines of different endianness.
+ *
+ * The tree type must provide a Save(std::ostream&) method and a constructor
+ * taking (dataset, std::istream&), like BinarySpaceTree, and it must be built
+ * on a dense matrix.
+ *
+ * If 'fatal' is true, a std::runtime_error is thrown on failure.
+ *
+ * @param filename Name of index file to write.
+ * @param tree Root of the tree to save.
+ * @param oldFromNew Mapping from tree point indices to original indices.
+ * @param fatal If an error should be reported as fatal (default false).
+ * @return Boolean value indicating success or failure of save.
+ */
+template<typename TreeType>
+bool SaveIndex(const std::string& filename,
+               const TreeType& tree,
+               const std::vector<size_t>& oldFromNew,
+               const bool fatal = false);
+
+/**
+ * Load a reference tree from a binary index file written by SaveIndex().  The
+ * given dataset is filled with the rearranged dataset stored in the index, and
+ * the returned tree (which the caller must delete) refers to it, so the dataset
+ * must not go out of scope before the tree is deleted.  No tree building is
+ * done.
+ *
+ * If 'fatal' is true, a std::runtime_error is thrown on failure; otherwise,
+ * NULL is returned.
+ *
+ * @param filename Name of index file to read.
+ * @param dataset Matrix to store the rearranged dataset in.
+ * @param oldFromNew Vector to store the mapping from tree point indices to
+ *     original indices in.
+ * @param fatal If an error should be reported as fatal (default false).
+ * @return Newly allocated root of the loaded tree, or NULL on failure.
+ */
+template<typename TreeType>
+TreeType* LoadIndex(const std::string& filename,
+                    typename TreeType::Mat& dataset,
+                    std::vector<size_t>& oldFromNew,
+                    const bool fatal = false);
+
+}; // namespace neighbor
+}; // namespace mlpack
+
+// Include implementation.
+#include "ns_index_impl.hpp"
+
+#endif
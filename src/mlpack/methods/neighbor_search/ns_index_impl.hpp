@@ -0,0 +1,194 @@
+/**
+ * @file ns_index_impl.hpp
+ *
+ * Implementation of SaveIndex() and LoadIndex().
+ */
+#ifndef __MLPACK_METHODS_NEIGHBOR_SEARCH_NS_INDEX_IMPL_HPP
+#define __MLPACK_METHODS_NEIGHBOR_SEARCH_NS_INDEX_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "ns_index.hpp"
+
+#include <algorithm>
+#include <fstream>
+
+namespace mlpack {
+namespace neighbor {
+
+//! The identifier at the start of every index file.
+static const char nsIndexMagic[8] = { 'M', 'L', 'P', 'K', 'I', 'D', 'X', '1' };
+
+template<typename TreeType>
+bool SaveIndex(const std::string& filename,
+               const TreeType& tree,
+               const std::vector<size_t>& oldFromNew,
+               const bool fatal)
+{
+  typedef typename TreeType::Mat::elem_type ElemType;
+
+  Timer::Start("saving_index");
+
+  const typename TreeType::Mat& dataset = tree.Dataset();
+  std::ofstream stream(filename.c_str(), std::ios::out | std::ios::binary);
+  if (!stream.is_open())
+  {
+    Timer::Stop("saving_index");
+    if (fatal)
+      Log::Fatal << "Cannot open file '" << filename << "' for writing. "
+          << "Save failed." << std::endl;
+    else
+      Log::Warn << "Cannot open file '" << filename << "' for writing; save "
+          << "failed." << std::endl;
+
+    return false;
+  }
+
+  // The header: identifier, element size, and dataset size.
+  const uint64_t elemSize = sizeof(ElemType);
+  const uint64_t rows = dataset.n_rows;
+  const uint64_t cols = dataset.n_cols;
+  stream.write(nsIndexMagic, sizeof(nsIndexMagic));
+  stream.write((const char*) &elemSize, sizeof(uint64_t));
+  stream.write((const char*) &rows, sizeof(uint64_t));
+  stream.write((const char*) &cols, sizeof(uint64_t));
+
+  // The dataset and the mapping, as raw blocks.
+  stream.write((const char*) dataset.memptr(), sizeof(ElemType) *
+      dataset.n_elem);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    const uint64_t index = oldFromNew[i];
+    stream.write((const char*) &index, sizeof(uint64_t));
+  }
+
+  // Lastly, the tree.
+  tree.Save(stream);
+
+  Timer::Stop("saving_index");
+
+  if (!stream.good())
+  {
+    if (fatal)
+      Log::Fatal << "Writing index to '" << filename << "' failed."
+          << std::endl;
+    else
+      Log::Warn << "Writing index to '" << filename << "' failed."
+          << std::endl;
+
+    return false;
+  }
+
+  Log::Info << "Saved index (" << rows << " x " << cols << ") to '"
+      << filename << "'." << std::endl;
+  return true;
+}
+
+template<typename TreeType>
+TreeType* LoadIndex(const std::string& filename,
+                    typename TreeType::Mat& dataset,
+                    std::vector<size_t>& oldFromNew,
+                    const bool fatal)
+{
+  typedef typename TreeType::Mat::elem_type ElemType;
+
+  Timer::Start("loading_index");
+
+  std::ifstream stream(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!stream.is_open())
+  {
+    Timer::Stop("loading_index");
+    if (fatal)
+      Log::Fatal << "Cannot open file '" << filename << "'. " << std::endl;
+    else
+      Log::Warn << "Cannot open file '" << filename << "'; load failed."
+          << std::endl;
+
+    return NULL;
+  }
+
+  char magic[sizeof(nsIndexMagic)];
+  uint64_t elemSize, rows, cols;
+  stream.read(magic, sizeof(magic));
+  stream.read((char*) &elemSize, sizeof(uint64_t));
+  stream.read((char*) &rows, sizeof(uint64_t));
+  stream.read((char*) &cols, sizeof(uint64_t));
+
+  // The dataset and the mapping must fit in the rest of the file; check that
+  // before allocating them, so that a corrupt header fails cleanly instead of
+  // allocating gigabytes.
+  bool sizeValid = false;
+  if (stream.good())
+  {
+    const std::streampos position = stream.tellg();
+    stream.seekg(0, std::ios::end);
+    const uint64_t remaining = (uint64_t) (stream.tellg() - position);
+    stream.seekg(position);
+
+    const uint64_t columnSize = rows * sizeof(ElemType) + sizeof(uint64_t);
+    sizeValid = (rows <= remaining / sizeof(ElemType)) &&
+        (cols <= remaining / columnSize);
+  }
+
+  if (!stream.good() || !sizeValid ||
+      !std::equal(magic, magic + sizeof(magic), nsIndexMagic) ||
+      (elemSize != sizeof(ElemType)))
+  {
+    Timer::Stop("loading_index");
+    if (fatal)
+      Log::Fatal << "'" << filename << "' is not a valid index file for this "
+          << "tree type." << std::endl;
+    else
+      Log::Warn << "'" << filename << "' is not a valid index file for this "
+          << "tree type; load failed." << std::endl;
+
+    return NULL;
+  }
+
+  // Read the dataset and the mapping directly into their final memory.
+  dataset.set_size(rows, cols);
+  stream.read((char*) dataset.memptr(), sizeof(ElemType) * dataset.n_elem);
+
+  oldFromNew.resize(cols);
+  for (size_t i = 0; i < cols; ++i)
+  {
+    uint64_t index;
+    stream.read((char*) &index, sizeof(uint64_t));
+    oldFromNew[i] = index;
+  }
+
+  TreeType* tree = NULL;
+  if (stream.good())
+  {
+    try
+    {
+      tree = new TreeType(dataset, stream);
+    }
+    catch (std::runtime_error&)
+    {
+      tree = NULL;
+    }
+  }
+
+  Timer::Stop("loading_index");
+
+  if (tree == NULL)
+  {
+    if (fatal)
+      Log::Fatal << "Loading index from '" << filename << "' failed; the file "
+          << "is truncated or corrupt." << std::endl;
+    else
+      Log::Warn << "Loading index from '" << filename << "' failed; the file "
+          << "is truncated or corrupt." << std::endl;
+
+    return NULL;
+  }
+
+  Log::Info << "Loaded index (" << rows << " x " << cols << ") from '"
+      << filename << "'." << std::endl;
+  return tree;
+}
+
+}; // namespace neighbor
+}; // namespace mlpack
+
+#endif
@@ -27,12 +27,13 @@ namespace neighbor {
  * @param distancesOut Matrix to store unmapped distances into.
  * @param squareRoot If true, take the square root of the distances.
  */
+template<typename eT>
 void Unmap(const arma::Mat<size_t>& neighbors,
-           const arma::mat& distances,
+           const arma::Mat<eT>& distances,
            const std::vector<size_t>& referenceMap,
            const std::vector<size_t>& queryMap,
            arma::Mat<size_t>& neighborsOut,
-           arma::mat& distancesOut,
+           arma::Mat<eT>& distancesOut,
            const bool squareRoot = false);
 
 /**
@@ -48,14 +49,18 @@ void Unmap(const arma::Mat<size_t>& neighbors,
  * @param distancesOut Matrix to store unmapped distances into.
  * @param squareRoot If true, take the square root of the distances.
  */
+template<typename eT>
 void Unmap(const arma::Mat<size_t>& neighbors,
-           const arma::mat& distances,
+           const arma::Mat<eT>& distances,
            const std::vector<size_t>& referenceMap,
            arma::Mat<size_t>& neighborsOut,
-           arma::mat& distancesOut,
+           arma::Mat<eT>& distancesOut,
            const bool squareRoot = false);
 
 }; // namespace neighbor
 }; // namespace mlpack
 
+// Include implementation.
+#include "unmap_impl.hpp"
+
 #endif
@@ -1,21 +1,26 @@
 /**
- * @file unmap.cpp
+ * @file unmap_impl.hpp
  * @author Ryan Curtin
  *
  * Auxiliary function to unmap neighbor search results.
  */
+#ifndef __MLPACK_METHODS_NEIGHBOR_SEARCH_UNMAP_IMPL_HPP
+#define __MLPACK_METHODS_NEIGHBOR_SEARCH_UNMAP_IMPL_HPP
+
+// In case it hasn't been included yet.
 #include "unmap.hpp"
 
 namespace mlpack {
 namespace neighbor {
 
 // Useful in the dual-tree setting.
+template<typename eT>
 void Unmap(const arma::Mat<size_t>& neighbors,
-           const arma::mat& distances,
+           const arma::Mat<eT>& distances,
            const std::vector<size_t>& referenceMap,
            const std::vector<size_t>& queryMap,
            arma::Mat<size_t>& neighborsOut,
-           arma::mat& distancesOut,
+           arma::Mat<eT>& distancesOut,
            const bool squareRoot)
 {
   // Set matrices to correct size.
@@ -39,11 +44,12 @@ void Unmap(const arma::Mat<size_t>& neighbors,
 }
 
 // Useful in the single-tree setting.
+template<typename eT>
 void Unmap(const arma::Mat<size_t>& neighbors,
-           const arma::mat& distances,
+           const arma::Mat<eT>& distances,
            const std::vector<size_t>& referenceMap,
            arma::Mat<size_t>& neighborsOut,
-           arma::mat& distancesOut,
+           arma::Mat<eT>& distancesOut,
            const bool squareRoot)
 {
   // Set matrices to correct size.
@@ -62,3 +68,5 @@ void Unmap(const arma::Mat<size_t>& neighbors,
 
 }; // namespace neighbor
 }; // namespace mlpack
+
+#endif
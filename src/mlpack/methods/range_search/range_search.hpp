@@ -11,6 +11,7 @@
 #include <mlpack/core.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/core/tree/binary_space_tree.hpp>
+#include <mlpack/core/tree/traversal_statistics.hpp>
 #include "range_search_stat.hpp"
 
 namespace mlpack {
@@ -28,6 +29,10 @@ template<typename MetricType = mlpack::metric::EuclideanDistance,
 class RangeSearch
 {
  public:
+  //! The type of the elements of the dataset, which is also the type of the
+  //! output distances.
+  typedef typename TreeType::Mat::elem_type ElemType;
+
   /**
    * Initialize the RangeSearch object with a given reference dataset (this is
    * the dataset which is searched).  Optionally, perform the computation in
@@ -113,7 +118,7 @@ class RangeSearch
   void Search(const typename TreeType::Mat& querySet,
               const math::Range& range,
               std::vector<std::vector<size_t>>& neighbors,
-              std::vector<std::vector<double>>& distances);
+              std::vector<std::vector<ElemType>>& distances);
 
   /**
    * Given a pre-built query tree, search for all reference points in the given
@@ -154,7 +159,7 @@ class RangeSearch
   void Search(TreeType* queryTree,
               const math::Range& range,
               std::vector<std::vector<size_t>>& neighbors,
-              std::vector<std::vector<double>>& distances);
+              std::vector<std::vector<ElemType>>& distances);
 
   /**
    * Search for all points in the given range for each point in the reference
@@ -188,11 +193,16 @@ class RangeSearch
    */
   void Search(const math::Range& range,
               std::vector<std::vector<size_t>>& neighbors,
-              std::vector<std::vector<double>>& distances);
+              std::vector<std::vector<ElemType>>& distances);
 
   // Returns a string representation of this object.
   std::string ToString() const;
 
+  //! Return the statistics of the tree traversals of all searches.
+  const tree::TraversalStatistics& Statistics() const { return statistics; }
+  //! Modify the statistics of the tree traversals (good for a reset).
+  tree::TraversalStatistics& Statistics() { return statistics; }
+
  private:
   //! Copy of reference matrix; used when a tree is built internally.
   typename TreeType::Mat referenceCopy;
@@ -213,6 +223,9 @@ class RangeSearch
 
   //! Instantiated distance metric.
   MetricType metric;
+
+  //! The statistics of the tree traversals.
+  tree::TraversalStatistics statistics;
 };
 
 }; // namespace range
@@ -101,7 +101,7 @@ void RangeSearch<MetricType, TreeType>::Search(
     const typename TreeType::Mat& querySet,
     const math::Range& range,
     std::vector<std::vector<size_t>>& neighbors,
-    std::vector<std::vector<double>>& distances)
+    std::vector<std::vector<ElemType>>& distances)
 {
   Timer::Start("range_search/computing_neighbors");
 
@@ -124,7 +124,7 @@ void RangeSearch<MetricType, TreeType>::Search(
   // To avoid extra copies, we will store the unmapped neighbors and distances
   // in a separate object.
   std::vector<std::vector<size_t>>* neighborPtr = &neighbors;
-  std::vector<std::vector<double>>* distancePtr = &distances;
+  std::vector<std::vector<ElemType>>* distancePtr = &distances;
 
   // Mapping is only necessary if the tree rearranges points.
   if (tree::TreeTraits<TreeType>::RearrangesDataset)
@@ -132,7 +132,7 @@ void RangeSearch<MetricType, TreeType>::Search(
     // Query indices only need to be mapped if we are building the query tree
     // ourselves.
     if (!singleMode && !naive)
-      distancePtr = new std::vector<std::vector<double>>;
+      distancePtr = new std::vector<std::vector<ElemType>>;
 
     // Reference indices only need to be mapped if we built the reference tree
     // ourselves.
@@ -166,6 +166,8 @@ void RangeSearch<MetricType, TreeType>::Search(
     // Now have it traverse for each point.
     for (size_t i = 0; i < querySet.n_cols; ++i)
       traverser.Traverse(i, *referenceTree);
+
+    statistics += traverser.Statistics();
   }
   else // Dual-tree recursion.
   {
@@ -181,6 +183,7 @@ void RangeSearch<MetricType, TreeType>::Search(
     typename TreeType::template DualTreeTraverser<RuleType> traverser(rules);
 
     traverser.Traverse(*queryTree, *referenceTree);
+    statistics += traverser.Statistics();
 
     // Clean up tree memory.
     delete queryTree;
@@ -260,7 +263,7 @@ void RangeSearch<MetricType, TreeType>::Search(
     TreeType* queryTree,
     const math::Range& range,
     std::vector<std::vector<size_t>>& neighbors,
-    std::vector<std::vector<double>>& distances)
+    std::vector<std::vector<ElemType>>& distances)
 {
   Timer::Start("range_search/computing_neighbors");
 
@@ -293,6 +296,7 @@ void RangeSearch<MetricType, TreeType>::Search(
   typename TreeType::template DualTreeTraverser<RuleType> traverser(rules);
 
   traverser.Traverse(*queryTree, *referenceTree);
+  statistics += traverser.Statistics();
 
   Timer::Stop("range_search/computing_neighbors");
 
@@ -319,18 +323,18 @@ template<typename MetricType, typename TreeType>
 void RangeSearch<MetricType, TreeType>::Search(
     const math::Range& range,
     std::vector<std::vector<size_t>>& neighbors,
-    std::vector<std::vector<double>>& distances)
+    std::vector<std::vector<ElemType>>& distances)
 {
   Timer::Start("range_search/computing_neighbors");
 
   // Here, we will use the query set as the reference set.
   std::vector<std::vector<size_t>>* neighborPtr = &neighbors;
-  std::vector<std::vector<double>>* distancePtr = &distances;
+  std::vector<std::vector<ElemType>>* distancePtr = &distances;
 
   if (tree::TreeTraits<TreeType>::RearrangesDataset && treeOwner)
   {
     // We will always need to rearrange in this case.
-    distancePtr = new std::vector<std::vector<double>>;
+    distancePtr = new std::vector<std::vector<ElemType>>;
     neighborPtr = new std::vector<std::vector<size_t>>;
   }
 
@@ -360,6 +364,8 @@ void RangeSearch<MetricType, TreeType>::Search(
     // Now have it traverse for each point.
     for (size_t i = 0; i < referenceSet.n_cols; ++i)
       traverser.Traverse(i, *referenceTree);
+
+    statistics += traverser.Statistics();
   }
   else // Dual-tree recursion.
   {
@@ -367,6 +373,7 @@ void RangeSearch<MetricType, TreeType>::Search(
     typename TreeType::template DualTreeTraverser<RuleType> traverser(rules);
 
     traverser.Traverse(*referenceTree, *referenceTree);
+    statistics += traverser.Statistics();
   }
 
   Timer::Stop("range_search/computing_neighbors");
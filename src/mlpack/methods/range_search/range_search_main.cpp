@@ -64,6 +64,8 @@ PARAM_FLAG("single_mode", "If true, single-tree search is used (as opposed to "
     "dual-tree search).", "s");
 PARAM_FLAG("cover_tree", "If true, use a cover tree for range searching "
     "(instead of a kd-tree).", "c");
+PARAM_FLAG("stats", "If true, print the number of prunes, scores, base cases "
+    "and nodes visited by the tree traversal (with --verbose).", "");
 
 typedef RangeSearch<> RSType;
 typedef CoverTree<metric::EuclideanDistance, tree::FirstPointIsRoot,
@@ -159,6 +161,9 @@ int main(int argc, char *argv[])
       // Query tree is automatically built if needed.
       rangeSearch.Search(queryData, r, neighbors, distances);
     }
+
+    if (CLI::HasParam("stats"))
+      Log::Info << rangeSearch.Statistics().ToString();
   }
   else
   {
@@ -216,6 +221,8 @@ int main(int argc, char *argv[])
     }
 
     Log::Info << "Neighbors computed." << endl;
+    if (CLI::HasParam("stats"))
+      Log::Info << rangeSearch.Statistics().ToString();
 
     // We have to map back to the original indices from before the tree
     // construction.
@@ -7,6 +7,8 @@
 #ifndef __MLPACK_METHODS_RANGE_SEARCH_RANGE_SEARCH_RULES_HPP
 #define __MLPACK_METHODS_RANGE_SEARCH_RANGE_SEARCH_RULES_HPP
 
+#include <mlpack/core/metrics/block_evaluate.hpp>
+
 #include "../neighbor_search/ns_traversal_info.hpp"
 
 namespace mlpack {
@@ -17,6 +19,9 @@ template<typename MetricType, typename TreeType>
 class RangeSearchRules
 {
  public:
+  //! The type of the elements of the dataset and of the distances.
+  typedef typename TreeType::Mat::elem_type ElemType;
+
   /**
    * Construct the RangeSearchRules object.  This is usually done from within
    * the RangeSearch class at search time.
@@ -30,11 +35,11 @@ class RangeSearchRules
    * @param sameSet If true, the query and reference set are taken to be the
    *      same, and a query point will not return itself in the results.
    */
-  RangeSearchRules(const arma::mat& referenceSet,
-                   const arma::mat& querySet,
+  RangeSearchRules(const typename TreeType::Mat& referenceSet,
+                   const typename TreeType::Mat& querySet,
                    const math::Range& range,
                    std::vector<std::vector<size_t> >& neighbors,
-                   std::vector<std::vector<double> >& distances,
+                   std::vector<std::vector<ElemType> >& distances,
                    MetricType& metric,
                    const bool sameSet = false);
 
@@ -46,6 +51,17 @@ class RangeSearchRules
    */
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
 
+  /**
+   * Prepare for the base cases between all points in the given query leaf and
+   * reference leaf.  If the metric supports it (see
+   * metric::BlockEvaluateTraits), the whole block of distances is computed at
+   * once and then used by the following calls to BaseCase().
+   *
+   * @param queryNode Query leaf.
+   * @param referenceNode Reference leaf.
+   */
+  void PrepareBaseCases(TreeType& queryNode, TreeType& referenceNode);
+
   /**
    * Get the score for recursion order.  A low score indicates priority for
    * recursion, while DBL_MAX indicates that the node should not be recursed
@@ -103,10 +119,10 @@ class RangeSearchRules
 
  private:
   //! The reference set.
-  const arma::mat& referenceSet;
+  const typename TreeType::Mat& referenceSet;
 
   //! The query set.
-  const arma::mat& querySet;
+  const typename TreeType::Mat& querySet;
 
   //! The range of distances for which we are searching.
   const math::Range& range;
@@ -115,7 +131,7 @@ class RangeSearchRules
   std::vector<std::vector<size_t> >& neighbors;
 
   //! The vector the resultant neighbor distances should be stored in.
-  std::vector<std::vector<double> >& distances;
+  std::vector<std::vector<ElemType> >& distances;
 
   //! The instantiated metric.
   MetricType& metric;
@@ -128,6 +144,13 @@ class RangeSearchRules
   //! The last reference index.
   size_t lastReferenceIndex;
 
+  //! Distances between the points of the last prepared leaf pair.
+  arma::Mat<ElemType> blockDistances;
+  //! The first query point of the last prepared leaf pair.
+  size_t blockQueryBegin;
+  //! The first reference point of the last prepared leaf pair.
+  size_t blockReferenceBegin;
+
   //! Add all the points in the given node to the results for the given query
   //! point.  If the base case has already been calculated, we make sure to not
   //! add that to the results twice.
@@ -15,11 +15,11 @@ namespace range {
 
 template<typename MetricType, typename TreeType>
 RangeSearchRules<MetricType, TreeType>::RangeSearchRules(
-    const arma::mat& referenceSet,
-    const arma::mat& querySet,
+    const typename TreeType::Mat& referenceSet,
+    const typename TreeType::Mat& querySet,
     const math::Range& range,
     std::vector<std::vector<size_t> >& neighbors,
-    std::vector<std::vector<double> >& distances,
+    std::vector<std::vector<ElemType> >& distances,
     MetricType& metric,
     const bool sameSet) :
     referenceSet(referenceSet),
@@ -30,7 +30,9 @@ RangeSearchRules<MetricType, TreeType>::RangeSearchRules(
     metric(metric),
     sameSet(sameSet),
     lastQueryIndex(querySet.n_cols),
-    lastReferenceIndex(referenceSet.n_cols)
+    lastReferenceIndex(referenceSet.n_cols),
+    blockQueryBegin(0),
+    blockReferenceBegin(0)
 {
   // Nothing to do.
 }
@@ -51,8 +53,14 @@ double RangeSearchRules<MetricType, TreeType>::BaseCase(
   if ((lastQueryIndex == queryIndex) && (lastReferenceIndex == referenceIndex))
     return 0.0; // No value to return... this shouldn't do anything bad.
 
-  const double distance = metric.Evaluate(querySet.unsafe_col(queryIndex),
-      referenceSet.unsafe_col(referenceIndex));
+  // Use the prepared block of distances if this pair is in it.
+  const size_t blockRow = queryIndex - blockQueryBegin;
+  const size_t blockCol = referenceIndex - blockReferenceBegin;
+  const double distance =
+      (blockRow < blockDistances.n_rows && blockCol < blockDistances.n_cols) ?
+      blockDistances(blockRow, blockCol) :
+      metric.Evaluate(querySet.unsafe_col(queryIndex),
+                      referenceSet.unsafe_col(referenceIndex));
 
   // Update last indices, so we don't accidentally perform a base case twice.
   lastQueryIndex = queryIndex;
@@ -67,6 +75,23 @@ double RangeSearchRules<MetricType, TreeType>::BaseCase(
   return distance;
 }
 
+//! Compute the distances for all base cases between two leaves at once.
+template<typename MetricType, typename TreeType>
+void RangeSearchRules<MetricType, TreeType>::PrepareBaseCases(
+    TreeType& queryNode,
+    TreeType& referenceNode)
+{
+  if (!metric::BlockEvaluateTraits<MetricType,
+      typename TreeType::Mat>::IsFaster(querySet.n_rows))
+    return;
+
+  metric::BlockEvaluate(metric, querySet, queryNode.Begin(), queryNode.Count(),
+      referenceSet, referenceNode.Begin(), referenceNode.Count(),
+      blockDistances);
+  blockQueryBegin = queryNode.Begin();
+  blockReferenceBegin = referenceNode.Begin();
+}
+
 //! Single-tree scoring function.
 template<typename MetricType, typename TreeType>
 double RangeSearchRules<MetricType, TreeType>::Score(const size_t queryIndex,
@@ -74,6 +74,8 @@ PARAM_FLAG("first_leaf_exact", "The flag to trigger sampling only after "
            "exactly exploring the first leaf.", "X");
 PARAM_INT("single_sample_limit", "The limit on the maximum number of "
     "samples (and hence the largest node you can approximate).", "S", 20);
+PARAM_FLAG("stats", "If true, print the number of prunes, scores, base cases "
+    "and nodes visited by the tree traversal (with --verbose).", "");
 
 int main(int argc, char *argv[])
 {
@@ -211,6 +213,8 @@ int main(int argc, char *argv[])
     }
 
     Log::Info << "Neighbors computed." << endl;
+    if (CLI::HasParam("stats"))
+      Log::Info << allkrann.Statistics().ToString();
 
     // We have to map back to the original indices from before the tree
     // construction.
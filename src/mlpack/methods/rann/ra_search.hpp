@@ -21,6 +21,7 @@
 #include <mlpack/core.hpp>
 
 #include <mlpack/core/tree/binary_space_tree.hpp>
+#include <mlpack/core/tree/traversal_statistics.hpp>
 
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/methods/neighbor_search/sort_policies/nearest_neighbor_sort.hpp>
@@ -278,6 +279,11 @@ class RASearch
   //! Modify the limit on the size of a node that can be approximation.
   size_t& SingleSampleLimit() { return singleSampleLimit; }
 
+  //! Get the statistics of the tree traversals of all searches.
+  const tree::TraversalStatistics& Statistics() const { return statistics; }
+  //! Modify the statistics of the tree traversals (good for a reset).
+  tree::TraversalStatistics& Statistics() { return statistics; }
+
   //! Returns a string representation of this object.
   std::string ToString() const;
 
@@ -316,6 +322,8 @@ class RASearch
   //! Permutations of reference points during tree building.
   std::vector<size_t> oldFromNewReferences;
 
+  //! The statistics of the tree traversals.
+  tree::TraversalStatistics statistics;
 }; // class RASearch
 
 }; // namespace neighbor
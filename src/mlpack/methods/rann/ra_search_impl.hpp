@@ -209,6 +209,7 @@ Search(const typename TreeType::Mat& querySet,
       // Now have it traverse for each point.
       for (size_t i = 0; i < querySetRef.n_cols; ++i)
         traverser.Traverse(i, *referenceTree);
+      statistics += traverser.Statistics();
 
       Log::Info << "Single-tree traversal complete." << std::endl;
       Log::Info << "Average number of distance calculations per query point: "
@@ -234,6 +235,7 @@ Search(const typename TreeType::Mat& querySet,
         << queryTree->Stat().NumSamplesMade() << std::endl;
 
     traverser.Traverse(*queryTree, *referenceTree);
+    statistics += traverser.Statistics();
 
     Log::Info << "Dual-tree traversal complete." << std::endl;
     Log::Info << "Average number of distance calculations per query point: "
@@ -341,6 +343,7 @@ void RASearch<SortPolicy, MetricType, TreeType>::Search(
   // Create the traverser.
   typename TreeType::template DualTreeTraverser<RuleType> traverser(rules);
   traverser.Traverse(*queryTree, *referenceTree);
+  statistics += traverser.Statistics();
 
   Timer::Stop("computing_neighbors");
 
@@ -413,6 +416,7 @@ void RASearch<SortPolicy, MetricType, TreeType>::Search(
     // Now have it traverse for each point.
     for (size_t i = 0; i < referenceSet.n_cols; ++i)
       traverser.Traverse(i, *referenceTree);
+    statistics += traverser.Statistics();
   }
   else
   {
@@ -420,6 +424,7 @@ void RASearch<SortPolicy, MetricType, TreeType>::Search(
     typename TreeType::template DualTreeTraverser<RuleType> traverser(rules);
 
     traverser.Traverse(*referenceTree, *referenceTree);
+    statistics += traverser.Statistics();
   }
 
   Timer::Stop("computing_neighbors");
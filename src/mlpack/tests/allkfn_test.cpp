@@ -569,4 +569,57 @@ BOOST_AUTO_TEST_CASE(DualBallTreeTest)
   }
 }
 
+/**
+ * Test the furthest-neighbors methods on a dataset where every point has nine
+ * duplicates, with k large enough that some of the furthest neighbors of each
+ * point must be its duplicates, at distance zero.  Every slot must be filled
+ * with a valid neighbor.
+ */
+BOOST_AUTO_TEST_CASE(DuplicatePointsTest)
+{
+  arma::mat points;
+  points.randu(3, 3);
+  arma::mat dataset(3, 30);
+  for (size_t i = 0; i < 30; ++i)
+    dataset.col(i) = points.col(i % 3);
+
+  AllkFN dualTree(dataset);
+  AllkFN singleTree(dataset, false, true);
+  AllkFN naive(dataset, true);
+
+  arma::Mat<size_t> dualNeighbors, singleNeighbors, naiveNeighbors;
+  arma::mat dualDistances, singleDistances, naiveDistances;
+  dualTree.Search(25, dualNeighbors, dualDistances);
+  singleTree.Search(25, singleNeighbors, singleDistances);
+  naive.Search(25, naiveNeighbors, naiveDistances);
+
+  // The duplicates are tied with each other, so the searches may pick
+  // different ones; check the distances, and that every neighbor is at the
+  // distance reported for it.
+  EuclideanDistance metric;
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    for (size_t j = 0; j < 25; ++j)
+    {
+      BOOST_REQUIRE_LT(naiveNeighbors(j, i), dataset.n_cols);
+      BOOST_REQUIRE_LT(dualNeighbors(j, i), dataset.n_cols);
+      BOOST_REQUIRE_LT(singleNeighbors(j, i), dataset.n_cols);
+      BOOST_REQUIRE_NE(naiveNeighbors(j, i), i);
+      BOOST_REQUIRE_NE(dualNeighbors(j, i), i);
+      BOOST_REQUIRE_NE(singleNeighbors(j, i), i);
+
+      BOOST_REQUIRE_CLOSE(dualDistances(j, i), naiveDistances(j, i), 1e-5);
+      BOOST_REQUIRE_CLOSE(singleDistances(j, i), naiveDistances(j, i), 1e-5);
+      BOOST_REQUIRE_CLOSE(metric.Evaluate(dataset.col(i),
+          dataset.col(dualNeighbors(j, i))), dualDistances(j, i), 1e-5);
+      BOOST_REQUIRE_CLOSE(metric.Evaluate(dataset.col(i),
+          dataset.col(singleNeighbors(j, i))), singleDistances(j, i), 1e-5);
+    }
+
+    // The last five furthest neighbors are duplicates.
+    for (size_t j = 20; j < 25; ++j)
+      BOOST_REQUIRE_EQUAL(naiveDistances(j, i), 0.0);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
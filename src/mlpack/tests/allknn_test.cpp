@@ -6,11 +6,17 @@
 #include <mlpack/core.hpp>
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
 #include <mlpack/methods/neighbor_search/unmap.hpp>
+#include <mlpack/methods/neighbor_search/ns_index.hpp>
 #include <mlpack/core/tree/cover_tree.hpp>
 #include <mlpack/core/tree/example_tree.hpp>
+#include <mlpack/core/tree/flat_binary_space_tree.hpp>
 #include <boost/test/unit_test.hpp>
 #include "old_boost_test_definitions.hpp"
 
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
 using namespace mlpack;
 using namespace mlpack::neighbor;
 using namespace mlpack::tree;
@@ -538,6 +544,139 @@ BOOST_AUTO_TEST_CASE(DualTreeVsNaive2)
   }
 }
 
+/**
+ * Test the dual-tree nearest-neighbors method with the naive method on
+ * higher-dimensional data, where the leaf-leaf base cases are computed in
+ * blocks.
+ */
+BOOST_AUTO_TEST_CASE(DualTreeVsNaiveHighDimensional)
+{
+  arma::mat dataset;
+  dataset.randu(30, 2000);
+  arma::mat querySet;
+  querySet.randu(30, 500);
+
+  AllkNN allknn(dataset);
+  AllkNN naive(dataset, true);
+
+  arma::Mat<size_t> neighborsTree;
+  arma::mat distancesTree;
+  allknn.Search(querySet, 10, neighborsTree, distancesTree);
+
+  arma::Mat<size_t> neighborsNaive;
+  arma::mat distancesNaive;
+  naive.Search(querySet, 10, neighborsNaive, distancesNaive);
+
+  for (size_t i = 0; i < neighborsTree.n_elem; i++)
+  {
+    BOOST_REQUIRE_EQUAL(neighborsTree[i], neighborsNaive[i]);
+    BOOST_REQUIRE_CLOSE(distancesTree[i], distancesNaive[i], 1e-5);
+  }
+}
+
+/**
+ * Test the dual-tree nearest-neighbors method with the naive method on
+ * higher-dimensional data far from the origin, where the squared norms of the
+ * points are much larger than the distances between them.
+ */
+BOOST_AUTO_TEST_CASE(DualTreeVsNaiveOffset)
+{
+  arma::mat dataset;
+  dataset.randu(30, 2000);
+  dataset += 1e6;
+  arma::mat querySet;
+  querySet.randu(30, 500);
+  querySet += 1e6;
+
+  AllkNN allknn(dataset);
+  AllkNN naive(dataset, true);
+
+  arma::Mat<size_t> neighborsTree;
+  arma::mat distancesTree;
+  allknn.Search(querySet, 10, neighborsTree, distancesTree);
+
+  arma::Mat<size_t> neighborsNaive;
+  arma::mat distancesNaive;
+  naive.Search(querySet, 10, neighborsNaive, distancesNaive);
+
+  for (size_t i = 0; i < neighborsTree.n_elem; i++)
+  {
+    BOOST_REQUIRE_EQUAL(neighborsTree[i], neighborsNaive[i]);
+    BOOST_REQUIRE_CLOSE(distancesTree[i], distancesNaive[i], 1e-5);
+  }
+}
+
+/**
+ * Test the dual-tree nearest-neighbors method with the naive method on
+ * higher-dimensional data where every point appears twice.  The distance
+ * between the two copies must come out as exactly zero.
+ */
+BOOST_AUTO_TEST_CASE(DualTreeVsNaiveDuplicates)
+{
+  arma::mat points;
+  points.randu(30, 1000);
+  points += 1e6;
+  const arma::mat dataset = arma::join_rows(points, points);
+  const arma::mat querySet = points.cols(0, 199);
+
+  AllkNN allknn(dataset);
+  AllkNN naive(dataset, true);
+
+  arma::Mat<size_t> neighborsTree;
+  arma::mat distancesTree;
+  allknn.Search(querySet, 6, neighborsTree, distancesTree);
+
+  arma::Mat<size_t> neighborsNaive;
+  arma::mat distancesNaive;
+  naive.Search(querySet, 6, neighborsNaive, distancesNaive);
+
+  // Every neighbor is tied with its copy, so the two searches may order them
+  // differently; check the distances, and that each neighbor is really at the
+  // distance reported for it.
+  EuclideanDistance metric;
+  for (size_t i = 0; i < querySet.n_cols; i++)
+  {
+    BOOST_REQUIRE_EQUAL(distancesTree(0, i), 0.0);
+    BOOST_REQUIRE_EQUAL(distancesTree(1, i), 0.0);
+
+    for (size_t j = 0; j < 6; j++)
+    {
+      BOOST_REQUIRE_LT(neighborsTree(j, i), dataset.n_cols);
+      BOOST_REQUIRE_CLOSE(distancesTree(j, i), distancesNaive(j, i), 1e-5);
+      BOOST_REQUIRE_CLOSE(metric.Evaluate(querySet.col(i),
+          dataset.col(neighborsTree(j, i))), distancesTree(j, i), 1e-5);
+    }
+  }
+}
+
+/**
+ * Test the dual-tree nearest-neighbors method with the naive method for a large
+ * value of k, so that the candidate heaps are several levels deep.
+ */
+BOOST_AUTO_TEST_CASE(DualTreeVsNaiveLargeK)
+{
+  arma::mat dataset;
+  if (!data::Load("test_data_3_1000.csv", dataset))
+    BOOST_FAIL("Cannot load test dataset test_data_3_1000.csv!");
+
+  AllkNN allknn(dataset);
+  AllkNN naive(dataset, true);
+
+  arma::Mat<size_t> neighborsTree;
+  arma::mat distancesTree;
+  allknn.Search(250, neighborsTree, distancesTree);
+
+  arma::Mat<size_t> neighborsNaive;
+  arma::mat distancesNaive;
+  naive.Search(250, neighborsNaive, distancesNaive);
+
+  for (size_t i = 0; i < neighborsTree.n_elem; i++)
+  {
+    BOOST_REQUIRE_EQUAL(neighborsTree[i], neighborsNaive[i]);
+    BOOST_REQUIRE_CLOSE(distancesTree[i], distancesNaive[i], 1e-5);
+  }
+}
+
 /**
  * Test the single-tree nearest-neighbors method with the naive method.  This
  * uses only a reference dataset.
@@ -573,6 +712,55 @@ BOOST_AUTO_TEST_CASE(SingleTreeVsNaive)
   }
 }
 
+/**
+ * Test the single-tree nearest-neighbors method with the naive method when the
+ * query points are split between several threads, both with a separate query
+ * set and with the reference set as the query set.
+ */
+BOOST_AUTO_TEST_CASE(ParallelSingleTreeVsNaive)
+{
+  arma::mat dataset;
+  dataset.randu(5, 2000);
+  arma::mat querySet;
+  querySet.randu(5, 700);
+
+#ifdef _OPENMP
+  const int threads = omp_get_max_threads();
+  omp_set_num_threads(std::max(threads, 4));
+#endif
+
+  AllkNN allknn(dataset, false, true);
+  AllkNN naive(dataset, true);
+
+  arma::Mat<size_t> neighborsTree, neighborsNaive;
+  arma::mat distancesTree, distancesNaive;
+
+  allknn.Search(querySet, 10, neighborsTree, distancesTree);
+  naive.Search(querySet, 10, neighborsNaive, distancesNaive);
+
+  arma::Mat<size_t> monoNeighborsTree, monoNeighborsNaive;
+  arma::mat monoDistancesTree, monoDistancesNaive;
+
+  allknn.Search(10, monoNeighborsTree, monoDistancesTree);
+  naive.Search(10, monoNeighborsNaive, monoDistancesNaive);
+
+#ifdef _OPENMP
+  omp_set_num_threads(threads);
+#endif
+
+  for (size_t i = 0; i < neighborsTree.n_elem; i++)
+  {
+    BOOST_REQUIRE_EQUAL(neighborsTree[i], neighborsNaive[i]);
+    BOOST_REQUIRE_CLOSE(distancesTree[i], distancesNaive[i], 1e-5);
+  }
+
+  for (size_t i = 0; i < monoNeighborsTree.n_elem; i++)
+  {
+    BOOST_REQUIRE_EQUAL(monoNeighborsTree[i], monoNeighborsNaive[i]);
+    BOOST_REQUIRE_CLOSE(monoDistancesTree[i], monoDistancesNaive[i], 1e-5);
+  }
+}
+
 /**
  * Test the cover tree single-tree nearest-neighbors method against the naive
  * method.  This uses only a random reference dataset.
@@ -715,6 +903,459 @@ BOOST_AUTO_TEST_CASE(DualBallTreeTest)
   }
 }
 
+/**
+ * Test the parallel dual-tree traverser against the naive method, with an
+ * explicitly specified task depth so that the query tree is split into tasks
+ * even if only one thread is available.
+ */
+BOOST_AUTO_TEST_CASE(ParallelDualTreeTraverserVsNaive)
+{
+  arma::mat dataset;
+  if (!data::Load("test_data_3_1000.csv", dataset))
+    BOOST_FAIL("Cannot load test dataset test_data_3_1000.csv!");
+
+  typedef BinarySpaceTree<HRectBound<2>,
+      NeighborSearchStat<NearestNeighborSort> > TreeType;
+  typedef NeighborSearchRules<NearestNeighborSort, EuclideanDistance, TreeType>
+      RuleType;
+
+  // The tree rearranges the dataset, so we run the naive search on the
+  // rearranged dataset too.
+  TreeType tree(dataset);
+
+  arma::Mat<size_t> neighborsTree(15, dataset.n_cols);
+  neighborsTree.fill(size_t() - 1);
+  arma::mat distancesTree(15, dataset.n_cols);
+  distancesTree.fill(NearestNeighborSort::WorstDistance());
+
+  EuclideanDistance metric;
+  RuleType rules(dataset, dataset, neighborsTree, distancesTree, metric, true);
+  TreeType::ParallelDualTreeTraverser<RuleType> traverser(rules, 4);
+  traverser.Traverse(tree, tree);
+  rules.SortResults();
+
+  BOOST_REQUIRE_GT(rules.BaseCases(), 0);
+  BOOST_REQUIRE_GT(rules.Scores(), 0);
+
+  AllkNN naive(dataset, true);
+
+  arma::Mat<size_t> neighborsNaive;
+  arma::mat distancesNaive;
+  naive.Search(15, neighborsNaive, distancesNaive);
+
+  for (size_t i = 0; i < neighborsTree.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighborsTree[i], neighborsNaive[i]);
+    BOOST_REQUIRE_CLOSE(distancesTree[i], distancesNaive[i], 1e-5);
+  }
+}
+
+/**
+ * Make sure that the parallel dual-tree traverser counts its visits at the
+ * same depths as the serial traverser.  The reference set fits in one leaf, so
+ * nothing can be pruned and both traversals visit every query node once, at
+ * its depth in the query tree.
+ */
+BOOST_AUTO_TEST_CASE(ParallelDualTreeTraverserStatisticsTest)
+{
+  if (!TraversalStatistics::Enabled)
+    return;
+
+  arma::mat serialQuerySet;
+  serialQuerySet.randu(3, 1000);
+  arma::mat parallelQuerySet(serialQuerySet);
+  arma::mat referenceSet;
+  referenceSet.randu(3, 10);
+
+  typedef BinarySpaceTree<HRectBound<2>,
+      NeighborSearchStat<NearestNeighborSort> > TreeType;
+  typedef NeighborSearchRules<NearestNeighborSort, EuclideanDistance, TreeType>
+      RuleType;
+
+  // Each tree rearranges its own copy of the query set.
+  TreeType serialQueryTree(serialQuerySet);
+  TreeType parallelQueryTree(parallelQuerySet);
+  TreeType referenceTree(referenceSet);
+  BOOST_REQUIRE(referenceTree.IsLeaf());
+
+  EuclideanDistance metric;
+  arma::Mat<size_t> serialNeighbors(3, serialQuerySet.n_cols);
+  serialNeighbors.fill(size_t() - 1);
+  arma::mat serialDistances(3, serialQuerySet.n_cols);
+  serialDistances.fill(NearestNeighborSort::WorstDistance());
+  RuleType serialRules(referenceSet, serialQuerySet, serialNeighbors,
+      serialDistances, metric);
+  TreeType::DualTreeTraverser<RuleType> serial(serialRules);
+  serial.Traverse(serialQueryTree, referenceTree);
+
+  arma::Mat<size_t> parallelNeighbors(3, parallelQuerySet.n_cols);
+  parallelNeighbors.fill(size_t() - 1);
+  arma::mat parallelDistances(3, parallelQuerySet.n_cols);
+  parallelDistances.fill(NearestNeighborSort::WorstDistance());
+  RuleType parallelRules(referenceSet, parallelQuerySet, parallelNeighbors,
+      parallelDistances, metric);
+  TreeType::ParallelDualTreeTraverser<RuleType> parallel(parallelRules, 3);
+  parallel.Traverse(parallelQueryTree, referenceTree);
+
+  const TraversalStatistics& serialStats = serial.Statistics();
+  const TraversalStatistics& parallelStats = parallel.Statistics();
+  BOOST_REQUIRE_EQUAL(serialStats.NumVisited(), serialQueryTree.TreeSize());
+  BOOST_REQUIRE_EQUAL(parallelStats.NumVisited(), serialStats.NumVisited());
+  BOOST_REQUIRE_EQUAL(parallelStats.NumBaseCases(),
+      serialStats.NumBaseCases());
+
+  BOOST_REQUIRE_EQUAL(parallelStats.VisitsPerDepth().size(),
+      serialStats.VisitsPerDepth().size());
+  for (size_t i = 0; i < serialStats.VisitsPerDepth().size(); ++i)
+    BOOST_REQUIRE_EQUAL(parallelStats.VisitsPerDepth()[i],
+        serialStats.VisitsPerDepth()[i]);
+}
+
+/**
+ * Test NeighborSearch with the parallel dual-tree traverser against the naive
+ * method, using both a query and reference dataset.
+ */
+BOOST_AUTO_TEST_CASE(ParallelDualTreeVsNaive)
+{
+  arma::mat dataset;
+  if (!data::Load("test_data_3_1000.csv", dataset))
+    BOOST_FAIL("Cannot load test dataset test_data_3_1000.csv!");
+
+  typedef BinarySpaceTree<HRectBound<2>,
+      NeighborSearchStat<NearestNeighborSort> > TreeType;
+  NeighborSearch<NearestNeighborSort, EuclideanDistance, TreeType,
+      TreeType::ParallelDualTreeTraverser> allknn(dataset);
+
+  AllkNN naive(dataset, true);
+
+  arma::Mat<size_t> neighborsTree;
+  arma::mat distancesTree;
+  allknn.Search(dataset, 15, neighborsTree, distancesTree);
+
+  arma::Mat<size_t> neighborsNaive;
+  arma::mat distancesNaive;
+  naive.Search(dataset, 15, neighborsNaive, distancesNaive);
+
+  for (size_t i = 0; i < neighborsTree.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighborsTree[i], neighborsNaive[i]);
+    BOOST_REQUIRE_CLOSE(distancesTree[i], distancesNaive[i], 1e-5);
+  }
+}
+
+/**
+ * Run the dual-tree search on single-precision data and compare with the naive
+ * search in single precision (which must give identical results) and the naive
+ * search in double precision (which must give nearly identical distances).
+ */
+BOOST_AUTO_TEST_CASE(FloatDualTreeVsNaive)
+{
+  arma::mat dataset;
+  if (!data::Load("test_data_3_1000.csv", dataset))
+    BOOST_FAIL("Cannot load test dataset test_data_3_1000.csv!");
+  arma::fmat floatDataset = arma::conv_to<arma::fmat>::from(dataset);
+
+  typedef BinarySpaceTree<HRectBound<2>,
+      NeighborSearchStat<NearestNeighborSort>, arma::fmat> FloatTreeType;
+  typedef NeighborSearch<NearestNeighborSort, EuclideanDistance,
+      FloatTreeType> FloatAllkNN;
+
+  FloatAllkNN allknn(floatDataset);
+  FloatAllkNN naive(floatDataset, true);
+  arma::mat roundedDataset = arma::conv_to<arma::mat>::from(floatDataset);
+  AllkNN doubleNaive(roundedDataset, true);
+
+  arma::Mat<size_t> neighborsTree, neighborsNaive, neighborsDouble;
+  arma::fmat distancesTree, distancesNaive;
+  arma::mat distancesDouble;
+  allknn.Search(10, neighborsTree, distancesTree);
+  naive.Search(10, neighborsNaive, distancesNaive);
+  doubleNaive.Search(10, neighborsDouble, distancesDouble);
+
+  for (size_t i = 0; i < neighborsTree.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighborsTree[i], neighborsNaive[i]);
+    BOOST_REQUIRE_CLOSE(distancesTree[i], distancesNaive[i], 1e-5);
+    BOOST_REQUIRE_CLOSE((double) distancesTree[i], distancesDouble[i], 1e-3);
+  }
+}
+
+/**
+ * Make sure that dual-tree and single-tree search with flat kd-trees (in both
+ * layouts) gives the same results as the naive method.
+ */
+template<typename LayoutType>
+void FlatTreeVsNaive()
+{
+  arma::mat dataset;
+  dataset.randu(5, 2000);
+  arma::mat queries;
+  queries.randu(5, 500);
+
+  typedef FlatBinarySpaceTree<NeighborSearchStat<NearestNeighborSort>,
+      arma::mat, LayoutType> TreeType;
+  typedef NeighborSearch<NearestNeighborSort, EuclideanDistance, TreeType>
+      FlatAllkNN;
+
+  FlatAllkNN dualTree(dataset);
+  FlatAllkNN singleTree(dataset, false, true);
+  AllkNN naive(dataset, true);
+
+  arma::Mat<size_t> neighborsDual, neighborsSingle, neighborsNaive;
+  arma::mat distancesDual, distancesSingle, distancesNaive;
+  dualTree.Search(queries, 7, neighborsDual, distancesDual);
+  singleTree.Search(queries, 7, neighborsSingle, distancesSingle);
+  naive.Search(queries, 7, neighborsNaive, distancesNaive);
+
+  for (size_t i = 0; i < neighborsNaive.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighborsDual[i], neighborsNaive[i]);
+    BOOST_REQUIRE_CLOSE(distancesDual[i], distancesNaive[i], 1e-5);
+    BOOST_REQUIRE_EQUAL(neighborsSingle[i], neighborsNaive[i]);
+    BOOST_REQUIRE_CLOSE(distancesSingle[i], distancesNaive[i], 1e-5);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(BreadthFirstFlatTreeVsNaive)
+{
+  FlatTreeVsNaive<BreadthFirstLayout>();
+}
+
+BOOST_AUTO_TEST_CASE(VanEmdeBoasFlatTreeVsNaive)
+{
+  FlatTreeVsNaive<VanEmdeBoasLayout>();
+}
+
+/**
+ * Check the traversal statistics of dual-tree and single-tree search with a
+ * kd-tree: every counter must be nonzero, the visits at each depth must add up
+ * to the total, and the statistics must add up over searches.
+ */
+BOOST_AUTO_TEST_CASE(KDTreeTraversalStatisticsTest)
+{
+  arma::mat dataset;
+  dataset.randu(3, 2000);
+
+  AllkNN dualTree(dataset);
+  AllkNN singleTree(dataset, false, true);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  dualTree.Search(3, neighbors, distances);
+  singleTree.Search(3, neighbors, distances);
+
+  // If the counters are compiled out, they must all stay zero.
+  if (!TraversalStatistics::Enabled)
+  {
+    BOOST_REQUIRE_EQUAL(dualTree.Statistics().NumVisited(), 0);
+    BOOST_REQUIRE_EQUAL(singleTree.Statistics().NumBaseCases(), 0);
+    return;
+  }
+
+  const TraversalStatistics& dual = dualTree.Statistics();
+  const TraversalStatistics& single = singleTree.Statistics();
+  for (size_t i = 0; i < 2; ++i)
+  {
+    const TraversalStatistics& stats = (i == 0) ? dual : single;
+
+    BOOST_REQUIRE_GT(stats.NumVisited(), 0);
+    BOOST_REQUIRE_GT(stats.NumScores(), 0);
+    BOOST_REQUIRE_GT(stats.NumPrunes(), 0);
+    BOOST_REQUIRE_GT(stats.NumBaseCases(), 0);
+    BOOST_REQUIRE_LE(stats.NumRescorePrunes(), stats.NumRescores());
+
+    size_t visits = 0;
+    for (size_t j = 0; j < stats.VisitsPerDepth().size(); ++j)
+      visits += stats.VisitsPerDepth()[j];
+    BOOST_REQUIRE_EQUAL(visits, stats.NumVisited());
+  }
+
+  // Only the base cases of dual-tree search score single query points.
+  BOOST_REQUIRE_GT(dual.NumPointScores(), 0);
+  BOOST_REQUIRE_LE(dual.NumPointPrunes(), dual.NumPointScores());
+  BOOST_REQUIRE_EQUAL(single.NumPointScores(), 0);
+
+  // The roots are visited once in dual-tree search, and once for each query
+  // point in single-tree search (whatever the number of threads).
+  BOOST_REQUIRE_EQUAL(dual.VisitsPerDepth()[0], 1);
+  BOOST_REQUIRE_EQUAL(single.VisitsPerDepth()[0], dataset.n_cols);
+
+  // Dual-tree search is deterministic, so a second search does the same work.
+  const size_t visited = dual.NumVisited();
+  const size_t baseCases = dual.NumBaseCases();
+  dualTree.Search(3, neighbors, distances);
+  BOOST_REQUIRE_EQUAL(dual.NumVisited(), 2 * visited);
+  BOOST_REQUIRE_EQUAL(dual.NumBaseCases(), 2 * baseCases);
+
+  dualTree.Statistics().Reset();
+  BOOST_REQUIRE_EQUAL(dual.NumVisited(), 0);
+  BOOST_REQUIRE_EQUAL(dual.VisitsPerDepth().size(), 0);
+}
+
+/**
+ * Check that the cover tree traversers count their work too.
+ */
+BOOST_AUTO_TEST_CASE(CoverTreeTraversalStatisticsTest)
+{
+  if (!TraversalStatistics::Enabled)
+    return;
+
+  arma::mat dataset;
+  dataset.randu(3, 1000);
+
+  typedef CoverTree<EuclideanDistance, FirstPointIsRoot,
+      NeighborSearchStat<NearestNeighborSort> > TreeType;
+  TreeType tree(dataset);
+
+  NeighborSearch<NearestNeighborSort, EuclideanDistance, TreeType>
+      dualTree(&tree);
+  NeighborSearch<NearestNeighborSort, EuclideanDistance, TreeType>
+      singleTree(&tree, true);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  dualTree.Search(3, neighbors, distances);
+  singleTree.Search(3, neighbors, distances);
+
+  for (size_t i = 0; i < 2; ++i)
+  {
+    const TraversalStatistics& stats = (i == 0) ? dualTree.Statistics() :
+        singleTree.Statistics();
+
+    BOOST_REQUIRE_GT(stats.NumVisited(), 0);
+    BOOST_REQUIRE_GT(stats.NumScores(), 0);
+    BOOST_REQUIRE_GT(stats.NumPrunes(), 0);
+    BOOST_REQUIRE_GT(stats.NumBaseCases(), 0);
+
+    size_t visits = 0;
+    for (size_t j = 0; j < stats.VisitsPerDepth().size(); ++j)
+      visits += stats.VisitsPerDepth()[j];
+    BOOST_REQUIRE_EQUAL(visits, stats.NumVisited());
+  }
+}
+
+/**
+ * Save a kd-tree to an index file, load it back, and make sure the loaded tree
+ * has the same structure and gives the same results as the original tree.
+ */
+BOOST_AUTO_TEST_CASE(SaveLoadIndexTest)
+{
+  arma::mat dataset;
+  dataset.randu(5, 1000);
+
+  typedef BinarySpaceTree<HRectBound<2>,
+      NeighborSearchStat<NearestNeighborSort> > TreeType;
+
+  std::vector<size_t> oldFromNew;
+  TreeType tree(dataset, oldFromNew, 15);
+  BOOST_REQUIRE(SaveIndex("allknn_index_test.bin", tree, oldFromNew));
+
+  arma::mat loadedDataset;
+  std::vector<size_t> loadedOldFromNew;
+  TreeType* loadedTree = LoadIndex<TreeType>("allknn_index_test.bin",
+      loadedDataset, loadedOldFromNew);
+  BOOST_REQUIRE(loadedTree != NULL);
+
+  BOOST_REQUIRE_EQUAL(loadedDataset.n_rows, dataset.n_rows);
+  BOOST_REQUIRE_EQUAL(loadedDataset.n_cols, dataset.n_cols);
+  for (size_t i = 0; i < dataset.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(loadedDataset[i], dataset[i]);
+  for (size_t i = 0; i < oldFromNew.size(); ++i)
+    BOOST_REQUIRE_EQUAL(loadedOldFromNew[i], oldFromNew[i]);
+
+  // Walk both trees and compare every node.
+  std::vector<TreeType*> nodes, loadedNodes;
+  nodes.push_back(&tree);
+  loadedNodes.push_back(loadedTree);
+  while (!nodes.empty())
+  {
+    TreeType* node = nodes.back();
+    TreeType* loadedNode = loadedNodes.back();
+    nodes.pop_back();
+    loadedNodes.pop_back();
+
+    BOOST_REQUIRE_EQUAL(node->Begin(), loadedNode->Begin());
+    BOOST_REQUIRE_EQUAL(node->Count(), loadedNode->Count());
+    BOOST_REQUIRE_EQUAL(node->NumChildren(), loadedNode->NumChildren());
+    for (size_t d = 0; d < dataset.n_rows; ++d)
+    {
+      BOOST_REQUIRE_EQUAL(node->Bound()[d].Lo(), loadedNode->Bound()[d].Lo());
+      BOOST_REQUIRE_EQUAL(node->Bound()[d].Hi(), loadedNode->Bound()[d].Hi());
+    }
+
+    for (size_t c = 0; c < node->NumChildren(); ++c)
+    {
+      nodes.push_back(&node->Child(c));
+      loadedNodes.push_back(&loadedNode->Child(c));
+    }
+  }
+
+  // Now make sure the search results are the same.
+  NeighborSearch<NearestNeighborSort, EuclideanDistance, TreeType>
+      allknn(&tree), loadedAllknn(loadedTree);
+
+  arma::Mat<size_t> neighbors, loadedNeighbors;
+  arma::mat distances, loadedDistances;
+  allknn.Search(5, neighbors, distances);
+  loadedAllknn.Search(5, loadedNeighbors, loadedDistances);
+
+  for (size_t i = 0; i < neighbors.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors[i], loadedNeighbors[i]);
+    BOOST_REQUIRE_CLOSE(distances[i], loadedDistances[i], 1e-5);
+  }
+
+  delete loadedTree;
+  remove("allknn_index_test.bin");
+
+  // A file which is not an index should be rejected.
+  data::Save("allknn_index_test.csv", dataset);
+  BOOST_REQUIRE(LoadIndex<TreeType>("allknn_index_test.csv", loadedDataset,
+      loadedOldFromNew) == NULL);
+  remove("allknn_index_test.csv");
+}
+
+/**
+ * Index files whose sizes are corrupt should be rejected without allocating
+ * anything huge.
+ */
+BOOST_AUTO_TEST_CASE(CorruptIndexTest)
+{
+  arma::mat dataset;
+  dataset.randu(3, 100);
+
+  typedef BinarySpaceTree<HRectBound<2>,
+      NeighborSearchStat<NearestNeighborSort> > TreeType;
+
+  std::vector<size_t> oldFromNew;
+  TreeType tree(dataset, oldFromNew, 10);
+
+  // The header is the magic number (8 bytes) and the element size, rows and
+  // columns (8 bytes each).  The dimensionality of the root's bound comes after
+  // the dataset, the mapping, and the first 33 bytes of the root node.
+  const size_t rowsOffset = 16;
+  const size_t boundOffset = 32 + 8 * dataset.n_elem + 8 * dataset.n_cols + 33;
+  const size_t offsets[] = { rowsOffset, boundOffset };
+  for (size_t i = 0; i < 2; ++i)
+  {
+    BOOST_REQUIRE(SaveIndex("allknn_corrupt_test.bin", tree, oldFromNew));
+
+    std::fstream f("allknn_corrupt_test.bin",
+        std::ios::in | std::ios::out | std::ios::binary);
+    const uint64_t huge = uint64_t(1) << 60;
+    f.seekp(offsets[i]);
+    f.write((const char*) &huge, sizeof(uint64_t));
+    f.close();
+
+    arma::mat loadedDataset;
+    std::vector<size_t> loadedOldFromNew;
+    BOOST_REQUIRE(LoadIndex<TreeType>("allknn_corrupt_test.bin",
+        loadedDataset, loadedOldFromNew) == NULL);
+  }
+
+  remove("allknn_corrupt_test.bin");
+}
+
 // Make sure sparse nearest neighbors works with kd trees.
 BOOST_AUTO_TEST_CASE(SparseAllkNNKDTreeTest)
 {
@@ -298,4 +298,61 @@ BOOST_AUTO_TEST_CASE(CFBatchPredictTest)
   }
 }
 
+/**
+ * Make sure that GetRecommendations() gives the un-rated items with the highest
+ * predicted ratings, best first.
+ */
+BOOST_AUTO_TEST_CASE(CFGetRecommendationsPredictTest)
+{
+  arma::mat dataset;
+  data::Load("GroupLens100k.csv", dataset);
+
+  CF<> c(dataset);
+
+  const size_t numUsers = 5;
+  const size_t numRecs = 10;
+  const size_t numItems = c.CleanedData().n_rows;
+  arma::Col<size_t> users(numUsers);
+  for (size_t i = 0; i < numUsers; ++i)
+    users(i) = 100 * i;
+
+  arma::Mat<size_t> recommendations;
+  c.GetRecommendations(numRecs, recommendations, users);
+
+  BOOST_REQUIRE_EQUAL(recommendations.n_rows, numRecs);
+  BOOST_REQUIRE_EQUAL(recommendations.n_cols, numUsers);
+
+  // Predict the rating of every item for each of the users.
+  arma::Mat<size_t> combinations(2, numUsers * numItems);
+  for (size_t i = 0; i < numUsers; ++i)
+  {
+    for (size_t j = 0; j < numItems; ++j)
+    {
+      combinations(0, i * numItems + j) = users(i);
+      combinations(1, i * numItems + j) = j;
+    }
+  }
+
+  arma::vec predictions;
+  c.Predict(combinations, predictions);
+
+  for (size_t i = 0; i < numUsers; ++i)
+  {
+    // Find the best predicted ratings of the items the user hasn't rated.
+    std::vector<double> unrated;
+    for (size_t j = 0; j < numItems; ++j)
+      if (c.CleanedData()(j, users(i)) == 0.0)
+        unrated.push_back(predictions[i * numItems + j]);
+    std::sort(unrated.begin(), unrated.end(), std::greater<double>());
+
+    for (size_t j = 0; j < numRecs; ++j)
+    {
+      const size_t item = recommendations(j, i);
+      BOOST_REQUIRE_LT(item, numItems);
+      BOOST_REQUIRE_EQUAL((double) c.CleanedData()(item, users(i)), 0.0);
+      BOOST_REQUIRE_CLOSE(predictions[i * numItems + item], unrated[j], 1e-5);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
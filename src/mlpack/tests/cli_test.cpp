@@ -7,8 +7,10 @@
 
 #include <iostream>
 #include <sstream>
+#include <thread>
 #ifndef _WIN32
   #include <sys/time.h>
+  #include <unistd.h> // For usleep().
 #endif
 
 // For Sleep().
@@ -269,4 +271,71 @@ BOOST_AUTO_TEST_CASE(MultiRunTimerTest)
   BOOST_REQUIRE_GE(Timer::Get("test_timer").tv_usec, 40000);
 }
 
+/**
+ * Timers started while another timer is running should be recorded under the
+ * path of the running timer, and the number of runs should be counted.
+ */
+BOOST_AUTO_TEST_CASE(NestedTimerTest)
+{
+  Timer::EnablePercentiles();
+
+  Timer::Start("nested_outer");
+  for (size_t i = 0; i < 10; ++i)
+  {
+    Timer::Start("nested_inner");
+    Timer::Stop("nested_inner");
+  }
+  Timer::Stop("nested_outer");
+
+  // Stopping a timer that isn't running does nothing.
+  Timer::Stop("nested_inner");
+
+  const TimerStatistics outer = Timer::GetStatistics("nested_outer");
+  const TimerStatistics inner = Timer::GetStatistics("nested_inner");
+  const TimerStatistics path = Timer::GetStatistics(
+      "nested_outer/nested_inner");
+
+  BOOST_REQUIRE_EQUAL(outer.count, 1);
+  BOOST_REQUIRE_EQUAL(inner.count, 10);
+  BOOST_REQUIRE_EQUAL(path.count, 10);
+  BOOST_REQUIRE_EQUAL(Timer::GetStatistics("nested_inner/nested_outer").count,
+      0);
+
+  // The inner timer can't take longer than the outer timer.
+  BOOST_REQUIRE_LE(inner.total, outer.total);
+  BOOST_REQUIRE_LE(inner.min, inner.p50);
+  BOOST_REQUIRE_LE(inner.p50, inner.p99);
+  BOOST_REQUIRE_LE(inner.p99, inner.max);
+
+  // The JSON output holds the full path.
+  std::ostringstream json;
+  CLI::GetSingleton().timer.PrintJSON(json);
+  BOOST_REQUIRE(json.str().find("nested_outer/nested_inner\": { \"count\": 10")
+      != std::string::npos);
+}
+
+/**
+ * Timers used from several threads at once should add up the runs of every
+ * thread.
+ */
+BOOST_AUTO_TEST_CASE(ThreadedTimerTest)
+{
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 4; ++i)
+  {
+    threads.push_back(std::thread([]()
+    {
+      for (size_t j = 0; j < 25; ++j)
+      {
+        ScopedTimer t("threaded_timer");
+      }
+    }));
+  }
+
+  for (size_t i = 0; i < threads.size(); ++i)
+    threads[i].join();
+
+  BOOST_REQUIRE_EQUAL(Timer::GetStatistics("threaded_timer").count, 100);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -307,6 +307,39 @@ BOOST_AUTO_TEST_CASE(GaussianMultipointMultivariateProbabilityTest)
   BOOST_REQUIRE_CLOSE(phis(5), -14.900192463287908, 1e-5);
 }
 
+/**
+ * Make sure that the batched LogProbability() gives the same results as
+ * LogProbability() on each point when there are several blocks of points, and
+ * that it stays finite far away from the mean, where Probability() underflows.
+ */
+BOOST_AUTO_TEST_CASE(GaussianMultipointLogProbabilityBlockTest)
+{
+  arma::vec mean = "5 6 3 3 2";
+  arma::mat cov("6 1 1 1 2;"
+                "1 7 1 0 0;"
+                "1 1 4 1 1;"
+                "1 0 1 7 0;"
+                "2 0 1 0 6");
+
+  GaussianDistribution g(mean, cov);
+
+  arma::mat points(5, 2500);
+  points.randn();
+  points *= 10.0;
+  points.col(2499).fill(1000.0);
+
+  arma::vec logPhis;
+  g.LogProbability(points, logPhis);
+
+  BOOST_REQUIRE_EQUAL(logPhis.n_elem, 2500);
+  for (size_t i = 0; i < points.n_cols; ++i)
+    BOOST_REQUIRE_CLOSE(logPhis[i], g.LogProbability(points.unsafe_col(i)),
+        1e-5);
+
+  BOOST_REQUIRE_GT(logPhis[2499], -std::numeric_limits<double>::max());
+  BOOST_REQUIRE_EQUAL(g.Probability(points.unsafe_col(2499)), 0.0);
+}
+
 /**
  * Make sure random observations follow the probability distribution correctly.
  */
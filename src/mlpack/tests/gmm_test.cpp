@@ -17,6 +17,10 @@
 #include <boost/test/unit_test.hpp>
 #include "old_boost_test_definitions.hpp"
 
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
 using namespace mlpack;
 using namespace mlpack::gmm;
 
@@ -764,4 +768,144 @@ BOOST_AUTO_TEST_CASE(UseExistingModelTest)
 }
 
 
+/**
+ * Make sure that one iteration of the (parallel, blocked) EMFit gives the same
+ * model as a straightforward serial EM iteration, with and without observation
+ * probabilities.
+ */
+BOOST_AUTO_TEST_CASE(EMFitIterationTest)
+{
+  // Enough points for several blocks, in three Gaussians.
+  const size_t gaussians = 3;
+  arma::mat observations(4, 5500);
+  observations.randn();
+  observations.cols(2000, 3999) += 3.0;
+  observations.cols(4000, 5499) -= 3.0;
+
+  arma::vec probabilities(observations.n_cols);
+  probabilities.randu();
+
+  for (size_t trial = 0; trial < 2; ++trial)
+  {
+    std::vector<distribution::GaussianDistribution> dists;
+    for (size_t i = 0; i < gaussians; ++i)
+    {
+      arma::vec mean(4);
+      mean.fill(3.0 * i - 3.0);
+      arma::mat covariance = arma::eye<arma::mat>(4, 4) * (1.0 + 0.5 * i);
+      dists.push_back(distribution::GaussianDistribution(mean, covariance));
+    }
+    arma::vec weights("0.3 0.3 0.4");
+
+    // The observation weights: all ones for the first overload.
+    const arma::vec pointWeights = (trial == 0) ?
+        arma::vec(arma::ones<arma::vec>(observations.n_cols)) : probabilities;
+
+    // Compute one EM iteration the straightforward way.
+    arma::mat condProb(observations.n_cols, gaussians);
+    for (size_t i = 0; i < gaussians; ++i)
+    {
+      arma::vec phis;
+      dists[i].Probability(observations, phis);
+      condProb.col(i) = weights[i] * phis;
+    }
+    for (size_t j = 0; j < observations.n_cols; ++j)
+      condProb.row(j) /= arma::accu(condProb.row(j));
+
+    std::vector<arma::vec> means(gaussians);
+    std::vector<arma::mat> covariances(gaussians);
+    arma::vec newWeights(gaussians);
+    for (size_t i = 0; i < gaussians; ++i)
+    {
+      const arma::vec w = condProb.col(i) % pointWeights;
+      newWeights[i] = arma::accu(w) / arma::accu(pointWeights);
+      means[i] = observations * w / arma::accu(w);
+
+      const arma::mat diffs = observations - means[i] *
+          arma::ones<arma::rowvec>(observations.n_cols);
+      covariances[i] = (diffs * arma::diagmat(w) * trans(diffs)) /
+          arma::accu(w);
+    }
+
+    EMFit<kmeans::KMeans<>, NoConstraint> em(2 /* one iteration */);
+    if (trial == 0)
+      em.Estimate(observations, dists, weights, true);
+    else
+      em.Estimate(observations, probabilities, dists, weights, true);
+
+    for (size_t i = 0; i < gaussians; ++i)
+    {
+      BOOST_REQUIRE_CLOSE(weights[i], newWeights[i], 1e-8);
+      for (size_t j = 0; j < 4; ++j)
+        BOOST_REQUIRE_CLOSE(dists[i].Mean()[j], means[i][j], 1e-8);
+      for (size_t j = 0; j < 16; ++j)
+      {
+        if (std::abs(covariances[i][j]) < 1e-10)
+          BOOST_REQUIRE_SMALL(dists[i].Covariance()[j], 1e-10);
+        else
+          BOOST_REQUIRE_CLOSE(dists[i].Covariance()[j], covariances[i][j],
+              1e-8);
+      }
+    }
+  }
+}
+
+/**
+ * Make sure that EMFit gives exactly the same model with one thread as with
+ * several threads.
+ */
+BOOST_AUTO_TEST_CASE(EMFitThreadCountTest)
+{
+  // Enough points for several groups of blocks, in three Gaussians.
+  const size_t gaussians = 3;
+  arma::mat observations(4, 70000);
+  observations.randn();
+  observations.cols(20000, 39999) += 3.0;
+  observations.cols(40000, 69999) -= 3.0;
+
+  std::vector<distribution::GaussianDistribution> initialDists;
+  for (size_t i = 0; i < gaussians; ++i)
+  {
+    arma::vec mean(4);
+    mean.fill(3.0 * i - 3.0);
+    arma::mat covariance = arma::eye<arma::mat>(4, 4) * (1.0 + 0.5 * i);
+    initialDists.push_back(distribution::GaussianDistribution(mean,
+        covariance));
+  }
+  const arma::vec initialWeights("0.3 0.3 0.4");
+
+  EMFit<kmeans::KMeans<>, NoConstraint> em(5);
+
+#ifdef _OPENMP
+  const int threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+#endif
+
+  std::vector<distribution::GaussianDistribution> serialDists(initialDists);
+  arma::vec serialWeights(initialWeights);
+  em.Estimate(observations, serialDists, serialWeights, true);
+
+#ifdef _OPENMP
+  omp_set_num_threads(std::max(threads, 4));
+#endif
+
+  std::vector<distribution::GaussianDistribution> dists(initialDists);
+  arma::vec weights(initialWeights);
+  em.Estimate(observations, dists, weights, true);
+
+#ifdef _OPENMP
+  omp_set_num_threads(threads);
+#endif
+
+  for (size_t i = 0; i < gaussians; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(weights[i], serialWeights[i]);
+    for (size_t j = 0; j < 4; ++j)
+      BOOST_REQUIRE_EQUAL(dists[i].Mean()[j], serialDists[i].Mean()[j]);
+    for (size_t j = 0; j < 16; ++j)
+      BOOST_REQUIRE_EQUAL(dists[i].Covariance()[j],
+          serialDists[i].Covariance()[j]);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
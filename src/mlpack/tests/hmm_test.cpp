@@ -5,6 +5,8 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/hmm/hmm.hpp>
+#include <mlpack/methods/hmm/hmm_filter.hpp>
+#include <mlpack/methods/hmm/hmm_fixed_lag_smoother.hpp>
 #include <mlpack/methods/gmm/gmm.hpp>
 
 #include <boost/test/unit_test.hpp>
@@ -209,6 +211,156 @@ BOOST_AUTO_TEST_CASE(SimpleBaumWelchDiscreteHMM)
   BOOST_REQUIRE_CLOSE(hmm.Initial()[0], 1.0, 1e-5);
 }
 
+/**
+ * Baum-Welch on many sequences of different lengths (some of them only one
+ * observation long), which are split between threads, should increase the
+ * log-likelihood of the data and give a valid model.
+ */
+BOOST_AUTO_TEST_CASE(BaumWelchVaryingLengthsTest)
+{
+  HMM<DiscreteDistribution> trueHmm(3, DiscreteDistribution(4));
+  trueHmm.Transition() = arma::mat("0.7 0.2 0.1;"
+                                   "0.2 0.7 0.2;"
+                                   "0.1 0.1 0.7");
+  trueHmm.Emission()[0].Probabilities() = "0.7 0.1 0.1 0.1";
+  trueHmm.Emission()[1].Probabilities() = "0.1 0.7 0.1 0.1";
+  trueHmm.Emission()[2].Probabilities() = "0.1 0.1 0.1 0.7";
+
+  std::vector<arma::mat> observations;
+  for (size_t i = 0; i < 300; i++)
+  {
+    arma::mat observation;
+    arma::Col<size_t> states;
+    const size_t length = (i % 10 == 0) ? 1 : 5 + math::RandInt(100);
+    trueHmm.Generate(length, observation, states, math::RandInt(3));
+    observations.push_back(observation);
+  }
+
+  HMM<DiscreteDistribution> hmm(3, DiscreteDistribution(4));
+  hmm.Transition() = arma::mat("0.5 0.3 0.2;"
+                               "0.3 0.4 0.3;"
+                               "0.2 0.3 0.5");
+  hmm.Emission()[0].Probabilities() = "0.4 0.2 0.2 0.2";
+  hmm.Emission()[1].Probabilities() = "0.2 0.4 0.2 0.2";
+  hmm.Emission()[2].Probabilities() = "0.2 0.2 0.2 0.4";
+
+  double oldLoglik = 0.0;
+  for (size_t i = 0; i < observations.size(); i++)
+    oldLoglik += hmm.LogLikelihood(observations[i]);
+
+  hmm.Train(observations);
+
+  double loglik = 0.0;
+  for (size_t i = 0; i < observations.size(); i++)
+    loglik += hmm.LogLikelihood(observations[i]);
+
+  BOOST_REQUIRE_GT(loglik, oldLoglik);
+  for (size_t j = 0; j < 3; j++)
+  {
+    BOOST_REQUIRE_CLOSE(arma::accu(hmm.Transition().col(j)), 1.0, 1e-5);
+    BOOST_REQUIRE_CLOSE(arma::accu(hmm.Emission()[j].Probabilities()), 1.0,
+        1e-5);
+  }
+}
+
+/**
+ * Make sure that one iteration of the (parallel) Baum-Welch algorithm on
+ * sequences of different lengths gives the same model as a straightforward
+ * serial iteration, with unscaled forward and backward probabilities.
+ */
+BOOST_AUTO_TEST_CASE(BaumWelchIterationTest)
+{
+  const size_t states = 3;
+  const size_t symbols = 4;
+
+  HMM<DiscreteDistribution> trueHmm(states, DiscreteDistribution(symbols));
+  trueHmm.Transition() = arma::mat("0.7 0.2 0.1;"
+                                   "0.2 0.7 0.2;"
+                                   "0.1 0.1 0.7");
+  trueHmm.Emission()[0].Probabilities() = "0.7 0.1 0.1 0.1";
+  trueHmm.Emission()[1].Probabilities() = "0.1 0.7 0.1 0.1";
+  trueHmm.Emission()[2].Probabilities() = "0.1 0.1 0.1 0.7";
+
+  // The sequences are short enough that the unscaled probabilities do not
+  // underflow.
+  std::vector<arma::mat> observations;
+  for (size_t i = 0; i < 50; i++)
+  {
+    arma::mat observation;
+    arma::Col<size_t> stateSeq;
+    const size_t length = (i % 10 == 0) ? 1 : 2 + math::RandInt(30);
+    trueHmm.Generate(length, observation, stateSeq, math::RandInt(3));
+    observations.push_back(observation);
+  }
+
+  // One iteration only: the first change in log-likelihood is always below the
+  // tolerance.
+  HMM<DiscreteDistribution> hmm(states, DiscreteDistribution(symbols),
+      std::numeric_limits<double>::max());
+  hmm.Transition() = arma::mat("0.5 0.3 0.2;"
+                               "0.3 0.4 0.3;"
+                               "0.2 0.3 0.5");
+  hmm.Emission()[0].Probabilities() = "0.4 0.2 0.2 0.2";
+  hmm.Emission()[1].Probabilities() = "0.2 0.4 0.2 0.2";
+  hmm.Emission()[2].Probabilities() = "0.2 0.2 0.2 0.4";
+
+  // Compute the expected transition and emission counts directly.
+  const arma::mat transition = hmm.Transition();
+  arma::mat transitionCounts(states, states);
+  transitionCounts.zeros();
+  arma::mat emissionCounts(states, symbols);
+  emissionCounts.zeros();
+  for (size_t seq = 0; seq < observations.size(); ++seq)
+  {
+    const size_t length = observations[seq].n_cols;
+    arma::mat emissionProb(states, length);
+    for (size_t t = 0; t < length; ++t)
+      for (size_t s = 0; s < states; ++s)
+        emissionProb(s, t) = hmm.Emission()[s].Probability(
+            observations[seq].unsafe_col(t));
+
+    arma::mat forward(states, length);
+    forward.col(0) = hmm.Initial() % emissionProb.col(0);
+    for (size_t t = 1; t < length; ++t)
+      forward.col(t) = (transition * forward.col(t - 1)) % emissionProb.col(t);
+
+    arma::mat backward(states, length);
+    backward.col(length - 1).ones();
+    for (size_t t = length - 1; t > 0; --t)
+      backward.col(t - 1) = trans(transition) *
+          (backward.col(t) % emissionProb.col(t));
+
+    const double probability = arma::accu(forward.col(length - 1));
+
+    // Transitions from state j at time t to state i at time t + 1.
+    for (size_t t = 0; t + 1 < length; ++t)
+      for (size_t i = 0; i < states; ++i)
+        for (size_t j = 0; j < states; ++j)
+          transitionCounts(i, j) += forward(j, t) * transition(i, j) *
+              emissionProb(i, t + 1) * backward(i, t + 1) / probability;
+
+    for (size_t t = 0; t < length; ++t)
+      for (size_t s = 0; s < states; ++s)
+        emissionCounts(s, (size_t) observations[seq](0, t)) +=
+            forward(s, t) * backward(s, t) / probability;
+  }
+
+  hmm.Train(observations);
+
+  for (size_t j = 0; j < states; ++j)
+  {
+    const double transitionSum = arma::accu(transitionCounts.col(j));
+    for (size_t i = 0; i < states; ++i)
+      BOOST_REQUIRE_CLOSE(hmm.Transition()(i, j),
+          transitionCounts(i, j) / transitionSum, 1e-5);
+
+    const double emissionSum = arma::accu(emissionCounts.row(j));
+    for (size_t k = 0; k < symbols; ++k)
+      BOOST_REQUIRE_CLOSE(hmm.Emission()[j].Probabilities()[k],
+          emissionCounts(j, k) / emissionSum, 1e-5);
+  }
+}
+
 /**
  * Increasing complexity, but still simple; 4 emissions, 2 states; the state can
  * be determined directly by the emission.
@@ -580,6 +732,448 @@ BOOST_AUTO_TEST_CASE(GaussianHMMSimpleTest)
   }
 }
 
+/**
+ * Make sure that the forward-backward algorithm and the Viterbi algorithm stay
+ * finite on a long sequence that contains observations which are so unlikely
+ * under every state that their emission probabilities underflow.
+ */
+BOOST_AUTO_TEST_CASE(GaussianHMMUnderflowTest)
+{
+  GaussianDistribution g1("5.0 5.0", "1.0 0.0; 0.0 1.0");
+  GaussianDistribution g2("-5.0 -5.0", "1.0 0.0; 0.0 1.0");
+
+  arma::vec initial("1 0");
+  arma::mat transition("0.75 0.25; 0.25 0.75");
+
+  std::vector<GaussianDistribution> emission;
+  emission.push_back(g1);
+  emission.push_back(g2);
+
+  HMM<GaussianDistribution> hmm(initial, transition, emission);
+
+  arma::mat observations;
+  arma::Col<size_t> classes;
+  hmm.Generate(20000, observations, classes);
+
+  // Every 1000th observation is an outlier which is closer to the first
+  // Gaussian; exp() of its log-probability is 0 for both states.
+  for (size_t i = 500; i < 20000; i += 1000)
+  {
+    observations.col(i).fill(1000.0);
+    classes[i] = 0;
+  }
+  BOOST_REQUIRE_EQUAL(g1.Probability(observations.unsafe_col(500)), 0.0);
+
+  const double loglik = hmm.LogLikelihood(observations);
+  BOOST_REQUIRE_GT(loglik, -std::numeric_limits<double>::max());
+
+  arma::mat stateProb;
+  BOOST_REQUIRE_CLOSE(hmm.Estimate(observations, stateProb), loglik, 1e-5);
+
+  arma::Col<size_t> predictedClasses;
+  hmm.Predict(observations, predictedClasses);
+
+  for (size_t i = 0; i < 20000; i++)
+  {
+    BOOST_REQUIRE_CLOSE(arma::accu(stateProb.col(i)), 1.0, 1e-5);
+    BOOST_REQUIRE_SMALL(stateProb((classes[i] + 1) % 2, i), 0.001);
+    BOOST_REQUIRE_EQUAL(predictedClasses[i], classes[i]);
+  }
+}
+
+/**
+ * A benchmark-sized version of GaussianHMMUnderflowTest: 10^6 observations from
+ * a 100-state Gaussian HMM, again with outliers whose probability underflows
+ * for every state.  This takes a while and needs several gigabytes of memory
+ * (each 100 x 10^6 matrix of probabilities takes 800MB), so it only runs when
+ * the MLPACK_LONG_TESTS environment variable is set.  The times taken by the
+ * forward algorithm, the forward-backward algorithm and the Viterbi algorithm
+ * are printed as test messages (use --log_level=message to see them).
+ */
+BOOST_AUTO_TEST_CASE(GaussianHMMLargeUnderflowTest)
+{
+  if (getenv("MLPACK_LONG_TESTS") == NULL)
+    return;
+
+  const size_t states = 100;
+  const size_t steps = 1000000;
+
+  // Well-separated one-dimensional Gaussians, with a sticky transition matrix.
+  std::vector<GaussianDistribution> emission(states);
+  for (size_t i = 0; i < states; ++i)
+  {
+    arma::vec mean(1);
+    mean[0] = 20.0 * i;
+    emission[i] = GaussianDistribution(mean, arma::eye<arma::mat>(1, 1));
+  }
+
+  arma::vec initial(states);
+  initial.fill(1.0 / states);
+  arma::mat transition(states, states);
+  transition.fill(0.1 / (states - 1));
+  transition.diag().fill(0.9);
+
+  HMM<GaussianDistribution> hmm(initial, transition, emission);
+
+  arma::mat observations;
+  arma::Col<size_t> classes;
+  hmm.Generate(steps, observations, classes);
+
+  // Every 1000th observation is an outlier, far beyond the last Gaussian.
+  for (size_t i = 500; i < steps; i += 1000)
+  {
+    observations(0, i) = 1e5;
+    classes[i] = states - 1;
+  }
+  BOOST_REQUIRE_EQUAL(emission[states - 1].Probability(
+      observations.unsafe_col(500)), 0.0);
+
+  Timer::Start("hmm_large_loglik");
+  const double loglik = hmm.LogLikelihood(observations);
+  Timer::Stop("hmm_large_loglik");
+  BOOST_REQUIRE_GT(loglik, -std::numeric_limits<double>::max());
+
+  arma::Col<size_t> predictedClasses;
+  Timer::Start("hmm_large_predict");
+  hmm.Predict(observations, predictedClasses);
+  Timer::Stop("hmm_large_predict");
+
+  for (size_t i = 0; i < steps; ++i)
+    BOOST_REQUIRE_EQUAL(predictedClasses[i], classes[i]);
+
+  arma::mat stateProb;
+  Timer::Start("hmm_large_estimate");
+  BOOST_REQUIRE_CLOSE(hmm.Estimate(observations, stateProb), loglik, 1e-5);
+  Timer::Stop("hmm_large_estimate");
+
+  for (size_t i = 0; i < steps; ++i)
+    BOOST_REQUIRE_CLOSE(arma::accu(stateProb.col(i)), 1.0, 1e-5);
+
+  const char* timers[] = { "hmm_large_loglik", "hmm_large_estimate",
+                           "hmm_large_predict" };
+  for (size_t i = 0; i < 3; ++i)
+  {
+    const timeval time = Timer::Get(timers[i]);
+    BOOST_TEST_MESSAGE(timers[i] << ": "
+        << (time.tv_sec + time.tv_usec / 1e6) << "s");
+  }
+}
+
+/**
+ * Build a three-state discrete HMM and a sequence generated from it, for the
+ * online filtering tests.
+ */
+HMM<DiscreteDistribution> CreateOnlineTestHMM(arma::mat& observations)
+{
+  arma::vec initial("0.5 0.3 0.2");
+  arma::mat transition("0.7 0.2 0.1;"
+                       "0.2 0.7 0.2;"
+                       "0.1 0.1 0.7");
+  std::vector<DiscreteDistribution> emission(3);
+  emission[0] = DiscreteDistribution("0.6 0.2 0.1 0.1");
+  emission[1] = DiscreteDistribution("0.1 0.6 0.2 0.1");
+  emission[2] = DiscreteDistribution("0.1 0.1 0.2 0.6");
+
+  HMM<DiscreteDistribution> hmm(initial, transition, emission);
+
+  arma::Col<size_t> states;
+  hmm.Generate(40, observations, states);
+
+  return hmm;
+}
+
+/**
+ * The online filter should give the same forward probabilities and
+ * log-likelihood as the forward algorithm on the whole sequence, also after it
+ * is reset.
+ */
+BOOST_AUTO_TEST_CASE(HMMFilterTest)
+{
+  arma::mat observations;
+  HMM<DiscreteDistribution> hmm = CreateOnlineTestHMM(observations);
+
+  arma::mat stateProb, forwardProb, backwardProb;
+  arma::vec scales;
+  const double loglik = hmm.Estimate(observations, stateProb, forwardProb,
+      backwardProb, scales);
+
+  HMMFilter<DiscreteDistribution> filter(hmm);
+  for (size_t trial = 0; trial < 2; trial++)
+  {
+    for (size_t t = 0; t < observations.n_cols; t++)
+    {
+      const arma::vec& posterior = filter.Update(observations.col(t));
+      for (size_t j = 0; j < 3; j++)
+        BOOST_REQUIRE_CLOSE(posterior[j], forwardProb(j, t), 1e-5);
+    }
+
+    BOOST_REQUIRE_EQUAL(filter.Steps(), observations.n_cols);
+    BOOST_REQUIRE_CLOSE(filter.LogLikelihood(), loglik, 1e-5);
+
+    filter.Reset();
+  }
+}
+
+/**
+ * Each estimate of the fixed-lag smoother should be the state probability of
+ * forward-backward on the sequence up to lag steps later, and the flushed
+ * estimates should be the state probabilities on the whole sequence.
+ */
+BOOST_AUTO_TEST_CASE(HMMFixedLagSmootherTest)
+{
+  arma::mat observations;
+  HMM<DiscreteDistribution> hmm = CreateOnlineTestHMM(observations);
+
+  const size_t lag = 4;
+  HMMFixedLagSmoother<DiscreteDistribution> smoother(hmm, lag);
+
+  arma::mat stateProb;
+  for (size_t t = 0; t < observations.n_cols; t++)
+  {
+    const bool available = smoother.Update(observations.col(t));
+    BOOST_REQUIRE_EQUAL(available, t >= lag);
+    if (!available)
+      continue;
+
+    hmm.Estimate(observations.cols(0, t), stateProb);
+    for (size_t j = 0; j < 3; j++)
+      BOOST_REQUIRE_CLOSE(smoother.Smoothed()[j], stateProb(j, t - lag), 1e-5);
+  }
+
+  arma::mat flushed;
+  smoother.Flush(flushed);
+  hmm.Estimate(observations, stateProb);
+
+  BOOST_REQUIRE_EQUAL(flushed.n_cols, lag);
+  for (size_t i = 0; i < lag; i++)
+    for (size_t j = 0; j < 3; j++)
+      BOOST_REQUIRE_CLOSE(flushed(j, i),
+          stateProb(j, observations.n_cols - lag + i), 1e-5);
+}
+
+/**
+ * Make sure that an HMM with a sparse transition matrix gives the same results
+ * as the same HMM with a dense transition matrix.  The HMM is left-to-right:
+ * each state can only stay, or move ahead by one or two states.
+ */
+BOOST_AUTO_TEST_CASE(SparseTransitionHMMTest)
+{
+  const size_t states = 20;
+  arma::mat transition(states, states);
+  transition.zeros();
+  for (size_t i = 0; i < states; i++)
+  {
+    transition(i, i) = 0.6;
+    if (i + 2 < states)
+    {
+      transition(i + 1, i) = 0.3;
+      transition(i + 2, i) = 0.1;
+    }
+    else if (i + 1 < states)
+    {
+      transition(i + 1, i) = 0.4;
+    }
+    else
+    {
+      transition(i, i) = 1.0;
+    }
+  }
+
+  arma::vec initial(states);
+  initial.zeros();
+  initial[0] = 1.0;
+
+  std::vector<DiscreteDistribution> emission(states, DiscreteDistribution(5));
+  for (size_t i = 0; i < states; i++)
+  {
+    emission[i].Probabilities().fill(0.1);
+    emission[i].Probabilities()[i % 5] = 0.6;
+  }
+
+  HMM<DiscreteDistribution> denseHmm(initial, transition, emission);
+  HMM<DiscreteDistribution, arma::sp_mat> sparseHmm(initial,
+      arma::sp_mat(transition), emission);
+
+  std::vector<arma::mat> observations(10);
+  std::vector<arma::Col<size_t> > stateSeqs(10);
+  for (size_t i = 0; i < 10; i++)
+    denseHmm.Generate(60, observations[i], stateSeqs[i]);
+
+  // The forward-backward algorithm and the Viterbi algorithm.
+  for (size_t i = 0; i < 10; i++)
+  {
+    arma::mat denseStateProb, sparseStateProb;
+    const double denseLoglik = denseHmm.Estimate(observations[i],
+        denseStateProb);
+    const double sparseLoglik = sparseHmm.Estimate(observations[i],
+        sparseStateProb);
+
+    BOOST_REQUIRE_CLOSE(sparseLoglik, denseLoglik, 1e-5);
+    BOOST_REQUIRE_CLOSE(sparseHmm.LogLikelihood(observations[i]),
+        denseLoglik, 1e-5);
+    for (size_t j = 0; j < denseStateProb.n_elem; j++)
+    {
+      if (std::abs(denseStateProb[j]) < 1e-10)
+        BOOST_REQUIRE_SMALL(sparseStateProb[j], 1e-10);
+      else
+        BOOST_REQUIRE_CLOSE(sparseStateProb[j], denseStateProb[j], 1e-5);
+    }
+
+    arma::Col<size_t> densePath, sparsePath;
+    const double denseViterbi = denseHmm.Predict(observations[i], densePath);
+    const double sparseViterbi = sparseHmm.Predict(observations[i],
+        sparsePath);
+
+    BOOST_REQUIRE_CLOSE(sparseViterbi, denseViterbi, 1e-5);
+    for (size_t t = 0; t < densePath.n_elem; t++)
+      BOOST_REQUIRE_EQUAL(sparsePath[t], densePath[t]);
+  }
+
+  // Baum-Welch training keeps the sparsity pattern, so it should give the same
+  // model in both cases.
+  HMM<DiscreteDistribution> denseTrained(denseHmm);
+  HMM<DiscreteDistribution, arma::sp_mat> sparseTrained(sparseHmm);
+  denseTrained.Train(observations);
+  sparseTrained.Train(observations);
+
+  BOOST_REQUIRE_LE(sparseTrained.Transition().n_nonzero,
+      sparseHmm.Transition().n_nonzero);
+  arma::mat sparseTransition(sparseTrained.Transition());
+  for (size_t j = 0; j < transition.n_elem; j++)
+  {
+    if (std::abs(denseTrained.Transition()[j]) < 1e-10)
+      BOOST_REQUIRE_SMALL(sparseTransition[j], 1e-10);
+    else
+      BOOST_REQUIRE_CLOSE(sparseTransition[j], denseTrained.Transition()[j],
+          1e-3);
+  }
+
+  // Labeled training only gives nonzero probability to the transitions which
+  // are seen.
+  denseTrained.Train(observations, stateSeqs);
+  sparseTrained.Train(observations, stateSeqs);
+
+  sparseTransition = arma::mat(sparseTrained.Transition());
+  for (size_t j = 0; j < transition.n_elem; j++)
+  {
+    if (transition[j] == 0.0)
+      BOOST_REQUIRE_SMALL(sparseTransition[j], 1e-10);
+    BOOST_REQUIRE_CLOSE(sparseTransition[j] + 1.0,
+        denseTrained.Transition()[j] + 1.0, 1e-5);
+  }
+}
+
+/**
+ * A model saved with a sparse transition matrix should be loadable with a
+ * dense transition matrix, and the other way around, in both file formats.
+ */
+BOOST_AUTO_TEST_CASE(SparseHMMLoadDenseTest)
+{
+  arma::mat transition("0.6 0.0 0.0;"
+                       "0.4 0.7 0.0;"
+                       "0.0 0.3 1.0");
+  arma::vec initial("1.0 0.0 0.0");
+  std::vector<GaussianDistribution> emission(3, GaussianDistribution(2));
+  for (size_t j = 0; j < emission.size(); ++j)
+    emission[j].Mean().fill((double) j);
+
+  HMM<GaussianDistribution, arma::sp_mat> sparseHmm(initial,
+      arma::sp_mat(transition), emission);
+  HMM<GaussianDistribution> denseHmm(initial, transition, emission);
+
+  const char* filenames[] = { "test-sparse-hmm.xml", "test-sparse-hmm.bin" };
+  for (size_t f = 0; f < 2; ++f)
+  {
+    util::SaveRestoreUtility sr;
+    sparseHmm.Save(sr);
+    sr.WriteFile(filenames[f]);
+
+    util::SaveRestoreUtility loader;
+    loader.ReadFile(filenames[f]);
+    HMM<GaussianDistribution> loadedDense(1, GaussianDistribution(2));
+    loadedDense.Load(loader);
+
+    util::SaveRestoreUtility sr2;
+    denseHmm.Save(sr2);
+    sr2.WriteFile(filenames[f]);
+
+    util::SaveRestoreUtility loader2;
+    loader2.ReadFile(filenames[f]);
+    HMM<GaussianDistribution, arma::sp_mat> loadedSparse(1,
+        GaussianDistribution(2));
+    loadedSparse.Load(loader2);
+
+    remove(filenames[f]);
+
+    BOOST_REQUIRE_EQUAL(loadedDense.Emission().size(), 3);
+    BOOST_REQUIRE_EQUAL(loadedSparse.Emission().size(), 3);
+    BOOST_REQUIRE_EQUAL(loadedDense.Transition().n_rows, 3);
+    BOOST_REQUIRE_EQUAL(loadedDense.Transition().n_cols, 3);
+    BOOST_REQUIRE_EQUAL(loadedSparse.Transition().n_rows, 3);
+    BOOST_REQUIRE_EQUAL(loadedSparse.Transition().n_cols, 3);
+    BOOST_REQUIRE_EQUAL(loadedSparse.Transition().n_nonzero, 5);
+
+    const arma::mat sparseTransition(loadedSparse.Transition());
+    for (size_t j = 0; j < transition.n_elem; ++j)
+    {
+      BOOST_REQUIRE_CLOSE(loadedDense.Transition()[j] + 1.0,
+          transition[j] + 1.0, 1e-5);
+      BOOST_REQUIRE_CLOSE(sparseTransition[j] + 1.0, transition[j] + 1.0,
+          1e-5);
+    }
+
+    for (size_t j = 0; j < 3; ++j)
+      BOOST_REQUIRE_CLOSE(loadedDense.Emission()[j].Mean()[0] + 1.0,
+          (double) j + 1.0, 1e-5);
+  }
+}
+
+/**
+ * Filter() with ahead > 0 should propagate the forward probabilities with the
+ * matrix power of the transition matrix, for dense and sparse transition
+ * matrices.
+ */
+BOOST_AUTO_TEST_CASE(HMMFilterAheadTest)
+{
+  arma::mat transition("0.8 0.3 0.0;"
+                       "0.2 0.6 0.5;"
+                       "0.0 0.1 0.5");
+  arma::vec initial("0.5 0.3 0.2");
+  std::vector<GaussianDistribution> emission(3, GaussianDistribution(1));
+  for (size_t j = 0; j < emission.size(); ++j)
+    emission[j].Mean()[0] = 3.0 * j;
+
+  HMM<GaussianDistribution> denseHmm(initial, transition, emission);
+  HMM<GaussianDistribution, arma::sp_mat> sparseHmm(initial,
+      arma::sp_mat(transition), emission);
+
+  arma::mat observations;
+  arma::Col<size_t> states;
+  denseHmm.Generate(30, observations, states);
+
+  const size_t ahead = 2;
+  arma::mat forwardProb;
+  arma::vec scales;
+  denseHmm.Forward(observations, scales, forwardProb);
+  const arma::mat propagated = transition * transition * forwardProb;
+  arma::mat expected(1, observations.n_cols);
+  expected.zeros();
+  for (size_t j = 0; j < emission.size(); ++j)
+    expected += emission[j].Mean() * propagated.row(j);
+
+  arma::mat denseFilter, sparseFilter;
+  denseHmm.Filter(observations, denseFilter, ahead);
+  sparseHmm.Filter(observations, sparseFilter, ahead);
+
+  BOOST_REQUIRE_EQUAL(denseFilter.n_cols, observations.n_cols);
+  BOOST_REQUIRE_EQUAL(sparseFilter.n_cols, observations.n_cols);
+  for (size_t t = 0; t < observations.n_cols; ++t)
+  {
+    BOOST_REQUIRE_CLOSE(denseFilter(0, t) + 1.0, expected(0, t) + 1.0, 1e-5);
+    BOOST_REQUIRE_CLOSE(sparseFilter(0, t) + 1.0, expected(0, t) + 1.0, 1e-5);
+  }
+}
+
 /**
  * Ensure that Gaussian HMMs can be trained properly, for the labeled training
  * case and also for the unlabeled training case.
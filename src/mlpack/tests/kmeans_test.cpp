@@ -7,10 +7,13 @@
 #include <mlpack/methods/kmeans/kmeans.hpp>
 #include <mlpack/methods/kmeans/allow_empty_clusters.hpp>
 #include <mlpack/methods/kmeans/refined_start.hpp>
+#include <mlpack/methods/kmeans/kmeans_plus_plus.hpp>
+#include <mlpack/methods/kmeans/kmeans_parallel.hpp>
 #include <mlpack/methods/kmeans/elkan_kmeans.hpp>
 #include <mlpack/methods/kmeans/hamerly_kmeans.hpp>
 #include <mlpack/methods/kmeans/pelleg_moore_kmeans.hpp>
 #include <mlpack/methods/kmeans/dual_tree_kmeans.hpp>
+#include <mlpack/methods/kmeans/mini_batch_kmeans.hpp>
 
 #include <mlpack/core/tree/cover_tree/cover_tree.hpp>
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
@@ -443,6 +446,93 @@ BOOST_AUTO_TEST_CASE(RefinedStartTest)
   BOOST_REQUIRE_LT(distortion, 14000.0);
 }
 
+/**
+ * Make sure that an initial partition policy puts every Gaussian of a set of 50
+ * far-apart Gaussians in its own cluster, and that k-means started from it
+ * converges to the means of the Gaussians.
+ */
+template<typename InitialPartitionPolicy>
+void SeparatedGaussiansPartitionTest(const InitialPartitionPolicy& policy)
+{
+  const size_t clusters = 50;
+  arma::mat dataset(2, 100 * clusters);
+  dataset.randn();
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    dataset(0, i) += 1000.0 * (i / 100);
+
+  arma::Col<size_t> assignments;
+  policy.Cluster(dataset, clusters, assignments);
+  BOOST_REQUIRE_EQUAL(assignments.n_elem, dataset.n_cols);
+
+  std::vector<bool> used(clusters, false);
+  for (size_t g = 0; g < clusters; ++g)
+  {
+    const size_t label = assignments[100 * g];
+    BOOST_REQUIRE_LT(label, clusters);
+    BOOST_REQUIRE(!used[label]);
+    used[label] = true;
+
+    for (size_t i = 100 * g; i < 100 * (g + 1); ++i)
+      BOOST_REQUIRE_EQUAL(assignments[i], label);
+  }
+
+  KMeans<EuclideanDistance, InitialPartitionPolicy> kmeans(1000,
+      EuclideanDistance(), policy);
+  arma::mat centroids;
+  kmeans.Cluster(dataset, clusters, assignments, centroids);
+
+  for (size_t g = 0; g < clusters; ++g)
+  {
+    const size_t label = assignments[100 * g];
+    BOOST_REQUIRE_SMALL(centroids(0, label) - 1000.0 * g, 0.5);
+    BOOST_REQUIRE_SMALL(centroids(1, label), 0.5);
+  }
+}
+
+/**
+ * Make sure k-means++ separates the Gaussians.
+ */
+BOOST_AUTO_TEST_CASE(KMeansPlusPlusTest)
+{
+  SeparatedGaussiansPartitionTest(KMeansPlusPlus());
+}
+
+/**
+ * Make sure k-means|| separates the Gaussians.
+ */
+BOOST_AUTO_TEST_CASE(KMeansParallelTest)
+{
+  SeparatedGaussiansPartitionTest(KMeansParallel());
+}
+
+/**
+ * Weighted k-means++ should never pick a point with weight zero, even if it is
+ * far away from every other point.
+ */
+BOOST_AUTO_TEST_CASE(WeightedKMeansPlusPlusTest)
+{
+  arma::mat dataset(2, 200);
+  dataset.randu();
+  dataset.col(199) += arma::vec("1000 1000");
+
+  arma::vec weights;
+  weights.ones(200);
+  weights[199] = 0.0;
+
+  for (size_t trial = 0; trial < 10; ++trial)
+  {
+    arma::Col<size_t> assignments;
+    KMeansPlusPlus::Cluster(dataset, weights, 2, assignments);
+
+    // The faraway point is not a centroid, so it shares its cluster.
+    size_t count = 0;
+    for (size_t i = 0; i < 200; ++i)
+      if (assignments[i] == assignments[199])
+        ++count;
+    BOOST_REQUIRE_GT(count, 1);
+  }
+}
+
 #ifdef ARMA_HAS_SPMAT
 // Can't do this test on Armadillo 3.4; var(SpBase) is not implemented.
 #if !((ARMA_VERSION_MAJOR == 3) && (ARMA_VERSION_MINOR == 4))
@@ -661,4 +751,331 @@ BOOST_AUTO_TEST_CASE(DTNNCoverTreeTest)
   }
 }
 
+/**
+ * Run one iteration of NaiveKMeans and compare with a simple serial loop over
+ * the points.  In 20 dimensions, the distances to the L2 metric are computed by
+ * matrix multiplication; the Manhattan distance is evaluated one pair at a
+ * time.  There are enough points for several blocks.
+ */
+template<typename MetricType>
+void NaiveKMeansIterateTest()
+{
+  arma::mat dataset(20, 5000);
+  dataset.randu();
+  arma::mat centroids(20, 37);
+  centroids.randu();
+
+  MetricType metric;
+  NaiveKMeans<MetricType, arma::mat> naive(dataset, metric);
+  arma::mat newCentroids;
+  arma::Col<size_t> counts;
+  naive.Iterate(centroids, newCentroids, counts);
+
+  arma::mat trueCentroids(20, 37);
+  trueCentroids.zeros();
+  arma::Col<size_t> trueCounts(37);
+  trueCounts.zeros();
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    size_t closest = 0;
+    for (size_t j = 1; j < centroids.n_cols; ++j)
+      if (metric.Evaluate(dataset.col(i), centroids.col(j)) <
+          metric.Evaluate(dataset.col(i), centroids.col(closest)))
+        closest = j;
+
+    trueCentroids.col(closest) += dataset.col(i);
+    trueCounts[closest]++;
+  }
+
+  BOOST_REQUIRE_EQUAL(naive.DistanceCalculations(), 5000 * 37 + 37);
+  for (size_t j = 0; j < centroids.n_cols; ++j)
+  {
+    BOOST_REQUIRE_EQUAL(counts[j], trueCounts[j]);
+    if (trueCounts[j] == 0)
+      continue;
+
+    for (size_t d = 0; d < dataset.n_rows; ++d)
+      BOOST_REQUIRE_CLOSE(newCentroids(d, j), trueCentroids(d, j) /
+          trueCounts[j], 1e-5);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(NaiveKMeansEuclideanIterateTest)
+{
+  NaiveKMeansIterateTest<EuclideanDistance>();
+}
+
+BOOST_AUTO_TEST_CASE(NaiveKMeansManhattanIterateTest)
+{
+  NaiveKMeansIterateTest<ManhattanDistance>();
+}
+
+/**
+ * With AllowEmptyClusters, the centroid of an empty cluster is DBL_MAX and is
+ * used again in the next iteration.  In 10 dimensions the distances are
+ * computed by matrix multiplication; the empty cluster must not keep the other
+ * points from being assigned to their clusters.
+ */
+BOOST_AUTO_TEST_CASE(NaiveKMeansAllowEmptyClusterTest)
+{
+  arma::mat dataset(10, 3000);
+  dataset.randu();
+  for (size_t i = 1000; i < 2000; ++i)
+    dataset.col(i) += 10;
+  for (size_t i = 2000; i < 3000; ++i)
+    dataset.col(i) += 20;
+
+  // The last centroid is far from all the points, so its cluster is empty
+  // from the first iteration on.
+  arma::mat centroids(10, 4);
+  centroids.col(0).fill(1);
+  centroids.col(1).fill(9);
+  centroids.col(2).fill(21);
+  centroids.col(3).fill(1000);
+
+  KMeans<EuclideanDistance, RandomPartition, AllowEmptyClusters> kmeans;
+  arma::Col<size_t> assignments;
+  kmeans.Cluster(dataset, 4, assignments, centroids, false, true);
+
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(assignments[i], i / 1000);
+
+  for (size_t j = 0; j < 3; ++j)
+  {
+    const arma::vec mean = arma::mean(dataset.cols(1000 * j,
+        1000 * j + 999), 1);
+    for (size_t d = 0; d < dataset.n_rows; ++d)
+      BOOST_REQUIRE_CLOSE(centroids(d, j), mean[d], 1e-5);
+  }
+
+  for (size_t d = 0; d < dataset.n_rows; ++d)
+    BOOST_REQUIRE_EQUAL(centroids(d, 3), DBL_MAX);
+}
+
+/**
+ * Re-cluster a dataset after some points were removed and some were added,
+ * starting from the bounds of the first run, and make sure that the result is
+ * the same as when starting from scratch with the same centroids, and that the
+ * bounds save distance calculations.
+ */
+template<template<class, class> class LloydStepType>
+void WarmStartTest()
+{
+  arma::mat dataset(2, 3000);
+  dataset.randn();
+  for (size_t i = 1000; i < 2000; ++i)
+    dataset.col(i) += arma::vec("10 10");
+  for (size_t i = 2000; i < 3000; ++i)
+    dataset.col(i) += arma::vec("-10 10");
+
+  arma::mat centroids("1 8 -8;"
+                      "1 8 8");
+  arma::Col<size_t> assignments;
+  arma::mat bounds;
+
+  KMeans<EuclideanDistance, RandomPartition, MaxVarianceNewCluster,
+      LloydStepType> kmeans;
+  kmeans.Cluster(dataset, 3, assignments, centroids, bounds, true);
+  BOOST_REQUIRE_EQUAL(bounds.n_cols, dataset.n_cols);
+
+  // Remove the first 30 points of each cluster, and add 100 new points.
+  arma::mat newPoints(2, 100);
+  newPoints.randn();
+  newPoints.cols(0, 49) += arma::repmat(arma::vec("10 10"), 1, 50);
+  arma::mat newDataset = arma::join_rows(arma::join_rows(arma::join_rows(
+      dataset.cols(30, 999), dataset.cols(1030, 1999)),
+      dataset.cols(2030, 2999)), newPoints);
+  arma::mat newBounds = arma::join_rows(arma::join_rows(bounds.cols(30, 999),
+      bounds.cols(1030, 1999)), bounds.cols(2030, 2999));
+
+  arma::mat warmCentroids(centroids);
+  arma::Col<size_t> warmAssignments;
+  kmeans.Cluster(newDataset, 3, warmAssignments, warmCentroids, newBounds);
+  BOOST_REQUIRE_EQUAL(newBounds.n_cols, newDataset.n_cols);
+
+  KMeans<> naive;
+  arma::mat naiveCentroids(centroids);
+  arma::Col<size_t> naiveAssignments;
+  naive.Cluster(newDataset, 3, naiveAssignments, naiveCentroids, false, true);
+
+  for (size_t i = 0; i < newDataset.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(warmAssignments[i], naiveAssignments[i]);
+  for (size_t i = 0; i < naiveCentroids.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(warmCentroids[i], naiveCentroids[i], 1e-5);
+
+  // A single step from the saved bounds should give the same centroids as a
+  // step from scratch, with fewer distance calculations.
+  newBounds = arma::join_rows(arma::join_rows(bounds.cols(30, 999),
+      bounds.cols(1030, 1999)), bounds.cols(2030, 2999));
+  EuclideanDistance metric;
+  LloydStepType<EuclideanDistance, arma::mat> cold(newDataset, metric);
+  LloydStepType<EuclideanDistance, arma::mat> warm(newDataset, metric);
+  warm.SetBounds(newBounds, 3);
+
+  arma::mat coldNewCentroids, warmNewCentroids;
+  arma::Col<size_t> coldCounts, warmCounts;
+  cold.Iterate(centroids, coldNewCentroids, coldCounts);
+  warm.Iterate(centroids, warmNewCentroids, warmCounts);
+
+  for (size_t i = 0; i < 3; ++i)
+    BOOST_REQUIRE_EQUAL(coldCounts[i], warmCounts[i]);
+  for (size_t i = 0; i < coldNewCentroids.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(coldNewCentroids[i], warmNewCentroids[i], 1e-5);
+  BOOST_REQUIRE_LT(warm.DistanceCalculations(),
+      cold.DistanceCalculations() / 2);
+}
+
+BOOST_AUTO_TEST_CASE(ElkanWarmStartTest)
+{
+  WarmStartTest<ElkanKMeans>();
+}
+
+BOOST_AUTO_TEST_CASE(HamerlyWarmStartTest)
+{
+  WarmStartTest<HamerlyKMeans>();
+}
+
+/**
+ * Make sure that clustering a dataset read in blocks from disk gives the same
+ * centroids as clustering it in memory, when the same initial centroids are
+ * used.
+ */
+BOOST_AUTO_TEST_CASE(StreamingKMeansTest)
+{
+  arma::mat dataset(2, 3000);
+  dataset.randn();
+  for (size_t i = 1000; i < 2000; ++i)
+    dataset.col(i) += arma::vec("20 20");
+  for (size_t i = 2000; i < 3000; ++i)
+    dataset.col(i) += arma::vec("-20 20");
+
+  data::Save("test_kmeans.csv", dataset);
+
+  // Load it back, so that both runs see exactly the same values.
+  arma::mat loaded;
+  data::Load("test_kmeans.csv", loaded, true);
+
+  arma::mat initialCentroids("1 15 -15;"
+                             "1 15 15");
+
+  KMeans<> kmeans;
+  arma::mat centroids(initialCentroids);
+  kmeans.Cluster(loaded, 3, centroids, true);
+
+  data::StreamReader<> reader("test_kmeans.csv", 256, true);
+  arma::mat streamCentroids(initialCentroids);
+  kmeans.Cluster(reader, 3, streamCentroids, true);
+
+  BOOST_REQUIRE_EQUAL(streamCentroids.n_rows, 2);
+  BOOST_REQUIRE_EQUAL(streamCentroids.n_cols, 3);
+  for (size_t i = 0; i < centroids.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(streamCentroids[i], centroids[i], 1e-5);
+
+  // Without initial centroids, the clusters should still be found.
+  reader.Reset();
+  kmeans.Cluster(reader, 3, streamCentroids);
+
+  arma::mat trueCentroids("0 20 -20;"
+                          "0 20 20");
+  for (size_t i = 0; i < 3; ++i)
+  {
+    double minDistance = DBL_MAX;
+    for (size_t j = 0; j < 3; ++j)
+      minDistance = std::min(minDistance, metric::EuclideanDistance::Evaluate(
+          trueCentroids.col(i), streamCentroids.col(j)));
+    BOOST_REQUIRE_SMALL(minDistance, 0.5);
+  }
+
+  remove("test_kmeans.csv");
+}
+
+/**
+ * Make sure that mini-batch k-means finds centroids close to those of Lloyd's
+ * algorithm on well-separated clusters, with a batch much smaller than the
+ * dataset.
+ */
+BOOST_AUTO_TEST_CASE(MiniBatchKMeansTest)
+{
+  arma::mat dataset(2, 30000);
+  dataset.randn();
+  for (size_t i = 10000; i < 20000; ++i)
+    dataset.col(i) += arma::vec("20 20");
+  for (size_t i = 20000; i < 30000; ++i)
+    dataset.col(i) += arma::vec("-20 20");
+
+  arma::mat initialCentroids("1 15 -15;"
+                             "1 15 15");
+
+  KMeans<> kmeans;
+  arma::mat centroids(initialCentroids);
+  kmeans.Cluster(dataset, 3, centroids, true);
+
+  KMeans<EuclideanDistance, RandomPartition, MaxVarianceNewCluster,
+      MiniBatchKMeans> miniBatch(100);
+  arma::mat miniBatchCentroids(initialCentroids);
+  arma::Col<size_t> assignments;
+  miniBatch.Cluster(dataset, 3, assignments, miniBatchCentroids, false, true);
+
+  for (size_t i = 0; i < 3; ++i)
+    BOOST_REQUIRE_SMALL(EuclideanDistance::Evaluate(centroids.col(i),
+        miniBatchCentroids.col(i)), 0.2);
+
+  // Each cluster should have all of its points.
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(assignments[i], i / 10000);
+
+  // Each step only looks at one batch.
+  EuclideanDistance metric;
+  MiniBatchKMeans<EuclideanDistance, arma::mat> step(dataset, metric, 500);
+  arma::mat newCentroids;
+  arma::Col<size_t> counts;
+  step.Iterate(centroids, newCentroids, counts);
+  step.Iterate(newCentroids, centroids, counts);
+  BOOST_REQUIRE_EQUAL(step.DistanceCalculations(), 2 * (500 * 3 + 3));
+  BOOST_REQUIRE_EQUAL(arma::accu(counts), (size_t) 1000);
+}
+
+/**
+ * Feed mini-batch k-means with the blocks of a dataset read from disk.
+ */
+BOOST_AUTO_TEST_CASE(MiniBatchKMeansStreamingTest)
+{
+  arma::mat dataset(2, 3000);
+  dataset.randn();
+  for (size_t i = 1000; i < 2000; ++i)
+    dataset.col(i) += arma::vec("20 20");
+  for (size_t i = 2000; i < 3000; ++i)
+    dataset.col(i) += arma::vec("-20 20");
+
+  // Shuffle, so that every block holds points of every cluster.
+  dataset = arma::shuffle(dataset, 1);
+  data::Save("test_mini_batch.csv", dataset);
+
+  arma::mat centroids("1 15 -15;"
+                      "1 15 15");
+
+  // The dataset isn't used by Update().
+  EuclideanDistance metric;
+  MiniBatchKMeans<EuclideanDistance, arma::mat> step(dataset, metric);
+
+  data::StreamReader<> reader("test_mini_batch.csv", 100, true);
+  arma::mat block;
+  for (size_t pass = 0; pass < 3; ++pass)
+  {
+    reader.Reset();
+    while (reader.NextBlock(block))
+      step.Update(block, centroids);
+  }
+
+  BOOST_REQUIRE_EQUAL(arma::accu(step.Counts()), (size_t) 9000);
+
+  arma::mat trueCentroids("0 20 -20;"
+                          "0 20 20");
+  for (size_t i = 0; i < 3; ++i)
+    BOOST_REQUIRE_SMALL(EuclideanDistance::Evaluate(trueCentroids.col(i),
+        centroids.col(i)), 0.3);
+
+  remove("test_mini_batch.csv");
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -280,6 +280,177 @@ BOOST_AUTO_TEST_CASE(LoadCSVTxtTest)
   remove("test_file.txt");
 }
 
+/**
+ * Make sure a TSV is loaded correctly.
+ */
+BOOST_AUTO_TEST_CASE(LoadTSVTest)
+{
+  std::fstream f;
+  f.open("test_file.tsv", std::fstream::out);
+
+  f << "1\t2\t3\t4" << std::endl;
+  f << "5\t6\t7\t8" << std::endl;
+
+  f.close();
+
+  arma::mat test;
+  BOOST_REQUIRE(data::Load("test_file.tsv", test) == true);
+
+  BOOST_REQUIRE_EQUAL(test.n_rows, 4);
+  BOOST_REQUIRE_EQUAL(test.n_cols, 2);
+
+  for (int i = 0; i < 8; i++)
+    BOOST_REQUIRE_CLOSE(test[i], (double) (i + 1), 1e-5);
+
+  // Remove the file.
+  remove("test_file.tsv");
+}
+
+/**
+ * Make sure the parser handles blank lines, short lines, empty fields and
+ * unusual numbers the way Armadillo does.
+ */
+BOOST_AUTO_TEST_CASE(ParseTextEdgeCasesTest)
+{
+  std::fstream f;
+  f.open("test_file.csv", std::fstream::out);
+
+  f << "1.5e3, -2, +0.25" << std::endl;
+  f << std::endl;
+  f << ",4\r" << std::endl;
+  f << "1e-300, 12345678901234567890, inf" << std::endl;
+  f << "0.1, -.5e-1, 7,"; // No newline at the end.
+
+  f.close();
+
+  arma::mat test;
+  BOOST_REQUIRE(data::Load("test_file.csv", test, false, false) == true);
+
+  BOOST_REQUIRE_EQUAL(test.n_rows, 4);
+  BOOST_REQUIRE_EQUAL(test.n_cols, 3);
+
+  BOOST_REQUIRE_CLOSE(test(0, 0), 1500.0, 1e-10);
+  BOOST_REQUIRE_CLOSE(test(0, 1), -2.0, 1e-10);
+  BOOST_REQUIRE_CLOSE(test(0, 2), 0.25, 1e-10);
+  BOOST_REQUIRE_SMALL(test(1, 0), 1e-10);
+  BOOST_REQUIRE_CLOSE(test(1, 1), 4.0, 1e-10);
+  BOOST_REQUIRE_SMALL(test(1, 2), 1e-10);
+  BOOST_REQUIRE_CLOSE(test(2, 0), 1e-300, 1e-10);
+  BOOST_REQUIRE_CLOSE(test(2, 1), 12345678901234567890.0, 1e-10);
+  BOOST_REQUIRE(std::isinf(test(2, 2)));
+  BOOST_REQUIRE_CLOSE(test(3, 0), 0.1, 1e-10);
+  BOOST_REQUIRE_CLOSE(test(3, 1), -0.05, 1e-10);
+  BOOST_REQUIRE_CLOSE(test(3, 2), 7.0, 1e-10);
+
+  // Raw ASCII lines must all have the same length.
+  f.open("test_file.txt", std::fstream::out);
+  f << "1 2 3" << std::endl;
+  f << "4 5" << std::endl;
+  f.close();
+
+  Log::Warn.ignoreInput = true;
+  BOOST_REQUIRE(data::Load("test_file.txt", test) == false);
+  Log::Warn.ignoreInput = false;
+
+  // Remove the files.
+  remove("test_file.csv");
+  remove("test_file.txt");
+}
+
+/**
+ * Make sure that a CSV file with a non-numeric header still loads, through
+ * Armadillo.
+ */
+BOOST_AUTO_TEST_CASE(ParseTextFallbackTest)
+{
+  std::fstream f;
+  f.open("test_file.csv", std::fstream::out);
+
+  f << "a, b" << std::endl;
+  f << "1, 2" << std::endl;
+  f << "3, 4" << std::endl;
+
+  f.close();
+
+  arma::mat test;
+  Log::Warn.ignoreInput = true;
+  BOOST_REQUIRE(data::Load("test_file.csv", test) == true);
+  Log::Warn.ignoreInput = false;
+
+  BOOST_REQUIRE_EQUAL(test.n_rows, 2);
+  BOOST_REQUIRE_EQUAL(test.n_cols, 3);
+
+  for (int i = 2; i < 6; i++)
+    BOOST_REQUIRE_CLOSE(test[i], (double) (i - 1), 1e-5);
+
+  // Remove the file.
+  remove("test_file.csv");
+}
+
+/**
+ * Load a large synthetic CSV file (so that it is split into several chunks) and
+ * a raw ASCII file, and make sure the result is the same as Armadillo's, both
+ * transposed and not.
+ */
+BOOST_AUTO_TEST_CASE(ParseTextLargeFileTest)
+{
+  arma::mat dataset(10, 10000);
+  dataset.randn();
+  dataset.row(0) *= 1e10;
+  dataset.row(1) *= 1e-10;
+  dataset(3, 3) = 0.0;
+  dataset(4, 4) = -1.0;
+
+  BOOST_REQUIRE(dataset.quiet_save("test_file.csv", arma::csv_ascii) == true);
+  BOOST_REQUIRE(dataset.quiet_save("test_file.txt", arma::raw_ascii) == true);
+
+  arma::mat armaCSV, armaRaw;
+  BOOST_REQUIRE(armaCSV.quiet_load("test_file.csv", arma::csv_ascii) == true);
+  BOOST_REQUIRE(armaRaw.quiet_load("test_file.txt", arma::raw_ascii) == true);
+
+  arma::mat csv, csvTrans, raw;
+  BOOST_REQUIRE(data::Load("test_file.csv", csv, false, false) == true);
+  BOOST_REQUIRE(data::Load("test_file.csv", csvTrans) == true);
+  BOOST_REQUIRE(data::Load("test_file.txt", raw, false, false) == true);
+
+  BOOST_REQUIRE_EQUAL(csv.n_rows, armaCSV.n_rows);
+  BOOST_REQUIRE_EQUAL(csv.n_cols, armaCSV.n_cols);
+  BOOST_REQUIRE_EQUAL(csvTrans.n_rows, armaCSV.n_cols);
+  BOOST_REQUIRE_EQUAL(csvTrans.n_cols, armaCSV.n_rows);
+  BOOST_REQUIRE_EQUAL(raw.n_rows, armaRaw.n_rows);
+  BOOST_REQUIRE_EQUAL(raw.n_cols, armaRaw.n_cols);
+
+  for (size_t i = 0; i < csv.n_rows; ++i)
+  {
+    for (size_t j = 0; j < csv.n_cols; ++j)
+    {
+      if (std::abs(armaCSV(i, j)) < 1e-20)
+        BOOST_REQUIRE_SMALL(csv(i, j), 1e-20);
+      else
+        BOOST_REQUIRE_CLOSE(csv(i, j), armaCSV(i, j), 1e-10);
+      BOOST_REQUIRE_EQUAL(csvTrans(j, i), csv(i, j));
+    }
+  }
+
+  for (size_t i = 0; i < raw.n_elem; ++i)
+  {
+    if (std::abs(armaRaw[i]) < 1e-20)
+      BOOST_REQUIRE_SMALL(raw[i], 1e-20);
+    else
+      BOOST_REQUIRE_CLOSE(raw[i], armaRaw[i], 1e-10);
+  }
+
+  // Single precision goes through the same parser.
+  arma::fmat csvFloat;
+  BOOST_REQUIRE(data::Load("test_file.csv", csvFloat, false, false) == true);
+  for (size_t i = 0; i < csvFloat.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(csvFloat[i], float(csv[i]));
+
+  // Remove the files.
+  remove("test_file.csv");
+  remove("test_file.txt");
+}
+
 /**
  * Make sure arma_binary is loaded correctly.
  */
@@ -360,6 +531,106 @@ BOOST_AUTO_TEST_CASE(LoadRawBinaryTest)
   remove("test_file.bin");
 }
 
+/**
+ * Make sure an arma_binary file can be mapped into memory, and that the
+ * copy-on-write mapping does not change the file.
+ */
+BOOST_AUTO_TEST_CASE(MappedArmaBinaryTest)
+{
+  arma::mat test = "1 5;"
+                   "2 6;"
+                   "3 7;"
+                   "4 8;";
+
+  // The mapped data is not transposed.
+  BOOST_REQUIRE(test.quiet_save("test_file.bin", arma::arma_binary) == true);
+
+  {
+    data::MappedMatrix<double> mapped;
+    BOOST_REQUIRE(data::Load("test_file.bin", mapped, false, true) == true);
+
+    BOOST_REQUIRE_EQUAL(mapped.Matrix().n_rows, 4);
+    BOOST_REQUIRE_EQUAL(mapped.Matrix().n_cols, 2);
+
+    for (int i = 0; i < 8; i++)
+      BOOST_REQUIRE_CLOSE(mapped.Matrix()[i], (double) (i + 1), 1e-5);
+
+    // Write to the private mapping.
+    mapped.Matrix().fill(0.0);
+  }
+
+  arma::mat reloaded;
+  BOOST_REQUIRE(reloaded.quiet_load("test_file.bin", arma::arma_binary)
+      == true);
+  for (int i = 0; i < 8; i++)
+    BOOST_REQUIRE_CLOSE(reloaded[i], (double) (i + 1), 1e-5);
+
+  // A matrix of a different element type can't be mapped.
+  data::MappedMatrix<float> wrongType;
+  Log::Warn.ignoreInput = true;
+  BOOST_REQUIRE(data::Load("test_file.bin", wrongType) == false);
+  Log::Warn.ignoreInput = false;
+
+  // Remove the file.
+  remove("test_file.bin");
+}
+
+/**
+ * Make sure an Armadillo binary header whose size overflows is rejected, even
+ * though the overflowed size matches the size of the file.
+ */
+BOOST_AUTO_TEST_CASE(MappedArmaBinaryOverflowTest)
+{
+  // 2 * (2^63 + 2) * 8 bytes wraps around to 32 bytes.
+  std::ofstream f("test_file.bin", std::ios::out | std::ios::binary);
+  f << "ARMA_MAT_BIN_FN008\n2 9223372036854775810\n";
+  const double data[4] = { 1.0, 2.0, 3.0, 4.0 };
+  f.write((const char*) data, sizeof(data));
+  f.close();
+
+  data::MappedMatrix<double> mapped;
+  Log::Warn.ignoreInput = true;
+  BOOST_REQUIRE(data::Load("test_file.bin", mapped) == false);
+  Log::Warn.ignoreInput = false;
+
+  remove("test_file.bin");
+}
+
+/**
+ * Make sure a raw_binary file can be mapped into memory with a given number of
+ * rows.
+ */
+BOOST_AUTO_TEST_CASE(MappedRawBinaryTest)
+{
+  arma::mat test = "1 5;"
+                   "2 6;"
+                   "3 7;"
+                   "4 8;";
+
+  BOOST_REQUIRE(test.quiet_save("test_file.bin", arma::raw_binary) == true);
+
+  data::MappedMatrix<double> mapped;
+  BOOST_REQUIRE(data::Load("test_file.bin", mapped, false, false, 4) == true);
+
+  BOOST_REQUIRE_EQUAL(mapped.Matrix().n_rows, 4);
+  BOOST_REQUIRE_EQUAL(mapped.Matrix().n_cols, 2);
+
+  for (int i = 0; i < 8; i++)
+    BOOST_REQUIRE_CLOSE(mapped.Matrix()[i], (double) (i + 1), 1e-5);
+
+  // The number of rows must divide the data.
+  data::MappedMatrix<double> wrongRows;
+  Log::Warn.ignoreInput = true;
+  BOOST_REQUIRE(data::Load("test_file.bin", wrongRows, false, false, 3)
+      == false);
+  Log::Warn.ignoreInput = false;
+
+  mapped.Clear();
+
+  // Remove the file.
+  remove("test_file.bin");
+}
+
 /**
  * Make sure load as PGM is successful.
  */
@@ -600,4 +871,120 @@ BOOST_AUTO_TEST_CASE(NormalizeLabelTest)
     BOOST_REQUIRE_EQUAL(randLabels[i], revertedLabels[i]);
 }
 
+/**
+ * Make sure that reading a CSV file in blocks gives the same points as loading
+ * it all at once, and that the file can be read again after Reset().
+ */
+BOOST_AUTO_TEST_CASE(StreamReaderCSVTest)
+{
+  arma::mat dataset(5, 1000);
+  dataset.randu();
+  data::Save("test_file.csv", dataset);
+
+  arma::mat loaded;
+  data::Load("test_file.csv", loaded, true);
+
+  data::StreamReader<> reader("test_file.csv", 128);
+  BOOST_REQUIRE(reader.IsOpen());
+  BOOST_REQUIRE_EQUAL(reader.Dimensionality(), 5);
+
+  for (size_t pass = 0; pass < 2; ++pass)
+  {
+    arma::mat block;
+    size_t points = 0;
+    while (reader.NextBlock(block))
+    {
+      BOOST_REQUIRE_EQUAL(block.n_rows, 5);
+      BOOST_REQUIRE_LE(block.n_cols, 128);
+      for (size_t i = 0; i < block.n_cols; ++i)
+        for (size_t j = 0; j < 5; ++j)
+          BOOST_REQUIRE_CLOSE(block(j, i), loaded(j, points + i), 1e-5);
+
+      points += block.n_cols;
+    }
+
+    BOOST_REQUIRE_EQUAL(points, 1000);
+    reader.Reset();
+  }
+
+  remove("test_file.csv");
+}
+
+/**
+ * Make sure that Armadillo binary and raw binary files can be read in blocks.
+ */
+BOOST_AUTO_TEST_CASE(StreamReaderBinaryTest)
+{
+  arma::mat dataset(3, 250);
+  dataset.randu();
+
+  // Points are stored one per column, without transposing.
+  BOOST_REQUIRE(dataset.quiet_save("test_file.bin", arma::arma_binary) ==
+      true);
+
+  {
+    data::StreamReader<> reader("test_file.bin", 100);
+    BOOST_REQUIRE(reader.IsOpen());
+    BOOST_REQUIRE_EQUAL(reader.Dimensionality(), 3);
+
+    arma::mat block;
+    size_t points = 0;
+    while (reader.NextBlock(block))
+    {
+      for (size_t i = 0; i < block.n_elem; ++i)
+        BOOST_REQUIRE_EQUAL(block[i], dataset[3 * points + i]);
+      points += block.n_cols;
+    }
+
+    BOOST_REQUIRE_EQUAL(points, 250);
+  }
+
+  // The element type has to match.
+  Log::Warn.ignoreInput = true;
+  data::StreamReader<float> wrongType("test_file.bin", 100);
+  Log::Warn.ignoreInput = false;
+  BOOST_REQUIRE(!wrongType.IsOpen());
+
+  BOOST_REQUIRE(dataset.quiet_save("test_file.bin", arma::raw_binary) == true);
+
+  {
+    data::StreamReader<> reader("test_file.bin", 100, false, 3);
+    BOOST_REQUIRE(reader.IsOpen());
+
+    arma::mat block;
+    size_t points = 0;
+    while (reader.NextBlock(block))
+    {
+      for (size_t i = 0; i < block.n_elem; ++i)
+        BOOST_REQUIRE_EQUAL(block[i], dataset[3 * points + i]);
+      points += block.n_cols;
+    }
+
+    BOOST_REQUIRE_EQUAL(points, 250);
+  }
+
+  remove("test_file.bin");
+}
+
+/**
+ * Make sure the StreamReader rejects an Armadillo binary header whose size
+ * overflows, even though the overflowed size matches the size of the file.
+ */
+BOOST_AUTO_TEST_CASE(StreamReaderBinaryOverflowTest)
+{
+  // 2 * (2^63 + 2) * 8 bytes wraps around to 32 bytes.
+  std::ofstream f("test_file.bin", std::ios::out | std::ios::binary);
+  f << "ARMA_MAT_BIN_FN008\n2 9223372036854775810\n";
+  const double data[4] = { 1.0, 2.0, 3.0, 4.0 };
+  f.write((const char*) data, sizeof(data));
+  f.close();
+
+  Log::Warn.ignoreInput = true;
+  data::StreamReader<> reader("test_file.bin", 100);
+  Log::Warn.ignoreInput = false;
+  BOOST_REQUIRE(!reader.IsOpen());
+
+  remove("test_file.bin");
+}
+
 BOOST_AUTO_TEST_SUITE_END();
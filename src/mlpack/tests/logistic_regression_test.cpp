@@ -40,6 +40,40 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionEvaluate)
   BOOST_REQUIRE_CLOSE(lrf.Evaluate(arma::vec("200 -100 20")), 0.0, 1e-5);
 }
 
+/**
+ * Make sure that a copy of a LogisticRegressionFunction on a block of points
+ * (from SetBlock()) keeps its own block, and that the block can be changed in
+ * the original without affecting the copy.
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionCopyBlock)
+{
+  arma::mat data("1 2 3;"
+                 "1 2 3");
+  arma::vec responses("1 1 0");
+  LogisticRegressionFunction lrf(data, responses, 0.0);
+
+  // The block holds the same points, with the responses as the last row.
+  arma::mat block("1 2 3;"
+                  "1 2 3;"
+                  "1 1 0");
+  lrf.SetBlock(block);
+
+  LogisticRegressionFunction copy(lrf);
+  LogisticRegressionFunction assigned(data, responses, 0.0);
+  assigned = lrf;
+
+  // Replace the block of the original with one point, and destroy it.
+  lrf.SetBlock(arma::mat("5; 5; 0"));
+  BOOST_REQUIRE_EQUAL(lrf.NumFunctions(), 1);
+  lrf = LogisticRegressionFunction(data, responses, 0.0);
+
+  BOOST_REQUIRE_EQUAL(copy.NumFunctions(), 3);
+  BOOST_REQUIRE_EQUAL(assigned.NumFunctions(), 3);
+  BOOST_REQUIRE_CLOSE(copy.Evaluate(arma::vec("1 1 1")), 7.0562141665, 1e-5);
+  BOOST_REQUIRE_CLOSE(assigned.Evaluate(arma::vec("1 1 1")), 7.0562141665,
+      1e-5);
+}
+
 /**
  * A more complicated test for the LogisticRegressionFunction.
  */
@@ -696,4 +730,92 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionInstantiatedOptimizer)
   BOOST_REQUIRE_SMALL(sigmoids[2], 0.1);
 }
 
+/**
+ * Test that SGD can train a logistic regression model on a dataset read from
+ * disk in blocks.
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionSGDStreamingTest)
+{
+  // The function only needs the dimensionality of the data; the points come
+  // from the blocks.
+  arma::mat predictors("1 2 3;"
+                       "1 2 3;"
+                       "1 2 3");
+  arma::vec responses("1 1 0");
+  LogisticRegressionFunction lrf(predictors, responses, 0.0005);
+
+  // Generate a two-Gaussian dataset, with the responses in the last row.
+  GaussianDistribution g1(arma::vec("1.0 1.0 1.0"), arma::eye<arma::mat>(3, 3));
+  GaussianDistribution g2(arma::vec("9.0 9.0 9.0"), arma::eye<arma::mat>(3, 3));
+
+  arma::mat dataset(4, 1000);
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    dataset.submat(0, i, 2, i) = (i % 2 == 0) ? g1.Random() : g2.Random();
+    dataset(3, i) = (i % 2 == 0) ? 0 : 1;
+  }
+  data::Save("test_lr.csv", dataset);
+
+  SGD<LogisticRegressionFunction> sgd(lrf, 0.01, 20000, 1e-10);
+  data::StreamReader<> reader("test_lr.csv", 100, true);
+  arma::mat parameters = lrf.GetInitialPoint();
+  sgd.Optimize(reader, parameters);
+
+  // Check the accuracy on the training set.
+  const arma::vec sigmoids = 1 / (1 + arma::exp(-parameters[0] -
+      dataset.rows(0, 2).t() * parameters.rows(1, 3)));
+  size_t correct = 0;
+  for (size_t i = 0; i < 1000; ++i)
+    if ((sigmoids[i] >= 0.5) == (dataset(3, i) == 1))
+      ++correct;
+
+  BOOST_REQUIRE_GE(correct, 995);
+
+  remove("test_lr.csv");
+}
+
+/**
+ * With regularization, SGD on a dataset read in blocks must optimize the same
+ * objective as SGD on the dataset in memory: without shuffling, the points are
+ * visited in the same order, so the parameters must be the same.  The last
+ * block is shorter than the others.
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionSGDStreamingRegularizationTest)
+{
+  GaussianDistribution g1(arma::vec("1.0 1.0 1.0"), arma::eye<arma::mat>(3, 3));
+  GaussianDistribution g2(arma::vec("3.0 3.0 3.0"), arma::eye<arma::mat>(3, 3));
+
+  arma::mat dataset(4, 1000);
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    dataset.submat(0, i, 2, i) = (i % 2 == 0) ? g1.Random() : g2.Random();
+    dataset(3, i) = (i % 2 == 0) ? 0 : 1;
+  }
+  data::Save("test_lr.csv", dataset);
+
+  // Use the data as it was saved, so both optimizations see the same points.
+  arma::mat loaded;
+  data::Load("test_lr.csv", loaded, true);
+  const arma::mat predictors = loaded.rows(0, 2);
+  const arma::vec responses = arma::trans(loaded.row(3));
+
+  // The tolerance is never reached, so both make the same number of updates.
+  LogisticRegressionFunction lrf(predictors, responses, 0.5);
+  SGD<LogisticRegressionFunction> sgd(lrf, 0.01, 5001, 0.0, false);
+  arma::mat parameters = lrf.GetInitialPoint();
+  const double objective = sgd.Optimize(parameters);
+
+  LogisticRegressionFunction streamLrf(predictors, responses, 0.5);
+  SGD<LogisticRegressionFunction> streamSgd(streamLrf, 0.01, 5001, 0.0, false);
+  data::StreamReader<> reader("test_lr.csv", 300, true);
+  arma::mat streamParameters = streamLrf.GetInitialPoint();
+  const double streamObjective = streamSgd.Optimize(reader, streamParameters);
+
+  for (size_t i = 0; i < parameters.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(streamParameters[i], parameters[i], 1e-5);
+  BOOST_REQUIRE_CLOSE(streamObjective, objective, 1e-5);
+
+  remove("test_lr.csv");
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -5,6 +5,7 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
+#include <mlpack/core/metrics/block_evaluate.hpp>
 #include <boost/test/unit_test.hpp>
 #include "old_boost_test_definitions.hpp"
 
@@ -82,4 +83,122 @@ BOOST_AUTO_TEST_CASE(LINFMetricTest)
                       lMetric.Evaluate(a2, b2), 1e-5);
 }
 
+/**
+ * Make sure that BlockEvaluate() gives the same distances as Evaluate(), both
+ * for the matrix multiplication version (L2) and the general version (L1).
+ */
+BOOST_AUTO_TEST_CASE(BlockEvaluateTest)
+{
+  arma::mat a(20, 50);
+  a.randn();
+  arma::mat b(20, 40);
+  b.randn();
+
+  EuclideanDistance l2;
+  SquaredEuclideanDistance squaredL2;
+  ManhattanDistance l1;
+
+  arma::mat l2Distances, squaredL2Distances, l1Distances;
+  BlockEvaluate(l2, a, 5, 30, b, 10, 25, l2Distances);
+  BlockEvaluate(squaredL2, a, 5, 30, b, 10, 25, squaredL2Distances);
+  BlockEvaluate(l1, a, 5, 30, b, 10, 25, l1Distances);
+
+  BOOST_REQUIRE_EQUAL(l2Distances.n_rows, 30);
+  BOOST_REQUIRE_EQUAL(l2Distances.n_cols, 25);
+  BOOST_REQUIRE_EQUAL(l1Distances.n_rows, 30);
+  BOOST_REQUIRE_EQUAL(l1Distances.n_cols, 25);
+
+  for (size_t i = 0; i < 30; ++i)
+  {
+    for (size_t j = 0; j < 25; ++j)
+    {
+      BOOST_REQUIRE_CLOSE(l2Distances(i, j),
+          l2.Evaluate(a.col(5 + i), b.col(10 + j)), 1e-5);
+      BOOST_REQUIRE_CLOSE(squaredL2Distances(i, j),
+          squaredL2.Evaluate(a.col(5 + i), b.col(10 + j)), 1e-5);
+      BOOST_REQUIRE_CLOSE(l1Distances(i, j),
+          l1.Evaluate(a.col(5 + i), b.col(10 + j)), 1e-5);
+    }
+  }
+
+  // The distance between a point and itself must not go negative.
+  BlockEvaluate(squaredL2, a, 0, 50, a, 0, 50, squaredL2Distances);
+  for (size_t i = 0; i < 50; ++i)
+    BOOST_REQUIRE_SMALL(squaredL2Distances(i, i), 1e-10);
+  BOOST_REQUIRE_GE(squaredL2Distances.min(), 0.0);
+
+  BOOST_REQUIRE(BlockEvaluateTraits<EuclideanDistance,
+      arma::mat>::IsFaster(64));
+  BOOST_REQUIRE(!BlockEvaluateTraits<ManhattanDistance,
+      arma::mat>::IsFaster(64));
+  BOOST_REQUIRE(!BlockEvaluateTraits<EuclideanDistance,
+      arma::sp_mat>::IsFaster(64));
+}
+
+/**
+ * Make sure that a point that is not finite (like the DBL_MAX centroid k-means
+ * gives to an empty cluster) does not spoil the distances between the other
+ * points of the blocks, and is infinitely far from all of them.
+ */
+BOOST_AUTO_TEST_CASE(BlockEvaluateNonFiniteTest)
+{
+  arma::mat a(20, 10);
+  a.randu();
+  a.col(3).fill(DBL_MAX);
+  arma::mat b(20, 30);
+  b.randu();
+  b.col(7).fill(DBL_MAX);
+
+  EuclideanDistance l2;
+  arma::mat distances;
+  BlockEvaluate(l2, a, 0, 10, b, 0, 30, distances);
+
+  for (size_t i = 0; i < 10; ++i)
+  {
+    for (size_t j = 0; j < 30; ++j)
+    {
+      if (i == 3 || j == 7)
+        BOOST_REQUIRE(distances(i, j) > DBL_MAX);
+      else
+        BOOST_REQUIRE_CLOSE(distances(i, j), l2.Evaluate(a.col(i), b.col(j)),
+            1e-5);
+    }
+  }
+}
+
+/**
+ * Make sure that BlockEvaluate() keeps its precision for single-precision data
+ * far from the origin, where the squared norms are much larger than the
+ * distances.
+ */
+BOOST_AUTO_TEST_CASE(FloatOffsetBlockEvaluateTest)
+{
+  arma::fmat a(10, 30);
+  a.randn();
+  a += 1000.0f;
+  arma::fmat b(10, 20);
+  b.randn();
+  b += 1000.0f;
+
+  EuclideanDistance l2;
+  SquaredEuclideanDistance squaredL2;
+  BOOST_REQUIRE(BlockEvaluateTraits<EuclideanDistance,
+      arma::fmat>::IsFaster(a.n_rows));
+
+  arma::fmat l2Distances, squaredL2Distances;
+  BlockEvaluate(l2, a, 0, 30, b, 0, 20, l2Distances);
+  BlockEvaluate(squaredL2, a, 0, 30, b, 0, 20, squaredL2Distances);
+
+  for (size_t i = 0; i < 30; ++i)
+  {
+    for (size_t j = 0; j < 20; ++j)
+    {
+      BOOST_REQUIRE_CLOSE(l2Distances(i, j),
+          (float) l2.Evaluate(a.col(i), b.col(j)), 1e-3);
+      BOOST_REQUIRE_CLOSE(squaredL2Distances(i, j),
+          (float) squaredL2.Evaluate(a.col(i), b.col(j)), 1e-3);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
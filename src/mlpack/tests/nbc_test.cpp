@@ -122,4 +122,48 @@ BOOST_AUTO_TEST_CASE(NaiveBayesClassifierIncrementalTest)
     BOOST_REQUIRE_EQUAL(testRes(i), calcVec(i));
 }
 
+// The same test, but the training set is read from disk in blocks.
+BOOST_AUTO_TEST_CASE(NaiveBayesClassifierStreamingTest)
+{
+  const char* trainFilename = "trainSet.csv";
+  const char* trainResultFilename = "trainRes.csv";
+  size_t classes = 2;
+
+  arma::mat trainRes;
+  data::Load(trainResultFilename, trainRes, true);
+
+  // The labels in the last row of the training set are already 0 and 1.
+  data::StreamReader<> reader(trainFilename, 50, true);
+  NaiveBayesClassifier<> nbcTest(reader, classes);
+
+  const size_t dimension = nbcTest.Means().n_rows;
+  for (size_t i = 0; i < dimension; i++)
+  {
+    for (size_t j = 0; j < classes; j++)
+    {
+      BOOST_REQUIRE_CLOSE(trainRes(i, j) + .00001, nbcTest.Means()(i, j),
+          0.01);
+      BOOST_REQUIRE_CLOSE(trainRes(i + dimension, j) + .00001,
+          nbcTest.Variances()(i, j), 0.01);
+    }
+  }
+
+  for (size_t i = 0; i < classes; i++)
+    BOOST_REQUIRE_CLOSE(trainRes(2 * dimension, i) + .00001,
+        nbcTest.Probabilities()(i), 0.01);
+}
+
+// An empty file holds no points to train on, so it must be reported.
+BOOST_AUTO_TEST_CASE(NaiveBayesClassifierEmptyStreamTest)
+{
+  std::ofstream empty("nbc_empty.bin", std::ios::binary);
+  empty.close();
+
+  // An empty raw binary file is a valid stream of 3-dimensional points.
+  data::StreamReader<> reader("nbc_empty.bin", 50, true, 3);
+  BOOST_REQUIRE_THROW(NaiveBayesClassifier<>(reader, 2), std::runtime_error);
+
+  remove("nbc_empty.bin");
+}
+
 BOOST_AUTO_TEST_SUITE_END();
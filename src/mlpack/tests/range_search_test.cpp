@@ -21,9 +21,10 @@ BOOST_AUTO_TEST_SUITE(RangeSearchTest);
 
 // Get our results into a sorted format, so we can actually then test for
 // correctness.
+template<typename eT>
 void SortResults(const vector<vector<size_t>>& neighbors,
-                 const vector<vector<double>>& distances,
-                 vector<vector<pair<double, size_t>>>& output)
+                 const vector<vector<eT>>& distances,
+                 vector<vector<pair<eT, size_t>>>& output)
 {
   output.resize(neighbors.size());
   for (size_t i = 0; i < neighbors.size(); i++)
@@ -489,6 +490,51 @@ BOOST_AUTO_TEST_CASE(DualTreeVsNaive1)
   }
 }
 
+/**
+ * Test the dual-tree range search method in single precision with the naive
+ * method in single precision, and make sure the distances are close to the
+ * double precision results.
+ */
+BOOST_AUTO_TEST_CASE(FloatDualTreeVsNaive)
+{
+  arma::mat dataset;
+  if (!data::Load("test_data_3_1000.csv", dataset))
+    BOOST_FAIL("Cannot load test dataset test_data_3_1000.csv!");
+  arma::fmat floatDataset = arma::conv_to<arma::fmat>::from(dataset);
+
+  typedef BinarySpaceTree<HRectBound<2>, RangeSearchStat, arma::fmat>
+      FloatTreeType;
+  RangeSearch<metric::EuclideanDistance, FloatTreeType> rs(floatDataset);
+  RangeSearch<metric::EuclideanDistance, FloatTreeType> naive(floatDataset,
+      true);
+
+  vector<vector<size_t>> neighborsTree;
+  vector<vector<float>> distancesTree;
+  rs.Search(Range(0.25, 1.05), neighborsTree, distancesTree);
+  vector<vector<pair<float, size_t>>> sortedTree;
+  SortResults(neighborsTree, distancesTree, sortedTree);
+
+  vector<vector<size_t>> neighborsNaive;
+  vector<vector<float>> distancesNaive;
+  naive.Search(Range(0.25, 1.05), neighborsNaive, distancesNaive);
+  vector<vector<pair<float, size_t>>> sortedNaive;
+  SortResults(neighborsNaive, distancesNaive, sortedNaive);
+
+  for (size_t i = 0; i < sortedTree.size(); i++)
+  {
+    BOOST_REQUIRE(sortedTree[i].size() == sortedNaive[i].size());
+
+    for (size_t j = 0; j < sortedTree[i].size(); j++)
+    {
+      BOOST_REQUIRE(sortedTree[i][j].second == sortedNaive[i][j].second);
+      BOOST_REQUIRE_CLOSE(sortedTree[i][j].first, sortedNaive[i][j].first,
+          1e-5);
+      BOOST_REQUIRE_CLOSE((double) sortedTree[i][j].first, arma::norm(
+          dataset.col(i) - dataset.col(sortedTree[i][j].second), 2), 1e-3);
+    }
+  }
+}
+
 /**
  * Test the dual-tree range search method with the naive method.  This uses
  * only a reference dataset.
@@ -164,4 +164,139 @@ BOOST_AUTO_TEST_CASE(SaveRestoreModelChildClassUsage)
   BOOST_REQUIRE(loader.AnInt() == s);
 }
 
+/**
+ * Perform a save and restore on basic types, matrices and children with the
+ * binary format.
+ */
+BOOST_AUTO_TEST_CASE(SaveRestoreBinary)
+{
+  int i = -23;
+  double d = 3.14159;
+  std::string cc = "Hello world!";
+  arma::mat matrix = arma::randu<arma::mat>(10, 7);
+  arma::Col<size_t> vec("3 1 4 1 5");
+  arma::fmat empty;
+
+  SaveRestoreUtility sr, child;
+  sr.SaveParameter(ARGSTR(i));
+  sr.SaveParameter(ARGSTR(d));
+  sr.SaveParameter(ARGSTR(cc));
+  sr.SaveParameter(ARGSTR(matrix));
+  sr.SaveParameter(ARGSTR(empty));
+  child.SaveParameter(ARGSTR(vec));
+  sr.AddChild(child, "child");
+  BOOST_REQUIRE(sr.WriteFile("test_binary.bin") == true);
+
+  SaveRestoreUtility loader;
+  BOOST_REQUIRE(loader.ReadFile("test_binary.bin") == true);
+
+  int i2;
+  double d2;
+  std::string cc2;
+  arma::mat matrix2;
+  arma::Col<size_t> vec2;
+  arma::fmat empty2(3, 3);
+  BOOST_REQUIRE_EQUAL(loader.LoadParameter(i2, "i"), i);
+  BOOST_REQUIRE_CLOSE(loader.LoadParameter(d2, "d"), d, 1e-5);
+  BOOST_REQUIRE_EQUAL(loader.LoadParameter(cc2, "cc"), cc);
+  loader.LoadParameter(matrix2, "matrix");
+  loader.LoadParameter(empty2, "empty");
+  loader.Children().at("child").LoadParameter(vec2, "vec");
+
+  // The binary format stores matrices exactly.
+  BOOST_REQUIRE_EQUAL(matrix2.n_rows, 10);
+  BOOST_REQUIRE_EQUAL(matrix2.n_cols, 7);
+  for (size_t j = 0; j < matrix.n_elem; ++j)
+    BOOST_REQUIRE_EQUAL(matrix[j], matrix2[j]);
+
+  BOOST_REQUIRE_EQUAL(empty2.n_elem, 0);
+
+  BOOST_REQUIRE_EQUAL(vec2.n_elem, 5);
+  for (size_t j = 0; j < vec.n_elem; ++j)
+    BOOST_REQUIRE_EQUAL(vec[j], vec2[j]);
+
+  // A matrix can be loaded with another element type.
+  arma::fmat fmatrix;
+  loader.LoadParameter(fmatrix, "matrix");
+  for (size_t j = 0; j < matrix.n_elem; ++j)
+    BOOST_REQUIRE_CLOSE(fmatrix[j], (float) matrix[j], 1e-3);
+
+  remove("test_binary.bin");
+}
+
+/**
+ * Make sure a model read from a binary file can be written as XML.
+ */
+BOOST_AUTO_TEST_CASE(ConvertBinaryToXML)
+{
+  arma::mat matrix;
+  matrix <<  1.2 << 2.3 << -0.1 << arma::endr
+         <<  3.5 << 2.4 << -1.2 << arma::endr;
+  size_t s = 12;
+
+  SaveRestoreUtility sr;
+  sr.SaveParameter(ARGSTR(matrix));
+  sr.SaveParameter(ARGSTR(s));
+  sr.WriteFile("test_convert.bin");
+
+  SaveRestoreUtility binary;
+  binary.ReadFile("test_convert.bin");
+  binary.WriteFile("test_convert.xml");
+
+  SaveRestoreUtility xml;
+  xml.ReadFile("test_convert.xml");
+
+  arma::mat matrix2;
+  size_t s2;
+  xml.LoadParameter(matrix2, "matrix");
+  BOOST_REQUIRE_EQUAL(xml.LoadParameter(s2, "s"), s);
+
+  BOOST_REQUIRE_EQUAL(matrix2.n_rows, 2);
+  BOOST_REQUIRE_EQUAL(matrix2.n_cols, 3);
+  for (size_t j = 0; j < matrix.n_elem; ++j)
+    BOOST_REQUIRE_CLOSE(matrix[j], matrix2[j], 1e-5);
+
+  remove("test_convert.bin");
+  remove("test_convert.xml");
+}
+
+/**
+ * Saving a parameter under the name of an earlier one should replace it, also
+ * when the earlier one was a dense matrix.
+ */
+BOOST_AUTO_TEST_CASE(OverwriteMatrixParameter)
+{
+  arma::mat dense = arma::randu<arma::mat>(4, 4);
+  arma::sp_mat sparse(4, 4);
+  sparse(1, 2) = 0.5;
+  sparse(3, 3) = 1.5;
+  size_t s = 7;
+
+  SaveRestoreUtility sr;
+  sr.SaveParameter(dense, "sparse");
+  sr.SaveParameter(sparse, "sparse");
+  sr.SaveParameter(dense, "s");
+  sr.SaveParameter(s, "s");
+
+  const char* filenames[] = { "test_overwrite.bin", "test_overwrite.xml" };
+  for (size_t f = 0; f < 2; ++f)
+  {
+    BOOST_REQUIRE(sr.WriteFile(filenames[f]) == true);
+
+    SaveRestoreUtility loader;
+    BOOST_REQUIRE(loader.ReadFile(filenames[f]) == true);
+
+    arma::sp_mat sparse2;
+    size_t s2;
+    loader.LoadParameter(sparse2, "sparse");
+    BOOST_REQUIRE_EQUAL(loader.LoadParameter(s2, "s"), s);
+
+    BOOST_REQUIRE_EQUAL(sparse2.n_nonzero, 2);
+    BOOST_REQUIRE_CLOSE((double) sparse2(1, 2), 0.5, 1e-5);
+    BOOST_REQUIRE_CLOSE((double) sparse2(3, 3), 1.5, 1e-5);
+
+    remove(filenames[f]);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
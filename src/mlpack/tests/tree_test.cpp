@@ -9,10 +9,15 @@
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/core/tree/cover_tree/cover_tree.hpp>
 #include <mlpack/core/tree/rectangle_tree.hpp>
+#include <mlpack/core/tree/flat_binary_space_tree.hpp>
 
 #include <queue>
 #include <stack>
 
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
 #include <boost/test/unit_test.hpp>
 #include "old_boost_test_definitions.hpp"
 
@@ -1913,6 +1918,182 @@ BOOST_AUTO_TEST_CASE(BinarySpaceTreeCopyConstructor)
   BOOST_REQUIRE_EQUAL(b.Right()->Right(), c.Right()->Right());
 }
 
+//! Make sure that the two trees are exactly the same, recursively.
+template<typename TreeType>
+void CheckSameTree(const TreeType& a, const TreeType& b)
+{
+  BOOST_REQUIRE_EQUAL(a.Begin(), b.Begin());
+  BOOST_REQUIRE_EQUAL(a.Count(), b.Count());
+  BOOST_REQUIRE_EQUAL(a.NumChildren(), b.NumChildren());
+  BOOST_REQUIRE_EQUAL(a.ParentDistance(), b.ParentDistance());
+  BOOST_REQUIRE_EQUAL(a.FurthestDescendantDistance(),
+      b.FurthestDescendantDistance());
+  for (size_t d = 0; d < a.Bound().Dim(); ++d)
+  {
+    BOOST_REQUIRE_EQUAL(a.Bound()[d].Lo(), b.Bound()[d].Lo());
+    BOOST_REQUIRE_EQUAL(a.Bound()[d].Hi(), b.Bound()[d].Hi());
+  }
+  BOOST_REQUIRE_EQUAL(a.Bound().MinWidth(), b.Bound().MinWidth());
+
+  if (!a.IsLeaf())
+  {
+    CheckSameTree(*a.Left(), *b.Left());
+    CheckSameTree(*a.Right(), *b.Right());
+  }
+}
+
+/**
+ * Build a kd-tree large enough to be built in parallel, with one thread and
+ * then with several threads, and make sure the trees, the reordered datasets,
+ * and the mappings are exactly the same.
+ */
+BOOST_AUTO_TEST_CASE(ParallelBuildTest)
+{
+  typedef BinarySpaceTree<HRectBound<2> > TreeType;
+
+  arma::mat dataset;
+  dataset.randu(4, 5 * TreeType::ParallelBuildSize);
+  arma::mat serialDataset(dataset);
+
+#ifdef _OPENMP
+  const int threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+#endif
+
+  std::vector<size_t> serialOldFromNew, serialNewFromOld;
+  TreeType serialTree(serialDataset, serialOldFromNew, serialNewFromOld, 15);
+
+#ifdef _OPENMP
+  omp_set_num_threads(std::max(threads, 4));
+#endif
+
+  std::vector<size_t> oldFromNew, newFromOld;
+  TreeType tree(dataset, oldFromNew, newFromOld, 15);
+
+#ifdef _OPENMP
+  omp_set_num_threads(threads);
+#endif
+
+  BOOST_REQUIRE_EQUAL(accu(dataset != serialDataset), (size_t) 0);
+  BOOST_REQUIRE_EQUAL(oldFromNew.size(), serialOldFromNew.size());
+  for (size_t i = 0; i < oldFromNew.size(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(oldFromNew[i], serialOldFromNew[i]);
+    BOOST_REQUIRE_EQUAL(newFromOld[i], serialNewFromOld[i]);
+  }
+
+  CheckSameTree(tree, serialTree);
+}
+
+/**
+ * Make sure that the given node of a flat tree is an exact copy of the given
+ * node of a BinarySpaceTree, recursively, and that every node comes after its
+ * parent in the layout.
+ */
+template<typename FlatTreeType, typename TreeType>
+void CheckFlatTree(const FlatTreeType& flat,
+                   const TreeType& node,
+                   std::vector<bool>& seen)
+{
+  BOOST_REQUIRE_LT(flat.Index(), seen.size());
+  BOOST_REQUIRE(!seen[flat.Index()]);
+  seen[flat.Index()] = true;
+  if (flat.Parent() != NULL)
+    BOOST_REQUIRE_LT(flat.Parent()->Index(), flat.Index());
+
+  BOOST_REQUIRE_EQUAL(flat.Begin(), node.Begin());
+  BOOST_REQUIRE_EQUAL(flat.Count(), node.Count());
+  BOOST_REQUIRE_EQUAL(flat.NumChildren(), node.NumChildren());
+  BOOST_REQUIRE_EQUAL(flat.NumPoints(), node.NumPoints());
+  BOOST_REQUIRE_CLOSE(flat.ParentDistance() + 1.0, node.ParentDistance() + 1.0,
+      1e-10);
+  BOOST_REQUIRE_CLOSE(flat.FurthestDescendantDistance() + 1.0,
+      node.FurthestDescendantDistance() + 1.0, 1e-10);
+  BOOST_REQUIRE_CLOSE(flat.FurthestPointDistance() + 1.0,
+      node.FurthestPointDistance() + 1.0, 1e-10);
+
+  arma::vec flatCentroid, centroid;
+  flat.Centroid(flatCentroid);
+  node.Bound().Centroid(centroid);
+  for (size_t i = 0; i < centroid.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(flatCentroid[i] + 1.0, centroid[i] + 1.0, 1e-10);
+
+  // The distances to a point must be the same as those of the bound.
+  arma::vec point("0.3 -0.2 0.6");
+  BOOST_REQUIRE_CLOSE(flat.MinDistance(point) + 1.0,
+      node.MinDistance(point) + 1.0, 1e-10);
+  BOOST_REQUIRE_CLOSE(flat.MaxDistance(point), node.MaxDistance(point), 1e-10);
+  const Range flatRange = flat.RangeDistance(point);
+  const Range range = node.RangeDistance(point);
+  BOOST_REQUIRE_CLOSE(flatRange.Lo() + 1.0, range.Lo() + 1.0, 1e-10);
+  BOOST_REQUIRE_CLOSE(flatRange.Hi(), range.Hi(), 1e-10);
+
+  if (!node.IsLeaf())
+  {
+    BOOST_REQUIRE_EQUAL(flat.Left()->Parent(), &flat);
+    BOOST_REQUIRE_EQUAL(flat.Right()->Parent(), &flat);
+
+    // Node-to-node distances between the children.
+    BOOST_REQUIRE_CLOSE(flat.Left()->MinDistance(flat.Right()) + 1.0,
+        node.Left()->MinDistance(node.Right()) + 1.0, 1e-10);
+    BOOST_REQUIRE_CLOSE(flat.Left()->MaxDistance(flat.Right()),
+        node.Left()->MaxDistance(node.Right()), 1e-10);
+    const Range childRange = flat.Left()->RangeDistance(flat.Right());
+    BOOST_REQUIRE_CLOSE(childRange.Lo() + 1.0,
+        node.Left()->MinDistance(node.Right()) + 1.0, 1e-10);
+    BOOST_REQUIRE_CLOSE(childRange.Hi(),
+        node.Left()->MaxDistance(node.Right()), 1e-10);
+
+    CheckFlatTree(*flat.Left(), *node.Left(), seen);
+    CheckFlatTree(*flat.Right(), *node.Right(), seen);
+  }
+}
+
+/**
+ * Build a flat tree with each layout and make sure it has exactly the structure
+ * and the bounds of the equivalent BinarySpaceTree.
+ */
+BOOST_AUTO_TEST_CASE(FlatBinarySpaceTreeTest)
+{
+  arma::mat dataset;
+  dataset.randu(3, 1000);
+  arma::mat flatDataset(dataset);
+  arma::mat vebDataset(dataset);
+
+  std::vector<size_t> oldFromNew, flatOldFromNew, vebOldFromNew;
+  BinarySpaceTree<HRectBound<2> > tree(dataset, oldFromNew, 10);
+  FlatBinarySpaceTree<> flatTree(flatDataset, flatOldFromNew, 10);
+  FlatBinarySpaceTree<EmptyStatistic, arma::mat, VanEmdeBoasLayout>
+      vebTree(vebDataset, vebOldFromNew, 10);
+
+  // The points must be ordered the same way.
+  for (size_t i = 0; i < oldFromNew.size(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(flatOldFromNew[i], oldFromNew[i]);
+    BOOST_REQUIRE_EQUAL(vebOldFromNew[i], oldFromNew[i]);
+  }
+  BOOST_REQUIRE_EQUAL(accu(flatDataset != dataset), (size_t) 0);
+
+  BOOST_REQUIRE_EQUAL(flatTree.TreeSize(), tree.TreeSize());
+  BOOST_REQUIRE_EQUAL(flatTree.TreeDepth(), tree.TreeDepth());
+  BOOST_REQUIRE_EQUAL(vebTree.TreeSize(), tree.TreeSize());
+  BOOST_REQUIRE_EQUAL(vebTree.TreeDepth(), tree.TreeDepth());
+
+  std::vector<bool> seen(tree.TreeSize(), false);
+  CheckFlatTree(flatTree, tree, seen);
+  for (size_t i = 0; i < seen.size(); ++i)
+    BOOST_REQUIRE(seen[i]);
+
+  seen.assign(tree.TreeSize(), false);
+  CheckFlatTree(vebTree, tree, seen);
+  for (size_t i = 0; i < seen.size(); ++i)
+    BOOST_REQUIRE(seen[i]);
+
+  // In the breadth-first layout the children of the root come right after it.
+  BOOST_REQUIRE_EQUAL(flatTree.Left()->Index(), (size_t) 1);
+  BOOST_REQUIRE_EQUAL(flatTree.Right()->Index(), (size_t) 2);
+}
+
 //! Count the number of leaves under this node.
 template<typename TreeType>
 size_t NumLeaves(TreeType* node)